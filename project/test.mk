@@ -5,6 +5,7 @@
 TEST_AEROSPIKE = aerospike_test.c
 TEST_AEROSPIKE += aerospike_batch/*.c
 TEST_AEROSPIKE += aerospike_bit/*.c
+TEST_AEROSPIKE += aerospike_cluster/*.c
 TEST_AEROSPIKE += aerospike_index/*.c
 TEST_AEROSPIKE += aerospike_geo/*.c
 TEST_AEROSPIKE += aerospike_info/*.c
@@ -56,6 +57,10 @@ ifeq ($(EVENT_LIB),libevent)
   TEST_LDFLAGS += -levent_core -levent_pthreads
 endif
 
+ifeq ($(EVENT_LIB),liburing)
+  TEST_LDFLAGS += -luring
+endif
+
 AS_HOST := 127.0.0.1
 AS_PORT := 3000
 AS_ARGS := -h $(AS_HOST) -p $(AS_PORT)
@@ -75,6 +80,12 @@ test-valgrind: test-build
 .PHONY: test-build
 test-build: $(TARGET_TEST)/aerospike_test
 
+# Objects do not depend on EVENT_LIB, so remove them before building with io_uring.
+.PHONY: test-liburing
+test-liburing:
+	@rm -rf $(TARGET_OBJ) $(TARGET_LIB) $(TARGET_TEST)
+	$(MAKE) EVENT_LIB=liburing test
+
 .PHONY: test-clean
 test-clean:
 	@rm -rf $(TARGET_TEST)
@@ -35,6 +35,7 @@
 #include <aerospike/as_operations.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_record.h>
+#include <aerospike/as_record_view.h>
 #include <aerospike/as_status.h>
 #include <aerospike/as_val.h>
 #include <aerospike/as_vector.h>
@@ -109,6 +110,106 @@ typedef struct as_batch_read_records_s {
 	as_vector list;
 } as_batch_read_records;
 
+/**
+ * Batch write record type.
+ *
+ * @ingroup batch_operations
+ */
+typedef enum as_batch_write_type_e {
+	/**
+	 * Write bins defined in as_batch_write_record.rec.
+	 */
+	AS_BATCH_WRITE_PUT,
+
+	/**
+	 * Apply operations defined in as_batch_write_record.ops.
+	 */
+	AS_BATCH_WRITE_OPERATE,
+
+	/**
+	 * Remove record.
+	 */
+	AS_BATCH_WRITE_REMOVE
+} as_batch_write_type;
+
+/**
+ * Key and write command used in batch write commands.  Each record may define its own
+ * policy and command type.  The results are located in the same batch record.
+ *
+ * @ingroup batch_operations
+ */
+typedef struct as_batch_write_record_s {
+	/**
+	 * The key to write.
+	 */
+	as_key key;
+
+	/**
+	 * Optional policy for this record.  If NULL, as_config.policies.batch_write is used.
+	 */
+	const as_policy_batch_write* policy;
+
+	/**
+	 * Bins to write when type is AS_BATCH_WRITE_PUT.  The record gen and ttl are also
+	 * applied.  The caller owns this record.
+	 */
+	as_record* rec;
+
+	/**
+	 * Operations to apply when type is AS_BATCH_WRITE_OPERATE.  The operations gen and ttl
+	 * are also applied.  The caller owns these operations.
+	 */
+	as_operations* ops;
+
+	/**
+	 * The write command type.
+	 */
+	as_batch_write_type type;
+
+	/**
+	 * The result of the write transaction.
+	 *
+	 * Values:
+	 * <ul>
+	 * <li>
+	 * AEROSPIKE_OK: record written or removed
+	 * </li>
+	 * <li>
+	 * AEROSPIKE_NO_RESPONSE: the record was not sent because the batch was aborted
+	 * </li>
+	 * <li>
+	 * Other: transaction error code, or the error of the node command that failed before
+	 * this record was processed
+	 * </li>
+	 * </ul>
+	 */
+	as_status result;
+
+	/**
+	 * Is it possible that the write transaction completed even though an error was
+	 * returned for this record.
+	 */
+	bool in_doubt;
+
+	/**
+	 * The record generation, expiration and bins returned by read operations.  Only valid
+	 * when result is AEROSPIKE_OK.
+	 */
+	as_record record;
+} as_batch_write_record;
+
+/**
+ * List of as_batch_write_record(s).
+ *
+ * @ingroup batch_operations
+ */
+typedef struct as_batch_write_records_s {
+	/**
+	 * List of as_batch_write_record(s).
+	 */
+	as_vector list;
+} as_batch_write_records;
+
 /**
  * This callback will be called with the results of aerospike_batch_get(),
  * or aerospike_batch_exists() functions.
@@ -136,9 +237,44 @@ typedef bool (*aerospike_batch_read_callback)(const as_batch_read* results, uint
 /**
  * @private
  * This callback is used by aerospike_batch_get_xdr() to send one batch record at a time
- * as soon as they are received in no particular order.
+ * as soon as they are received in no particular order.  The callback may be called
+ * concurrently from multiple threads when the batch policy is concurrent or split_keys
+ * is set.
  */
 typedef bool (*as_batch_callback_xdr)(as_key* key, as_record* record, void* udata);
+
+/**
+ * This callback is used by aerospike_batch_get_view() to send one found record at a time
+ * as soon as it is received, in no particular order.  The view references the response
+ * buffer and is only valid during the callback.  The callback may be called concurrently
+ * from multiple threads when the batch policy is concurrent or split_keys is set.
+ *
+ * @param key			The key of the record.
+ * @param view			The record view.
+ * @param udata 		User-data provided to the calling function.
+ *
+ * @return `true` to continue. Otherwise, abort the batch.
+ *
+ * @ingroup batch_operations
+ */
+typedef bool (*as_batch_view_callback)(const as_key* key, as_record_view* view, void* udata);
+
+/**
+ * This callback is used by aerospike_batch_read_stream() to send one batch record at a time
+ * as soon as its node response is parsed, in no particular order.  The record's bins are
+ * destroyed when the callback returns, so copy any values that must outlive the callback.
+ * The callback may be called concurrently from multiple threads when the batch policy is
+ * concurrent or split_keys is set.
+ *
+ * @param record		The batch record.  record->result contains the record's status.
+ * @param index			The record's position in the batch record list.
+ * @param udata 		User-data provided to the calling function.
+ *
+ * @return `true` to continue. Otherwise, abort the batch.
+ *
+ * @ingroup batch_operations
+ */
+typedef bool (*as_batch_read_stream_callback)(as_batch_read_record* record, uint32_t index, void* udata);
 	
 /**
  * Asynchronous batch user callback.  This function is called once when the batch completes or an
@@ -155,6 +291,40 @@ typedef bool (*as_batch_callback_xdr)(as_key* key, as_record* record, void* udat
  */
 typedef void (*as_async_batch_listener)(as_error* err, as_batch_read_records* records, void* udata, as_event_loop* event_loop);
 
+/**
+ * Asynchronous streaming batch user callback.  This function is called for each record as
+ * soon as its node response is parsed, in no particular order.  The record's bins are
+ * destroyed when the callback returns.
+ *
+ * The callback is called one final time with a NULL record when the batch completes, is
+ * aborted or an error has occurred.  Batch records must not be destroyed before this call.
+ *
+ * @param err			This error structure is only populated on the final call when the command
+ * 						fails or is aborted. Null otherwise.
+ * @param record 		The batch record or NULL on the final call.
+ * @param index			The record's position in the batch record list.
+ * @param udata 		User data that is forwarded from asynchronous command function.
+ * @param event_loop 	Event loop that this command was executed on.
+ *
+ * @return `true` to continue. Otherwise, abort the batch.  Ignored on the final call.
+ *
+ * @ingroup batch_operations
+ */
+typedef bool (*as_async_batch_read_stream_listener)(as_error* err, as_batch_read_record* record, uint32_t index, void* udata, as_event_loop* event_loop);
+
+/**
+ * Asynchronous batch write user callback.  This function is called once when the batch
+ * completes or an error has occurred.  Per record results are available in both cases.
+ *
+ * @param err			This error structure is only populated when the command fails. Null on success.
+ * @param records 		Batch records.  Records must be destroyed with as_batch_write_destroy() when done.
+ * @param udata 		User data that is forwarded from asynchronous command function.
+ * @param event_loop 	Event loop that this command was executed on.
+ *
+ * @ingroup batch_operations
+ */
+typedef void (*as_async_batch_write_listener)(as_error* err, as_batch_write_records* records, void* udata, as_event_loop* event_loop);
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -351,6 +521,286 @@ aerospike_batch_read_async(
 	as_async_batch_listener listener, void* udata, as_event_loop* event_loop
 	);
 
+/**
+ * Read multiple records for specified batch keys and stream each record to the callback as
+ * soon as its node response is parsed.  Results from fast nodes are not delayed by slow nodes
+ * and only the records in flight hold bins, which bounds peak memory for large batches.
+ * Returning false from the callback cancels the remaining node commands.
+ *
+ * ~~~~~~~~~~{.c}
+ * bool my_callback(as_batch_read_record* record, uint32_t index, void* udata) {
+ *     if (record->result == AEROSPIKE_OK) {
+ *         // Process record->record.
+ *     }
+ *     return true;
+ * }
+ *
+ * if (aerospike_batch_read_stream(&as, &err, NULL, &records, my_callback, NULL) != AEROSPIKE_OK) {
+ *     fprintf(stderr, "error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ *
+ * as_batch_read_destroy(&records);
+ * ~~~~~~~~~~
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param records		List of keys and bins to retrieve.
+ * @param callback 		The callback to invoke for each record read.
+ * @param udata			The user-data for the callback.
+ *
+ * @return AEROSPIKE_OK if successful. AEROSPIKE_ERR_CLIENT_ABORT if the callback returned
+ * false. Otherwise an error.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_read_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_read_records* records,
+	as_batch_read_stream_callback callback, void* udata
+	);
+
+/**
+ * Asynchronously read multiple records for specified batch keys and stream each record to
+ * the listener as soon as its node response is parsed.  Records must be created with
+ * as_batch_read_create() and may be destroyed on the listener's final call.
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param records		List of keys and bins to retrieve.
+ * @param listener 		User function to be called for each record and on completion.
+ * @param udata 		User data to be forwarded to user callback.
+ * @param event_loop 	Event loop assigned to run this command. If NULL, an event loop will be choosen by round-robin.
+ *
+ * @return AEROSPIKE_OK if async command succesfully queued. Otherwise an error.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_read_stream_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_read_records* records,
+	as_async_batch_read_stream_listener listener, void* udata, as_event_loop* event_loop
+	);
+
+/**
+ * Initialize `as_batch_write_records` with specified capacity on the stack using alloca().
+ *
+ * When the batch is no longer needed, then use as_batch_write_destroy() to
+ * release the batch and associated resources.
+ *
+ * @param __records		Batch record list.
+ * @param __capacity	Initial capacity of batch record list. List will resize when necessary.
+ *
+ * @relates as_batch_write_record
+ * @ingroup batch_operations
+ */
+#define as_batch_write_inita(__records, __capacity) \
+	as_vector_inita(&((__records)->list), sizeof(as_batch_write_record), __capacity);
+
+/**
+ * Initialize `as_batch_write_records` with specified capacity on the heap.
+ *
+ * When the batch is no longer needed, then use as_batch_write_destroy() to
+ * release the batch and associated resources.
+ *
+ * @param records	Batch record list.
+ * @param capacity	Initial capacity of batch record list. List will resize when necessary.
+ *
+ * @relates as_batch_write_record
+ * @ingroup batch_operations
+ */
+static inline void
+as_batch_write_init(as_batch_write_records* records, uint32_t capacity)
+{
+	as_vector_init(&records->list, sizeof(as_batch_write_record), capacity);
+}
+
+/**
+ * Create `as_batch_write_records` on heap with specified list capacity on the heap.
+ *
+ * When the batch is no longer needed, then use as_batch_write_destroy() to
+ * release the batch and associated resources.
+ *
+ * @param capacity	Initial capacity of batch record list. List will resize when necessary.
+ * @return			Batch record list.
+ *
+ * @relates as_batch_write_record
+ * @ingroup batch_operations
+ */
+static inline as_batch_write_records*
+as_batch_write_create(uint32_t capacity)
+{
+	return (as_batch_write_records*) as_vector_create(sizeof(as_batch_write_record), capacity);
+}
+
+/**
+ * Reserve a new `as_batch_write_record` slot.  Capacity will be increased when necessary.
+ * Return reference to record.  The record is already initialized to zeroes, which
+ * defines a put with the default policy.
+ *
+ * @param records	Batch record list.
+ *
+ * @relates as_batch_write_record
+ * @ingroup batch_operations
+ */
+static inline as_batch_write_record*
+as_batch_write_reserve(as_batch_write_records* records)
+{
+	return (as_batch_write_record*)as_vector_reserve(&records->list);
+}
+
+/**
+ * Destroy keys and result records in record list.  It's the responsility of the caller to
+ * destroy `as_batch_write_record.rec` and `as_batch_write_record.ops` when necessary.
+ *
+ * @param records	Batch record list.
+ *
+ * @relates as_batch_write_record
+ * @ingroup batch_operations
+ */
+AS_EXTERN void
+as_batch_write_destroy(as_batch_write_records* records);
+
+/**
+ * Write, operate on or remove multiple records in one batch call.  Records are grouped
+ * by their master node and each node receives a single command.  Each record may define
+ * its own command type and policy.  The result of each record is located in the same
+ * batch record.  This method requires Aerospike Server version >= 6.0.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_batch_write_records records;
+ * as_batch_write_inita(&records, 2);
+ *
+ * as_record rec;
+ * as_record_inita(&rec, 1);
+ * as_record_set_int64(&rec, "bin1", 10);
+ *
+ * as_batch_write_record* record = as_batch_write_reserve(&records);
+ * as_key_init(&record->key, "ns", "set", "key1");
+ * record->type = AS_BATCH_WRITE_PUT;
+ * record->rec = &rec;
+ *
+ * record = as_batch_write_reserve(&records);
+ * as_key_init(&record->key, "ns", "set", "key2");
+ * record->type = AS_BATCH_WRITE_REMOVE;
+ *
+ * if (aerospike_batch_write(&as, &err, NULL, &records) != AEROSPIKE_OK) {
+ *     fprintf(stderr, "error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ *
+ * as_batch_write_destroy(&records);
+ * as_record_destroy(&rec);
+ * ~~~~~~~~~~
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * 						Only timeouts, retries, concurrent, allow_inline, compress and filter_exp are used.
+ * 						Records are always sent to the partition master.
+ * @param records		List of keys and write commands.  The results are located in the same array.
+ *
+ * @return AEROSPIKE_OK if all node commands succeeded. Otherwise an error.  Check each record
+ * result for per record errors.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_write(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_write_records* records
+	);
+
+/**
+ * Asynchronously write, operate on or remove multiple records in one batch call.
+ * See aerospike_batch_write() for details.
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param records		List of keys and write commands.  The results are located in the same array.
+ * 						Must create using as_batch_write_create() (which allocates memory on heap) because
+ * 						async method will return immediately after queueing command.
+ * @param listener 		User function to be called with command results.
+ * @param udata 		User data to be forwarded to user callback.
+ * @param event_loop 	Event loop assigned to run this command. If NULL, an event loop will be choosen by round-robin.
+ *
+ * @return AEROSPIKE_OK if async command succesfully queued. Otherwise an error.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_write_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_write_records* records,
+	as_async_batch_write_listener listener, void* udata, as_event_loop* event_loop
+	);
+
+/**
+ * Apply the same operations to multiple records in one batch call.  The type, policy and
+ * operations of each batch record are set before the batch is run.
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The batch policy. If NULL, then the default policy will be used.
+ * @param policy_write	The record policy. If NULL, then the default batch write policy will be used.
+ * @param records		List of keys.  The results are located in the same array.
+ * @param ops			The operations to apply to each record.
+ *
+ * @return AEROSPIKE_OK if all node commands succeeded. Otherwise an error.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_operate(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records, as_operations* ops
+	);
+
+/**
+ * Asynchronously apply the same operations to multiple records in one batch call.
+ * See aerospike_batch_operate() and aerospike_batch_write_async() for details.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_operate_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records, as_operations* ops,
+	as_async_batch_write_listener listener, void* udata, as_event_loop* event_loop
+	);
+
+/**
+ * Remove multiple records in one batch call.  The type and policy of each batch record
+ * are set before the batch is run.
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The batch policy. If NULL, then the default policy will be used.
+ * @param policy_write	The record policy. If NULL, then the default batch write policy will be used.
+ * @param records		List of keys.  The results are located in the same array.
+ *
+ * @return AEROSPIKE_OK if all node commands succeeded. Otherwise an error.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_remove(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records
+	);
+
+/**
+ * Asynchronously remove multiple records in one batch call.
+ * See aerospike_batch_remove() and aerospike_batch_write_async() for details.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_remove_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records,
+	as_async_batch_write_listener listener, void* udata, as_event_loop* event_loop
+	);
+
 /**
  * Look up multiple records by key, then return all bins.
  *
@@ -397,6 +847,39 @@ aerospike_batch_get_xdr(
 	as_batch_callback_xdr callback, void* udata
 	);
 
+/**
+ * Look up multiple records by key, then return all bins as record views.  The callback is
+ * called for each found record as soon as it's received, in no particular order.  Records
+ * are not copied or deserialized unless the callback requests it, so this is the most
+ * efficient way to read large batches.
+ *
+ * ~~~~~~~~~~{.c}
+ * bool my_callback(const as_key* key, as_record_view* view, void* udata) {
+ *     int64_t count;
+ *     if (as_record_view_get_int64(view, "count", &count)) {
+ *         // Process count.
+ *     }
+ *     return true;
+ * }
+ * ~~~~~~~~~~
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param batch			The batch of keys to read.
+ * @param callback 		The callback to invoke for each record read.
+ * @param udata			The user-data for the callback.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_get_view(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
+	as_batch_view_callback callback, void* udata
+	);
+
 /**
  * Look up multiple records by key, then return specified bins.
  *
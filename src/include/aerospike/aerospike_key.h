@@ -36,6 +36,7 @@
 #include <aerospike/as_operations.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_record.h>
+#include <aerospike/as_record_view.h>
 #include <aerospike/as_status.h>
 #include <aerospike/as_val.h>
 
@@ -81,6 +82,42 @@ aerospike_key_get(
 	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
 	);
 
+/**
+ * Look up a record by key and return all bins as a record view.  Bins are decoded on access
+ * from a single copy of the server response, so no per-bin memory is allocated.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_key key;
+ * as_key_init(&key, "ns", "set", "key");
+ * 
+ * as_record_view view;
+ * if (aerospike_key_get_view(&as, &err, NULL, &key, &view) != AEROSPIKE_OK) {
+ *     printf("error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ * else {
+ *     int64_t count;
+ *     as_record_view_get_int64(&view, "count", &count);
+ *     as_record_view_destroy(&view);
+ * }
+ * ~~~~~~~~~~
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param key			The key of the record.
+ * @param view 			The view to be populated. Must be destroyed with as_record_view_destroy()
+ *						if AEROSPIKE_OK is returned.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN as_status
+aerospike_key_get_view(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_record_view* view
+	);
+
 /**
  * Asynchronously look up a record by key and return all bins.
  *
@@ -161,6 +198,28 @@ aerospike_key_select(
 	const char* bins[], as_record** rec
 	);
 
+/**
+ * Lookup a record by key, then return specified bins as a record view.
+ * See aerospike_key_get_view().
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param key			The key of the record.
+ * @param bins			The bins to select. A NULL terminated array of NULL terminated strings.
+ * @param view 			The view to be populated. Must be destroyed with as_record_view_destroy()
+ *						if AEROSPIKE_OK is returned.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN as_status
+aerospike_key_select_view(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record_view* view
+	);
+
 /**
  * Asynchronously lookup a record by key, then return specified bins.
  *
@@ -93,6 +93,7 @@
 #include <aerospike/as_policy.h>
 #include <aerospike/as_query.h>
 #include <aerospike/as_record.h>
+#include <aerospike/as_record_view.h>
 #include <aerospike/as_status.h>
 #include <aerospike/as_stream.h>
 
@@ -184,6 +185,32 @@ aerospike_query_foreach(
 	aerospike_query_foreach_callback callback, void* udata
 	);
 
+/**
+ * Execute a query and call the callback function with a record view for each record.
+ * Bins are decoded on access directly from the response buffer.  The view is only valid
+ * during the callback.  When all records have been received, the callback is called with
+ * a NULL view.  Aggregation queries are not supported.
+ *
+ * Multiple threads will likely be calling the callback in parallel.  Therefore,
+ * your callback implementation should be thread safe.
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param query			The query to execute against the cluster.
+ * @param callback		The callback function to call for each record.
+ * @param udata			User-data to be passed to the callback.
+ *
+ * @return AEROSPIKE_OK on success, otherwise an error.
+ *
+ * @ingroup query_operations
+ */
+AS_EXTERN as_status
+aerospike_query_foreach_view(
+	aerospike* as, as_error* err, const as_policy_query* policy, const as_query* query,
+	as_record_view_callback callback, void* udata
+	);
+
 /**
  * Asynchronously execute a query and call the listener function for each result item.
  * Standard secondary index queries are supported, but aggregation queries are not supported
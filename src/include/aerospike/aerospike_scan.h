@@ -99,6 +99,7 @@
 #include <aerospike/as_partition_filter.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_record.h>
+#include <aerospike/as_record_view.h>
 #include <aerospike/as_scan.h>
 #include <aerospike/as_status.h>
 #include <aerospike/as_val.h>
@@ -286,6 +287,32 @@ aerospike_scan_foreach(
 	aerospike_scan_foreach_callback callback, void* udata
 	);
 
+/**
+ * Scan the records in the specified namespace and set in the cluster and return each record
+ * as a record view.  Bins are decoded on access directly from the response buffer, so records
+ * are not copied or deserialized unless the callback requests it.
+ *
+ * The view is only valid during the callback.  When all records have been scanned, then
+ * callback will be called with a NULL view.  Multiple threads will likely be calling the
+ * callback in parallel.  Therefore, your callback implementation should be thread safe.
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param scan			The scan to execute against the cluster.
+ * @param callback		The function to be called for each record scanned.
+ * @param udata			User-data to be passed to the callback.
+ *
+ * @return AEROSPIKE_OK on success. Otherwise an error occurred.
+ *
+ * @ingroup scan_operations
+ */
+AS_EXTERN as_status
+aerospike_scan_foreach_view(
+	aerospike* as, as_error* err, const as_policy_scan* policy, const as_scan* scan,
+	as_record_view_callback callback, void* udata
+	);
+
 /**
  * Scan the records in the specified namespace and set for a single node.
  *
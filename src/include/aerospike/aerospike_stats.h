@@ -17,6 +17,7 @@
 #pragma once
 
 #include <aerospike/aerospike.h>
+#include <aerospike/as_arena.h>
 #include <aerospike/as_node.h>
 
 /**
@@ -87,6 +88,22 @@ typedef struct as_node_stats_s {
 	 */
 	as_conn_stats pipeline;
 
+	/**
+	 * Circuit breaker state.  Always AS_CIRCUIT_CLOSED when circuit breakers are disabled.
+	 */
+	as_circuit_state circuit_state;
+
+	/**
+	 * Total number of times the node's circuit breaker has been opened.
+	 */
+	uint32_t circuit_opened;
+
+	/**
+	 * Total commands that were not sent to this node because its circuit breaker was open.
+	 * Includes reads that were redirected to another replica.
+	 */
+	uint32_t circuit_rejected;
+
 } as_node_stats;
 
 /**
@@ -139,6 +156,16 @@ typedef struct as_cluster_stats_s {
 	 */
 	uint32_t thread_pool_queued_tasks;
 
+	/**
+	 * Total retries that were not attempted because the cluster retry budget was exhausted.
+	 */
+	uint32_t retries_rejected;
+
+	/**
+	 * Command buffer arena statistics.  Arenas are shared by all client instances in the process.
+	 */
+	as_arena_stats arena;
+
 } as_cluster_stats;
 
 struct as_cluster_s;
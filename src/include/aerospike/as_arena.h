@@ -0,0 +1,116 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Maximum number of buffers cached per thread.
+ */
+#define AS_ARENA_SLOTS 8
+
+/**
+ * @private
+ * Minimum arena buffer capacity.
+ */
+#define AS_ARENA_MIN_BLOCK (1024 * 16)
+
+/**
+ * @private
+ * Buffers larger than this are allocated from the heap and never cached.
+ */
+#define AS_ARENA_MAX_BLOCK (1024 * 1024 * 8)
+
+/**
+ * @private
+ * Number of buffer acquisitions between high-water checks.
+ */
+#define AS_ARENA_TRIM_INTERVAL 4096
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+/**
+ * Command buffer arena statistics.  These values are process wide and
+ * summarize the buffer caches of all threads.
+ * @ingroup cluster_stats
+ */
+typedef struct as_arena_stats_s {
+	/**
+	 * Bytes currently cached in thread arenas.
+	 */
+	uint64_t bytes;
+
+	/**
+	 * Command buffers served from an existing arena buffer.  Each thread adds its
+	 * count every AS_ARENA_TRIM_INTERVAL acquisitions, so this value lags slightly.
+	 */
+	uint64_t reuses;
+
+	/**
+	 * Command buffers that required a heap allocation.
+	 */
+	uint64_t heap_allocs;
+
+	/**
+	 * Arena buffers released because they exceeded recent high-water usage.
+	 */
+	uint64_t trims;
+
+} as_arena_stats;
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Acquire command buffer of at least size bytes from the calling thread's arena.
+ * The buffer must be released by as_arena_release().
+ */
+AS_EXTERN uint8_t*
+as_arena_acquire(size_t size);
+
+/**
+ * @private
+ * Release command buffer acquired by as_arena_acquire().  The buffer may be released on any
+ * thread.  It is returned to the arena of the thread that acquired it, or freed if that
+ * thread has exited.  NULL is ignored.
+ */
+AS_EXTERN void
+as_arena_release(uint8_t* buf);
+
+/**
+ * @private
+ * Retrieve process wide arena statistics.
+ */
+AS_EXTERN void
+as_arena_stats_get(as_arena_stats* stats);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -85,14 +85,15 @@ as_async_write_command_create(
 	// Allocate enough memory to cover: struct size + write buffer size + auth max buffer size
 	// Then, round up memory size in 1KB increments.
 	size_t s = (sizeof(as_async_write_command) + size + AS_AUTHENTICATION_MAX_SIZE + 1023) & ~1023;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	event_loop = as_event_assign(event_loop);
+	as_event_command* cmd = (as_event_command*)as_slab_alloc(event_loop->slab, s);
 	as_async_write_command* wcmd = (as_async_write_command*)cmd;
 	cmd->total_deadline = policy->total_timeout;
 	cmd->socket_timeout = policy->socket_timeout;
 	cmd->max_retries = policy->max_retries;
 	cmd->iteration = 0;
 	cmd->replica = replica;
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = event_loop;
 	cmd->cluster = cluster;
 	cmd->node = NULL;
 	cmd->ns = ns;
@@ -107,6 +108,7 @@ as_async_write_command_create(
 	cmd->state = AS_ASYNC_STATE_UNREGISTERED;
 	cmd->flags = flags;
 	cmd->flags2 = 0;
+	cmd->replica_index = 0;
 	wcmd->listener = listener;
 	return cmd;
 }
@@ -123,14 +125,15 @@ as_async_record_command_create(
 	// Then, round up memory size in 4KB increments to reduce fragmentation and to allow socket
 	// read to reuse buffer for small socket write sizes.
 	size_t s = (sizeof(as_async_record_command) + size + AS_AUTHENTICATION_MAX_SIZE + 4095) & ~4095;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	event_loop = as_event_assign(event_loop);
+	as_event_command* cmd = (as_event_command*)as_slab_alloc(event_loop->slab, s);
 	as_async_record_command* rcmd = (as_async_record_command*)cmd;
 	cmd->total_deadline = policy->total_timeout;
 	cmd->socket_timeout = policy->socket_timeout;
 	cmd->max_retries = policy->max_retries;
 	cmd->iteration = 0;
 	cmd->replica = replica;
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = event_loop;
 	cmd->cluster = cluster;
 	cmd->node = NULL;
 	cmd->ns = ns;
@@ -145,6 +148,7 @@ as_async_record_command_create(
 	cmd->state = AS_ASYNC_STATE_UNREGISTERED;
 	cmd->flags = flags;
 	cmd->flags2 = 0;
+	cmd->replica_index = 0;
 	if (deserialize) {
 		cmd->flags2 |= AS_ASYNC_FLAGS2_DESERIALIZE;
 	}
@@ -164,14 +168,15 @@ as_async_value_command_create(
 	// Then, round up memory size in 4KB increments to reduce fragmentation and to allow socket
 	// read to reuse buffer for small socket write sizes.
 	size_t s = (sizeof(as_async_value_command) + size + AS_AUTHENTICATION_MAX_SIZE + 4095) & ~4095;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	event_loop = as_event_assign(event_loop);
+	as_event_command* cmd = (as_event_command*)as_slab_alloc(event_loop->slab, s);
 	as_async_value_command* vcmd = (as_async_value_command*)cmd;
 	cmd->total_deadline = policy->total_timeout;
 	cmd->socket_timeout = policy->socket_timeout;
 	cmd->max_retries = policy->max_retries;
 	cmd->iteration = 0;
 	cmd->replica = replica;
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = event_loop;
 	cmd->cluster = cluster;
 	cmd->node = NULL;
 	cmd->ns = ns;
@@ -186,6 +191,7 @@ as_async_value_command_create(
 	cmd->state = AS_ASYNC_STATE_UNREGISTERED;
 	cmd->flags = flags;
 	cmd->flags2 = 0;
+	cmd->replica_index = 0;
 	vcmd->listener = listener;
 	return cmd;
 }
@@ -199,14 +205,15 @@ as_async_info_command_create(
 	// Allocate enough memory to cover: struct size + write buffer size + auth max buffer size
 	// Then, round up memory size in 1KB increments.
 	size_t s = (sizeof(as_async_info_command) + size + AS_AUTHENTICATION_MAX_SIZE + 1023) & ~1023;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	event_loop = as_event_assign(event_loop);
+	as_event_command* cmd = (as_event_command*)as_slab_alloc(event_loop->slab, s);
 	as_async_info_command* icmd = (as_async_info_command*)cmd;
 	cmd->total_deadline = policy->timeout;
 	cmd->socket_timeout = policy->timeout;
 	cmd->max_retries = 1;
 	cmd->iteration = 0;
 	cmd->replica = AS_POLICY_REPLICA_MASTER;
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = event_loop;
 	cmd->cluster = node->cluster;
 	cmd->node = node;
 	cmd->ns = NULL;
@@ -219,8 +226,9 @@ as_async_info_command_create(
 	cmd->type = AS_ASYNC_TYPE_INFO;
 	cmd->proto_type = AS_INFO_MESSAGE_TYPE;
 	cmd->state = AS_ASYNC_STATE_UNREGISTERED;
-	cmd->flags = AS_ASYNC_FLAGS_MASTER;
+	cmd->flags = 0;
 	cmd->flags2 = 0;
+	cmd->replica_index = 0;
 	icmd->listener = listener;
 	return cmd;
 }
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_status.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Maximum commands allowed per tend interval while a circuit is half open.
+ */
+#define AS_CIRCUIT_PROBES 10
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+/**
+ * Node circuit breaker state.
+ *
+ * @ingroup cluster_stats
+ */
+typedef enum as_circuit_state_e {
+	/**
+	 * Commands are sent to the node.
+	 */
+	AS_CIRCUIT_CLOSED,
+
+	/**
+	 * Node error rate exceeded the limit.  Commands fail fast with AEROSPIKE_ERR_CIRCUIT_OPEN
+	 * or reads are redirected to another replica.
+	 */
+	AS_CIRCUIT_OPEN,
+
+	/**
+	 * Open period has expired.  A limited number of commands are sent to the node to determine
+	 * if the circuit should be closed or opened again.
+	 */
+	AS_CIRCUIT_HALF_OPEN
+
+} as_circuit_state;
+
+/**
+ * @private
+ * Node circuit breaker.  Commands update counters and the cluster tend thread evaluates
+ * the counters once per tend interval of wall clock time.
+ */
+typedef struct as_circuit_s {
+	uint32_t requests;
+	uint32_t errors;
+	uint32_t probes;
+	uint32_t opened;
+	uint32_t rejected;
+	uint64_t open_until;
+	uint8_t state;
+} as_circuit;
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Initialize circuit breaker.
+ */
+static inline void
+as_circuit_init(as_circuit* circuit)
+{
+	memset(circuit, 0, sizeof(as_circuit));
+}
+
+/**
+ * @private
+ * Return if a command can be sent to the node.
+ */
+static inline bool
+as_circuit_allow(as_circuit* circuit)
+{
+	switch (as_load_uint8(&circuit->state)) {
+		case AS_CIRCUIT_CLOSED:
+			return true;
+
+		case AS_CIRCUIT_HALF_OPEN:
+			if (as_faa_uint32(&circuit->probes, 1) < AS_CIRCUIT_PROBES) {
+				return true;
+			}
+			break;
+
+		default:
+			break;
+	}
+	as_incr_uint32(&circuit->rejected);
+	return false;
+}
+
+/**
+ * @private
+ * Return if command status indicates the node may be overloaded or unreachable.
+ */
+static inline bool
+as_circuit_is_error(as_status status)
+{
+	switch (status) {
+		case AEROSPIKE_ERR_TIMEOUT:
+		case AEROSPIKE_ERR_CONNECTION:
+		case AEROSPIKE_ERR_ASYNC_CONNECTION:
+		case AEROSPIKE_ERR_DEVICE_OVERLOAD:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * @private
+ * Record command attempt result.
+ */
+static inline void
+as_circuit_record(as_circuit* circuit, as_status status)
+{
+	as_incr_uint32(&circuit->requests);
+
+	if (as_circuit_is_error(status)) {
+		as_incr_uint32(&circuit->errors);
+	}
+}
+
+/**
+ * @private
+ * Evaluate counters recorded since the last evaluation and reset them.  The circuit opens when
+ * at least min_requests attempts were recorded and the error percentage is greater than or
+ * equal to error_rate.  An open circuit becomes half open open_ms milliseconds after now.
+ */
+void
+as_circuit_tend(
+	as_circuit* circuit, uint32_t error_rate, uint32_t min_requests, uint32_t open_ms,
+	uint64_t now
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -22,6 +22,7 @@
 #include <aerospike/as_partition.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_thread_pool.h>
+#include <citrusleaf/cf_clock.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -77,6 +78,12 @@ typedef struct as_gc_item_s {
 	 * Release function.
 	 */
 	as_release_fn release_fn;
+
+	/**
+	 * @private
+	 * Epoch when data was retired.  Data is released after all threads have left this epoch.
+	 */
+	uint64_t epoch;
 } as_gc_item;
 
 /**
@@ -130,6 +137,12 @@ typedef struct as_cluster_s {
 	 * Expected cluster name for all nodes.  May be null.
 	 */
 	char* cluster_name;
+
+	/**
+	 * @private
+	 * Partition map snapshot file path.  May be null.
+	 */
+	char* snapshot_path;
 	
 	/**
 	 * Cluster event function that will be called when nodes are added/removed from the cluster.
@@ -174,6 +187,12 @@ typedef struct as_cluster_s {
 	 * Pool of threads used to query server nodes in parallel for batch, scan and query.
 	 */
 	as_thread_pool thread_pool;
+
+	/**
+	 * @private
+	 * Pool of threads used by the tend thread to send info requests to nodes in parallel.
+	 */
+	as_thread_pool tend_pool;
 		
 	/**
 	 * @private
@@ -220,6 +239,30 @@ typedef struct as_cluster_s {
 	 */
 	uint32_t tend_interval;
 
+	/**
+	 * @private
+	 * Minimum milliseconds between early cluster tends.
+	 */
+	uint32_t tend_interval_min;
+
+	/**
+	 * @private
+	 * Maximum milliseconds between cluster tends when the cluster is stable.
+	 */
+	uint32_t tend_interval_max;
+
+	/**
+	 * @private
+	 * Time in milliseconds of the last circuit breaker, retry budget and latency evaluation.
+	 */
+	uint64_t stats_time;
+
+	/**
+	 * @private
+	 * Minimum milliseconds between partition map snapshot writes.
+	 */
+	uint32_t snapshot_interval;
+
 	/**
 	 * @private
 	 * Cluster tend counter.
@@ -262,6 +305,91 @@ typedef struct as_cluster_s {
 	 */
 	uint32_t conn_pools_per_node;
 
+	/**
+	 * @private
+	 * Number of synchronous pipeline connections used for each node.
+	 */
+	uint32_t sync_pipe_conns_per_node;
+
+	/**
+	 * @private
+	 * Minimum bin value size sent directly from user memory.
+	 */
+	uint32_t gather_write_threshold;
+
+	/**
+	 * @private
+	 * Minimum referenced value size that uses kernel zero-copy writes.
+	 */
+	uint32_t zero_copy_threshold;
+
+	/**
+	 * @private
+	 * Node error percentage that opens node circuit breaker.  Zero disables circuit breakers.
+	 */
+	uint32_t circuit_error_rate;
+
+	/**
+	 * @private
+	 * Minimum node command attempts per tend interval before circuit breaker is evaluated.
+	 */
+	uint32_t circuit_min_requests;
+
+	/**
+	 * @private
+	 * Milliseconds that a node circuit breaker stays open.
+	 */
+	uint32_t circuit_open_ms;
+
+	/**
+	 * @private
+	 * Retry budget percentage.  Zero allows all retries.
+	 */
+	uint32_t retry_budget;
+
+	/**
+	 * @private
+	 * Minimum retries allowed per tend interval.
+	 */
+	uint32_t retry_budget_min;
+
+	/**
+	 * @private
+	 * Commands started in current tend interval.
+	 */
+	uint32_t retry_requests;
+
+	/**
+	 * @private
+	 * Retries attempted in current tend interval.
+	 */
+	uint32_t retry_count;
+
+	/**
+	 * @private
+	 * Retries allowed in current tend interval.
+	 */
+	uint32_t retry_limit;
+
+	/**
+	 * @private
+	 * Total retries rejected because retry budget was exhausted.
+	 */
+	uint32_t retries_rejected;
+
+	/**
+	 * @private
+	 * Total commands started.  Only counted when count_commands is true.
+	 */
+	uint64_t commands;
+
+	/**
+	 * @private
+	 * Latency histogram of all commands that received a response.  Only recorded when
+	 * count_commands is true.
+	 */
+	as_hedge_latency latency;
+
 	/**
 	 * @private
 	 * Initial connection timeout in milliseconds.
@@ -316,6 +444,18 @@ typedef struct as_cluster_s {
 	 */
 	bool rack_aware;
 
+	/**
+	 * @private
+	 * Count commands started for shared memory process statistics.
+	 */
+	bool count_commands;
+
+	/**
+	 * @private
+	 * Cluster tend has been requested before the next tend interval.
+	 */
+	uint8_t tend_requested;
+
 	/**
 	 * @private
 	 * Should continue to tend cluster.
@@ -375,6 +515,122 @@ as_nodes_release(as_nodes* nodes)
 	}
 }
 
+/**
+ * @private
+ * Count command toward retry budget.
+ */
+static inline void
+as_cluster_retry_budget_request(as_cluster* cluster)
+{
+	if (cluster->retry_budget > 0) {
+		as_incr_uint32(&cluster->retry_requests);
+	}
+}
+
+/**
+ * @private
+ * Count command start for retry budget and process statistics.  Return command start time
+ * in microseconds when process statistics are enabled.  Otherwise, return zero.
+ */
+static inline uint64_t
+as_cluster_command_request(as_cluster* cluster)
+{
+	as_cluster_retry_budget_request(cluster);
+
+	if (cluster->count_commands) {
+		as_incr_uint64(&cluster->commands);
+		return cf_getus();
+	}
+	return 0;
+}
+
+/**
+ * @private
+ * Record latency of command started at begin for process statistics.
+ */
+static inline void
+as_cluster_command_latency(as_cluster* cluster, uint64_t begin)
+{
+	if (begin) {
+		as_hedge_latency_add(&cluster->latency, cf_getus() - begin);
+	}
+}
+
+/**
+ * @private
+ * Return if retry budget allows another retry.
+ */
+static inline bool
+as_cluster_retry_budget_allow(as_cluster* cluster)
+{
+	if (cluster->retry_budget == 0 ||
+		as_aaf_uint32(&cluster->retry_count, 1) <= as_load_uint32(&cluster->retry_limit)) {
+		return true;
+	}
+	as_incr_uint32(&cluster->retries_rejected);
+	return false;
+}
+
+/**
+ * @private
+ * Return if node circuit breaker allows a command to be sent to the node.
+ */
+static inline bool
+as_node_circuit_allow(as_cluster* cluster, as_node* node)
+{
+	return cluster->circuit_error_rate == 0 || as_circuit_allow(&node->circuit);
+}
+
+/**
+ * @private
+ * Record command attempt result in node circuit breaker.
+ */
+static inline void
+as_node_circuit_record(as_cluster* cluster, as_node* node, as_status status)
+{
+	if (cluster->circuit_error_rate > 0) {
+		as_circuit_record(&node->circuit, status);
+	}
+}
+
+/**
+ * @private
+ * Update node circuit breakers, retry budget and node latency statistics.  Called by every
+ * tend, but only evaluated once per tend_interval of wall clock time, so early tends and
+ * backed off tends do not change the length of the statistics windows.
+ */
+void
+as_cluster_tend_stats(as_cluster* cluster);
+
+/**
+ * @private
+ * Set tend requested flag and wake the cluster tender.
+ */
+void
+as_cluster_signal_tend(as_cluster* cluster);
+
+/**
+ * @private
+ * Request an early cluster tend after a connection error to a node.  Only the first request
+ * before the next tend signals the tender.
+ */
+static inline void
+as_cluster_request_tend(as_cluster* cluster)
+{
+	if (cluster->tend_interval_min > 0 && ! as_load_uint8(&cluster->tend_requested)) {
+		as_cluster_signal_tend(cluster);
+	}
+}
+
+/**
+ * @private
+ * Put retired data on garbage collector stack.  Data must already be unreachable from
+ * the cluster.  It is released on a later tend after all commands that could have
+ * observed it have completed.  Only called from the tend thread.
+ */
+void
+as_cluster_gc_add(as_cluster* cluster, void* data, as_release_fn release_fn);
+
 /**
  * Reserve nodes and all sub nodes.
  */
@@ -432,11 +688,14 @@ as_node_get_by_name(as_cluster* cluster, const char* name);
  * @private
  * Get mapped node given partition and replica.  This function does not reserve the node.
  * The caller must reserve the node for future use.
+ *
+ * Sequence based replica policies start at replica_index modulo the partition's replica
+ * count.  Commands increment replica_index on each retry, so retries walk all replicas.
  */
 as_node*
 as_partition_reg_get_node(
 	as_cluster* cluster, const char* ns, as_partition* p, as_policy_replica replica,
-	bool use_master, bool is_retry
+	uint8_t replica_index, bool is_retry
 	);
 
 struct as_partition_shm_s;
@@ -449,7 +708,7 @@ struct as_partition_shm_s;
 as_node*
 as_partition_shm_get_node(
 	as_cluster* cluster, const char* ns, struct as_partition_shm_s* partition,
-	as_policy_replica replica, bool use_master, bool is_retry
+	as_policy_replica replica, uint8_t replica_index, bool is_retry
 	);
 
 /**
@@ -460,16 +719,16 @@ as_partition_shm_get_node(
 static inline as_node*
 as_partition_get_node(
 	as_cluster* cluster, const char* ns, void* partition, as_policy_replica replica,
-	bool master, bool is_retry
+	uint8_t replica_index, bool is_retry
 	)
 {
 	if (cluster->shm_info) {
 		return as_partition_shm_get_node(cluster, ns, (struct as_partition_shm_s*)partition,
-										 replica, master, is_retry);
+										 replica, replica_index, is_retry);
 	}
 	else {
-		return as_partition_reg_get_node(cluster, ns, (as_partition*)partition, replica, master,
-										 is_retry);
+		return as_partition_reg_get_node(cluster, ns, (as_partition*)partition, replica,
+										 replica_index, is_retry);
 	}
 }
 
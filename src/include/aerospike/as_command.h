@@ -16,6 +16,7 @@
  */
 #pragma once 
 
+#include <aerospike/as_arena.h>
 #include <aerospike/as_bin.h>
 #include <aerospike/as_buffer.h>
 #include <aerospike/as_cluster.h>
@@ -38,6 +39,9 @@ extern "C" {
 #define AS_COMMAND_FLAGS_READ 1
 #define AS_COMMAND_FLAGS_BATCH 2
 #define AS_COMMAND_FLAGS_LINEARIZE 4
+#define AS_COMMAND_FLAGS_GATHER 8
+#define AS_COMMAND_FLAGS_HEDGE 16
+#define AS_COMMAND_FLAGS_VIEW 32
 
 // Field IDs
 #define AS_FIELD_NAMESPACE 0
@@ -114,6 +118,7 @@ extern "C" {
 
 #define AS_STACK_BUF_SIZE (1024 * 16)
 #define AS_COMPRESS_THRESHOLD 128
+#define AS_COMMAND_GATHER_MAX 8
 
 /**
  * @private
@@ -134,15 +139,16 @@ local_free(void* memory)
 
 /**
  * @private
- * Allocate command buffer on stack or heap depending on given size.
+ * Acquire command buffer from the calling thread's buffer arena.
+ * The buffer must be freed by as_command_buffer_free().
  */
-#define as_command_buffer_init(_sz) (_sz > AS_STACK_BUF_SIZE) ? (uint8_t*)local_malloc(_sz) : (uint8_t*)alloca(_sz)
+#define as_command_buffer_init(_sz) as_arena_acquire(_sz)
 
 /**
  * @private
- * Free command buffer.
+ * Return command buffer to the buffer arena of the thread that acquired it.
  */
-#define as_command_buffer_free(_buf, _sz) if (_sz > AS_STACK_BUF_SIZE) {local_free(_buf);}
+#define as_command_buffer_free(_buf, _sz) as_arena_release(_buf)
 
 /******************************************************************************
  * TYPES
@@ -162,6 +168,29 @@ typedef as_status (*as_parse_results_fn) (
 	as_error* err, as_node* node, uint8_t* buf, size_t size, void* user_data
 	);
 
+/**
+ * @private
+ * Bin value that is sent directly from user memory.
+ */
+typedef struct as_command_gather_ref_s {
+	uint8_t* pos;  // Command buffer position where value would have been copied.
+	uint8_t* data;
+	uint32_t len;
+} as_command_gather_ref;
+
+/**
+ * @private
+ * Large bin values that are referenced instead of copied into the command buffer.
+ * The command is sent with a single scatter/gather write of buffer segments and values.
+ */
+typedef struct as_command_gather_s {
+	as_command_gather_ref refs[AS_COMMAND_GATHER_MAX];
+	size_t ext_size;
+	uint32_t threshold;
+	uint32_t reserved;
+	uint32_t size;
+} as_command_gather;
+
 /**
  * @private
  * Synchronous command data.
@@ -176,14 +205,17 @@ typedef struct as_command_s {
 	void* udata;
 	uint8_t* buf;
 	size_t buf_size;
+	as_command_gather* gather; // Used when AS_COMMAND_FLAGS_GATHER is set.
 	uint32_t partition_id;
 	as_policy_replica replica;
 	uint64_t deadline_ms;
 	uint32_t socket_timeout;
 	uint32_t total_timeout;
 	uint32_t iteration;
+	uint32_t hedge_delay; // Used when AS_COMMAND_FLAGS_HEDGE is set.
+	uint32_t hedge_percentile; // Used when AS_COMMAND_FLAGS_HEDGE is set.
 	uint8_t flags;
-	bool master;
+	uint8_t replica_index; // Sequence replica index.  Incremented on retry.
 	bool master_sc; // Used in batch only.
 } as_command;
 
@@ -200,6 +232,13 @@ typedef struct as_command_parse_result_data_s {
  * FUNCTIONS
  ******************************************************************************/
 
+/**
+ * @private
+ * Calculate size of user key field.
+ */
+size_t
+as_command_user_key_size(const as_key* key);
+
 /**
  * @private
  * Calculate size of command header plus key fields.
@@ -244,6 +283,35 @@ as_command_bin_size(const as_bin* bin, as_buffer* buffer)
 	return strlen(bin->name) + as_command_value_size((as_val*)bin->valuep, buffer) + 8;
 }
 
+/**
+ * @private
+ * Calculate size of operations and set read/write attributes for operate commands.
+ * Operations are not modified, so the same as_operations can be shared by multiple
+ * commands running in parallel.
+ */
+size_t
+as_command_operate_size(
+	const as_operations* ops, as_buffer* buffers, as_command_gather* gather, uint8_t* rattr,
+	uint8_t* wattr
+	);
+
+/**
+ * @private
+ * Return wire protocol operator.  Map operators are sent as their CDT equivalents.
+ */
+static inline uint8_t
+as_command_operator(as_operator op)
+{
+	switch (op) {
+		case AS_OPERATOR_MAP_READ:
+			return AS_OPERATOR_CDT_READ;
+		case AS_OPERATOR_MAP_MODIFY:
+			return AS_OPERATOR_CDT_MODIFY;
+		default:
+			return (uint8_t)op;
+	}
+}
+
 /**
  * @private
  * Calculate size of bin name. Return error is bin name greater than AS_BIN_NAME_MAX_LEN characters.
@@ -329,6 +397,67 @@ as_command_set_attr_read(
 	as_command_set_attr_compress(compress, read_attr);
 }
 	
+/**
+ * @private
+ * Set write attributes for write commands and return the generation to send.
+ */
+static inline uint32_t
+as_command_set_attr_write(
+	as_policy_commit_level commit_level, as_policy_exists exists, as_policy_gen gen_policy,
+	uint32_t gen, bool durable_delete, uint8_t* write_attr, uint8_t* info_attr
+	)
+{
+	switch (exists) {
+		default:
+		case AS_POLICY_EXISTS_IGNORE:
+			break;
+			
+		case AS_POLICY_EXISTS_UPDATE:
+			*info_attr |= AS_MSG_INFO3_UPDATE_ONLY;
+			break;
+			
+		case AS_POLICY_EXISTS_CREATE_OR_REPLACE:
+			*info_attr |= AS_MSG_INFO3_CREATE_OR_REPLACE;
+			break;
+			
+		case AS_POLICY_EXISTS_REPLACE:
+			*info_attr |= AS_MSG_INFO3_REPLACE_ONLY;
+			break;
+			
+		case AS_POLICY_EXISTS_CREATE:
+			*write_attr |= AS_MSG_INFO2_CREATE_ONLY;
+			break;
+	}
+
+	uint32_t generation;
+
+	switch (gen_policy) {
+		default:
+		case AS_POLICY_GEN_IGNORE:
+			generation = 0;
+			break;
+			
+		case AS_POLICY_GEN_EQ:
+			generation = gen;
+			*write_attr |= AS_MSG_INFO2_GENERATION;
+			break;
+			
+		case AS_POLICY_GEN_GT:
+			generation = gen;
+			*write_attr |= AS_MSG_INFO2_GENERATION_GT;
+			break;
+	}
+
+	if (commit_level == AS_POLICY_COMMIT_LEVEL_MASTER) {
+		*info_attr |= AS_MSG_INFO3_COMMIT_MASTER;
+	}
+
+	if (durable_delete) {
+		*write_attr |= AS_MSG_INFO2_DURABLE_DELETE;
+	}
+	return generation;
+}
+
 /**
  * @private
  * Write command header for write commands.
@@ -440,6 +569,13 @@ as_command_write_field_digest(uint8_t* p, const as_digest* val)
 	return p + AS_DIGEST_VALUE_SIZE;
 }
 
+/**
+ * @private
+ * Write user key field.
+ */
+uint8_t*
+as_command_write_user_key(uint8_t* begin, const as_key* key);
+
 /**
  * @private
  * Write key structure.
@@ -477,6 +613,16 @@ as_command_write_bin_name(uint8_t* cmd, const char* name)
 uint8_t*
 as_command_write_bin(uint8_t* begin, uint8_t operation_type, const as_bin* bin, as_buffer* buffer);
 
+/**
+ * @private
+ * Write bin.  String/blob values reserved in gather are referenced instead of copied.
+ */
+uint8_t*
+as_command_write_bin_gather(
+	uint8_t* begin, uint8_t operation_type, const as_bin* bin, as_buffer* buffer,
+	as_command_gather* gather
+	);
+
 /**
  * @private
  * Finish writing command.
@@ -490,6 +636,110 @@ as_command_write_end(uint8_t* begin, uint8_t* end)
 	return len;
 }
 
+/**
+ * @private
+ * Finish writing command that may reference values outside the command buffer.
+ * Return size of data written to command buffer.
+ */
+static inline size_t
+as_command_write_end_gather(uint8_t* begin, uint8_t* end, as_command_gather* gather)
+{
+	if (! gather || gather->size == 0) {
+		return as_command_write_end(begin, end);
+	}
+
+	// Proto size includes referenced values.
+	uint64_t len = end - begin;
+	uint64_t proto = (len + gather->ext_size - 8) | ((uint64_t)AS_PROTO_VERSION << 56) |
+		((uint64_t)AS_MESSAGE_TYPE << 48);
+	*(uint64_t*)begin = cf_swap_to_be64(proto);
+	return len;
+}
+
+/**
+ * @private
+ * Initialize gather.  A zero threshold disables value references.
+ */
+static inline void
+as_command_gather_init(as_command_gather* gather, as_cluster* cluster)
+{
+	gather->ext_size = 0;
+	gather->threshold = cluster->gather_write_threshold;
+	gather->reserved = 0;
+	gather->size = 0;
+}
+
+/**
+ * @private
+ * Return true if bin value is a string/blob that should be referenced.
+ */
+static inline bool
+as_command_gather_value(
+	const as_command_gather* gather, const as_bin* bin, uint8_t** data, uint32_t* len,
+	uint8_t* type
+	)
+{
+	if (gather->threshold == 0) {
+		return false;
+	}
+
+	as_val* val = (as_val*)bin->valuep;
+
+	switch (val->type) {
+		case AS_STRING: {
+			as_string* v = as_string_fromval(val);
+			// v->len should have been already set by as_command_value_size().
+			*data = (uint8_t*)v->value;
+			*len = (uint32_t)v->len;
+			*type = AS_BYTES_STRING;
+			break;
+		}
+		case AS_BYTES: {
+			as_bytes* v = as_bytes_fromval(val);
+			*data = v->value;
+			*len = v->size;
+			*type = v->type;
+			break;
+		}
+		default:
+			return false;
+	}
+	return *len >= gather->threshold;
+}
+
+/**
+ * @private
+ * Reserve bin value reference if value qualifies.  Must be called for each bin in the same
+ * order as as_command_write_bin_gather().  Return number of bytes that will not be written
+ * to the command buffer.
+ */
+static inline size_t
+as_command_gather_reserve(as_command_gather* gather, const as_bin* bin)
+{
+	uint8_t* data;
+	uint32_t len;
+	uint8_t type;
+
+	if (gather->reserved < AS_COMMAND_GATHER_MAX &&
+		as_command_gather_value(gather, bin, &data, &len, &type)) {
+		gather->reserved++;
+		gather->ext_size += len;
+		return len;
+	}
+	return 0;
+}
+
+/**
+ * @private
+ * Discard all reserved value references.
+ */
+static inline void
+as_command_gather_clear(as_command_gather* gather)
+{
+	gather->ext_size = 0;
+	gather->reserved = 0;
+}
+
 /**
  * @private
  * Finish writing compressed command.
@@ -537,7 +787,7 @@ static inline void
 as_command_start_timer(as_command* cmd)
 {
 	cmd->iteration = 0;
-	cmd->master = true;
+	cmd->replica_index = 0;
 
 	const as_policy_base* policy = cmd->policy;
 
@@ -586,6 +836,14 @@ as_command_parse_header(as_error* err, as_node* node, uint8_t* buf, size_t size,
 as_status
 as_command_parse_result(as_error* err, as_node* node, uint8_t* buf, size_t size, void* udata);
 
+/**
+ * @private
+ * Parse server record into a record view.  Used for view reads.  Bin names and values
+ * reference buf.  Commands with AS_COMMAND_FLAGS_VIEW transfer buf to the view on success.
+ */
+as_status
+as_command_parse_result_view(as_error* err, as_node* node, uint8_t* buf, size_t size, void* udata);
+
 /**
  * @private
  * Parse server success or failure result.
@@ -523,10 +523,111 @@ typedef struct as_config_s {
 	 * Contention for pooled connections can be reduced by creating multiple mini connection pools
 	 * per node.
 	 *
+	 * Each pool is a lock-free shard.  A transaction first uses the shard assigned to the
+	 * calling thread's cpu and steals a pooled connection from another shard when its own shard
+	 * is empty.  Setting this value to the number of cpu cores is a reasonable choice for highly
+	 * concurrent applications.
+	 *
 	 * Default: 1
 	 */
 	uint32_t conn_pools_per_node;
 
+	/**
+	 * Number of synchronous pipeline connections used for each node.  When greater than zero,
+	 * single record synchronous commands (get, put, remove, operate, apply...) are written on a
+	 * pipeline connection that is shared by multiple application threads.  Responses are read
+	 * in the order the commands were written, so many commands may be in flight on a single
+	 * socket.  This greatly reduces the number of sync connections needed by highly concurrent
+	 * applications that issue small commands.
+	 *
+	 * Batch, scan and query commands always use pooled connections.  Sync pipelining is disabled
+	 * when TLS is used for transactions.
+	 *
+	 * A command that times out while waiting for its response gives up its turn and the
+	 * response is discarded when it arrives.  Other commands on the connection are not affected.
+	 * A socket failure on a pipeline connection fails all commands in flight on that connection.
+	 * These commands are then retried according to their policy.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t sync_pipe_conns_per_node;
+
+	/**
+	 * Minimum string/blob bin value size in bytes that is sent directly from the application's
+	 * value buffer instead of being copied into the command buffer.  The command is then
+	 * written with a single scatter/gather socket write.  Applies to synchronous put and
+	 * operate commands that are not compressed.  The value buffer must not be modified while
+	 * the command is in progress.
+	 *
+	 * Use 0 to always copy values into the command buffer.
+	 *
+	 * Default: 131072 (128KB)
+	 */
+	uint32_t gather_write_threshold;
+
+	/**
+	 * Minimum total size in bytes of values referenced by a scatter/gather write (see
+	 * gather_write_threshold) before the write requests kernel zero-copy transmission
+	 * (MSG_ZEROCOPY).  Only supported on Linux 4.14+ without TLS.  Zero-copy avoids the copy
+	 * into kernel socket buffers, but adds page pinning and completion notification overhead,
+	 * so it usually only benefits values of several hundred KB or more.
+	 *
+	 * Use 0 to disable zero-copy writes.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t zero_copy_threshold;
+
+	/**
+	 * Node error percentage that opens the node's circuit breaker.  Timeouts, connection errors
+	 * and device overload errors count as node errors.  Command attempts and errors are counted
+	 * for each tend interval.  When the error percentage is greater than or equal to this value,
+	 * commands to the node fail fast with AEROSPIKE_ERR_CIRCUIT_OPEN.  Reads that are allowed
+	 * to use a replica are redirected to another replica instead.
+	 *
+	 * After circuit_open_ms, the circuit becomes half open and a few commands are sent to the
+	 * node.  The circuit is closed if these commands succeed and opened again otherwise.
+	 *
+	 * Use 0 to disable circuit breakers.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t circuit_error_rate;
+
+	/**
+	 * Minimum command attempts on a node within a tend interval before the node's error
+	 * percentage is used to open its circuit breaker.
+	 *
+	 * Default: 100
+	 */
+	uint32_t circuit_min_requests;
+
+	/**
+	 * Milliseconds a node's circuit breaker stays open before it becomes half open.
+	 *
+	 * Default: 5000
+	 */
+	uint32_t circuit_open_ms;
+
+	/**
+	 * Maximum retries within a tend interval expressed as a percentage of the commands started
+	 * in the previous tend interval.  Retries are shared by all nodes in the cluster.  When
+	 * the budget is exhausted, commands return their last error instead of retrying.  This
+	 * avoids multiplying load on the cluster when nodes are overloaded.
+	 *
+	 * Use 0 to allow all retries defined by command policies.
+	 *
+	 * Default: 0 (unlimited)
+	 */
+	uint32_t retry_budget;
+
+	/**
+	 * Minimum retries allowed within a tend interval when retry_budget is enabled.
+	 *
+	 * Default: 10
+	 */
+	uint32_t retry_budget_min;
+
 	/**
 	 * Initial host connection timeout in milliseconds.  The timeout when opening a connection
 	 * to the server host for the first time.
@@ -568,6 +669,26 @@ typedef struct as_config_s {
 	 */
 	uint32_t tender_interval;
 
+	/**
+	 * Minimum milliseconds between cluster tends when a tend is triggered early.  Connection
+	 * refused or reset errors to a node wake the cluster tender, so a failed node and the new
+	 * partition map are discovered without waiting for the next tender_interval.  Early tends
+	 * are not started sooner than this interval after the previous tend started.  If zero,
+	 * connection errors do not trigger early tends.  Not used with shared memory.
+	 * Default: 50
+	 */
+	uint32_t tender_interval_min;
+
+	/**
+	 * Maximum milliseconds between cluster tends when the cluster is stable.  If greater than
+	 * tender_interval, the tend interval is doubled after each tend where nodes and partition
+	 * generations are unchanged, up to this limit.  The interval is reset to tender_interval
+	 * on any cluster change or connection error.  Circuit breaker, retry budget and latency
+	 * statistics are still evaluated every tender_interval.  Not used with shared memory.
+	 * Default: 0 (fixed tender_interval)
+	 */
+	uint32_t tender_interval_max;
+
 	/**
 	 * Number of threads stored in underlying thread pool used by synchronous batch/scan/query commands.
 	 * These commands are often sent to multiple server nodes in parallel threads.  A thread pool 
@@ -587,6 +708,34 @@ typedef struct as_config_s {
 	 */
 	int tend_thread_cpu;
 
+	/**
+	 * Number of threads used by the cluster tender to send info requests to server nodes
+	 * concurrently.  With concurrent requests, the tend cycle time is bounded by the slowest
+	 * node instead of the sum of all nodes.  If zero, nodes are tended one at a time in the
+	 * tend thread.
+	 * Default: 8
+	 */
+	uint32_t tend_thread_pool_size;
+
+	/**
+	 * Path of partition map snapshot file.  If set, the cluster tender periodically writes
+	 * nodes, racks and partition maps to this file.  On startup, a valid snapshot is loaded
+	 * so commands can be routed immediately instead of waiting for the initial cluster tends.
+	 * The snapshot is then corrected by the tend thread.  Not used with shared memory.
+	 * Snapshots are only written and loaded when cluster_name is set.  A snapshot is not
+	 * loaded when its cluster name differs or any configured seed host is not in the
+	 * snapshot seed list.  Use as_config_set_snapshot_path() to set this field.
+	 * Default: NULL (disabled)
+	 */
+	char* snapshot_path;
+
+	/**
+	 * Minimum milliseconds between partition map snapshot writes.  A snapshot is only
+	 * written when nodes or partition maps have changed since the last write.
+	 * Default: 10000
+	 */
+	uint32_t snapshot_interval;
+
 	/**
 	 * Client policies
 	 */
@@ -709,6 +858,24 @@ typedef struct as_config_s {
 	 * Default: 30
 	 */
 	uint32_t shm_takeover_threshold_sec;
+
+	/**
+	 * Shared memory maximum number of client processes that publish statistics.  Each process
+	 * attached to the shared memory segment claims a slot and periodically writes its connection
+	 * counts, command count and read latency histogram.  Any attached process can then read
+	 * statistics for all clients on the host with as_shm_get_process_stats().
+	 * Default: 0 (disabled)
+	 */
+	uint32_t shm_max_processes;
+
+	/**
+	 * Request huge pages for the shared memory segment.  Huge pages reduce TLB misses when
+	 * many processes access the partition maps.  Only supported on Linux and requires
+	 * preallocated huge pages (vm.nr_hugepages).  If huge pages are not available, regular
+	 * pages are used and a warning is logged.
+	 * Default: false
+	 */
+	bool shm_huge_pages;
 } as_config;
 
 /******************************************************************************
@@ -812,6 +979,17 @@ as_config_set_cluster_name(as_config* config, const char* cluster_name)
 	as_config_set_string(&config->cluster_name, cluster_name);
 }
 
+/**
+ * Set partition map snapshot file path.
+ *
+ * @relates as_config
+ */
+static inline void
+as_config_set_snapshot_path(as_config* config, const char* path)
+{
+	as_config_set_string(&config->snapshot_path, path);
+}
+
 /**
  * Set cluster event callback and user data.
  *
@@ -16,39 +16,131 @@
  */
 #pragma once
 
-#include <aerospike/as_queue.h>
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_socket.h>
-#include <pthread.h>
+#include <citrusleaf/alloc.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Connection pool shard alignment.
+ */
+#define AS_CONN_POOL_ALIGN 64
+
 /******************************************************************************
  * TYPES
  *****************************************************************************/
 
 /**
  * @private
- * Sync connection pool.
+ * Sync connection pool shard.
+ *
+ * Sockets are stored in a fixed array of slots.  Slots holding pooled sockets form a LIFO
+ * stack starting at head.  Unused slots form a second stack starting at free_head.  Both
+ * stack heads are 64 bit words where the low 32 bits are the slot index plus one (0 means empty)
+ * and the high 32 bits are a counter that is incremented on every successful swap.  The counter
+ * prevents the ABA problem, so push and pop are lock-free compare and swap loops.
+ *
+ * The struct is padded to a cache line so shards in the node's pool array do not share lines.
  */
 typedef struct as_conn_pool_s {
 	/**
-	 * Mutex lock.
+	 * Socket slots.
+	 */
+	as_socket* sockets;
+
+	/**
+	 * Next slot link for each slot (index plus one, 0 means end of stack).
+	 */
+	uint32_t* links;
+
+	/**
+	 * Head of pooled socket stack.
+	 */
+	uint64_t head;
+
+	/**
+	 * Head of unused slot stack.
+	 */
+	uint64_t free_head;
+
+	/**
+	 * Number of sockets currently in pool.
+	 */
+	uint32_t size;
+
+	/**
+	 * Total number of connections opened by this pool (in pool and in use).
 	 */
-	pthread_mutex_t lock;
+	uint32_t total;
 
 	/**
-	 * Queue.
+	 * Maximum number of connections.
 	 */
-	as_queue queue;
+	uint32_t capacity;
 
 	/**
 	 * Minimum number of connections.
 	 */
 	uint32_t min_size;
+
+	/**
+	 * Pad to cache line.
+	 */
+	uint8_t pad[16];
 } as_conn_pool;
 
+/******************************************************************************
+ * PRIVATE FUNCTIONS
+ *****************************************************************************/
+
+static inline uint64_t
+as_conn_pool_stack_next(uint64_t head, uint32_t index)
+{
+	return (((head >> 32) + 1) << 32) | index;
+}
+
+static inline uint32_t
+as_conn_pool_stack_pop(as_conn_pool* pool, uint64_t* head)
+{
+	while (true) {
+		uint64_t old = as_load_uint64(head);
+		uint32_t index = (uint32_t)old;
+
+		if (index == 0) {
+			return 0;
+		}
+
+		// Link may be stale if another thread popped this slot concurrently, but then the
+		// head counter has also changed and the compare and swap will fail.
+		uint32_t next = as_load_uint32(&pool->links[index - 1]);
+
+		if (as_cas_uint64(head, old, as_conn_pool_stack_next(old, next))) {
+			return index;
+		}
+	}
+}
+
+static inline void
+as_conn_pool_stack_push(as_conn_pool* pool, uint64_t* head, uint32_t first, uint32_t last)
+{
+	while (true) {
+		uint64_t old = as_load_uint64(head);
+		as_store_uint32(&pool->links[last - 1], (uint32_t)old);
+
+		if (as_cas_uint64(head, old, as_conn_pool_stack_next(old, first))) {
+			return;
+		}
+	}
+}
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -58,37 +150,75 @@ typedef struct as_conn_pool_s {
  * Initialize a connection pool.
  */
 static inline void
-as_conn_pool_init(as_conn_pool* pool, uint32_t item_size, uint32_t min_size, uint32_t max_size)
+as_conn_pool_init(as_conn_pool* pool, uint32_t min_size, uint32_t max_size)
 {
-	pthread_mutex_init(&pool->lock, NULL);
-	as_queue_init(&pool->queue, item_size, max_size);
+	pool->head = 0;
+	pool->free_head = 0;
+	pool->size = 0;
+	pool->total = 0;
+	pool->capacity = max_size;
 	pool->min_size = min_size;
+
+	if (max_size == 0) {
+		pool->sockets = NULL;
+		pool->links = NULL;
+		return;
+	}
+
+	pool->sockets = cf_malloc(sizeof(as_socket) * max_size);
+	pool->links = cf_malloc(sizeof(uint32_t) * max_size);
+
+	// Chain all slots into the unused slot stack.
+	for (uint32_t i = 0; i < max_size; i++) {
+		pool->links[i] = (i + 1 < max_size) ? i + 2 : 0;
+	}
+	pool->free_head = 1;
 }
 
 /**
  * @private
- * Pop connection from head of pool.
+ * Allocate array of connection pool shards aligned to a cache line.  cf_malloc() does not
+ * guarantee cache line alignment, so the allocation is padded and the allocated pointer is
+ * stored just before the array.  Release with as_conn_pools_destroy().
  */
-static inline bool
-as_conn_pool_pop_head(as_conn_pool* pool, as_socket* sock)
+static inline as_conn_pool*
+as_conn_pools_create(uint32_t n_pools)
 {
-	pthread_mutex_lock(&pool->lock);
-	bool status = as_queue_pop(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
-	return status;
+	uint8_t* mem = cf_malloc(sizeof(as_conn_pool) * n_pools + sizeof(void*) + AS_CONN_POOL_ALIGN - 1);
+	uintptr_t p = ((uintptr_t)mem + sizeof(void*) + AS_CONN_POOL_ALIGN - 1) &
+		~(uintptr_t)(AS_CONN_POOL_ALIGN - 1);
+
+	((void**)p)[-1] = mem;
+	return (as_conn_pool*)p;
 }
 
 /**
  * @private
- * Pop connection from tail of pool.
+ * Release array of connection pool shards allocated by as_conn_pools_create().
+ */
+static inline void
+as_conn_pools_destroy(as_conn_pool* pools)
+{
+	cf_free(((void**)pools)[-1]);
+}
+
+/**
+ * @private
+ * Pop most recently used connection from pool.
  */
 static inline bool
-as_conn_pool_pop_tail(as_conn_pool* pool, as_socket* sock)
+as_conn_pool_pop_head(as_conn_pool* pool, as_socket* sock)
 {
-	pthread_mutex_lock(&pool->lock);
-	bool status = as_queue_pop_tail(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
-	return status;
+	uint32_t index = as_conn_pool_stack_pop(pool, &pool->head);
+
+	if (index == 0) {
+		return false;
+	}
+
+	*sock = pool->sockets[index - 1];
+	as_decr_uint32(&pool->size);
+	as_conn_pool_stack_push(pool, &pool->free_head, index, index);
+	return true;
 }
 
 /**
@@ -98,23 +228,60 @@ as_conn_pool_pop_tail(as_conn_pool* pool, as_socket* sock)
 static inline bool
 as_conn_pool_push_head(as_conn_pool* pool, as_socket* sock)
 {
-	pthread_mutex_lock(&pool->lock);
-	bool status = as_queue_push_head_limit(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
-	return status;
+	uint32_t index = as_conn_pool_stack_pop(pool, &pool->free_head);
+
+	if (index == 0) {
+		return false;
+	}
+
+	pool->sockets[index - 1] = *sock;
+	as_incr_uint32(&pool->size);
+	as_conn_pool_stack_push(pool, &pool->head, index, index);
+	return true;
 }
 
 /**
  * @private
- * Push connection to tail of pool if size < capacity.
+ * Detach all pooled connections from pool.  Return first slot index of detached chain
+ * (0 if pool is empty).  Connections are linked from most recently used to least recently used.
+ * Used by the cluster tend thread to trim idle connections.
  */
-static inline bool
-as_conn_pool_push_tail(as_conn_pool* pool, as_socket* sock)
+static inline uint32_t
+as_conn_pool_detach(as_conn_pool* pool)
+{
+	while (true) {
+		uint64_t old = as_load_uint64(&pool->head);
+		uint32_t index = (uint32_t)old;
+
+		if (index == 0) {
+			return 0;
+		}
+
+		if (as_cas_uint64(&pool->head, old, as_conn_pool_stack_next(old, 0))) {
+			return index;
+		}
+	}
+}
+
+/**
+ * @private
+ * Attach chain of connections previously returned by as_conn_pool_detach().
+ */
+static inline void
+as_conn_pool_attach(as_conn_pool* pool, uint32_t first, uint32_t last)
 {
-	pthread_mutex_lock(&pool->lock);
-	bool status = as_queue_push_limit(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
-	return status;
+	as_conn_pool_stack_push(pool, &pool->head, first, last);
+}
+
+/**
+ * @private
+ * Return slot of a detached connection that has been closed to unused slot stack.
+ */
+static inline void
+as_conn_pool_release_slot(as_conn_pool* pool, uint32_t index)
+{
+	as_decr_uint32(&pool->size);
+	as_conn_pool_stack_push(pool, &pool->free_head, index, index);
 }
 
 /**
@@ -125,7 +292,7 @@ as_conn_pool_push_tail(as_conn_pool* pool, as_socket* sock)
 static inline bool
 as_conn_pool_incr(as_conn_pool* pool)
 {
-	return as_faa_uint32(&pool->queue.total, 1) < pool->queue.capacity;
+	return as_faa_uint32(&pool->total, 1) < pool->capacity;
 }
 
 /**
@@ -135,7 +302,7 @@ as_conn_pool_incr(as_conn_pool* pool)
 static inline void
 as_conn_pool_decr(as_conn_pool* pool)
 {
-	as_decr_uint32(&pool->queue.total);
+	as_decr_uint32(&pool->total);
 }
 
 /**
@@ -145,27 +312,34 @@ as_conn_pool_decr(as_conn_pool* pool)
 static inline int
 as_conn_pool_excess(as_conn_pool* pool)
 {
-	return as_load_uint32(&pool->queue.total) - pool->min_size;
+	return as_load_uint32(&pool->total) - pool->min_size;
 }
 
 /**
  * @private
- * Destroy a connection pool.
+ * Return number of connections currently in pool.
+ */
+static inline uint32_t
+as_conn_pool_size(as_conn_pool* pool)
+{
+	return as_load_uint32(&pool->size);
+}
+
+/**
+ * @private
+ * Destroy a connection pool.  No other thread may access the pool.
  */
 static inline void
 as_conn_pool_destroy(as_conn_pool* pool)
 {
 	as_socket sock;
 
-	pthread_mutex_lock(&pool->lock);
-
-	while (as_queue_pop(&pool->queue, &sock)) {
+	while (as_conn_pool_pop_head(pool, &sock)) {
 		as_socket_close(&sock);
 	}
 
-	as_queue_destroy(&pool->queue);
-	pthread_mutex_unlock(&pool->lock);
-	pthread_mutex_destroy(&pool->lock);
+	cf_free(pool->sockets);
+	cf_free(pool->links);
 }
 
 #ifdef __cplusplus
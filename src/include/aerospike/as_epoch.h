@@ -0,0 +1,70 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Enter read-side critical section on the calling thread.  Nodes and partition tables
+ * observed inside the section are not reclaimed until the thread calls as_epoch_exit().
+ * Sections may be nested.  Only thread local memory is written.
+ */
+AS_EXTERN void
+as_epoch_enter(void);
+
+/**
+ * @private
+ * Exit read-side critical section entered by as_epoch_enter().
+ */
+AS_EXTERN void
+as_epoch_exit(void);
+
+/**
+ * @private
+ * Return current global epoch.  Objects retired by the tender are stamped with this value.
+ */
+AS_EXTERN uint64_t
+as_epoch_current(void);
+
+/**
+ * @private
+ * Advance global epoch.  Threads that enter a critical section afterwards can not observe
+ * objects retired before the call.
+ */
+AS_EXTERN void
+as_epoch_advance(void);
+
+/**
+ * @private
+ * Return the oldest epoch held by a thread inside a critical section or UINT64_MAX if
+ * all threads are quiescent.  Objects retired at an older epoch may be reclaimed.
+ */
+AS_EXTERN uint64_t
+as_epoch_min_active(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -26,7 +26,8 @@
  * Generic asynchronous events abstraction.  Designed to support multiple event libraries.
  * Only one library is supported per build.
  */
-#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBUV) || defined(AS_USE_LIBEVENT)
+#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBUV) || defined(AS_USE_LIBEVENT) || \
+	defined(AS_USE_LIBURING)
 #define AS_EVENT_LIB_DEFINED 1
 #endif
 
@@ -37,9 +38,13 @@
 #elif defined(AS_USE_LIBEVENT)
 #include <event2/event_struct.h>
 #include <aerospike/as_vector.h>
+#elif defined(AS_USE_LIBURING)
+struct as_uring_loop;
 #else
 #endif
 
+struct as_slab_s;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -96,6 +101,18 @@ typedef struct as_policy_event {
 	 * Default: 256 (if delay queue is used)
 	 */
 	uint32_t queue_initial_capacity;
+
+	/**
+	 * Distribute event loops evenly across NUMA nodes and restrict each event loop thread to
+	 * the cpus of its node.  Memory first touched by event loop threads (connections and
+	 * buffers) is then allocated on the local node.  as_event_loop_get() returns an event loop
+	 * on the caller's current node, so async commands are created and processed on the same
+	 * node.  Ignored when the host has only one NUMA node or NUMA topology is not available
+	 * (non-linux platforms).
+	 *
+	 * Default: false
+	 */
+	bool numa_aware;
 } as_policy_event;
 
 /**
@@ -116,17 +133,24 @@ typedef struct as_event_loop {
 	struct event wakeup;
 	struct event trim;
 	as_vector clusters;
+#elif defined(AS_USE_LIBURING)
+	struct as_uring_loop* loop;
 #else
 	void* loop;
 #endif
 		
 	struct as_event_loop* next;
+	// Circular linked list of event loops on the same NUMA node.
+	struct as_event_loop* numa_next;
 	pthread_mutex_t lock;
 	as_queue queue;
 	as_queue delay_queue;
 	as_queue pipe_cb_queue;
+	struct as_slab_s* slab;
 	pthread_t thread;
 	uint32_t index;
+	// NUMA node id or -1 if event loop is not bound to a node.
+	int numa_node;
 	uint32_t max_commands_in_queue;
 	int max_commands_in_process;
 	int pending;
@@ -145,6 +169,7 @@ AS_EXTERN extern as_event_loop* as_event_loops;
 AS_EXTERN extern as_event_loop* as_event_loop_current;
 AS_EXTERN extern uint32_t as_event_loop_size;
 AS_EXTERN extern bool as_event_single_thread;
+AS_EXTERN extern bool as_event_numa_aware;
 
 /******************************************************************************
  * PUBLIC FUNCTIONS
@@ -161,6 +186,7 @@ as_policy_event_init(as_policy_event* policy)
 	policy->max_commands_in_process = 0;
 	policy->max_commands_in_queue = 0;
 	policy->queue_initial_capacity = 256;
+	policy->numa_aware = false;
 }
 
 /**
@@ -370,7 +396,15 @@ as_event_loop_get_by_index(uint32_t index)
 }
 
 /**
- * Retrieve a random event loop using round robin distribution.
+ * @private
+ * Retrieve event loop on the caller's current NUMA node using round robin distribution.
+ */
+AS_EXTERN as_event_loop*
+as_event_loop_get_numa(void);
+
+/**
+ * Retrieve a random event loop using round robin distribution.  When event loops were created
+ * with as_policy_event.numa_aware, an event loop on the caller's NUMA node is preferred.
  *
  * @return			Client's generic event loop abstraction that is used in client async commands.
  *
@@ -379,6 +413,10 @@ as_event_loop_get_by_index(uint32_t index)
 static inline as_event_loop*
 as_event_loop_get()
 {
+	if (as_event_numa_aware) {
+		return as_event_loop_get_numa();
+	}
+
 	// The last event loop points to the first event loop to create a circular linked list.
 	// Not atomic because doesn't need to be exactly accurate.
 	as_event_loop* event_loop = as_event_loop_current;
@@ -460,6 +498,27 @@ as_event_close_loop(as_event_loop* event_loop);
 AS_EXTERN void
 as_event_destroy_loops();
 
+/******************************************************************************
+ * LIBURING FUNCTIONS
+ *****************************************************************************/
+
+#if defined(AS_USE_LIBURING)
+
+/**
+ * Process events on an externally registered io_uring event loop.  The client owns the
+ * io_uring instance, so the loop argument passed to as_event_set_external_loop() is ignored.
+ * This function must be called from the same thread that called as_event_set_external_loop()
+ * and it returns after the event loop is closed.
+ *
+ * @param event_loop	Event loop returned by as_event_set_external_loop().
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN void
+as_event_uring_run(as_event_loop* event_loop);
+
+#endif
+
 /******************************************************************************
  * LIBEVENT SINGLE THREAD MODE FUNCTIONS
  *****************************************************************************/
@@ -21,6 +21,7 @@
 #include <aerospike/as_listener.h>
 #include <aerospike/as_queue.h>
 #include <aerospike/as_proto.h>
+#include <aerospike/as_slab.h>
 #include <aerospike/as_socket.h>
 #include <citrusleaf/cf_ll.h>
 #include <pthread.h>
@@ -32,6 +33,8 @@
 struct as_uv_tls;
 #elif defined(AS_USE_LIBEVENT)
 #include <event2/event.h>
+#elif defined(AS_USE_LIBURING)
+#include <liburing.h>
 #else
 #endif
 
@@ -56,8 +59,8 @@ extern "C" {
 #define AS_ASYNC_STATE_COMMAND_READ_BODY 10
 #define AS_ASYNC_STATE_QUEUE_ERROR 11
 #define AS_ASYNC_STATE_RETRY 12
+#define AS_ASYNC_STATE_HEDGE 13
 
-#define AS_ASYNC_FLAGS_MASTER 1
 #define AS_ASYNC_FLAGS_READ 2
 #define AS_ASYNC_FLAGS_HAS_TIMER 4
 #define AS_ASYNC_FLAGS_USING_SOCKET_TIMER 8
@@ -67,6 +70,9 @@ extern "C" {
 #define AS_ASYNC_FLAGS_MASTER_SC 128
 
 #define AS_ASYNC_FLAGS2_DESERIALIZE 1
+#define AS_ASYNC_FLAGS2_HEDGE 2
+#define AS_ASYNC_FLAGS2_HEDGE_COPY 4
+#define AS_ASYNC_FLAGS2_LATENCY 8
 
 #define AS_ASYNC_AUTH_RETURN_CODE 1
 
@@ -75,10 +81,29 @@ extern "C" {
 #define AS_EVENT_CONNECTION_ERROR 2
 
 #define AS_EVENT_QUEUE_INITIAL_CAPACITY 256
+
+#if defined(AS_USE_LIBURING)
+// Maximum received buffers staged on a connection before they are consumed by a command.
+#define AS_URING_RX_MAX 16
+#endif
 	
 struct as_event_command;
 struct as_event_executor;
 
+#if defined(AS_USE_LIBURING)
+typedef struct {
+	uint64_t deadline;  // Milliseconds.
+	uint64_t repeat;    // Milliseconds. Zero for one-shot timers.
+	uint32_t index;     // Timer heap index + 1. Zero when not scheduled.
+} as_uring_timer;
+
+typedef struct {
+	uint16_t bid;
+	uint16_t offset;
+	uint32_t len;
+} as_uring_chunk;
+#endif
+
 typedef struct {
 #if defined(AS_USE_LIBEV)
 	struct ev_io watcher;
@@ -95,6 +120,20 @@ typedef struct {
 #elif defined(AS_USE_LIBEVENT)
 	struct event watcher;
 	as_socket socket;
+#elif defined(AS_USE_LIBURING)
+	as_socket socket;
+	as_event_loop* event_loop;
+	struct as_event_command* send_cmd;  // Command that owns the in-flight send.
+	int fixed;         // Registered file index or -1 when the raw fd is used.
+	uint32_t ops;      // In-flight ring operations plus active callback references.
+	uint32_t poll;     // Poll mask wanted by TLS and connect states.
+	uint8_t armed;     // Ring operations currently armed.
+	bool closed;       // Closed while ring operations were in flight.
+	bool scheduled;    // Queued on the event loop ready list.
+	int rx_error;      // Receive error (errno), -1 when closed by peer.
+	uint8_t rx_head;
+	uint8_t rx_count;
+	as_uring_chunk rx[AS_URING_RX_MAX];  // Received data not yet consumed by a command.
 #else
 #endif
 	int watching;
@@ -122,6 +161,8 @@ typedef struct as_event_command {
 	uv_timer_t timer;
 #elif defined(AS_USE_LIBEVENT)
 	struct event timer;
+#elif defined(AS_USE_LIBURING)
+	as_uring_timer timer;
 #else
 #endif
 	uint64_t total_deadline;
@@ -139,6 +180,18 @@ typedef struct as_event_command {
 	as_event_parse_results_fn parse_results;
 	as_pipe_listener pipe_listener;
 	cf_ll_element pipe_link;
+
+	// Hedged read fields.  Used when AS_ASYNC_FLAGS2_HEDGE is set.
+	struct as_event_command* hedge;  // Peer command or NULL when not hedged.
+	uint64_t hedge_begin;
+	uint32_t hedge_delay;
+	uint32_t hedge_percentile;
+
+	// Node latency tracking start time.  Used when AS_ASYNC_FLAGS2_LATENCY is set.
+	uint64_t latency_begin;
+
+	// Command start time for process statistics.  Zero when statistics are disabled.
+	uint64_t stats_begin;
 	
 	uint8_t* buf;
 	uint32_t command_sent_counter;
@@ -154,6 +207,7 @@ typedef struct as_event_command {
 	uint8_t state;
 	uint8_t flags;
 	uint8_t flags2;
+	uint8_t replica_index;  // Sequence replica index.  Incremented on retry.
 } as_event_command;
 
 typedef struct {
@@ -571,6 +625,84 @@ as_event_command_release(as_event_command* cmd)
 	as_event_command_free(cmd);
 }
 
+/******************************************************************************
+ * LIBURING INLINE FUNCTIONS
+ *****************************************************************************/
+
+#elif defined(AS_USE_LIBURING)
+
+void as_uring_timer_start(as_event_command* cmd, uint64_t timeout, uint64_t repeat);
+void as_uring_timer_stop(as_event_command* cmd);
+void as_event_stop_watcher(as_event_command* cmd, as_event_connection* conn);
+void as_event_close_connection(as_event_connection* conn);
+
+static inline bool
+as_event_connection_current(as_event_connection* conn, uint64_t max_socket_idle_ns)
+{
+	return as_socket_current_trim(conn->socket.last_used, max_socket_idle_ns);
+}
+
+static inline int
+as_event_validate_connection(as_event_connection* conn, uint64_t max_socket_idle_ns)
+{
+	// Receive errors and staged data have already been pulled off the socket by the ring.
+	if (conn->rx_error || conn->closed) {
+		return -1;
+	}
+
+	if (conn->rx_count > 0) {
+		return conn->rx_count;
+	}
+	return as_socket_validate(&conn->socket, max_socket_idle_ns);
+}
+
+static inline void
+as_event_set_conn_last_used(as_event_connection* conn)
+{
+	conn->socket.last_used = cf_getns();
+}
+
+static inline void
+as_event_timer_once(as_event_command* cmd, uint64_t timeout)
+{
+	as_uring_timer_start(cmd, timeout, 0);
+	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER;
+}
+
+static inline void
+as_event_timer_repeat(as_event_command* cmd, uint64_t repeat)
+{
+	as_uring_timer_start(cmd, repeat, repeat);
+	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER | AS_ASYNC_FLAGS_USING_SOCKET_TIMER;
+}
+
+static inline void
+as_event_timer_again(as_event_command* cmd)
+{
+	as_uring_timer_start(cmd, cmd->timer.repeat, cmd->timer.repeat);
+}
+
+static inline void
+as_event_timer_stop(as_event_command* cmd)
+{
+	if (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER) {
+		as_uring_timer_stop(cmd);
+	}
+}
+
+static inline void
+as_event_stop_read(as_event_connection* conn)
+{
+	// This method only needed for libuv pipelined connections.
+}
+
+static inline void
+as_event_command_release(as_event_command* cmd)
+{
+	// Ring completions reference the connection, never the command.
+	as_event_command_free(cmd);
+}
+
 /******************************************************************************
  * EVENT_LIB NOT DEFINED INLINE FUNCTIONS
  *****************************************************************************/
@@ -787,7 +919,7 @@ as_event_command_destroy(as_event_command* cmd)
 {
 	// Use this function to free batch/scan/query commands that were never started.
 	as_node_release(cmd->node);
-	cf_free(cmd);
+	as_slab_free(cmd);
 }
 
 static inline void
@@ -796,6 +928,7 @@ as_event_loop_destroy(as_event_loop* event_loop)
 	as_queue_destroy(&event_loop->queue);
 	as_queue_destroy(&event_loop->delay_queue);
 	as_queue_destroy(&event_loop->pipe_cb_queue);
+	as_slab_destroy(event_loop->slab);
 	pthread_mutex_destroy(&event_loop->lock);
 }
 
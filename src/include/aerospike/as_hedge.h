@@ -0,0 +1,94 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Number of latency buckets.  Bucket i counts latencies in [2^i, 2^(i+1)) microseconds.
+ */
+#define AS_HEDGE_BUCKETS 24
+
+/**
+ * @private
+ * Minimum number of samples before a learned hedge delay is used.
+ */
+#define AS_HEDGE_MIN_SAMPLES 100
+
+/**
+ * @private
+ * Sample count at which bucket counts are halved so older samples decay.
+ */
+#define AS_HEDGE_WINDOW 8192
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+/**
+ * @private
+ * Node read latency histogram used to learn hedge delays.
+ */
+typedef struct as_hedge_latency_s {
+	uint32_t buckets[AS_HEDGE_BUCKETS];
+	uint32_t count;
+} as_hedge_latency;
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Initialize latency histogram.
+ */
+static inline void
+as_hedge_latency_init(as_hedge_latency* lat)
+{
+	memset(lat, 0, sizeof(as_hedge_latency));
+}
+
+/**
+ * @private
+ * Add read latency sample.
+ */
+void
+as_hedge_latency_add(as_hedge_latency* lat, uint64_t elapsed_us);
+
+/**
+ * @private
+ * Return delay in milliseconds before a read is hedged to the alternate replica.
+ * percentile is expressed in tenths of a percent.  When percentile is zero or not enough
+ * samples have been recorded, the fixed delay is returned.  Otherwise, the learned delay is
+ * returned, capped by delay when delay is non-zero.  Return zero when reads should not be hedged.
+ */
+uint32_t
+as_hedge_delay(as_hedge_latency* lat, uint32_t delay, uint32_t percentile);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
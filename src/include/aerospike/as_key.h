@@ -228,6 +228,13 @@ typedef struct as_key_s {
 	 */
 	as_digest digest;
 
+	/**
+	 * @private
+	 * Partition table index + 1 resolved by the last command that used this key.  Zero if not
+	 * resolved.  The namespace is verified before the cached index is used.
+	 */
+	uint16_t ns_id;
+
 } as_key;
 
 /******************************************************************************
@@ -689,6 +696,31 @@ as_key_digest(as_key* key);
 AS_EXTERN as_status
 as_key_set_digest(as_error* err, as_key* key);
 
+/**
+ * Set the digest values of an array of keys.  Digests are computed several keys at a time
+ * using the cpu's vector units when available, which is faster than calling
+ * as_key_set_digest() for each key.  Keys must be integer, string or blob.  Otherwise,
+ * an error is returned.
+ *
+ * @param err Error message that is populated on error.
+ * @param keys The keys to set the digests for.
+ * @param n_keys Number of keys.
+ *
+ * @return Status code.
+ *
+ * @relates as_key
+ * @ingroup as_key_object
+ */
+AS_EXTERN as_status
+as_keys_set_digests(as_error* err, as_key* keys, uint32_t n_keys);
+
+/**
+ * @private
+ * Set the digest values of an array of key pointers.
+ */
+as_status
+as_keys_set_digests_ptr(as_error* err, as_key** keys, uint32_t n_keys);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -17,10 +17,12 @@
 #pragma once
 
 #include <aerospike/as_atomic.h>
+#include <aerospike/as_circuit.h>
 #include <aerospike/as_config.h>
 #include <aerospike/as_conn_pool.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_event.h>
+#include <aerospike/as_hedge.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_partition.h>
 #include <aerospike/as_queue.h>
@@ -268,9 +270,17 @@ typedef struct as_node_s {
 	
 	/**
 	 * @private
-	 * Pools of current, cached sockets.
+	 * Pools of current, cached sockets.  Each pool is a lock-free shard.  Transactions prefer
+	 * the shard assigned to the calling cpu/thread and steal from other shards when empty.
 	 */
 	as_conn_pool* sync_conn_pools;
+
+	/**
+	 * @private
+	 * Sync pipeline connections shared by multiple transaction threads.  NULL if sync
+	 * pipelining is disabled.
+	 */
+	struct as_sync_pipe_s* sync_pipes;
 	
 	/**
 	 * @private
@@ -315,12 +325,6 @@ typedef struct as_node_s {
 	 */
 	uint32_t session_token_length;
 
-	/**
-	 * @private
-	 * Connection queue iterator.  Not atomic by design.
-	 */
-	uint32_t conn_iter;
-
 	/**
 	 * @private
 	 * Total sync connections opened.
@@ -333,6 +337,38 @@ typedef struct as_node_s {
 	 */
 	uint32_t sync_conns_closed;
 
+	/**
+	 * @private
+	 * Read latency histogram used to learn hedged read delays.
+	 */
+	as_hedge_latency read_latency;
+
+	/**
+	 * @private
+	 * Smoothed read response time in microseconds.  Used by AS_POLICY_REPLICA_LOWEST_LATENCY.
+	 */
+	uint32_t latency_ewma;
+
+	/**
+	 * @private
+	 * Reads sent to this node that are waiting on a response.
+	 * Used by AS_POLICY_REPLICA_LOWEST_LATENCY.
+	 */
+	uint32_t latency_in_flight;
+
+	/**
+	 * @private
+	 * Smoothed batch response time per key in nanoseconds.  Used to size batch sub-commands
+	 * when as_policy_batch.split_latency is set.
+	 */
+	uint32_t batch_key_ns;
+
+	/**
+	 * @private
+	 * Circuit breaker.  Used when as_config.circuit_error_rate is set.
+	 */
+	as_circuit circuit;
+
 	/**
 	 * @private
 	 * Server's generation count for peers.
@@ -442,6 +478,50 @@ typedef struct as_node_info_s {
 
 } as_node_info;
 
+/**
+ * @private
+ * Tend info request type.
+ */
+typedef enum as_node_tend_type_e {
+	AS_NODE_TEND_REFRESH,
+	AS_NODE_TEND_PEERS,
+	AS_NODE_TEND_PARTITIONS,
+	AS_NODE_TEND_RACKS
+} as_node_tend_type;
+
+/**
+ * @private
+ * Tend info request.  The round trip may run in any thread while other nodes are tended
+ * concurrently.  The response is processed afterwards in the tend thread.
+ */
+typedef struct as_node_tend_s {
+	/**
+	 * Node to tend.
+	 */
+	as_node* node;
+
+	/**
+	 * Heap allocated info response.  NULL when the request failed.
+	 */
+	char* response;
+
+	/**
+	 * Request error.
+	 */
+	as_error err;
+
+	/**
+	 * Request status.
+	 */
+	as_status status;
+
+	/**
+	 * Request type.
+	 */
+	as_node_tend_type type;
+
+} as_node_tend;
+
 /******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
@@ -548,6 +628,25 @@ as_node_get_address_string(as_node* node)
 as_status
 as_node_authenticate_connection(struct as_cluster_s* cluster, uint64_t deadline_ms);
 
+/**
+ * @private
+ * Create and authenticate a new connection to the given node.  Return 0 on success.
+ */
+as_status
+as_node_create_connection(
+	as_error* err, as_node* node, uint32_t socket_timeout, uint64_t deadline_ms, as_conn_pool* pool,
+	as_socket* sock
+	);
+
+/**
+ * @private
+ * Return preferred connection shard in range [0, max) for the calling thread.  Use the current
+ * cpu when available so threads running on the same cpu share a shard.  Otherwise, assign each
+ * thread a fixed shard on first use.
+ */
+uint32_t
+as_node_get_shard(uint32_t max);
+
 /**
  * @private
  * Get a connection to the given node from pool and validate.  Return 0 on success.
@@ -597,6 +696,101 @@ as_node_put_connection(as_node* node, as_socket* sock)
 	}
 }
 
+/**
+ * @private
+ * Mark read as sent to node.
+ */
+static inline void
+as_node_latency_begin(as_node* node)
+{
+	as_incr_uint32(&node->latency_in_flight);
+}
+
+/**
+ * @private
+ * Mark read as completed.  If sample is true, add response time to the node's smoothed
+ * response time with a weight of 1/8.
+ */
+static inline void
+as_node_latency_end(as_node* node, uint64_t elapsed_us, bool sample)
+{
+	as_decr_uint32(&node->latency_in_flight);
+
+	if (! sample) {
+		return;
+	}
+
+	uint32_t us = (elapsed_us < UINT32_MAX)? (uint32_t)elapsed_us : UINT32_MAX - 1;
+	uint32_t ewma = as_load_uint32(&node->latency_ewma);
+
+	// Concurrent updates may be lost, which is acceptable for an estimate.
+	if (ewma == 0) {
+		as_store_uint32(&node->latency_ewma, us + 1);
+	}
+	else {
+		int64_t diff = (int64_t)us - (int64_t)ewma;
+		as_store_uint32(&node->latency_ewma, (uint32_t)((int64_t)ewma + diff / 8));
+	}
+}
+
+/**
+ * @private
+ * Add batch command response time to the node's smoothed response time per key with a
+ * weight of 1/8.
+ */
+static inline void
+as_node_batch_latency(as_node* node, uint64_t elapsed_ns, uint32_t n_keys)
+{
+	if (n_keys == 0) {
+		return;
+	}
+
+	uint64_t per_key = elapsed_ns / n_keys;
+	uint32_t ns = (per_key < UINT32_MAX)? (uint32_t)per_key : UINT32_MAX - 1;
+	uint32_t ewma = as_load_uint32(&node->batch_key_ns);
+
+	// Concurrent updates may be lost, which is acceptable for an estimate.
+	if (ewma == 0) {
+		as_store_uint32(&node->batch_key_ns, ns + 1);
+	}
+	else {
+		int64_t diff = (int64_t)ns - (int64_t)ewma;
+		as_store_uint32(&node->batch_key_ns, (uint32_t)((int64_t)ewma + diff / 8));
+	}
+}
+
+/**
+ * @private
+ * Return node's expected read latency score.  Lower is better.
+ */
+static inline uint64_t
+as_node_latency_score(as_node* node)
+{
+	return ((uint64_t)as_load_uint32(&node->latency_ewma) + 1) *
+		((uint64_t)as_load_uint32(&node->latency_in_flight) + 1);
+}
+
+/**
+ * @private
+ * Return node with the lowest expected read latency.  Ties go to the first node.
+ */
+static inline as_node*
+as_node_latency_select(as_node* first, as_node* second)
+{
+	return (as_node_latency_score(second) < as_node_latency_score(first))? second : first;
+}
+
+/**
+ * @private
+ * Decay smoothed response time so nodes that are no longer selected are eventually retried.
+ * Called by the cluster tend thread.
+ */
+static inline void
+as_node_latency_decay(as_node* node)
+{
+	as_store_uint32(&node->latency_ewma, as_load_uint32(&node->latency_ewma) / 2);
+}
+
 /**
  * @private
  * Balance sync connections.
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Maximum supported NUMA node id plus one.
+ */
+#define AS_NUMA_MAX_NODES 64
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+/**
+ * @private
+ * Saved thread cpu affinity.
+ */
+#if defined(__linux__)
+typedef cpu_set_t as_numa_mask;
+#else
+typedef int as_numa_mask;
+#endif
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+#if defined(__linux__)
+/**
+ * @private
+ * Read a sysfs cpu or node list file into set.  Example: "0-15,32-47".  Return false if the
+ * file can not be read.
+ */
+bool
+as_numa_read_list(const char* path, cpu_set_t* set);
+#endif
+
+/**
+ * @private
+ * Read NUMA topology from sysfs.  Only nodes with cpus available to this process are used.
+ * Return number of usable nodes or zero if NUMA topology is not available.
+ */
+uint32_t
+as_numa_init(void);
+
+/**
+ * @private
+ * Return node id of the n'th usable node.
+ */
+uint32_t
+as_numa_node(uint32_t index);
+
+/**
+ * @private
+ * Return node id of the cpu that the calling thread is running on or -1 if unknown.
+ */
+int
+as_numa_current_node(void);
+
+/**
+ * @private
+ * Restrict calling thread to the cpus of a node and store previous affinity in saved.
+ * Threads created by the calling thread inherit this affinity and the kernel places
+ * memory on the node where it is first touched.
+ */
+bool
+as_numa_bind_thread(uint32_t node, as_numa_mask* saved);
+
+/**
+ * @private
+ * Restore calling thread affinity saved by as_numa_bind_thread().
+ */
+void
+as_numa_restore_thread(as_numa_mask* saved);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
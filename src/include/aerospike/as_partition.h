@@ -20,6 +20,10 @@
 #include <aerospike/as_std.h>
 #include <aerospike/as_status.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,6 +43,19 @@ extern "C" {
  */
 #define AS_MAX_NAMESPACE_SIZE 32
 
+/**
+ * @private
+ * Maximum number of replicas (master and proles) tracked per partition.  Additional
+ * replicas reported by the server are ignored.
+ */
+#define AS_MAX_REPLICAS 4
+
+/**
+ * @private
+ * Namespace hash table size.  Must be a power of 2 and at least twice AS_MAX_NAMESPACES.
+ */
+#define AS_PARTITION_HASH_SIZE 256
+
 /******************************************************************************
  * TYPES
  *****************************************************************************/
@@ -50,13 +67,18 @@ struct as_key_s;
 /**
  * @private
  * Map of namespace data partitions to nodes.
- *
- * TODO - not ideal for replication factor > 2.
  */
 typedef struct as_partition_s {
-	struct as_node_s* master;
-	struct as_node_s* prole;
+	/**
+	 * Replica nodes in server order.  The master is at index zero.
+	 */
+	struct as_node_s* nodes[AS_MAX_REPLICAS];
 	uint32_t regime;
+
+	/**
+	 * Number of replicas reported by the server, limited to AS_MAX_REPLICAS.
+	 */
+	uint8_t replica_count;
 } as_partition;
 
 /**
@@ -78,6 +100,12 @@ typedef struct as_partition_table_s {
 typedef struct as_partition_tables_s {
 	as_partition_table* tables[AS_MAX_NAMESPACES];
 	uint32_t size;
+
+	/**
+	 * Open addressing namespace hash.  Each slot contains a table index + 1.  Zero is an empty
+	 * slot.  Slots are only added by the tend thread and are never removed.
+	 */
+	uint8_t hash[AS_PARTITION_HASH_SIZE];
 } as_partition_tables;
 
 /**
@@ -108,7 +136,83 @@ as_partition_tables_destroy(as_partition_tables* tables);
  */
 as_partition_table*
 as_partition_tables_get(as_partition_tables* tables, const char* ns);
+
+/**
+ * @private
+ * Get partition table given key.  The table index is cached in the key, so later commands on
+ * the same key skip the namespace lookup.
+ */
+as_partition_table*
+as_partition_tables_get_key(as_partition_tables* tables, const struct as_key_s* key);
+
+/**
+ * @private
+ * Create empty partition table with capacity partitions and add it to the cluster's tables.
+ * Used to restore a partition map snapshot before the cluster is tended.  Return NULL if the
+ * namespace already exists or the maximum number of namespaces has been reached.
+ */
+as_partition_table*
+as_partition_tables_restore(as_partition_tables* tables, const char* ns, uint32_t capacity, bool sc_mode);
+
+/**
+ * @private
+ * Set partition replicas restored from a partition map snapshot.  Null nodes are skipped.
+ * Only called before the cluster is tended.
+ */
+void
+as_partition_restore(as_partition* p, struct as_node_s** nodes, uint8_t replica_count, uint32_t regime);
+
+/**
+ * @private
+ * Return namespace hash (FNV-1a).
+ */
+static inline uint32_t
+as_partition_ns_hash(const char* ns)
+{
+	uint32_t h = 2166136261u;
+
+	while (*ns) {
+		h ^= (uint8_t)*ns++;
+		h *= 16777619u;
+	}
+	return h;
+}
 	
+/**
+ * @private
+ * Return number of 64 bit words needed to decode a base64 partition bitmap of len characters.
+ */
+static inline uint32_t
+as_partition_bitmap_words(uint32_t len)
+{
+	return ((len / 4) * 3 + 7) / 8;
+}
+
+/**
+ * @private
+ * Decode base64 partition bitmap into as_partition_bitmap_words(len) words.  Partition
+ * (w * 64 + i) is owned when bit (63 - i) of words[w] is set.  Bits beyond n_partitions
+ * are cleared.  Encoded characters are trusted for speed.
+ */
+void
+as_partition_bitmap_decode(const char* b64, uint32_t len, uint32_t n_partitions, uint64_t* words);
+
+/**
+ * @private
+ * Return number of leading zero bits in a non-zero word.
+ */
+static inline uint32_t
+as_partition_clz64(uint64_t v)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, v);
+	return 63 - (uint32_t)index;
+#else
+	return (uint32_t)__builtin_clzll(v);
+#endif
+}
+
 /**
  * @private
  * Return partition ID given digest.
@@ -44,6 +44,7 @@
  * policy values for a type of operation.
  *
  * - as_policy_batch
+ * - as_policy_batch_write
  * - as_policy_info
  * - as_policy_operate
  * - as_policy_read
@@ -297,7 +298,15 @@ typedef enum as_policy_replica_e {
 	 * as_config.rack_aware, as_config.rack_id, and server rack configuration must also
 	 * be set to enable this functionality.
 	 */
-	AS_POLICY_REPLICA_PREFER_RACK
+	AS_POLICY_REPLICA_PREFER_RACK,
+
+	/**
+	 * Read from the master or prole node with the lowest expected latency.  Each node's
+	 * expected latency is its smoothed response time scaled by its outstanding request count.
+	 * Retries alternate between master and prole like SEQUENCE.  Writes use SEQUENCE.
+	 * Currently restricted to master and one prole.
+	 */
+	AS_POLICY_REPLICA_LOWEST_LATENCY
 
 } as_policy_replica;
 
@@ -564,6 +573,30 @@ typedef struct as_policy_read_s {
 	 */
 	bool deserialize;
 
+	/**
+	 * Milliseconds to wait for a response before sending a duplicate (hedged) read to the
+	 * alternate replica.  The first response is returned and the other is discarded.
+	 * Hedged reads reduce tail latency caused by a temporarily slow node at the cost of
+	 * extra load.  Hedging requires a replica policy other than AS_POLICY_REPLICA_MASTER
+	 * and only applies to single record get, select and exists commands.
+	 *
+	 * When hedge_percentile is also set, hedge_delay caps the learned delay and is used
+	 * until enough latency samples have been recorded.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t hedge_delay;
+
+	/**
+	 * Learn the hedge delay from recent read latencies of the target node.  Reads are hedged
+	 * when the response has not arrived within this latency percentile, expressed in tenths
+	 * of a percent.  For example, 990 hedges reads slower than the 99th percentile and
+	 * 999 hedges reads slower than the 99.9th percentile.
+	 *
+	 * Default: 0 (use fixed hedge_delay)
+	 */
+	uint32_t hedge_percentile;
+
 } as_policy_read;
 	
 /**
@@ -871,8 +904,84 @@ typedef struct as_policy_batch_s {
 	 */
 	bool deserialize;
 
+	/**
+	 * Split a node's batch read into parallel sub-commands of at most this many keys.
+	 * Sub-commands use separate connections and their results are stored in the original
+	 * key order.  When set, sync batch reads run in parallel threads regardless of the
+	 * concurrent field, so per record batch callbacks may be called concurrently.  Batch
+	 * writes are not split.
+	 *
+	 * Default: 0 (do not split)
+	 */
+	uint32_t split_keys;
+
+	/**
+	 * Target response time in milliseconds for each batch read sub-command.  When set, the
+	 * number of keys per sub-command is reduced below split_keys using the node's observed
+	 * batch response time per key, so slower nodes receive smaller sub-commands.  Only used
+	 * when split_keys is set.
+	 *
+	 * Default: 0 (split by split_keys only)
+	 */
+	uint32_t split_latency;
+
 } as_policy_batch;
-	
+
+/**
+ * Policy attributes used for each record of batch write, remove and operate commands.
+ * Timeouts, retries and node concurrency are defined by the enclosing as_policy_batch.
+ *
+ * @ingroup client_policies
+ */
+typedef struct as_policy_batch_write_s {
+
+	/**
+	 * Optional expression filter.  If filter_exp exists and evaluates to false, the record
+	 * is not modified and its result is set to AEROSPIKE_FILTERED_OUT.
+	 *
+	 * Default: NULL
+	 */
+	struct as_exp* filter_exp;
+
+	/**
+	 * Specifies the behavior for the key.
+	 */
+	as_policy_key key;
+
+	/**
+	 * Specifies the number of replicas required to be committed successfully when writing
+	 * before returning transaction succeeded.
+	 */
+	as_policy_commit_level commit_level;
+
+	/**
+	 * Specifies the behavior for the generation value.  The expected generation is taken
+	 * from as_record.gen for puts, as_operations.gen for operates and the generation
+	 * field below for removes.
+	 */
+	as_policy_gen gen;
+
+	/**
+	 * The expected generation of the record for batch removes.
+	 */
+	uint16_t generation;
+
+	/**
+	 * Specifies the behavior for the existence of the record.
+	 */
+	as_policy_exists exists;
+
+	/**
+	 * If the transaction results in a record deletion, leave a tombstone for the record.
+	 * This prevents deleted records from reappearing after node failures.
+	 * Valid for Aerospike Server Enterprise Edition only.
+	 *
+	 * Default: false (do not tombstone deleted records).
+	 */
+	bool durable_delete;
+
+} as_policy_batch_write;
+
 /**
  * Query Policy
  *
@@ -1026,6 +1135,11 @@ typedef struct as_policies_s {
 	 */
 	as_policy_batch batch;
 
+	/**
+	 * The default batch write policy.  Used for records that do not define their own policy.
+	 */
+	as_policy_batch_write batch_write;
+
 	/**
 	 * The default scan policy.
 	 */
@@ -1127,6 +1241,8 @@ as_policy_read_init(as_policy_read* p)
 	p->read_mode_ap = AS_POLICY_READ_MODE_AP_DEFAULT;
 	p->read_mode_sc = AS_POLICY_READ_MODE_SC_DEFAULT;
 	p->deserialize = true;
+	p->hedge_delay = 0;
+	p->hedge_percentile = 0;
 	return p;
 }
 
@@ -1306,6 +1422,8 @@ as_policy_batch_init(as_policy_batch* p)
 	p->allow_inline = true;
 	p->send_set_name = false;
 	p->deserialize = true;
+	p->split_keys = 0;
+	p->split_latency = 0;
 	return p;
 }
 
@@ -1323,6 +1441,41 @@ as_policy_batch_copy(const as_policy_batch* src, as_policy_batch* trg)
 	*trg = *src;
 }
 
+/**
+ * Initialize as_policy_batch_write to default values.
+ *
+ * @param p	The policy to initialize.
+ * @return	The initialized policy.
+ *
+ * @relates as_policy_batch_write
+ */
+static inline as_policy_batch_write*
+as_policy_batch_write_init(as_policy_batch_write* p)
+{
+	p->filter_exp = NULL;
+	p->key = AS_POLICY_KEY_DEFAULT;
+	p->commit_level = AS_POLICY_COMMIT_LEVEL_DEFAULT;
+	p->gen = AS_POLICY_GEN_DEFAULT;
+	p->generation = 0;
+	p->exists = AS_POLICY_EXISTS_DEFAULT;
+	p->durable_delete = false;
+	return p;
+}
+
+/**
+ * Shallow copy as_policy_batch_write values.
+ *
+ * @param src	The source policy.
+ * @param trg	The target policy.
+ *
+ * @relates as_policy_batch_write
+ */
+static inline void
+as_policy_batch_write_copy(const as_policy_batch_write* src, as_policy_batch_write* trg)
+{
+	*trg = *src;
+}
+
 /**
  * Initialize as_policy_scan to default values.
  *
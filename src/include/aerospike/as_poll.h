@@ -100,6 +100,46 @@ as_poll_socket(as_poll* poll, as_socket_fd fd, uint32_t timeout, bool read)
 	return rv;
 }
 
+// Wait for either socket to become readable.  as_poll_init() must be called with the larger fd.
+// Return bitmap of readable sockets (1: fd1, 2: fd2), 0 on timeout or -1 on error.
+static inline int
+as_poll_sockets_read(as_poll* poll, as_socket_fd fd1, as_socket_fd fd2, uint32_t timeout)
+{
+	memset(poll->set, 0, poll->size);
+	FD_SET(fd1 % FD_SETSIZE, &poll->set[fd1 / FD_SETSIZE]);
+	FD_SET(fd2 % FD_SETSIZE, &poll->set[fd2 / FD_SETSIZE]);
+
+	struct timeval tv;
+	struct timeval* tvp;
+
+	if (timeout > 0) {
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		tvp = &tv;
+	}
+	else {
+		tvp = NULL;
+	}
+
+	as_socket_fd max = (fd1 > fd2)? fd1 : fd2;
+	int rv = select(max + 1, poll->set /*readfd*/, 0 /*writefd*/, 0/*oobfd*/, tvp);
+
+	if (rv <= 0) {
+		return rv;
+	}
+
+	rv = 0;
+
+	if (FD_ISSET(fd1 % FD_SETSIZE, &poll->set[fd1 / FD_SETSIZE])) {
+		rv |= 1;
+	}
+
+	if (FD_ISSET(fd2 % FD_SETSIZE, &poll->set[fd2 / FD_SETSIZE])) {
+		rv |= 2;
+	}
+	return rv;
+}
+
 static inline void
 as_poll_destroy(as_poll* poll)
 {
@@ -148,6 +188,43 @@ as_poll_socket(as_poll* poll, as_socket_fd fd, uint32_t timeout, bool read)
 	return rv;
 }
 
+static inline int
+as_poll_sockets_read(as_poll* poll, as_socket_fd fd1, as_socket_fd fd2, uint32_t timeout)
+{
+	FD_ZERO(&poll->set);
+	FD_SET(fd1, &poll->set);
+	FD_SET(fd2, &poll->set);
+
+	struct timeval tv;
+	struct timeval* tvp;
+
+	if (timeout > 0) {
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		tvp = &tv;
+	}
+	else {
+		tvp = NULL;
+	}
+
+	int rv = select(0, &poll->set /*readfd*/, 0 /*writefd*/, 0/*oobfd*/, tvp);
+
+	if (rv <= 0) {
+		return rv;
+	}
+
+	rv = 0;
+
+	if (FD_ISSET(fd1, &poll->set)) {
+		rv |= 1;
+	}
+
+	if (FD_ISSET(fd2, &poll->set)) {
+		rv |= 2;
+	}
+	return rv;
+}
+
 #define as_poll_destroy(_poll)
 
 #endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_val.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Number of bin views indexed on the stack by batch, scan and query callback views.  Records
+ * with more bins are indexed on the heap.
+ */
+#define AS_RECORD_VIEW_STACK_BINS 64
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+/**
+ * Bin of a record view.  Name and value reference the server response buffer.
+ *
+ * @relates as_record_view
+ */
+typedef struct as_bin_view_s {
+	/**
+	 * Bin name.  Not null terminated.
+	 */
+	const uint8_t* name;
+
+	/**
+	 * Raw value in server wire format.
+	 */
+	const uint8_t* data;
+
+	/**
+	 * Raw value size in bytes.
+	 */
+	uint32_t size;
+
+	/**
+	 * Bin name length.
+	 */
+	uint8_t name_len;
+
+	/**
+	 * Server particle type (as_bytes_type).
+	 */
+	uint8_t type;
+
+	/**
+	 * @private
+	 * Value decoded by as_record_view_get_val().  Owned by the view.
+	 */
+	as_val* val;
+
+} as_bin_view;
+
+/**
+ * Read-only record that decodes bins on access directly from the server response buffer.
+ *
+ * Regular reads copy every bin into a heap allocated as_val.  A record view keeps the raw
+ * response and only indexes bin locations, so integer, double, string and blob values can be
+ * read without allocation or copy.  Lists and maps are only deserialized when requested with
+ * as_record_view_get_val().
+ *
+ * Views returned by aerospike_key_get_view() and aerospike_key_select_view() own the server
+ * response buffer the bins point into and must be released with as_record_view_destroy().
+ *
+ * Views passed to batch, scan and query view callbacks reference the client's response
+ * buffer and are only valid for the duration of the callback.  The client destroys them
+ * after the callback returns.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_record_view view;
+ *
+ * if (aerospike_key_get_view(&as, &err, NULL, &key, &view) == AEROSPIKE_OK) {
+ *     uint32_t len;
+ *     const char* name = as_record_view_get_str(&view, "name", &len);
+ *     int64_t age;
+ *     as_record_view_get_int64(&view, "age", &age);
+ *     as_record_view_destroy(&view);
+ * }
+ * ~~~~~~~~~~
+ *
+ * @ingroup client_objects
+ */
+typedef struct as_record_view_s {
+	/**
+	 * Record key.  Only populated for scan and query results.
+	 */
+	as_key key;
+
+	/**
+	 * Bins.
+	 */
+	as_bin_view* bins;
+
+	/**
+	 * @private
+	 * Server response buffer when owned by the view.  Bin names and values point into this
+	 * buffer.  The bins array is allocated separately and also owned by the view.
+	 */
+	void* buf;
+
+	/**
+	 * Record generation.
+	 */
+	uint16_t gen;
+
+	/**
+	 * Record time to live (expiration) in seconds.
+	 */
+	uint32_t ttl;
+
+	/**
+	 * Number of bins.
+	 */
+	uint16_t n_bins;
+
+} as_record_view;
+
+/**
+ * Record view callback.  Called for each record of a batch, scan or query.  The view is only
+ * valid during the callback.  Scan and query call the callback with a NULL view when all
+ * records have been received.
+ *
+ * @param view		The record view or NULL when complete.
+ * @param udata		User-data provided to the calling function.
+ *
+ * @return `true` to continue to the next record. Otherwise, abort.
+ *
+ * @relates as_record_view
+ */
+typedef bool (*as_record_view_callback)(as_record_view* view, void* udata);
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Index bins of a server response.  Bin names and values reference the response buffer.
+ */
+as_status
+as_record_view_parse_bins(
+	as_record_view* view, as_error* err, uint8_t** pp, uint8_t* end, as_bin_view* bins,
+	uint16_t n_bins
+	);
+
+/**
+ * Release values decoded by the view and the view's response buffer if owned.
+ *
+ * @relates as_record_view
+ */
+AS_EXTERN void
+as_record_view_destroy(as_record_view* view);
+
+/**
+ * Get bin by name.  Return NULL if the bin does not exist.
+ *
+ * @relates as_record_view
+ */
+AS_EXTERN const as_bin_view*
+as_record_view_get(const as_record_view* view, const char* name);
+
+/**
+ * Get integer bin value.  Return false if the bin does not exist or is not an integer.
+ *
+ * @relates as_record_view
+ */
+AS_EXTERN bool
+as_record_view_get_int64(const as_record_view* view, const char* name, int64_t* value);
+
+/**
+ * Get double bin value.  Return false if the bin does not exist or is not a double.
+ *
+ * @relates as_record_view
+ */
+AS_EXTERN bool
+as_record_view_get_double(const as_record_view* view, const char* name, double* value);
+
+/**
+ * Get string bin value.  The returned pointer references the response buffer and is NOT
+ * null terminated.  Return NULL if the bin does not exist or is not a string.
+ *
+ * @relates as_record_view
+ */
+AS_EXTERN const char*
+as_record_view_get_str(const as_record_view* view, const char* name, uint32_t* len);
+
+/**
+ * Get blob bin value.  The returned pointer references the response buffer.
+ * Return NULL if the bin does not exist or is not a blob.
+ *
+ * @relates as_record_view
+ */
+AS_EXTERN const uint8_t*
+as_record_view_get_bytes(const as_record_view* view, const char* name, uint32_t* size);
+
+/**
+ * Decode bin value into an as_val.  Lists and maps are deserialized on first access.
+ * The value is cached and owned by the view, so it must not be destroyed by the caller.
+ * Return NULL if the bin does not exist.
+ *
+ * @relates as_record_view
+ */
+AS_EXTERN as_val*
+as_record_view_get_val(as_record_view* view, const char* name);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * RIPEMD-160 digest size in bytes.
+ */
+#define AS_RIPEMD160_SIZE 20
+
+/**
+ * @private
+ * Maximum number of messages hashed in one as_ripemd160_multi() call.
+ */
+#define AS_RIPEMD160_LANES 16
+
+/**
+ * @private
+ * Maximum message size accepted by as_ripemd160_multi().  Messages and padding must fit
+ * in four 64 byte blocks.
+ */
+#define AS_RIPEMD160_MULTI_MAX (4 * 64 - 9)
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Compute RIPEMD-160 digests of up to AS_RIPEMD160_LANES messages in parallel.  Each message
+ * length must not exceed AS_RIPEMD160_MULTI_MAX.  The widest vector unit supported by the
+ * cpu (AVX-512, AVX2 or the compiler's baseline) is selected at runtime.
+ */
+void
+as_ripemd160_multi(
+	const uint8_t** msgs, const uint32_t* lens, uint32_t n_msgs,
+	uint8_t digests[][AS_RIPEMD160_SIZE]
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
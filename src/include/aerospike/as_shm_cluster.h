@@ -18,6 +18,7 @@
 
 #include <aerospike/as_atomic.h>
 #include <aerospike/as_config.h>
+#include <aerospike/as_hedge.h>
 #include <aerospike/as_node.h>
 #include <aerospike/as_partition.h>
 #include <citrusleaf/cf_queue.h>
@@ -26,6 +27,17 @@
 extern "C" {
 #endif
 
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Shared memory layout version.  Increment when any shared memory structure changes.
+ * Zero is reserved for layouts that did not store a version.
+ */
+#define AS_SHM_VERSION 1
+
 /******************************************************************************
  * TYPES
  *****************************************************************************/
@@ -92,32 +104,39 @@ typedef struct as_node_shm_s {
 
 /**
  * @private
- * Shared memory representation of map of namespace data partitions to nodes. 16 bytes.
+ * Shared memory representation of map of namespace data partitions to nodes. 32 bytes.
  */
 typedef struct as_partition_shm_s {
 	/**
 	 * @private
-	 * Master node index offset.
+	 * Replica node index offsets in server order.  The master is at index zero.
 	 */
-	uint32_t master;
+	uint32_t nodes[AS_MAX_REPLICAS];
 
 	/**
 	 * @private
-	 * Prole node index offset.
+	 * Current regime for strong consistency mode.
 	 */
-	uint32_t prole;
+	uint32_t regime;
 
 	/**
 	 * @private
-	 * Current regime for strong consistency mode.
+	 * Sequence lock.  Odd while the tender is updating this partition.  Readers copy the
+	 * partition and retry if the sequence changed during the copy.
 	 */
-	uint32_t regime;
+	uint32_t seq;
+
+	/**
+	 * @private
+	 * Number of replicas reported by the server, limited to AS_MAX_REPLICAS.
+	 */
+	uint8_t replica_count;
 
 	/**
 	 * @private
 	 * Pad to 8 byte boundary.
 	 */
-	uint32_t pad;
+	uint8_t pad[7];
 } as_partition_shm;
 
 /**
@@ -150,6 +169,75 @@ typedef struct as_partition_table_shm_s {
 	as_partition_shm partitions[];
 } as_partition_table_shm;
 
+/**
+ * Client process statistics published in shared memory.  Each process attached to the
+ * shared memory segment writes its own slot once per tend interval.  160 bytes.
+ */
+typedef struct as_process_shm_s {
+	/**
+	 * Last time statistics were published in milliseconds since epoch.
+	 */
+	uint64_t timestamp;
+
+	/**
+	 * Total commands started by this process.  The command rate is the difference between two
+	 * samples divided by the difference in timestamps.
+	 */
+	uint64_t commands;
+
+	/**
+	 * Process id that owns this slot.  Zero if slot is free.
+	 */
+	uint32_t pid;
+
+	/**
+	 * @private
+	 * Sequence lock.  Odd while the owner process is writing this slot.
+	 */
+	uint32_t seq;
+
+	/**
+	 * Sync connections in use and in pool for all nodes.
+	 */
+	uint32_t sync_in_use;
+	uint32_t sync_in_pool;
+
+	/**
+	 * Async connections in use and in pool for all nodes.
+	 */
+	uint32_t async_in_use;
+	uint32_t async_in_pool;
+
+	/**
+	 * Pipeline connections in use and in pool for all nodes.
+	 */
+	uint32_t pipe_in_use;
+	uint32_t pipe_in_pool;
+
+	/**
+	 * Total sync connections opened and closed for all nodes.
+	 */
+	uint32_t conns_opened;
+	uint32_t conns_closed;
+
+	/**
+	 * Total retries rejected because retry budget was exhausted.
+	 */
+	uint32_t retries_rejected;
+
+	/**
+	 * @private
+	 * Pad to 8 byte boundary.
+	 */
+	uint32_t pad;
+
+	/**
+	 * Latency histogram of all commands that received a response.  Bucket i counts latencies
+	 * in [2^i, 2^(i+1)) microseconds.  Older samples decay.
+	 */
+	uint32_t latency[AS_HEDGE_BUCKETS];
+} as_process_shm;
+
 /**
  * @private
  * Shared memory cluster map. The map contains fixed arrays of nodes and partition tables.
@@ -239,9 +327,10 @@ typedef struct as_cluster_shm_s {
 	
 	/**
 	 * @private
-	 * Pad to 4 byte boundary.
+	 * Shared memory layout version.  Set to AS_SHM_VERSION by the process that initializes
+	 * shared memory.  Processes with a different layout version are not allowed to attach.
 	 */
-	char pad[2];
+	uint16_t version;
 
 	/**
 	 * @private
@@ -249,6 +338,18 @@ typedef struct as_cluster_shm_s {
 	 */
 	uint32_t rebalance_gen;
 
+	/**
+	 * @private
+	 * Cluster offset to process statistics slots after the partition tables.
+	 */
+	uint32_t processes_offset;
+
+	/**
+	 * @private
+	 * Maximum number of process statistics slots.
+	 */
+	uint32_t processes_capacity;
+
 	/*
 	 * @private
 	 * Dynamically allocated node array.
@@ -256,6 +357,7 @@ typedef struct as_cluster_shm_s {
 	as_node_shm nodes[];
 	
 	// This is where the dynamically allocated partition tables are located.
+	// Process statistics slots follow the partition tables.
 } as_cluster_shm;
 
 /**
@@ -298,6 +400,21 @@ typedef struct as_shm_info_s {
 	 * Is this process responsible for performing cluster tending.
 	 */
 	volatile bool is_tend_master;
+
+	/**
+	 * @private
+	 * Process local direct mapped cache of namespace hash to shared memory partition table
+	 * index + 1.  Zero is an empty slot.  Entries may be overwritten by colliding namespaces,
+	 * so the namespace is verified on each hit.
+	 */
+	uint16_t ns_cache[AS_PARTITION_HASH_SIZE];
+
+	/**
+	 * @private
+	 * Statistics slot claimed by this process.  Null if process statistics are disabled or
+	 * all slots are in use.
+	 */
+	as_process_shm* process;
 } as_shm_info;
 
 /******************************************************************************
@@ -344,18 +461,51 @@ as_shm_node_replace_racks(as_cluster_shm* cluster_shm, as_node* node, as_racks*
  * Find partition table for namespace in shared memory.
  */
 as_partition_table_shm*
-as_shm_find_partition_table(as_cluster_shm* cluster_shm, const char* ns);
+as_shm_find_partition_table(as_shm_info* shm_info, const char* ns);
+
+/**
+ * @private
+ * Find partition table for key in shared memory.  The table index is cached in the key, so
+ * later commands on the same key skip the namespace lookup.
+ */
+as_partition_table_shm*
+as_shm_get_key_partition_table(as_shm_info* shm_info, const struct as_key_s* key);
 
 /**
  * @private
- * Update shared memory partition tables for given namespace.
+ * Update shared memory partition tables for given namespace.  bitmaps contains one encoded
+ * partition bitmap per replica level, starting with the master.  Each changed partition is
+ * published with all its replicas under one sequence update.
  */
 void
 as_shm_update_partitions(
-	as_shm_info* shm_info, const char* ns, char* bitmap_b64, int64_t len, as_node* node,
-	bool master, uint32_t regime
+	as_shm_info* shm_info, const char* ns, char** bitmaps, uint32_t n_bitmaps, int64_t len,
+	as_node* node, uint8_t replica_count, uint32_t regime
 	);
 
+/**
+ * Copy statistics of client processes attached to the same shared memory segment into
+ * stats and return the number of processes copied.  At most capacity processes are copied.
+ * Return zero if shared memory or process statistics are not enabled.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_process_shm stats[64];
+ * uint32_t n = as_shm_get_process_stats(as->cluster, stats, 64);
+ * ~~~~~~~~~~
+ */
+AS_EXTERN uint32_t
+as_shm_get_process_stats(struct as_cluster_s* cluster, as_process_shm* stats, uint32_t capacity);
+
+/**
+ * @private
+ * Get shared memory process statistics slots array.
+ */
+static inline as_process_shm*
+as_shm_get_processes(as_cluster_shm* cluster_shm)
+{
+	return (as_process_shm*) ((char*)cluster_shm + cluster_shm->processes_offset);
+}
+
 /**
  * @private
  * Get shared memory partition tables array.
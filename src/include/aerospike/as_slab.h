@@ -0,0 +1,117 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Number of slab size classes.  Class i holds objects of (1024 << i) bytes.
+ */
+#define AS_SLAB_CLASSES 7
+
+/**
+ * @private
+ * Largest object size cached by a slab.  Larger objects are allocated from the heap.
+ */
+#define AS_SLAB_MAX_SIZE (1024 << (AS_SLAB_CLASSES - 1))
+
+/**
+ * @private
+ * Maximum bytes cached per size class in each of the local and shared free lists.
+ */
+#define AS_SLAB_CLASS_BYTES (1024 * 1024)
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+struct as_slab_header_s;
+
+/**
+ * @private
+ * Size class free lists.  The local list is only accessed by the owner thread.
+ * The shared list receives objects freed by other threads and overflow from the
+ * local list.
+ */
+typedef struct as_slab_class_s {
+	struct as_slab_header_s* local;
+	struct as_slab_header_s* shared;
+	uint32_t local_size;
+	uint32_t shared_size;
+	uint32_t max;
+} as_slab_class;
+
+/**
+ * @private
+ * Object cache owned by a single thread (usually an event loop thread).  Allocations
+ * and frees on the owner thread do not lock.  Other threads may allocate and free
+ * through a bounded shared list protected by a mutex.
+ */
+typedef struct as_slab_s {
+	pthread_mutex_t lock;
+	const pthread_t* thread;
+	as_slab_class classes[AS_SLAB_CLASSES];
+} as_slab;
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Create slab owned by the thread referenced by thread.  The thread id is read on
+ * each call, so it may be assigned after the slab is created.
+ */
+as_slab*
+as_slab_create(const pthread_t* thread);
+
+/**
+ * @private
+ * Free cached objects and destroy slab.  All objects allocated from the slab must
+ * be freed before the slab is destroyed.
+ */
+void
+as_slab_destroy(as_slab* slab);
+
+/**
+ * @private
+ * Allocate at least size bytes.  If slab is NULL or size exceeds AS_SLAB_MAX_SIZE,
+ * the object is allocated from the heap.
+ */
+void*
+as_slab_alloc(as_slab* slab, size_t size);
+
+/**
+ * @private
+ * Return object allocated by as_slab_alloc() to its slab.  May be called from any thread.
+ */
+void
+as_slab_free(void* ptr);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_vector.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+struct as_cluster_s;
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Return fingerprint of cluster nodes and partition map generations.  A snapshot only needs
+ * to be written when the fingerprint changes.  Only called from the tend thread.
+ */
+uint64_t
+as_snapshot_fingerprint(struct as_cluster_s* cluster);
+
+/**
+ * @private
+ * Write cluster name, seeds, nodes, racks and partition tables to cluster->snapshot_path.
+ * The file is written to a temporary path and renamed, so readers never see a partial
+ * snapshot.  Nothing is written when cluster_name is not set.  Only called from the tend
+ * thread.
+ */
+as_status
+as_snapshot_write(struct as_cluster_s* cluster, as_error* err);
+
+/**
+ * @private
+ * Load snapshot from cluster->snapshot_path.  On success, partition tables are restored and
+ * the snapshot nodes are appended to nodes.  The caller must add these nodes to the cluster.
+ * Restored node generations are invalidated, so the next cluster tend refreshes peers,
+ * partitions and racks from the server.  Nothing is restored when cluster_name is not set,
+ * or the snapshot is missing, invalid or from a different cluster.  A snapshot is from a
+ * different cluster when its cluster name differs or a configured seed is not in its seed
+ * list.  Only called before the tend thread is started.
+ */
+as_status
+as_snapshot_load(struct as_cluster_s* cluster, as_error* err, as_vector* /* <as_node*> */ nodes);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
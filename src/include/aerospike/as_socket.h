@@ -92,6 +92,21 @@ typedef struct as_socket_s {
 	struct ssl_st* ssl;
 } as_socket;
 
+/**
+ * @private
+ * Maximum number of segments in a scatter/gather socket write.
+ */
+#define AS_SOCKET_IOV_MAX 32
+
+/**
+ * @private
+ * Scatter/gather socket write segment.
+ */
+typedef struct as_socket_iov_s {
+	uint8_t* data;
+	size_t size;
+} as_socket_iov;
+
 /**
  * @private
  * Return true if TLS context exists and not TLS login only.
@@ -136,6 +151,14 @@ as_socket_create_fd(int family, as_socket_fd* fdp);
 int
 as_socket_create(as_socket* sock, int family, as_tls_context* ctx, const char* tls_name);
 
+/**
+ * @private
+ * Allow kernel zero-copy writes (MSG_ZEROCOPY) on socket.  Ignored on platforms that do not
+ * support zero-copy.
+ */
+void
+as_socket_enable_zero_copy(as_socket* sock);
+
 /**
  * @private
  * Wrap existing fd in a socket.
@@ -259,6 +282,18 @@ as_socket_write_deadline(
 	uint32_t socket_timeout, uint64_t deadline
 	);
 
+/**
+ * @private
+ * Write segments with future deadline in milliseconds.  Segments are sent with scatter/gather
+ * writes, so segment data is not copied.  If zero_copy is true and the platform supports it,
+ * request kernel zero-copy transmission (MSG_ZEROCOPY).  If deadline is zero, do not set deadline.
+ */
+as_status
+as_socket_writev_deadline(
+	as_error* err, as_socket* sock, struct as_node_s* node, as_socket_iov* iov, uint32_t iov_size,
+	uint32_t socket_timeout, uint64_t deadline, bool zero_copy
+	);
+
 /**
  * @private
  * Read socket data with future deadline in milliseconds.
@@ -270,6 +305,17 @@ as_socket_read_deadline(
 	uint32_t socket_timeout, uint64_t deadline
 	);
 
+/**
+ * @private
+ * Wait until socket data is available to read without consuming any data.
+ * If deadline is zero, do not set deadline.
+ */
+as_status
+as_socket_wait_readable(
+	as_error* err, as_socket* sock, struct as_node_s* node, uint32_t socket_timeout,
+	uint64_t deadline
+	);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
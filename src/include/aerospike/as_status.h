@@ -32,6 +32,17 @@ typedef enum as_status_e {
 	/***************************************************************************
 	 * Client Errors
 	 **************************************************************************/
+	/**
+	 * No response was received from the server for this batch record.  The command
+	 * may still be in flight or the node command failed before the record was processed.
+	 */
+	AEROSPIKE_NO_RESPONSE = -15,
+
+	/**
+	 * Node circuit breaker is open.  Command was not sent to the node.
+	 */
+	AEROSPIKE_ERR_CIRCUIT_OPEN = -14,
+
 	/**
 	 * Abort split batch retry and use normal node retry instead.
 	 * Used internally and should not be returned to user.
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_socket.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Maximum distance between the next response to be read and a command that gives up its
+ * turn.  Commands further behind invalidate the connection when they time out.
+ */
+#define AS_SYNC_PIPE_WINDOW 256
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+struct as_node_s;
+
+/**
+ * @private
+ * Synchronous pipeline connection.  Multiple threads write commands on the same socket and
+ * read their responses in the order the commands were written (FIFO).  The thread whose
+ * response is next on the wire reads directly from the socket.  Other threads wait their turn.
+ *
+ * A command that times out before any byte of its response was read gives up its turn.  Its
+ * response is read and discarded by the next command waiting on the connection.
+ *
+ * Write failures and partially read responses invalidate the connection.  All commands in
+ * flight on an invalid connection fail with a connection error and are retried by the normal
+ * command retry logic.  The socket is closed when the last command in flight has left the
+ * connection.
+ */
+typedef struct as_sync_pipe_s {
+	/**
+	 * Serializes command writes and sequence number assignment.
+	 */
+	pthread_mutex_t write_lock;
+
+	/**
+	 * Protects connection state below.
+	 */
+	pthread_mutex_t lock;
+
+	/**
+	 * Signaled when the next response may be read or the connection is invalidated.
+	 */
+	pthread_cond_t cond;
+
+	/**
+	 * Pipeline socket.  fd is -1 when not connected.
+	 */
+	as_socket socket;
+
+	/**
+	 * Sequence number of next command written.
+	 */
+	uint64_t write_seq;
+
+	/**
+	 * Sequence number of next command response to be read.
+	 */
+	uint64_t read_seq;
+
+	/**
+	 * Incremented when connection is invalidated.
+	 */
+	uint32_t generation;
+
+	/**
+	 * Number of commands currently written on connection that have not completed.
+	 */
+	uint32_t inflight;
+
+	/**
+	 * Is connection usable for new commands.
+	 */
+	bool valid;
+
+	/**
+	 * Is a thread creating a new socket for this connection.
+	 */
+	bool connecting;
+
+	/**
+	 * Is a thread discarding the response of a command that gave up its turn.
+	 */
+	bool draining;
+
+	/**
+	 * Commands that gave up their turn, indexed by sequence number modulo AS_SYNC_PIPE_WINDOW.
+	 * Their responses are discarded when they are next on the wire.
+	 */
+	uint8_t abandoned[AS_SYNC_PIPE_WINDOW];
+} as_sync_pipe;
+
+/**
+ * @private
+ * Command position in a synchronous pipeline connection.
+ */
+typedef struct as_sync_pipe_ticket_s {
+	as_sync_pipe* pipe;
+	uint64_t seq;
+	uint32_t generation;
+	bool abandoned;
+} as_sync_pipe_ticket;
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @private
+ * Initialize pipeline connection.
+ */
+void
+as_sync_pipe_init(as_sync_pipe* pipe);
+
+/**
+ * @private
+ * Close pipeline connection and release resources.  No other thread may access the pipe.
+ */
+void
+as_sync_pipe_destroy(struct as_node_s* node, as_sync_pipe* pipe);
+
+/**
+ * @private
+ * Reserve position on one of the node's pipeline connections and write command.
+ *
+ * Return false when no pipeline connection is available (pipelining disabled or connection
+ * still draining after a failure).  The caller should then use a pooled connection.
+ *
+ * Return true when the command was handled by a pipeline connection.  status contains the
+ * write result.  On failure, the ticket has already been released.
+ */
+bool
+as_sync_pipe_write(
+	as_error* err, struct as_node_s* node, uint8_t* buf, size_t size, uint32_t socket_timeout,
+	uint64_t deadline_ms, as_sync_pipe_ticket* ticket, as_status* status
+	);
+
+/**
+ * @private
+ * Wait until the command's response is next on the wire and has started to arrive.  On
+ * success, the caller must read exactly one response from ticket->pipe->socket and then call
+ * as_sync_pipe_release().
+ *
+ * On timeout, the command gives up its turn and its response is discarded later.  The
+ * connection remains valid.
+ */
+as_status
+as_sync_pipe_wait(
+	as_error* err, struct as_node_s* node, as_sync_pipe_ticket* ticket, uint32_t socket_timeout,
+	uint64_t deadline_ms
+	);
+
+/**
+ * @private
+ * Release ticket.  If ok is false, the response was not fully read and the connection is
+ * invalidated.  Tickets that gave up their turn in as_sync_pipe_wait() are released when
+ * their response is discarded, so this call has no effect on them.
+ */
+void
+as_sync_pipe_release(struct as_node_s* node, as_sync_pipe_ticket* ticket, bool ok);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -27,6 +27,7 @@
 #include <aerospike/as_policy.h>
 #include <aerospike/as_predexp.h>
 #include <aerospike/as_record.h>
+#include <aerospike/as_ripemd160.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_status.h>
 #include <aerospike/as_thread_pool.h>
@@ -34,6 +35,23 @@
 #include <citrusleaf/cf_clock.h>
 #include <citrusleaf/cf_digest.h>
 
+/************************************************************************
+ * 	MACROS
+ ************************************************************************/
+
+// Batch record flags.
+#define AS_BATCH_MSG_INFO 0x2
+#define AS_BATCH_MSG_GEN 0x4
+#define AS_BATCH_MSG_TTL 0x8
+
+// Batch field flags.
+#define AS_BATCH_ALLOW_INLINE 0x1
+#define AS_BATCH_RESPOND_ALL_KEYS 0x4
+
+// Batch read split limits.
+#define AS_BATCH_SPLIT_MIN_KEYS 64
+#define AS_BATCH_SPLIT_MAX 16
+
 /************************************************************************
  * 	TYPES
  ************************************************************************/
@@ -41,8 +59,22 @@
 typedef struct as_batch_node_s {
 	as_node* node;
 	as_vector offsets;
+	uint32_t n_offsets;
 } as_batch_node;
 
+typedef struct as_batch_group_key_s {
+	uint32_t node_index;
+	uint32_t offset;
+} as_batch_group_key;
+
+typedef struct as_batch_group_s {
+	as_vector* batch_nodes;
+	uint32_t* table;
+	as_batch_group_key* keys;
+	uint32_t mask;
+	uint32_t n_keys;
+} as_batch_group;
+
 typedef struct as_batch_task_s {
 	as_node* node;
 	as_vector offsets;
@@ -54,11 +86,15 @@ typedef struct as_batch_task_s {
 	uint32_t n_keys;
 	as_policy_replica replica_sc;
 	bool use_batch_records;
+	bool has_write;
 } as_batch_task;
 
 typedef struct as_batch_task_records_s {
 	as_batch_task base;
 	as_vector* records;
+	const as_policy_batch_write* policy_write;
+	as_batch_read_stream_callback callback;
+	void* udata;
 } as_batch_task_records;
 
 typedef struct as_batch_task_keys_s {
@@ -69,6 +105,7 @@ typedef struct as_batch_task_keys_s {
 	as_batch_read* results;
 	aerospike_batch_read_callback callback;
 	as_batch_callback_xdr callback_xdr;
+	as_batch_view_callback callback_view;
 	void* udata;
 	const char** bins;
 	uint32_t n_bins;
@@ -84,11 +121,34 @@ typedef struct {
 	as_event_executor executor;
 	as_batch_read_records* records;
 	as_async_batch_listener listener;
+	as_async_batch_read_stream_listener stream_listener;
 	as_policy_replica replica_sc;
 } as_async_batch_executor;
 
+typedef struct {
+	as_event_executor executor;
+	as_batch_write_records* records;
+	as_async_batch_write_listener listener;
+} as_async_batch_write_executor;
+
+typedef struct as_batch_write_attr_s {
+	uint16_t n_fields;
+	uint16_t n_ops;
+	uint8_t read_attr;
+	uint8_t write_attr;
+} as_batch_write_attr;
+
+typedef struct as_batch_write_plan_s {
+	as_batch_write_attr* attrs;
+	as_buffer* buffers;
+	uint32_t filter_size;
+	uint16_t field_count_header;
+} as_batch_write_plan;
+
 typedef struct as_async_batch_command {
 	as_event_command command;
+	uint64_t begin;
+	uint32_t n_keys;
 	uint8_t space[];
 } as_async_batch_command;
 
@@ -123,11 +183,62 @@ as_batch_parse_record(uint8_t** pp, as_error* err, as_msg* msg, as_record* rec,
 	return as_command_parse_bins(pp, err, rec, msg->n_ops, deserialize);
 }
 
+static as_status
+as_batch_parse_view(uint8_t** pp, uint8_t* end, as_error* err, as_msg* msg, as_batch_task_keys* btk,
+	as_key* key)
+{
+	as_record_view view;
+	memset(&view, 0, sizeof(as_record_view));
+	view.gen = (uint16_t)msg->generation;
+	view.ttl = cf_server_void_time_to_ttl(msg->record_ttl);
+
+	// View references response buffer directly.  Bin index is on the stack unless the
+	// record has more bins than fit.
+	as_bin_view stack_bins[AS_RECORD_VIEW_STACK_BINS];
+	as_bin_view* bins = (msg->n_ops <= AS_RECORD_VIEW_STACK_BINS)? stack_bins :
+		cf_malloc(sizeof(as_bin_view) * msg->n_ops);
+	as_status status = as_record_view_parse_bins(&view, err, pp, end, bins, msg->n_ops);
+
+	if (status != AEROSPIKE_OK) {
+		as_record_view_destroy(&view);
+
+		if (bins != stack_bins) {
+			cf_free(bins);
+		}
+		return status;
+	}
+
+	bool rv = btk->callback_view(key, &view, btk->udata);
+	as_record_view_destroy(&view);
+
+	if (bins != stack_bins) {
+		cf_free(bins);
+	}
+	return rv ? AEROSPIKE_OK : AEROSPIKE_ERR_CLIENT_ABORT;
+}
+
 static void
 as_batch_complete_async(as_event_executor* executor)
 {
 	as_async_batch_executor* e = (as_async_batch_executor*)executor;
-	e->listener(executor->err, e->records, executor->udata, executor->event_loop);
+
+	if (e->stream_listener) {
+		e->stream_listener(executor->err, NULL, 0, executor->udata, executor->event_loop);
+	}
+	else {
+		e->listener(executor->err, e->records, executor->udata, executor->event_loop);
+	}
+}
+
+static inline void
+as_batch_stream_release(as_batch_read_record* record)
+{
+	// Streamed bins are only valid during the callback.  Free them now so only records
+	// in flight hold memory.  The result is kept to detect records resent on retry.
+	if (record->result == AEROSPIKE_OK) {
+		as_record_destroy(&record->record);
+		as_record_init(&record->record, 0);
+	}
 }
 
 static inline bool
@@ -162,6 +273,13 @@ as_batch_async_skip_records(as_event_command* cmd, uint8_t* p, uint8_t* end)
 	return false;
 }
 
+static inline void
+as_batch_async_latency(as_event_command* cmd)
+{
+	as_async_batch_command* bcmd = (as_async_batch_command*)cmd;
+	as_node_batch_latency(cmd->node, cf_getns() - bcmd->begin, bcmd->n_keys);
+}
+
 static bool
 as_batch_async_parse_records(as_event_command* cmd)
 {
@@ -190,6 +308,7 @@ as_batch_async_parse_records(as_event_command* cmd)
 		p += sizeof(as_msg);
 		
 		if (msg->info3 & AS_MSG_INFO3_LAST) {
+			as_batch_async_latency(cmd);
 			as_event_batch_complete(cmd);
 			return true;
 		}
@@ -206,6 +325,13 @@ as_batch_async_parse_records(as_event_command* cmd)
 		p = as_batch_parse_fields(p, msg->n_fields);
 		
 		as_batch_read_record* record = as_vector_get(records, offset);
+
+		if (executor->stream_listener && record->result != AEROSPIKE_NO_RESPONSE) {
+			// Record was already streamed before this command was retried.
+			p = as_command_ignore_bins(p, msg->n_ops);
+			continue;
+		}
+
 		record->result = msg->result_code;
 		
 		if (msg->result_code == AEROSPIKE_OK) {
@@ -217,6 +343,20 @@ as_batch_async_parse_records(as_event_command* cmd)
 				return true;
 			}
 		}
+
+		if (executor->stream_listener) {
+			as_event_executor* e = &executor->executor;
+			bool rv = executor->stream_listener(NULL, record, offset, e->udata, e->event_loop);
+			as_batch_stream_release(record);
+
+			if (! rv) {
+				// Other node commands skip their remaining records once the executor is
+				// invalidated.  The listener is notified when they complete.
+				as_error_set_message(&err, AEROSPIKE_ERR_CLIENT_ABORT, "");
+				as_event_response_error(cmd, &err);
+				return true;
+			}
+		}
 	}
 	return false;
 }
@@ -227,6 +367,12 @@ as_batch_parse_records(as_error* err, as_node* node, uint8_t* buf, size_t size,
 	as_batch_task* task = udata;
 	bool deserialize = task->policy->deserialize;
 
+	if (task->use_batch_records && ((as_batch_task_records*)task)->callback &&
+		as_load_uint32(task->error_mutex)) {
+		// Another node command failed or the stream was aborted.  Stop early.
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT_ABORT, "");
+	}
+
 	uint8_t* p = buf;
 	uint8_t* end = buf + size;
 	
@@ -255,6 +401,13 @@ as_batch_parse_records(as_error* err, as_node* node, uint8_t* buf, size_t size,
 		if (task->use_batch_records) {
 			as_batch_task_records* btr = (as_batch_task_records*)task;
 			as_batch_read_record* record = as_vector_get(btr->records, offset);
+
+			if (btr->callback && record->result != AEROSPIKE_NO_RESPONSE) {
+				// Record was already streamed before this command was retried.
+				p = as_command_ignore_bins(p, msg->n_ops);
+				continue;
+			}
+
 			record->result = msg->result_code;
 			
 			if (msg->result_code == AEROSPIKE_OK) {
@@ -265,12 +418,30 @@ as_batch_parse_records(as_error* err, as_node* node, uint8_t* buf, size_t size,
 					return status;
 				}
 			}
+
+			if (btr->callback) {
+				bool rv = btr->callback(record, offset, btr->udata);
+				as_batch_stream_release(record);
+
+				if (!rv) {
+					return as_error_set_message(err, AEROSPIKE_ERR_CLIENT_ABORT, "");
+				}
+			}
 		}
 		else {
 			as_batch_task_keys* btk = (as_batch_task_keys*)task;
 			as_key* key = &btk->keys[offset];
 
-			if (btk->callback_xdr) {
+			if (btk->callback_view) {
+				if (msg->result_code == AEROSPIKE_OK) {
+					as_status status = as_batch_parse_view(&p, end, err, msg, btk, key);
+
+					if (status != AEROSPIKE_OK) {
+						return status;
+					}
+				}
+			}
+			else if (btk->callback_xdr) {
 				if (msg->result_code == AEROSPIKE_OK) {
 					as_record rec;
 					as_status status = as_batch_parse_record(&p, err, msg, &rec, deserialize);
@@ -306,6 +477,136 @@ as_batch_parse_records(as_error* err, as_node* node, uint8_t* buf, size_t size,
 	return AEROSPIKE_OK;
 }
 
+static as_status
+as_batch_parse_write(
+	uint8_t** pp, as_error* err, as_msg* msg, as_batch_write_record* record, bool deserialize
+	)
+{
+	if (record->result == AEROSPIKE_OK) {
+		// Normal retry may resend records that already succeeded.
+		as_record_destroy(&record->record);
+		as_record_init(&record->record, 0);
+	}
+
+	record->result = msg->result_code;
+	record->in_doubt = false;
+
+	if (msg->result_code != AEROSPIKE_OK) {
+		*pp = as_command_ignore_bins(*pp, msg->n_ops);
+		return AEROSPIKE_OK;
+	}
+	return as_batch_parse_record(pp, err, msg, &record->record, deserialize);
+}
+
+static void
+as_batch_write_set_error(as_vector* records, as_vector* offsets, as_error* err)
+{
+	// Records without a response may have been written before the node command failed.
+	uint32_t n = offsets ? offsets->size : records->size;
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t offset = offsets ? *(uint32_t*)as_vector_get(offsets, i) : i;
+		as_batch_write_record* record = as_vector_get(records, offset);
+
+		if (record->result == AEROSPIKE_NO_RESPONSE) {
+			record->result = err->code;
+			record->in_doubt = err->in_doubt;
+		}
+	}
+}
+
+static bool
+as_batch_async_parse_writes(as_event_command* cmd)
+{
+	uint8_t* p = cmd->buf + cmd->pos;
+	uint8_t* end = cmd->buf + cmd->len;
+	as_async_batch_write_executor* executor = cmd->udata;  // udata is overloaded to contain executor.
+
+	// Results are recorded even after another node command failed because those writes
+	// may have been applied.  Records are not returned to the user until all node
+	// commands complete.
+	as_error err;
+	as_vector* records = &executor->records->list;
+
+	while (p < end) {
+		as_msg* msg = (as_msg*)p;
+		as_msg_swap_header_from_be(msg);
+		p += sizeof(as_msg);
+
+		if (msg->info3 & AS_MSG_INFO3_LAST) {
+			if (msg->result_code != AEROSPIKE_OK) {
+				as_error_set_message(&err, msg->result_code, as_error_string(msg->result_code));
+				as_event_response_error(cmd, &err);
+				return true;
+			}
+			as_event_batch_complete(cmd);
+			return true;
+		}
+
+		uint32_t offset = msg->transaction_ttl; // overloaded to contain batch index
+
+		if (offset >= records->size) {
+			as_error_update(&err, AEROSPIKE_ERR_CLIENT, "Batch index %u >= batch size: %u",
+							offset, records->size);
+			as_event_response_error(cmd, &err);
+			return true;
+		}
+
+		p = as_batch_parse_fields(p, msg->n_fields);
+
+		as_batch_write_record* record = as_vector_get(records, offset);
+		as_status status = as_batch_parse_write(&p, &err, msg, record,
+												cmd->flags2 & AS_ASYNC_FLAGS2_DESERIALIZE);
+
+		if (status != AEROSPIKE_OK) {
+			as_event_response_error(cmd, &err);
+			return true;
+		}
+	}
+	return false;
+}
+
+static as_status
+as_batch_parse_writes(as_error* err, as_node* node, uint8_t* buf, size_t size, void* udata)
+{
+	as_batch_task_records* btr = udata;
+	bool deserialize = btr->base.policy->deserialize;
+
+	uint8_t* p = buf;
+	uint8_t* end = buf + size;
+
+	while (p < end) {
+		as_msg* msg = (as_msg*)p;
+		as_msg_swap_header_from_be(msg);
+		p += sizeof(as_msg);
+
+		if (msg->info3 & AS_MSG_INFO3_LAST) {
+			if (msg->result_code != AEROSPIKE_OK) {
+				return as_error_set_message(err, msg->result_code,
+											as_error_string(msg->result_code));
+			}
+			return AEROSPIKE_NO_MORE_RECORDS;
+		}
+
+		uint32_t offset = msg->transaction_ttl;  // overloaded to contain batch index
+
+		if (offset >= btr->base.n_keys) {
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Batch index %u >= batch size: %u",
+								   offset, btr->base.n_keys);
+		}
+
+		p = as_batch_parse_fields(p, msg->n_fields);
+
+		as_batch_write_record* record = as_vector_get(btr->records, offset);
+		as_status status = as_batch_parse_write(&p, err, msg, record, deserialize);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
 static size_t
 as_batch_size_records(
 	const as_policy_batch* policy, as_vector* records, as_vector* offsets,
@@ -469,6 +770,232 @@ as_batch_index_records_write(
 	return as_command_write_end(cmd, p);
 }
 
+static size_t
+as_batch_size_writes(
+	const as_policy_batch* policy, const as_policy_batch_write* policy_write, as_vector* records,
+	as_vector* offsets, as_batch_write_plan* plan
+	)
+{
+	// Estimate buffer size.
+	size_t size = AS_HEADER_SIZE + AS_FIELD_HEADER_SIZE + sizeof(uint32_t) + 1;
+
+	if (policy->base.filter_exp) {
+		size += AS_FIELD_HEADER_SIZE + policy->base.filter_exp->packed_sz;
+		plan->filter_size = 0;
+		plan->field_count_header = 2;
+	}
+	else if (policy->base.predexp) {
+		size += as_predexp_list_size(policy->base.predexp, &plan->filter_size);
+		plan->field_count_header = 2;
+	}
+	else {
+		plan->filter_size = 0;
+		plan->field_count_header = 1;
+	}
+
+	uint32_t n_offsets = offsets->size;
+	uint32_t n_buffers = 0;
+
+	for (uint32_t i = 0; i < n_offsets; i++) {
+		uint32_t offset = *(uint32_t*)as_vector_get(offsets, i);
+		as_batch_write_record* record = as_vector_get(records, offset);
+
+		if (record->type == AS_BATCH_WRITE_PUT) {
+			n_buffers += record->rec->bins.size;
+		}
+		else if (record->type == AS_BATCH_WRITE_OPERATE) {
+			n_buffers += record->ops->binops.size;
+		}
+	}
+
+	// Attributes and serialized list/map values are saved for as_batch_index_writes_write().
+	plan->attrs = cf_malloc(sizeof(as_batch_write_attr) * n_offsets);
+	plan->buffers = cf_calloc(n_buffers + 1, sizeof(as_buffer));
+
+	as_buffer* buffers = plan->buffers;
+
+	for (uint32_t i = 0; i < n_offsets; i++) {
+		uint32_t offset = *(uint32_t*)as_vector_get(offsets, i);
+		as_batch_write_record* record = as_vector_get(records, offset);
+		const as_policy_batch_write* bwp = record->policy ? record->policy : policy_write;
+		as_batch_write_attr* attr = &plan->attrs[i];
+
+		// Offset, digest, record flags, attributes, generation, ttl, field and op counts.
+		size += sizeof(uint32_t) + AS_DIGEST_VALUE_SIZE + 14;
+		size += as_command_string_field_size(record->key.ns);
+		size += as_command_string_field_size(record->key.set);
+		attr->n_fields = 2;
+
+		if (bwp->key == AS_POLICY_KEY_SEND && record->key.valuep) {
+			size += as_command_user_key_size(&record->key);
+			attr->n_fields++;
+		}
+
+		if (bwp->filter_exp) {
+			size += AS_FIELD_HEADER_SIZE + bwp->filter_exp->packed_sz;
+			attr->n_fields++;
+		}
+
+		switch (record->type) {
+			default:
+			case AS_BATCH_WRITE_PUT: {
+				as_bin* bins = record->rec->bins.entries;
+				uint16_t n_bins = record->rec->bins.size;
+
+				for (uint16_t j = 0; j < n_bins; j++) {
+					size += as_command_bin_size(&bins[j], buffers++);
+				}
+				attr->n_ops = n_bins;
+				attr->read_attr = 0;
+				attr->write_attr = AS_MSG_INFO2_WRITE;
+				break;
+			}
+
+			case AS_BATCH_WRITE_OPERATE:
+				size += as_command_operate_size(record->ops, buffers, NULL, &attr->read_attr,
+												&attr->write_attr);
+				attr->n_ops = (uint16_t)record->ops->binops.size;
+				buffers += attr->n_ops;
+				break;
+
+			case AS_BATCH_WRITE_REMOVE:
+				attr->n_ops = 0;
+				attr->read_attr = 0;
+				attr->write_attr = AS_MSG_INFO2_WRITE | AS_MSG_INFO2_DELETE;
+				break;
+		}
+	}
+	return size;
+}
+
+static inline void
+as_batch_write_plan_destroy(as_batch_write_plan* plan)
+{
+	cf_free(plan->attrs);
+	cf_free(plan->buffers);
+}
+
+static size_t
+as_batch_index_writes_write(
+	const as_policy_batch* policy, const as_policy_batch_write* policy_write, as_vector* records,
+	as_vector* offsets, as_batch_write_plan* plan, uint8_t* cmd
+	)
+{
+	uint32_t n_offsets = offsets->size;
+	uint8_t* p = as_command_write_header_read(cmd, &policy->base, policy->read_mode_ap,
+		policy->read_mode_sc, policy->base.total_timeout, plan->field_count_header, 0,
+		AS_MSG_INFO1_BATCH_INDEX);
+
+	if (policy->base.filter_exp) {
+		p = as_exp_write(policy->base.filter_exp, p);
+	}
+	else if (policy->base.predexp) {
+		p = as_predexp_list_write(policy->base.predexp, plan->filter_size, p);
+	}
+
+	uint8_t* field_size_ptr = p;
+
+	p = as_command_write_field_header(p, AS_FIELD_BATCH_INDEX, 0);
+
+	*(uint32_t*)p = cf_swap_to_be32(n_offsets);
+	p += sizeof(uint32_t);
+
+	// Request a response for every key, so each record receives its own result.
+	*p++ = (policy->allow_inline? AS_BATCH_ALLOW_INLINE : 0) | AS_BATCH_RESPOND_ALL_KEYS;
+
+	as_buffer* buffers = plan->buffers;
+
+	for (uint32_t i = 0; i < n_offsets; i++) {
+		uint32_t offset = *(uint32_t*)as_vector_get(offsets, i);
+		*(uint32_t*)p = cf_swap_to_be32(offset);
+		p += sizeof(uint32_t);
+
+		as_batch_write_record* record = as_vector_get(records, offset);
+		memcpy(p, record->key.digest.value, AS_DIGEST_VALUE_SIZE);
+		p += AS_DIGEST_VALUE_SIZE;
+
+		const as_policy_batch_write* bwp = record->policy ? record->policy : policy_write;
+		as_batch_write_attr* attr = &plan->attrs[i];
+		as_policy_exists exists;
+		uint32_t gen;
+		uint32_t ttl;
+
+		switch (record->type) {
+			default:
+			case AS_BATCH_WRITE_PUT:
+				exists = bwp->exists;
+				gen = record->rec->gen;
+				ttl = record->rec->ttl;
+				break;
+
+			case AS_BATCH_WRITE_OPERATE:
+				exists = bwp->exists;
+				gen = record->ops->gen;
+				ttl = record->ops->ttl;
+				break;
+
+			case AS_BATCH_WRITE_REMOVE:
+				exists = AS_POLICY_EXISTS_IGNORE;
+				gen = bwp->generation;
+				ttl = 0;
+				break;
+		}
+
+		uint8_t read_attr = attr->read_attr;
+		uint8_t write_attr = attr->write_attr;
+		uint8_t info_attr = 0;
+		uint32_t generation = as_command_set_attr_write(bwp->commit_level, exists, bwp->gen, gen,
+			bwp->durable_delete, &write_attr, &info_attr);
+
+#if defined USE_XDR
+		read_attr |= AS_MSG_INFO1_XDR;
+#endif
+
+		*p++ = AS_BATCH_MSG_INFO | AS_BATCH_MSG_GEN | AS_BATCH_MSG_TTL;
+		*p++ = read_attr;
+		*p++ = write_attr;
+		*p++ = info_attr;
+		*(uint16_t*)p = cf_swap_to_be16((uint16_t)generation);
+		p += sizeof(uint16_t);
+		*(uint32_t*)p = cf_swap_to_be32(ttl);
+		p += sizeof(uint32_t);
+		*(uint16_t*)p = cf_swap_to_be16(attr->n_fields);
+		p += sizeof(uint16_t);
+		*(uint16_t*)p = cf_swap_to_be16(attr->n_ops);
+		p += sizeof(uint16_t);
+		p = as_command_write_field_string(p, AS_FIELD_NAMESPACE, record->key.ns);
+		p = as_command_write_field_string(p, AS_FIELD_SETNAME, record->key.set);
+
+		if (bwp->key == AS_POLICY_KEY_SEND && record->key.valuep) {
+			p = as_command_write_user_key(p, &record->key);
+		}
+
+		if (bwp->filter_exp) {
+			p = as_exp_write(bwp->filter_exp, p);
+		}
+
+		if (record->type == AS_BATCH_WRITE_PUT) {
+			as_bin* bins = record->rec->bins.entries;
+
+			for (uint16_t j = 0; j < attr->n_ops; j++) {
+				p = as_command_write_bin(p, AS_OPERATOR_WRITE, &bins[j], buffers++);
+			}
+		}
+		else if (record->type == AS_BATCH_WRITE_OPERATE) {
+			as_binop* ops = record->ops->binops.entries;
+
+			for (uint16_t j = 0; j < attr->n_ops; j++) {
+				p = as_command_write_bin(p, as_command_operator(ops[j].op), &ops[j].bin, buffers++);
+			}
+		}
+	}
+	// Write real field size.
+	size_t size = p - field_size_ptr - 4;
+	*(uint32_t*)field_size_ptr = cf_swap_to_be32((uint32_t)size);
+
+	return as_command_write_end(cmd, p);
+}
+
 static inline as_policy_replica
 as_batch_get_replica_sc(const as_policy_batch* policy)
 {
@@ -477,7 +1004,8 @@ as_batch_get_replica_sc(const as_policy_batch* policy)
 			return AS_POLICY_REPLICA_MASTER;
 
 		case AS_POLICY_READ_MODE_SC_LINEARIZE:
-			return (policy->replica != AS_POLICY_REPLICA_PREFER_RACK) ?
+			return (policy->replica != AS_POLICY_REPLICA_PREFER_RACK &&
+					policy->replica != AS_POLICY_REPLICA_LOWEST_LATENCY) ?
 					policy->replica : AS_POLICY_REPLICA_SEQUENCE;
 
 		default:
@@ -488,7 +1016,8 @@ as_batch_get_replica_sc(const as_policy_batch* policy)
 static as_status
 as_batch_get_node(
 	as_cluster* cluster, as_error* err, const as_key* key, as_policy_replica replica,
-	as_policy_replica replica_sc, bool master, bool master_sc, bool is_retry, as_node** node_pp
+	as_policy_replica replica_sc, uint8_t replica_index, bool master_sc, bool is_retry,
+	as_node** node_pp
 	)
 {
 	as_partition_info pi;
@@ -500,10 +1029,11 @@ as_batch_get_node(
 
 	if (pi.sc_mode) {
 		replica = replica_sc;
-		master = master_sc;
+		replica_index = master_sc? 0 : 1;
 	}
 
-	as_node* node = as_partition_get_node(cluster, pi.ns, pi.partition, replica, master, is_retry);
+	as_node* node = as_partition_get_node(cluster, pi.ns, pi.partition, replica, replica_index,
+										  is_retry);
 
 	if (! node) {
 		*node_pp = NULL;
@@ -526,17 +1056,25 @@ as_batch_command_init(
 	cmd->node = task->node;
 	cmd->ns = NULL;        // Not referenced when node set.
 	cmd->partition = NULL; // Not referenced when node set.
-	cmd->parse_results_fn = as_batch_parse_records;
 	cmd->udata = task;
 	cmd->buf = buf;
 	cmd->buf_size = size;
 	cmd->partition_id = 0; // Not referenced when node set.
-	cmd->replica = policy->replica;
 
-	// Note: Do not set flags to AS_COMMAND_FLAGS_LINEARIZE because AP and SC replicas
-	// are tracked separately for batch (cmd->master and cmd->master_sc).
-	// SC master/replica switch is done in as_batch_retry().
-	cmd->flags = AS_COMMAND_FLAGS_READ | AS_COMMAND_FLAGS_BATCH;
+	if (task->has_write) {
+		// Writes are only sent to the master.  Leave read flag unset, so in_doubt is tracked.
+		cmd->parse_results_fn = as_batch_parse_writes;
+		cmd->replica = AS_POLICY_REPLICA_MASTER;
+		cmd->flags = AS_COMMAND_FLAGS_BATCH;
+	}
+	else {
+		// Note: Do not set flags to AS_COMMAND_FLAGS_LINEARIZE because AP and SC replicas
+		// are tracked separately for batch (cmd->replica_index and cmd->master_sc).
+		// SC master/replica switch is done in as_batch_retry().
+		cmd->parse_results_fn = as_batch_parse_records;
+		cmd->replica = policy->replica;
+		cmd->flags = AS_COMMAND_FLAGS_READ | AS_COMMAND_FLAGS_BATCH;
+	}
 
 	if (! parent) {
 		// Normal batch.
@@ -547,7 +1085,7 @@ as_batch_command_init(
 		// Split retry mode.  Do not reset timer.
 		cmd->master_sc = parent->master_sc;
 		cmd->iteration = parent->iteration;
-		cmd->master = parent->master;
+		cmd->replica_index = parent->replica_index;
 		cmd->socket_timeout = parent->socket_timeout;
 		cmd->total_timeout = parent->total_timeout;
 		cmd->deadline_ms = parent->deadline_ms;
@@ -555,7 +1093,68 @@ as_batch_command_init(
 }
 
 static as_status
-as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command* parent)
+as_batch_read_command_execute(as_command* cmd, as_batch_task* task, as_error* err)
+{
+	uint64_t begin = cf_getns();
+	as_status status = as_command_execute(cmd, err);
+
+	if (status == AEROSPIKE_OK) {
+		// Response time per key determines the size of future batch sub-commands.
+		as_node_batch_latency(task->node, cf_getns() - begin, task->offsets.size);
+	}
+	return status;
+}
+
+static as_status
+as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command* parent)
+{
+	as_error_reset(err);
+
+	as_batch_task* task = &btr->base;
+	const as_policy_batch* policy = task->policy;
+
+	// Estimate buffer size.
+	uint16_t field_count_header;
+	uint32_t filter_size;
+	size_t size = as_batch_size_records(policy, btr->records, &task->offsets, &field_count_header,
+										&filter_size, NULL);
+		
+	size_t capacity = size;
+
+	// Write command
+	uint8_t* buf = as_command_buffer_init(capacity);
+	size = as_batch_index_records_write(btr->records, &task->offsets, policy, buf,
+										field_count_header, filter_size, NULL);
+
+	as_status status;
+
+	if (policy->base.compress && size > AS_COMPRESS_THRESHOLD) {
+		// Compress command.
+		size_t comp_capacity = as_command_compress_max_size(size);
+		size_t comp_size = comp_capacity;
+		uint8_t* comp_buf = as_command_buffer_init(comp_capacity);
+		status = as_command_compress(err, buf, size, comp_buf, &comp_size);
+		as_command_buffer_free(buf, capacity);
+
+		if (status != AEROSPIKE_OK) {
+			as_command_buffer_free(comp_buf, comp_capacity);
+			return status;
+		}
+		capacity = comp_capacity;
+		buf = comp_buf;
+		size = comp_size;
+	}
+
+	as_command cmd;
+
+	as_batch_command_init(&cmd, task, policy, buf, size, parent);
+	status = as_batch_read_command_execute(&cmd, task, err);
+	as_command_buffer_free(buf, capacity);
+	return status;
+}
+
+static as_status
+as_batch_execute_writes(as_batch_task_records* btr, as_error* err, as_command* parent)
 {
 	as_error_reset(err);
 
@@ -563,17 +1162,17 @@ as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command*
 	const as_policy_batch* policy = task->policy;
 
 	// Estimate buffer size.
-	uint16_t field_count_header;
-	uint32_t filter_size;
-	size_t size = as_batch_size_records(policy, btr->records, &task->offsets, &field_count_header,
-										&filter_size, NULL);
-		
+	as_batch_write_plan plan;
+	size_t size = as_batch_size_writes(policy, btr->policy_write, btr->records, &task->offsets,
+									   &plan);
+
 	size_t capacity = size;
 
 	// Write command
 	uint8_t* buf = as_command_buffer_init(capacity);
-	size = as_batch_index_records_write(btr->records, &task->offsets, policy, buf,
-										field_count_header, filter_size, NULL);
+	size = as_batch_index_writes_write(policy, btr->policy_write, btr->records, &task->offsets,
+									   &plan, buf);
+	as_batch_write_plan_destroy(&plan);
 
 	as_status status;
 
@@ -587,6 +1186,7 @@ as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command*
 
 		if (status != AEROSPIKE_OK) {
 			as_command_buffer_free(comp_buf, comp_capacity);
+			as_batch_write_set_error(btr->records, &task->offsets, err);
 			return status;
 		}
 		capacity = comp_capacity;
@@ -599,6 +1199,10 @@ as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command*
 	as_batch_command_init(&cmd, task, policy, buf, size, parent);
 	status = as_command_execute(&cmd, err);
 	as_command_buffer_free(buf, capacity);
+
+	if (status != AEROSPIKE_OK) {
+		as_batch_write_set_error(btr->records, &task->offsets, err);
+	}
 	return status;
 }
 
@@ -753,7 +1357,7 @@ as_batch_execute_keys(as_batch_task_keys* btk, as_error* err, as_command* parent
 	as_command cmd;
 
 	as_batch_command_init(&cmd, task, policy, buf, size, parent);
-	status = as_command_execute(&cmd, err);
+	status = as_batch_read_command_execute(&cmd, task, err);
 	as_command_buffer_free(buf, capacity);
 	return status;
 }
@@ -768,7 +1372,11 @@ as_batch_worker(void* data)
 
 	as_error err;
 
-	if (task->use_batch_records) {
+	if (task->has_write) {
+		// Execute batch referenced in aerospike_batch_write().
+		complete_task.result = as_batch_execute_writes((as_batch_task_records*)task, &err, NULL);
+	}
+	else if (task->use_batch_records) {
 		// Execute batch referenced in aerospike_batch_read().
 		complete_task.result = as_batch_execute_records((as_batch_task_records*)task, &err, NULL);
 	}
@@ -787,19 +1395,114 @@ as_batch_worker(void* data)
 	cf_queue_push(task->complete_q, &complete_task);
 }
 
-static as_batch_node*
-as_batch_node_find(as_vector* batch_nodes, as_node* node)
+static inline uint32_t*
+as_batch_group_slot(as_batch_group* group, as_node* node)
 {
-	as_batch_node* batch_node = batch_nodes->list;
-	uint32_t n_batch_nodes = batch_nodes->size;
+	// Open addressing table of batch node indexes + 1.  Zero is an empty slot.
+	as_batch_node* list = group->batch_nodes->list;
+	uint64_t hash = (uint64_t)(uintptr_t)node * 0x9E3779B97F4A7C15ULL;
+	uint32_t i = (uint32_t)(hash >> 32) & group->mask;
 
-	for (uint32_t i = 0; i < n_batch_nodes; i++) {
-		if (batch_node->node == node) {
-			return batch_node;
+	while (true) {
+		uint32_t* slot = &group->table[i];
+
+		if (*slot == 0 || list[*slot - 1].node == node) {
+			return slot;
 		}
-		batch_node++;
+		i = (i + 1) & group->mask;
+	}
+}
+
+static void
+as_batch_group_init(as_batch_group* group, as_vector* batch_nodes, uint32_t n_nodes, uint32_t n_keys)
+{
+	uint32_t capacity = 16;
+
+	while (capacity < n_nodes * 2) {
+		capacity <<= 1;
+	}
+
+	group->batch_nodes = batch_nodes;
+	group->table = cf_calloc(capacity, sizeof(uint32_t));
+	group->keys = cf_malloc(sizeof(as_batch_group_key) * n_keys);
+	group->mask = capacity - 1;
+	group->n_keys = 0;
+}
+
+static void
+as_batch_group_add(as_batch_group* group, as_node* node, uint32_t offset)
+{
+	// First pass of counting sort.  Find batch node and count its keys.
+	uint32_t* slot = as_batch_group_slot(group, node);
+
+	if (*slot == 0) {
+		// Add batch node.
+		as_node_reserve(node);
+		as_batch_node* batch_node = as_vector_reserve(group->batch_nodes);
+		batch_node->node = node;  // Transfer node
+		batch_node->n_offsets = 0;
+		*slot = group->batch_nodes->size;
+
+		if (group->batch_nodes->size * 2 > group->mask + 1) {
+			// Keep table at most half full.
+			uint32_t capacity = (group->mask + 1) * 2;
+			as_batch_node* list = group->batch_nodes->list;
+			uint32_t index = *slot - 1;
+
+			cf_free(group->table);
+			group->table = cf_calloc(capacity, sizeof(uint32_t));
+			group->mask = capacity - 1;
+
+			for (uint32_t i = 0; i < group->batch_nodes->size; i++) {
+				*as_batch_group_slot(group, list[i].node) = i + 1;
+			}
+			slot = as_batch_group_slot(group, list[index].node);
+		}
+	}
+
+	uint32_t index = *slot - 1;
+	as_batch_node* batch_node = as_vector_get(group->batch_nodes, index);
+	batch_node->n_offsets++;
+
+	as_batch_group_key* key = &group->keys[group->n_keys++];
+	key->node_index = index;
+	key->offset = offset;
+}
+
+static void
+as_batch_group_finish(as_batch_group* group)
+{
+	// Second pass of counting sort.  Allocate exact offsets for each batch node once and
+	// distribute keys in their original order.
+	as_batch_node* list = group->batch_nodes->list;
+	uint32_t n_batch_nodes = group->batch_nodes->size;
+
+	for (uint32_t i = 0; i < n_batch_nodes; i++) {
+		as_vector_init(&list[i].offsets, sizeof(uint32_t), list[i].n_offsets);
+	}
+
+	for (uint32_t i = 0; i < group->n_keys; i++) {
+		as_batch_group_key* key = &group->keys[i];
+		as_vector_append(&list[key->node_index].offsets, &key->offset);
+	}
+
+	cf_free(group->table);
+	cf_free(group->keys);
+}
+
+static void
+as_batch_group_destroy(as_batch_group* group)
+{
+	// Abort grouping before as_batch_group_finish().  Offsets have not been allocated.
+	as_batch_node* list = group->batch_nodes->list;
+	uint32_t n_batch_nodes = group->batch_nodes->size;
+
+	for (uint32_t i = 0; i < n_batch_nodes; i++) {
+		as_node_release(list[i].node);
 	}
-	return NULL;
+	as_vector_destroy(group->batch_nodes);
+	cf_free(group->table);
+	cf_free(group->keys);
 }
 
 static void
@@ -843,11 +1546,82 @@ as_batch_release_nodes_after_async(as_vector* batch_nodes)
 	as_vector_destroy(batch_nodes);
 }
 
+static uint32_t
+as_batch_split_size(const as_policy_batch* policy, as_node* node)
+{
+	uint32_t max_keys = policy->split_keys;
+
+	if (policy->split_latency == 0) {
+		return max_keys;
+	}
+
+	uint32_t key_ns = as_load_uint32(&node->batch_key_ns);
+
+	if (key_ns == 0) {
+		// No batch responses have been observed yet.
+		return max_keys;
+	}
+
+	uint64_t keys = (uint64_t)policy->split_latency * 1000 * 1000 / key_ns;
+	uint32_t min_keys = (max_keys < AS_BATCH_SPLIT_MIN_KEYS)? max_keys : AS_BATCH_SPLIT_MIN_KEYS;
+
+	if (keys < min_keys) {
+		return min_keys;
+	}
+	return (keys < max_keys)? (uint32_t)keys : max_keys;
+}
+
+static void
+as_batch_split_nodes(const as_policy_batch* policy, as_vector* batch_nodes)
+{
+	// Split large node key lists into sub-commands of contiguous offsets.  Sub-commands
+	// share the node, so each one holds its own node reference.
+	uint32_t n_batch_nodes = batch_nodes->size;
+
+	for (uint32_t i = 0; i < n_batch_nodes; i++) {
+		as_batch_node* batch_node = as_vector_get(batch_nodes, i);
+		uint32_t n_offsets = batch_node->offsets.size;
+		uint32_t split_size = as_batch_split_size(policy, batch_node->node);
+
+		if (n_offsets <= split_size) {
+			continue;
+		}
+
+		uint32_t n_sub = (n_offsets + split_size - 1) / split_size;
+
+		if (n_sub > AS_BATCH_SPLIT_MAX) {
+			n_sub = AS_BATCH_SPLIT_MAX;
+		}
+
+		uint32_t sub_size = (n_offsets + n_sub - 1) / n_sub;
+		as_node* node = batch_node->node;
+		uint32_t* offsets = batch_node->offsets.list;
+
+		for (uint32_t start = sub_size; start < n_offsets; start += sub_size) {
+			uint32_t count = (n_offsets - start < sub_size)? n_offsets - start : sub_size;
+
+			// Reserve may move the batch node list.
+			as_batch_node* sub = as_vector_reserve(batch_nodes);
+			as_node_reserve(node);
+			sub->node = node;
+			sub->n_offsets = count;
+			as_vector_init(&sub->offsets, sizeof(uint32_t), count);
+			memcpy(sub->offsets.list, offsets + start, sizeof(uint32_t) * count);
+			sub->offsets.size = count;
+		}
+
+		batch_node = as_vector_get(batch_nodes, i);
+		batch_node->offsets.size = sub_size;
+		batch_node->n_offsets = sub_size;
+	}
+}
+
 static as_status
 as_batch_keys_execute(
 	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
 	int read_attr, const char** bins, uint32_t n_bins,
-	aerospike_batch_read_callback callback, as_batch_callback_xdr callback_xdr, void* udata
+	aerospike_batch_read_callback callback, as_batch_callback_xdr callback_xdr,
+	as_batch_view_callback callback_view, void* udata
 	)
 {
 	as_error_reset(err);
@@ -859,7 +1633,9 @@ as_batch_keys_execute(
 	uint32_t n_keys = batch->keys.size;
 	
 	if (n_keys == 0) {
-		callback(0, 0, udata);
+		if (callback) {
+			callback(0, 0, udata);
+		}
 		return AEROSPIKE_OK;
 	}
 	
@@ -880,17 +1656,19 @@ as_batch_keys_execute(
 
 	char* ns = batch->keys.entries[0].ns;
 	as_status status = AEROSPIKE_OK;
-	
-	// Create initial key capacity for each node as average + 25%.
-	uint32_t offsets_capacity = n_keys / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
+	as_policy_replica replica_sc = as_batch_get_replica_sc(policy);
 
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
+	// Compute digests several keys at a time before mapping keys to nodes.
+	status = as_keys_set_digests(err, batch->keys.entries, n_keys);
+
+	if (status != AEROSPIKE_OK) {
+		as_batch_release_nodes(&batch_nodes);
+		as_nodes_release(nodes);
+		return status;
 	}
 
-	as_policy_replica replica_sc = as_batch_get_replica_sc(policy);
+	as_batch_group group;
+	as_batch_group_init(&group, &batch_nodes, n_nodes, n_keys);
 
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < n_keys; i++) {
@@ -902,45 +1680,25 @@ as_batch_keys_execute(
 			result->result = AEROSPIKE_ERR_RECORD_NOT_FOUND;
 			as_record_init(&result->record, 0);
 		}
-		
-		status = as_key_set_digest(err, key);
-		
-		if (status != AEROSPIKE_OK) {
-			as_batch_release_nodes(&batch_nodes);
-			as_nodes_release(nodes);
-			return status;
-		}
 
 		as_node* node;
-		status = as_batch_get_node(cluster, err, key, policy->replica, replica_sc, true, true,
+		status = as_batch_get_node(cluster, err, key, policy->replica, replica_sc, 0, true,
 								   false, &node);
 
 		if (status != AEROSPIKE_OK) {
-			as_batch_release_nodes(&batch_nodes);
+			as_batch_group_destroy(&group);
 			as_nodes_release(nodes);
 			return status;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
-		
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
-
-			if (n_keys <= 5000) {
-				// All keys and offsets should fit on stack.
-				as_vector_inita(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
-			else {
-				// Allocate vector on heap to avoid stack overflow.
-				as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
-		}
-		as_vector_append(&batch_node->offsets, &i);
+		as_batch_group_add(&group, node, i);
 	}
+	as_batch_group_finish(&group);
 	as_nodes_release(nodes);
+
+	if (policy->split_keys) {
+		as_batch_split_nodes(policy, &batch_nodes);
+	}
 	
 	uint32_t error_mutex = 0;
 	
@@ -960,12 +1718,13 @@ as_batch_keys_execute(
 	btk.results = results;
 	btk.callback = callback;
 	btk.callback_xdr = callback_xdr;
+	btk.callback_view = callback_view;
 	btk.udata = udata;
 	btk.bins = bins;
 	btk.n_bins = n_bins;
 	btk.read_attr = read_attr;
 
-	if (policy->concurrent && batch_nodes.size > 1) {
+	if ((policy->concurrent || policy->split_keys) && batch_nodes.size > 1) {
 		// Run batch requests in parallel in separate threads.
 		btk.base.complete_q = cf_queue_create(sizeof(as_batch_complete_task), true);
 		
@@ -1040,9 +1799,10 @@ as_batch_keys_execute(
 }
 
 static as_status
-as_batch_read_execute_sync(
+as_batch_execute_sync(
 	as_cluster* cluster, as_error* err, const as_policy_batch* policy, as_policy_replica replica_sc,
-	as_vector* records, uint32_t n_keys, as_vector* batch_nodes, as_command* parent
+	as_vector* records, uint32_t n_keys, as_vector* batch_nodes, as_command* parent,
+	const as_policy_batch_write* policy_write, as_batch_read_stream_callback callback, void* udata
 	)
 {
 	as_status status = AEROSPIKE_OK;
@@ -1059,9 +1819,16 @@ as_batch_read_execute_sync(
 	btr.base.n_keys = n_keys;
 	btr.base.replica_sc = replica_sc;
 	btr.base.use_batch_records = true;
+	btr.base.has_write = policy_write != NULL;
 	btr.records = records;
+	btr.policy_write = policy_write;
+	btr.callback = callback;
+	btr.udata = udata;
 
-	if (policy->concurrent && n_batch_nodes > 1 && parent == NULL) {
+	// Split batch reads always run in parallel.
+	bool concurrent = policy->concurrent || (policy->split_keys && ! policy_write);
+
+	if (concurrent && n_batch_nodes > 1 && parent == NULL) {
 		// Run batch requests in parallel in separate threads.
 		btr.base.complete_q = cf_queue_create(sizeof(as_batch_complete_task), true);
 		
@@ -1113,7 +1880,13 @@ as_batch_read_execute_sync(
 			
 			btr.base.node = batch_node->node;
 			memcpy(&btr.base.offsets, &batch_node->offsets, sizeof(as_vector));
-			status = as_batch_execute_records(&btr, err, parent);
+
+			if (policy_write) {
+				status = as_batch_execute_writes(&btr, err, parent);
+			}
+			else {
+				status = as_batch_execute_records(&btr, err, parent);
+			}
 		}
 	}
 	
@@ -1123,27 +1896,28 @@ as_batch_read_execute_sync(
 }
 
 static inline as_event_command*
-as_batch_read_command_create(
+as_batch_command_create(
 	as_cluster* cluster, const as_policy_batch* policy, as_node* node,
-	as_async_batch_executor* executor, size_t size, uint8_t flags
+	as_event_executor* executor, as_event_parse_results_fn parse_results, size_t size,
+	uint32_t n_keys, uint8_t flags
 	)
 {
 	// Allocate enough memory to cover, then, round up memory size in 8KB increments to reduce
 	// fragmentation and to allow socket read to reuse buffer.
 	size_t s = (sizeof(as_async_batch_command) + size + AS_AUTHENTICATION_MAX_SIZE + 8191) & ~8191;
-	as_event_command* cmd = cf_malloc(s);
+	as_event_command* cmd = as_slab_alloc(executor->event_loop->slab, s);
 	cmd->total_deadline = policy->base.total_timeout;
 	cmd->socket_timeout = policy->base.socket_timeout;
 	cmd->max_retries = policy->base.max_retries;
 	cmd->iteration = 0;
 	cmd->replica = policy->replica;
-	cmd->event_loop = executor->executor.event_loop;
+	cmd->event_loop = executor->event_loop;
 	cmd->cluster = cluster;
 	cmd->node = node;
 	cmd->ns = NULL;
 	cmd->partition = NULL;
 	cmd->udata = executor;  // Overload udata to be the executor.
-	cmd->parse_results = as_batch_async_parse_records;
+	cmd->parse_results = parse_results;
 	cmd->pipe_listener = NULL;
 	cmd->buf = ((as_async_batch_command*)cmd)->space;
 	cmd->read_capacity = (uint32_t)(s - size - sizeof(as_async_batch_command));
@@ -1152,6 +1926,9 @@ as_batch_read_command_create(
 	cmd->state = AS_ASYNC_STATE_UNREGISTERED;
 	cmd->flags = flags;
 	cmd->flags2 = policy->deserialize ? AS_ASYNC_FLAGS2_DESERIALIZE : 0;
+	cmd->replica_index = 0;
+	((as_async_batch_command*)cmd)->begin = cf_getns();
+	((as_async_batch_command*)cmd)->n_keys = n_keys;
 	return cmd;
 }
 
@@ -1167,9 +1944,9 @@ as_batch_read_execute_async(
 	executor->replica_sc = replica_sc;
 
 	// Note: Do not set flags to AS_ASYNC_FLAGS_LINEARIZE because AP and SC replicas
-	// are tracked separately for batch (AS_ASYNC_FLAGS_MASTER and AS_ASYNC_FLAGS_MASTER_SC).
+	// are tracked separately for batch (replica_index and AS_ASYNC_FLAGS_MASTER_SC).
 	// SC master/replica switch is done in as_batch_retry_async().
-	uint8_t flags = AS_ASYNC_FLAGS_READ | AS_ASYNC_FLAGS_MASTER | AS_ASYNC_FLAGS_MASTER_SC;
+	uint8_t flags = AS_ASYNC_FLAGS_READ | AS_ASYNC_FLAGS_MASTER_SC;
 
 	as_status status = AEROSPIKE_OK;
 
@@ -1184,8 +1961,8 @@ as_batch_read_execute_async(
 
 		if (! (policy->base.compress && size > AS_COMPRESS_THRESHOLD)) {
 			// Send uncompressed command.
-			as_event_command* cmd = as_batch_read_command_create(cluster, policy, batch_node->node,
-				executor, size, flags);
+			as_event_command* cmd = as_batch_command_create(cluster, policy, batch_node->node,
+				exec, as_batch_async_parse_records, size, batch_node->offsets.size, flags);
 
 			cmd->write_len = (uint32_t)as_batch_index_records_write(records, &batch_node->offsets,
 				policy, cmd->buf, field_count_header, filter_size, NULL);
@@ -1203,8 +1980,8 @@ as_batch_read_execute_async(
 			// Allocate command with compressed upper bound.
 			size_t comp_size = as_command_compress_max_size(size);
 
-			as_event_command* cmd = as_batch_read_command_create(cluster, policy, batch_node->node,
-				executor, comp_size, flags);
+			as_event_command* cmd = as_batch_command_create(cluster, policy, batch_node->node,
+				exec, as_batch_async_parse_records, comp_size, batch_node->offsets.size, flags);
 
 			// Compress buffer and execute.
 			status = as_command_compress(err, buf, size, cmd->buf, &comp_size);
@@ -1213,7 +1990,7 @@ as_batch_read_execute_async(
 			if (status != AEROSPIKE_OK) {
 				as_event_executor_cancel(exec, i);
 				as_batch_release_nodes_cancel_async(batch_nodes, i + 1);
-				cf_free(cmd);
+				as_slab_free(cmd);
 				break;
 			}
 			cmd->write_len = (uint32_t)comp_size;
@@ -1230,10 +2007,30 @@ as_batch_read_execute_async(
 	return status;
 }
 
+static as_status
+as_batch_records_set_digests(as_error* err, as_vector* list)
+{
+	as_key* keys[AS_RIPEMD160_LANES];
+	uint32_t n = 0;
+
+	// The key is the first field of both as_batch_read_record and as_batch_write_record.
+	for (uint32_t i = 0; i < list->size; i++) {
+		keys[n++] = as_vector_get(list, i);
+
+		if (n == AS_RIPEMD160_LANES || i + 1 == list->size) {
+			as_status status = as_keys_set_digests_ptr(err, keys, n);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+			n = 0;
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
 static void
-as_batch_read_cleanup(
-	as_async_batch_executor* async_executor, as_nodes* nodes, as_vector* batch_nodes
-	)
+as_batch_cleanup(void* async_executor, as_nodes* nodes, as_vector* batch_nodes)
 {
 	if (batch_nodes) {
 		as_batch_release_nodes(batch_nodes);
@@ -1251,7 +2048,7 @@ as_batch_read_cleanup(
 static as_status
 as_batch_records_execute(
 	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_read_records* records,
-	as_async_batch_executor* async_executor
+	as_batch_read_stream_callback callback, void* udata, as_async_batch_executor* async_executor
 	)
 {
 	if (! policy) {
@@ -1270,7 +2067,7 @@ as_batch_records_execute(
 	uint32_t n_nodes = nodes->size;
 	
 	if (n_nodes == 0) {
-		as_batch_read_cleanup(async_executor, nodes, NULL);
+		as_batch_cleanup(async_executor, nodes, NULL);
 		return as_error_set_message(err, AEROSPIKE_ERR_SERVER, cluster_empty_error);
 	}
 	
@@ -1278,70 +2075,238 @@ as_batch_records_execute(
 	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
 
 	as_status status = AEROSPIKE_OK;
+	as_policy_replica replica_sc = as_batch_get_replica_sc(policy);
+
+	// Compute digests several keys at a time before mapping keys to nodes.
+	status = as_batch_records_set_digests(err, list);
+
+	if (status != AEROSPIKE_OK) {
+		as_batch_cleanup(async_executor, nodes, &batch_nodes);
+		return status;
+	}
+
+	// Streamed records start without a response so records resent on retry are only
+	// delivered once.
+	bool stream = callback || (async_executor && async_executor->stream_listener);
+	as_status initial_result = stream ? AEROSPIKE_NO_RESPONSE : AEROSPIKE_ERR_RECORD_NOT_FOUND;
+
+	as_batch_group group;
+	as_batch_group_init(&group, &batch_nodes, n_nodes, n_keys);
+
+	// Map keys to server nodes.
+	for (uint32_t i = 0; i < n_keys; i++) {
+		as_batch_read_record* record = as_vector_get(list, i);
+		as_key* key = &record->key;
+		
+		record->result = initial_result;
+		as_record_init(&record->record, 0);
+		
+		as_node* node;
+		status = as_batch_get_node(cluster, err, key, policy->replica, replica_sc, 0, true,
+								   false, &node);
+
+		if (status != AEROSPIKE_OK) {
+			as_batch_group_destroy(&group);
+			as_batch_cleanup(async_executor, nodes, NULL);
+			return status;
+		}
+
+		as_batch_group_add(&group, node, i);
+	}
+	as_batch_group_finish(&group);
+	as_nodes_release(nodes);
+
+	if (policy->split_keys) {
+		as_batch_split_nodes(policy, &batch_nodes);
+	}
 	
-	// Create initial key capacity for each node as average + 25%.
-	uint32_t offsets_capacity = n_keys / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
+	if (async_executor) {
+		return as_batch_read_execute_async(cluster, err, policy, replica_sc, list,
+										   &batch_nodes, async_executor);
+	}
 	
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
+	return as_batch_execute_sync(cluster, err, policy, replica_sc, list, n_keys, &batch_nodes,
+								 NULL, NULL, callback, udata);
+}
+
+static void
+as_batch_write_complete_async(as_event_executor* executor)
+{
+	as_async_batch_write_executor* e = (as_async_batch_write_executor*)executor;
+
+	if (executor->err) {
+		as_batch_write_set_error(&e->records->list, NULL, executor->err);
+	}
+	e->listener(executor->err, e->records, executor->udata, executor->event_loop);
+}
+
+static as_status
+as_batch_write_execute_async(
+	as_cluster* cluster, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_vector* records, as_vector* batch_nodes,
+	as_async_batch_write_executor* executor
+	)
+{
+	uint32_t n_batch_nodes = batch_nodes->size;
+	as_event_executor* exec = &executor->executor;
+	exec->max_concurrent = exec->max = exec->queued = n_batch_nodes;
+
+	// Writes are only sent to the master.  Leave read flag unset, so in_doubt is tracked.
+	uint8_t flags = AS_ASYNC_FLAGS_MASTER_SC;
+
+	as_status status = AEROSPIKE_OK;
+
+	for (uint32_t i = 0; i < n_batch_nodes; i++) {
+		as_batch_node* batch_node = as_vector_get(batch_nodes, i);
+
+		// Estimate buffer size.
+		as_batch_write_plan plan;
+		size_t size = as_batch_size_writes(policy, policy_write, records, &batch_node->offsets,
+										   &plan);
+
+		if (! (policy->base.compress && size > AS_COMPRESS_THRESHOLD)) {
+			// Send uncompressed command.
+			as_event_command* cmd = as_batch_command_create(cluster, policy, batch_node->node,
+				exec, as_batch_async_parse_writes, size, 0, flags);
+
+			cmd->replica = AS_POLICY_REPLICA_MASTER;
+			cmd->write_len = (uint32_t)as_batch_index_writes_write(policy, policy_write, records,
+				&batch_node->offsets, &plan, cmd->buf);
+			as_batch_write_plan_destroy(&plan);
+
+			status = as_event_command_execute(cmd, err);
+		}
+		else {
+			// Send compressed command.
+			// First write uncompressed buffer.
+			size_t capacity = size;
+			uint8_t* buf = as_command_buffer_init(capacity);
+			size = as_batch_index_writes_write(policy, policy_write, records, &batch_node->offsets,
+											   &plan, buf);
+			as_batch_write_plan_destroy(&plan);
+
+			// Allocate command with compressed upper bound.
+			size_t comp_size = as_command_compress_max_size(size);
+
+			as_event_command* cmd = as_batch_command_create(cluster, policy, batch_node->node,
+				exec, as_batch_async_parse_writes, comp_size, 0, flags);
+
+			cmd->replica = AS_POLICY_REPLICA_MASTER;
+
+			// Compress buffer and execute.
+			status = as_command_compress(err, buf, size, cmd->buf, &comp_size);
+			as_command_buffer_free(buf, capacity);
+
+			if (status != AEROSPIKE_OK) {
+				as_event_executor_cancel(exec, i);
+				as_batch_release_nodes_cancel_async(batch_nodes, i + 1);
+				as_slab_free(cmd);
+				break;
+			}
+			cmd->write_len = (uint32_t)comp_size;
+			status = as_event_command_execute(cmd, err);
+		}
+
+		if (status != AEROSPIKE_OK) {
+			as_event_executor_cancel(exec, i);
+			as_batch_release_nodes_cancel_async(batch_nodes, i + 1);
+			break;
+		}
+	}
+	as_batch_release_nodes_after_async(batch_nodes);
+	return status;
+}
+
+static as_status
+as_batch_writes_execute(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_write_records* records,
+	as_async_batch_write_executor* async_executor
+	)
+{
+	as_policy_batch policy_local;
+
+	if (! policy) {
+		// Write batches should not retry by default.
+		as_policy_batch_copy(&as->config.policies.batch, &policy_local);
+		policy_local.base.max_retries = 0;
+		policy = &policy_local;
+	}
+
+	const as_policy_batch_write* policy_write = &as->config.policies.batch_write;
+	as_vector* list = &records->list;
+	uint32_t n_keys = records->list.size;
+
+	if (n_keys == 0) {
+		return AEROSPIKE_OK;
+	}
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		as_batch_write_record* record = as_vector_get(list, i);
+
+		if ((record->type == AS_BATCH_WRITE_PUT && ! record->rec) ||
+			(record->type == AS_BATCH_WRITE_OPERATE &&
+			 (! record->ops || record->ops->binops.size == 0))) {
+			if (async_executor) {
+				cf_free(async_executor);
+			}
+			return as_error_update(err, AEROSPIKE_ERR_PARAM,
+								   "Batch record %u has no bins or operations", i);
+		}
+	}
+
+	as_cluster* cluster = as->cluster;
+	as_nodes* nodes = as_nodes_reserve(cluster);
+	uint32_t n_nodes = nodes->size;
+
+	if (n_nodes == 0) {
+		as_batch_cleanup(async_executor, nodes, NULL);
+		return as_error_set_message(err, AEROSPIKE_ERR_SERVER, cluster_empty_error);
+	}
+
+	as_vector batch_nodes;
+	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
+
+	// Compute digests several keys at a time before mapping keys to nodes.
+	as_status status = as_batch_records_set_digests(err, list);
+
+	if (status != AEROSPIKE_OK) {
+		as_batch_cleanup(async_executor, nodes, &batch_nodes);
+		return status;
 	}
-	
-	as_policy_replica replica_sc = as_batch_get_replica_sc(policy);
 
-	// Map keys to server nodes.
+	as_batch_group group;
+	as_batch_group_init(&group, &batch_nodes, n_nodes, n_keys);
+
+	// Map keys to partition master nodes.
 	for (uint32_t i = 0; i < n_keys; i++) {
-		as_batch_read_record* record = as_vector_get(list, i);
-		as_key* key = &record->key;
-		
-		record->result = AEROSPIKE_ERR_RECORD_NOT_FOUND;
+		as_batch_write_record* record = as_vector_get(list, i);
+
+		record->result = AEROSPIKE_NO_RESPONSE;
+		record->in_doubt = false;
 		as_record_init(&record->record, 0);
-		
-		status = as_key_set_digest(err, key);
-		
-		if (status != AEROSPIKE_OK) {
-			as_batch_read_cleanup(async_executor, nodes, &batch_nodes);
-			return status;
-		}
-		
+
 		as_node* node;
-		status = as_batch_get_node(cluster, err, key, policy->replica, replica_sc, true, true,
-								   false, &node);
+		status = as_batch_get_node(cluster, err, &record->key, AS_POLICY_REPLICA_MASTER,
+								   AS_POLICY_REPLICA_MASTER, true, true, false, &node);
 
 		if (status != AEROSPIKE_OK) {
-			as_batch_read_cleanup(async_executor, nodes, &batch_nodes);
+			as_batch_group_destroy(&group);
+			as_batch_cleanup(async_executor, nodes, NULL);
 			return status;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
-		
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
-			
-			if (n_keys <= 5000) {
-				// All keys and offsets should fit on stack.
-				as_vector_inita(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
-			else {
-				// Allocate vector on heap to avoid stack overflow.
-				as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
-		}
-		as_vector_append(&batch_node->offsets, &i);
+		as_batch_group_add(&group, node, i);
 	}
+	as_batch_group_finish(&group);
 	as_nodes_release(nodes);
-	
+
 	if (async_executor) {
-		return as_batch_read_execute_async(cluster, err, policy, replica_sc, list,
-										   &batch_nodes, async_executor);
+		return as_batch_write_execute_async(cluster, err, policy, policy_write, list,
+											&batch_nodes, async_executor);
 	}
-	
-	return as_batch_read_execute_sync(cluster, err, policy, replica_sc, list, n_keys,
-									  &batch_nodes, NULL);
+
+	return as_batch_execute_sync(cluster, err, policy, AS_POLICY_REPLICA_MASTER, list, n_keys,
+								 &batch_nodes, NULL, policy_write, NULL, NULL);
 }
 
 /******************************************************************************
@@ -1366,60 +2331,60 @@ as_batch_retry_records(as_batch_task_records* btr, as_command* parent, as_error*
 	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
 
 	as_status status = AEROSPIKE_OK;
-
-	// Create initial key capacity for each node as average + 25%.
 	uint32_t offsets_size = task->offsets.size;
-	uint32_t offsets_capacity = offsets_size / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
 
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
-	}
+	as_batch_group group;
+	as_batch_group_init(&group, &batch_nodes, n_nodes, offsets_size);
 
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < offsets_size; i++) {
 		uint32_t offset = *(uint32_t*)as_vector_get(&task->offsets, i);
 		as_batch_read_record* record = as_vector_get(btr->records, offset);
+
+		if (btr->callback && record->result != AEROSPIKE_NO_RESPONSE) {
+			// Record was already streamed.
+			continue;
+		}
+
 		as_key* key = &record->key;
 
 		as_node* node;
 		status = as_batch_get_node(cluster, err, key, task->policy->replica, task->replica_sc,
-								   parent->master, parent->master_sc, true, &node);
+								   parent->replica_index, parent->master_sc, true, &node);
 
 		if (status != AEROSPIKE_OK) {
-			as_batch_release_nodes(&batch_nodes);
+			as_batch_group_destroy(&group);
 			as_nodes_release(nodes);
 			return status;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
+		as_batch_group_add(&group, node, offset);
+	}
+
+	uint32_t n_pending = group.n_keys;
 
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
+	as_batch_group_finish(&group);
+	as_nodes_release(nodes);
 
-			// Allocate vector on heap to avoid stack overflow.
-			as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-		}
-		as_vector_append(&batch_node->offsets, &offset);
+	if (n_pending == 0) {
+		// Every streamed record was delivered before the command failed.
+		as_batch_release_nodes(&batch_nodes);
+		as_error_reset(err);
+		return AEROSPIKE_OK;
 	}
-	as_nodes_release(nodes);
 
-	if (batch_nodes.size == 1) {
+	if (batch_nodes.size == 1 && n_pending == offsets_size) {
 		as_batch_node* batch_node = as_vector_get(&batch_nodes, 0);
 
 		if (batch_node->node == task->node) {
-			// Batch node is the same.
+			// Batch node and records are the same.
 			as_batch_release_nodes(&batch_nodes);
 			return AEROSPIKE_USE_NORMAL_RETRY;
 		}
 	}
 
-	return as_batch_read_execute_sync(cluster, err, task->policy, task->replica_sc, list,
-									  task->n_keys, &batch_nodes, parent);
+	return as_batch_execute_sync(cluster, err, task->policy, task->replica_sc, list,
+								 task->n_keys, &batch_nodes, parent, NULL, btr->callback, btr->udata);
 }
 
 static as_status
@@ -1439,16 +2404,10 @@ as_batch_retry_keys(as_batch_task_keys* btk, as_command* parent, as_error* err)
 	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
 
 	as_status status = AEROSPIKE_OK;
-
-	// Create initial key capacity for each node as average + 25%.
 	uint32_t offsets_size = task->offsets.size;
-	uint32_t offsets_capacity = offsets_size / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
 
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
-	}
+	as_batch_group group;
+	as_batch_group_init(&group, &batch_nodes, n_nodes, offsets_size);
 
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < offsets_size; i++) {
@@ -1457,27 +2416,17 @@ as_batch_retry_keys(as_batch_task_keys* btk, as_command* parent, as_error* err)
 
 		as_node* node;
 		status = as_batch_get_node(cluster, err, key, task->policy->replica, task->replica_sc,
-								   parent->master, parent->master_sc, true, &node);
+								   parent->replica_index, parent->master_sc, true, &node);
 
 		if (status != AEROSPIKE_OK) {
-			as_batch_release_nodes(&batch_nodes);
+			as_batch_group_destroy(&group);
 			as_nodes_release(nodes);
 			return status;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
-
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
-
-			// Allocate vector on heap to avoid stack overflow.
-			as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-		}
-		as_vector_append(&batch_node->offsets, &offset);
+		as_batch_group_add(&group, node, offset);
 	}
+	as_batch_group_finish(&group);
 	as_nodes_release(nodes);
 
 	if (batch_nodes.size == 1) {
@@ -1504,6 +2453,77 @@ as_batch_retry_keys(as_batch_task_keys* btk, as_command* parent, as_error* err)
 	return status;
 }
 
+static as_status
+as_batch_retry_writes(as_batch_task_records* btr, as_command* parent, as_error* err)
+{
+	as_batch_task* task = &btr->base;
+	as_cluster* cluster = task->cluster;
+	as_nodes* nodes = as_nodes_reserve(cluster);
+	uint32_t n_nodes = nodes->size;
+
+	if (n_nodes == 0) {
+		as_nodes_release(nodes);
+		return as_error_set_message(err, AEROSPIKE_ERR_SERVER, cluster_empty_error);
+	}
+
+	as_vector batch_nodes;
+	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
+
+	as_status status = AEROSPIKE_OK;
+	uint32_t offsets_size = task->offsets.size;
+
+	as_batch_group group;
+	as_batch_group_init(&group, &batch_nodes, n_nodes, offsets_size);
+
+	// Map records that did not receive a response to their current master.  The master
+	// may have changed since the batch was split.
+	for (uint32_t i = 0; i < offsets_size; i++) {
+		uint32_t offset = *(uint32_t*)as_vector_get(&task->offsets, i);
+		as_batch_write_record* record = as_vector_get(btr->records, offset);
+
+		if (record->result != AEROSPIKE_NO_RESPONSE) {
+			continue;
+		}
+
+		as_node* node;
+		status = as_batch_get_node(cluster, err, &record->key, AS_POLICY_REPLICA_MASTER,
+								   AS_POLICY_REPLICA_MASTER, 0, true, true, &node);
+
+		if (status != AEROSPIKE_OK) {
+			as_batch_group_destroy(&group);
+			as_nodes_release(nodes);
+			return status;
+		}
+
+		as_batch_group_add(&group, node, offset);
+	}
+
+	uint32_t n_pending = group.n_keys;
+
+	as_batch_group_finish(&group);
+	as_nodes_release(nodes);
+
+	if (n_pending == 0) {
+		// Every record received a response before the command failed.
+		as_batch_release_nodes(&batch_nodes);
+		as_error_reset(err);
+		return AEROSPIKE_OK;
+	}
+
+	if (batch_nodes.size == 1 && n_pending == offsets_size) {
+		as_batch_node* batch_node = as_vector_get(&batch_nodes, 0);
+
+		if (batch_node->node == task->node) {
+			// Batch node and records are the same.
+			as_batch_release_nodes(&batch_nodes);
+			return AEROSPIKE_USE_NORMAL_RETRY;
+		}
+	}
+
+	return as_batch_execute_sync(cluster, err, task->policy, task->replica_sc, btr->records,
+								 task->n_keys, &batch_nodes, parent, btr->policy_write, NULL, NULL);
+}
+
 as_status
 as_batch_retry(as_command* parent, as_error* err)
 {
@@ -1516,10 +2536,16 @@ as_batch_retry(as_command* parent, as_error* err)
 		return err->code;
 	}
 
+	if (task->has_write) {
+		// Only records without a response are retried.
+		return as_batch_retry_writes((as_batch_task_records*)task, parent, err);
+	}
+
 	const as_policy_batch* policy = task->policy;
 	as_policy_replica replica = policy->replica;
 
-	if (!(replica == AS_POLICY_REPLICA_SEQUENCE || replica == AS_POLICY_REPLICA_PREFER_RACK)) {
+	if (!(replica == AS_POLICY_REPLICA_SEQUENCE || replica == AS_POLICY_REPLICA_PREFER_RACK ||
+		  replica == AS_POLICY_REPLICA_LOWEST_LATENCY)) {
 		// Node assignment will not change.
 		return AEROSPIKE_USE_NORMAL_RETRY;
 	}
@@ -1539,13 +2565,14 @@ as_batch_retry(as_command* parent, as_error* err)
 
 static inline as_event_command*
 as_batch_retry_command_create(
-	as_event_command* parent, as_node* node, size_t size, uint64_t deadline, uint8_t flags
+	as_event_command* parent, as_node* node, size_t size, uint32_t n_keys, uint64_t deadline,
+	uint8_t flags
 	)
 {
 	// Allocate enough memory to cover, then, round up memory size in 8KB increments to reduce
 	// fragmentation and to allow socket read to reuse buffer.
 	size_t s = (sizeof(as_async_batch_command) + size + AS_AUTHENTICATION_MAX_SIZE + 8191) & ~8191;
-	as_event_command* cmd = cf_malloc(s);
+	as_event_command* cmd = as_slab_alloc(parent->event_loop->slab, s);
 	cmd->total_deadline = deadline;
 	cmd->socket_timeout = parent->socket_timeout;
 	cmd->max_retries = parent->max_retries;
@@ -1567,12 +2594,22 @@ as_batch_retry_command_create(
 	cmd->state = AS_ASYNC_STATE_UNREGISTERED;
 	cmd->flags = flags;
 	cmd->flags2 = parent->flags2;
+	cmd->replica_index = parent->replica_index;
+	cmd->stats_begin = parent->stats_begin;
+	((as_async_batch_command*)cmd)->begin = cf_getns();
+	((as_async_batch_command*)cmd)->n_keys = n_keys;
 	return cmd;
 }
 
 int
 as_batch_retry_async(as_event_command* parent, bool timeout)
 {
+	if (parent->parse_results == as_batch_async_parse_writes) {
+		// Write batches are only sent to the master.  The send buffer is not parsed
+		// for split retry, so resend the command to the same node.
+		return 1;  // Go through normal retry.
+	}
+
 	as_async_batch_executor* executor = parent->udata; // udata is overloaded to contain executor.
 
 	if (! executor->executor.valid) {
@@ -1580,7 +2617,8 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 	}
 
 	if (!(parent->replica == AS_POLICY_REPLICA_SEQUENCE ||
-		  parent->replica == AS_POLICY_REPLICA_PREFER_RACK)) {
+		  parent->replica == AS_POLICY_REPLICA_PREFER_RACK ||
+		  parent->replica == AS_POLICY_REPLICA_LOWEST_LATENCY)) {
 		return 1;  // Go through normal retry.
 	}
 
@@ -1685,15 +2723,6 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 	p += sizeof(uint32_t);
 	policy.allow_inline = (bool)*p++;
 
-	// Create initial key capacity for each node as average + 25%.
-	uint32_t offsets_capacity = offsets_size / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
-
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
-	}
-
 	if (! timeout || policy.read_mode_sc != AS_POLICY_READ_MODE_SC_LINEARIZE) {
 		parent->flags ^= AS_ASYNC_FLAGS_MASTER_SC;  // Alternate between SC master and prole.
 	}
@@ -1701,6 +2730,9 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 	as_vector batch_nodes;
 	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
 
+	as_batch_group group;
+	as_batch_group_init(&group, &batch_nodes, n_nodes, offsets_size);
+
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < offsets_size; i++) {
 		uint32_t offset = cf_swap_from_be32(*(uint32_t*)p);
@@ -1711,12 +2743,12 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 
 		as_node* node;
 		status = as_batch_get_node(cluster, &err, key, policy.replica, executor->replica_sc,
-								   parent->flags & AS_ASYNC_FLAGS_MASTER,
+								   parent->replica_index,
 								   parent->flags & AS_ASYNC_FLAGS_MASTER_SC,
 								   true, &node);
 
 		if (status != AEROSPIKE_OK) {
-			as_batch_release_nodes(&batch_nodes);
+			as_batch_group_destroy(&group);
 			as_nodes_release(nodes);
 
 			// Close parent command with error.
@@ -1729,18 +2761,7 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 			return -1;  // Abort all retries.
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
-
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
-
-			// Allocate vector on heap to avoid stack overflow.
-			as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-		}
-		as_vector_append(&batch_node->offsets, &offset);
+		as_batch_group_add(&group, node, offset);
 
 		p += AS_DIGEST_VALUE_SIZE;
 
@@ -1762,6 +2783,7 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 			}
 		}
 	}
+	as_batch_group_finish(&group);
 	as_nodes_release(nodes);
 
 	if (batch_nodes.size == 1) {
@@ -1805,8 +2827,7 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 	e->queued = e->max;
 	pthread_mutex_unlock(&e->lock);
 
-	uint8_t flags = AS_ASYNC_FLAGS_READ | (parent->flags & AS_ASYNC_FLAGS_MASTER) |
-					(parent->flags & AS_ASYNC_FLAGS_MASTER_SC);
+	uint8_t flags = AS_ASYNC_FLAGS_READ | (parent->flags & AS_ASYNC_FLAGS_MASTER_SC);
 
 	for (uint32_t i = 0; i < batch_nodes.size; i++) {
 		as_batch_node* batch_node = as_vector_get(&batch_nodes, i);
@@ -1818,7 +2839,7 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 
 		if (! (policy.base.compress && size > AS_COMPRESS_THRESHOLD)) {
 			as_event_command* cmd = as_batch_retry_command_create(parent, batch_node->node, size,
-									deadline, flags);
+									batch_node->offsets.size, deadline, flags);
 
 			cmd->write_len = (uint32_t)as_batch_index_records_write(records, &batch_node->offsets,
 									&policy, cmd->buf, field_count_header, filter_size, filter_field);
@@ -1838,7 +2859,7 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 			size_t comp_size = as_command_compress_max_size(size);
 
 			as_event_command* cmd = as_batch_retry_command_create(parent, batch_node->node,
-									comp_size, deadline, flags);
+									comp_size, batch_node->offsets.size, deadline, flags);
 
 			// Compress buffer and execute.
 			status = as_command_compress(&err, buf, size, cmd->buf, &comp_size);
@@ -1847,7 +2868,7 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 			if (status != AEROSPIKE_OK) {
 				as_event_executor_error(e, &err, batch_nodes.size - i);
 				as_batch_release_nodes_cancel_async(&batch_nodes, i + 1);
-				cf_free(cmd);
+				as_slab_free(cmd);
 				break;
 			}
 
@@ -1880,7 +2901,40 @@ aerospike_batch_read(
 	)
 {
 	as_error_reset(err);
-	return as_batch_records_execute(as, err, policy, records, 0);
+	return as_batch_records_execute(as, err, policy, records, NULL, NULL, NULL);
+}
+
+static as_status
+as_batch_records_execute_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_read_records* records,
+	as_async_batch_listener listener, as_async_batch_read_stream_listener stream_listener,
+	void* udata, as_event_loop* event_loop
+	)
+{
+
+	// Batch will be split up into a command for each node.
+	// Allocate batch data shared by each command.
+	as_async_batch_executor* executor = cf_malloc(sizeof(as_async_batch_executor));
+	as_event_executor* exec = &executor->executor;
+	pthread_mutex_init(&exec->lock, NULL);
+	exec->commands = 0;
+	exec->event_loop = as_event_assign(event_loop);
+	exec->complete_fn = as_batch_complete_async;
+	exec->udata = udata;
+	exec->err = NULL;
+	exec->ns = NULL;
+	exec->cluster_key = 0;
+	exec->max_concurrent = 0;
+	exec->max = 0;
+	exec->count = 0;
+	exec->queued = 0;
+	exec->notify = true;
+	exec->valid = true;
+	executor->records = records;
+	executor->listener = listener;
+	executor->stream_listener = stream_listener;
+
+	return as_batch_records_execute(as, err, policy, records, NULL, NULL, executor);
 }
 
 as_status
@@ -1896,15 +2950,107 @@ aerospike_batch_read_async(
 		listener(0, records, udata, event_loop);
 		return AEROSPIKE_OK;
 	}
+	return as_batch_records_execute_async(as, err, policy, records, listener, NULL, udata,
+										  event_loop);
+}
+
+as_status
+aerospike_batch_read_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_read_records* records,
+	as_batch_read_stream_callback callback, void* udata
+	)
+{
+	as_error_reset(err);
+	return as_batch_records_execute(as, err, policy, records, callback, udata, NULL);
+}
+
+as_status
+aerospike_batch_read_stream_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_read_records* records,
+	as_async_batch_read_stream_listener listener, void* udata, as_event_loop* event_loop
+	)
+{
+	as_error_reset(err);
+
+	// Check for empty batch.
+	if (records->list.size == 0) {
+		listener(0, NULL, 0, udata, event_loop);
+		return AEROSPIKE_OK;
+	}
+	return as_batch_records_execute_async(as, err, policy, records, NULL, listener, udata,
+										  event_loop);
+}
+
+/**
+ * Destroy keys and records in record list.  It's the responsility of the caller to
+ * free `as_batch_read_record.bin_names` when necessary.
+ */
+void
+as_batch_read_destroy(as_batch_read_records* records)
+{
+	as_vector* list = &records->list;
 	
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_batch_read_record* record = as_vector_get(list, i);
+		
+		// Destroy key.
+		as_key_destroy(&record->key);
+		
+		// Destroy record if exists.
+		if (record->result == AEROSPIKE_OK) {
+			as_record_destroy(&record->record);
+		}
+	}
+	as_vector_destroy(list);
+}
+
+static inline void
+as_batch_write_set_type(
+	as_batch_write_records* records, as_batch_write_type type,
+	const as_policy_batch_write* policy_write, as_operations* ops
+	)
+{
+	as_vector* list = &records->list;
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_batch_write_record* record = as_vector_get(list, i);
+		record->type = type;
+		record->policy = policy_write;
+		record->ops = ops;
+	}
+}
+
+as_status
+aerospike_batch_write(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_write_records* records
+	)
+{
+	as_error_reset(err);
+	return as_batch_writes_execute(as, err, policy, records, NULL);
+}
+
+as_status
+aerospike_batch_write_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_write_records* records,
+	as_async_batch_write_listener listener, void* udata, as_event_loop* event_loop
+	)
+{
+	as_error_reset(err);
+
+	// Check for empty batch.
+	if (records->list.size == 0) {
+		listener(0, records, udata, event_loop);
+		return AEROSPIKE_OK;
+	}
+
 	// Batch will be split up into a command for each node.
 	// Allocate batch data shared by each command.
-	as_async_batch_executor* executor = cf_malloc(sizeof(as_async_batch_executor));
+	as_async_batch_write_executor* executor = cf_malloc(sizeof(as_async_batch_write_executor));
 	as_event_executor* exec = &executor->executor;
 	pthread_mutex_init(&exec->lock, NULL);
 	exec->commands = 0;
 	exec->event_loop = as_event_assign(event_loop);
-	exec->complete_fn = as_batch_complete_async;
+	exec->complete_fn = as_batch_write_complete_async;
 	exec->udata = udata;
 	exec->err = NULL;
 	exec->ns = NULL;
@@ -1918,24 +3064,66 @@ aerospike_batch_read_async(
 	executor->records = records;
 	executor->listener = listener;
 
-	return as_batch_records_execute(as, err, policy, records, executor);
+	return as_batch_writes_execute(as, err, policy, records, executor);
+}
+
+as_status
+aerospike_batch_operate(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records, as_operations* ops
+	)
+{
+	as_batch_write_set_type(records, AS_BATCH_WRITE_OPERATE, policy_write, ops);
+	return aerospike_batch_write(as, err, policy, records);
+}
+
+as_status
+aerospike_batch_operate_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records, as_operations* ops,
+	as_async_batch_write_listener listener, void* udata, as_event_loop* event_loop
+	)
+{
+	as_batch_write_set_type(records, AS_BATCH_WRITE_OPERATE, policy_write, ops);
+	return aerospike_batch_write_async(as, err, policy, records, listener, udata, event_loop);
+}
+
+as_status
+aerospike_batch_remove(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records
+	)
+{
+	as_batch_write_set_type(records, AS_BATCH_WRITE_REMOVE, policy_write, NULL);
+	return aerospike_batch_write(as, err, policy, records);
+}
+
+as_status
+aerospike_batch_remove_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy,
+	const as_policy_batch_write* policy_write, as_batch_write_records* records,
+	as_async_batch_write_listener listener, void* udata, as_event_loop* event_loop
+	)
+{
+	as_batch_write_set_type(records, AS_BATCH_WRITE_REMOVE, policy_write, NULL);
+	return aerospike_batch_write_async(as, err, policy, records, listener, udata, event_loop);
 }
 
 /**
- * Destroy keys and records in record list.  It's the responsility of the caller to
- * free `as_batch_read_record.bin_names` when necessary.
+ * Destroy keys and result records in record list.  It's the responsility of the caller to
+ * destroy `as_batch_write_record.rec` and `as_batch_write_record.ops` when necessary.
  */
 void
-as_batch_read_destroy(as_batch_read_records* records)
+as_batch_write_destroy(as_batch_write_records* records)
 {
 	as_vector* list = &records->list;
-	
+
 	for (uint32_t i = 0; i < list->size; i++) {
-		as_batch_read_record* record = as_vector_get(list, i);
-		
+		as_batch_write_record* record = as_vector_get(list, i);
+
 		// Destroy key.
 		as_key_destroy(&record->key);
-		
+
 		// Destroy record if exists.
 		if (record->result == AEROSPIKE_OK) {
 			as_record_destroy(&record->record);
@@ -1954,7 +3142,7 @@ aerospike_batch_get(
 	)
 {
 	return as_batch_keys_execute(as, err, policy, batch, AS_MSG_INFO1_READ | AS_MSG_INFO1_GET_ALL,
-								 NULL, 0, callback, NULL, udata);
+								 NULL, 0, callback, NULL, NULL, udata);
 }
 
 /**
@@ -1969,7 +3157,20 @@ aerospike_batch_get_xdr(
 	)
 {
 	return as_batch_keys_execute(as, err, policy, batch, AS_MSG_INFO1_READ | AS_MSG_INFO1_GET_ALL,
-								 NULL, 0, NULL, callback, udata);
+								 NULL, 0, NULL, callback, NULL, udata);
+}
+
+/**
+ * Look up multiple records by key, then return all bins as record views.
+ */
+as_status
+aerospike_batch_get_view(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
+	as_batch_view_callback callback, void* udata
+	)
+{
+	return as_batch_keys_execute(as, err, policy, batch, AS_MSG_INFO1_READ | AS_MSG_INFO1_GET_ALL,
+								 NULL, 0, NULL, NULL, callback, udata);
 }
 
 /**
@@ -1982,7 +3183,7 @@ aerospike_batch_get_bins(
 	)
 {
 	return as_batch_keys_execute(as, err, policy, batch, AS_MSG_INFO1_READ, bins, n_bins, callback,
-								 NULL, udata);
+								 NULL, NULL, udata);
 }
 
 /**
@@ -1996,5 +3197,5 @@ aerospike_batch_exists(
 {
 	return as_batch_keys_execute(as, err, policy, batch,
 								 AS_MSG_INFO1_READ | AS_MSG_INFO1_GET_NOBINDATA, NULL, 0, callback,
-								 NULL, udata);
+								 NULL, NULL, udata);
 }
@@ -89,7 +89,8 @@ as_command_init_read(
 				break;
 
 			case AS_POLICY_READ_MODE_SC_LINEARIZE:
-				cmd->replica = (replica != AS_POLICY_REPLICA_PREFER_RACK) ?
+				cmd->replica = (replica != AS_POLICY_REPLICA_PREFER_RACK &&
+								replica != AS_POLICY_REPLICA_LOWEST_LATENCY) ?
 								replica : AS_POLICY_REPLICA_SEQUENCE;
 				cmd->flags = AS_COMMAND_FLAGS_READ | AS_COMMAND_FLAGS_LINEARIZE;
 				break;
@@ -108,14 +109,25 @@ as_command_init_read(
 
 static inline as_status
 as_command_execute_read(
-	as_cluster* cluster, as_error* err, const as_policy_base* policy, as_policy_replica replica,
-	as_policy_read_mode_sc read_mode_sc, uint8_t* buf, size_t size, as_partition_info* pi,
-	const as_parse_results_fn fn, void* udata
+	as_cluster* cluster, as_error* err, const as_policy_read* policy, uint8_t* buf, size_t size,
+	as_partition_info* pi, const as_parse_results_fn fn, void* udata
 	)
 {
 	as_command cmd;
-	as_command_init_read(&cmd, cluster, policy, replica, read_mode_sc, size, pi,
-						 fn, udata);
+	as_command_init_read(&cmd, cluster, &policy->base, policy->replica, policy->read_mode_sc,
+						 size, pi, fn, udata);
+
+	if ((policy->hedge_delay > 0 || policy->hedge_percentile > 0) &&
+		cmd.replica != AS_POLICY_REPLICA_MASTER) {
+		cmd.flags |= AS_COMMAND_FLAGS_HEDGE;
+		cmd.hedge_delay = policy->hedge_delay;
+		cmd.hedge_percentile = policy->hedge_percentile;
+	}
+
+	if (fn == as_command_parse_result_view) {
+		// The view takes ownership of the response buffer.
+		cmd.flags |= AS_COMMAND_FLAGS_VIEW;
+	}
 
 	cmd.buf = buf;
 	as_command_start_timer(&cmd);
@@ -150,24 +162,38 @@ as_event_command_init_read(
 		switch (read_mode_sc) {
 			case AS_POLICY_READ_MODE_SC_SESSION:
 				ri->replica = AS_POLICY_REPLICA_MASTER;
-				ri->flags = AS_ASYNC_FLAGS_MASTER | AS_ASYNC_FLAGS_READ;
+				ri->flags = AS_ASYNC_FLAGS_READ;
 				break;
 
 			case AS_POLICY_READ_MODE_SC_LINEARIZE:
-				ri->replica = (replica != AS_POLICY_REPLICA_PREFER_RACK) ?
+				ri->replica = (replica != AS_POLICY_REPLICA_PREFER_RACK &&
+							   replica != AS_POLICY_REPLICA_LOWEST_LATENCY) ?
 							   replica : AS_POLICY_REPLICA_SEQUENCE;
-				ri->flags = AS_ASYNC_FLAGS_MASTER | AS_ASYNC_FLAGS_READ | AS_ASYNC_FLAGS_LINEARIZE;
+				ri->flags = AS_ASYNC_FLAGS_READ | AS_ASYNC_FLAGS_LINEARIZE;
 				break;
 
 			default:
 				ri->replica = replica;
-				ri->flags = AS_ASYNC_FLAGS_MASTER | AS_ASYNC_FLAGS_READ;
+				ri->flags = AS_ASYNC_FLAGS_READ;
 				break;
 		}
 	}
 	else {
 		ri->replica = replica;
-		ri->flags = AS_ASYNC_FLAGS_MASTER | AS_ASYNC_FLAGS_READ;
+		ri->flags = AS_ASYNC_FLAGS_READ;
+	}
+}
+
+static inline void
+as_event_command_init_hedge(as_event_command* cmd, const as_policy_read* policy)
+{
+	if ((policy->hedge_delay > 0 || policy->hedge_percentile > 0) &&
+		cmd->replica != AS_POLICY_REPLICA_MASTER && ! cmd->pipe_listener) {
+		cmd->flags2 |= AS_ASYNC_FLAGS2_HEDGE;
+		cmd->hedge = NULL;
+		cmd->hedge_begin = 0;
+		cmd->hedge_delay = policy->hedge_delay;
+		cmd->hedge_percentile = policy->hedge_percentile;
 	}
 }
 
@@ -205,15 +231,12 @@ as_command_write_filter(const as_policy_base* policy, uint32_t filter_size, uint
  * GET
  *****************************************************************************/
 
-as_status
-aerospike_key_get(
-	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
+static as_status
+as_key_get_execute(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_parse_results_fn fn, void* udata
 	)
 {
-	if (! policy) {
-		policy = &as->config.policies.read;
-	}
-
 	as_cluster* cluster = as->cluster;
 	as_partition_info pi;
 	as_status status = as_key_partition_init(cluster, err, key, &pi);
@@ -236,15 +259,40 @@ aerospike_key_get(
 	p = as_command_write_filter(&policy->base, filter_size, p);
 	size = as_command_write_end(buf, p);
 
+	status = as_command_execute_read(cluster, err, policy, buf, size, &pi, fn, udata);
+
+	as_command_buffer_free(buf, size);
+	return status;
+}
+
+as_status
+aerospike_key_get(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
+	)
+{
+	if (! policy) {
+		policy = &as->config.policies.read;
+	}
+
 	as_command_parse_result_data data;
 	data.record = rec;
 	data.deserialize = policy->deserialize;
 
-	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-				policy->read_mode_sc, buf, size, &pi, as_command_parse_result, &data);
+	return as_key_get_execute(as, err, policy, key, as_command_parse_result, &data);
+}
 
-	as_command_buffer_free(buf, size);
-	return status;
+as_status
+aerospike_key_get_view(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_record_view* view
+	)
+{
+	if (! policy) {
+		policy = &as->config.policies.read;
+	}
+
+	memset(view, 0, sizeof(as_record_view));
+	return as_key_get_execute(as, err, policy, key, as_command_parse_result_view, view);
 }
 
 as_status
@@ -278,6 +326,7 @@ aerospike_key_get_async(
 		cluster, &policy->base, ri.replica, pi.ns, pi.partition, policy->deserialize,
 		ri.flags, listener, udata, event_loop, pipe_listener,
 		size, as_event_command_parse_result);
+	as_event_command_init_hedge(cmd, policy);
 
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(cmd->buf, &policy->base, policy->read_mode_ap,
@@ -293,16 +342,12 @@ aerospike_key_get_async(
  * SELECT
  *****************************************************************************/
 
-as_status
-aerospike_key_select(
+static as_status
+as_key_select_execute(
 	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
-	const char* bins[], as_record** rec
+	const char* bins[], as_parse_results_fn fn, void* udata
 	)
 {
-	if (! policy) {
-		policy = &as->config.policies.read;
-	}
-	
 	as_cluster* cluster = as->cluster;
 	as_partition_info pi;
 	as_status status = as_key_partition_init(cluster, err, key, &pi);
@@ -339,15 +384,41 @@ aerospike_key_select(
 	}
 	size = as_command_write_end(buf, p);
 
+	status = as_command_execute_read(cluster, err, policy, buf, size, &pi, fn, udata);
+
+	as_command_buffer_free(buf, size);
+	return status;
+}
+
+as_status
+aerospike_key_select(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record** rec
+	)
+{
+	if (! policy) {
+		policy = &as->config.policies.read;
+	}
+
 	as_command_parse_result_data data;
 	data.record = rec;
 	data.deserialize = policy->deserialize;
 
-	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-				policy->read_mode_sc, buf, size, &pi, as_command_parse_result, &data);
+	return as_key_select_execute(as, err, policy, key, bins, as_command_parse_result, &data);
+}
 
-	as_command_buffer_free(buf, size);
-	return status;
+as_status
+aerospike_key_select_view(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record_view* view
+	)
+{
+	if (! policy) {
+		policy = &as->config.policies.read;
+	}
+
+	memset(view, 0, sizeof(as_record_view));
+	return as_key_select_execute(as, err, policy, key, bins, as_command_parse_result_view, view);
 }
 
 as_status
@@ -390,6 +461,7 @@ aerospike_key_select_async(
 		cluster, &policy->base, ri.replica, pi.ns, pi.partition, policy->deserialize,
 		ri.flags, listener, udata, event_loop, pipe_listener,
 		size, as_event_command_parse_result);
+	as_event_command_init_hedge(cmd, policy);
 
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(cmd->buf, &policy->base, policy->read_mode_ap,
@@ -439,8 +511,8 @@ aerospike_key_exists(
 	p = as_command_write_filter(&policy->base, filter_size, p);
 	size = as_command_write_end(buf, p);
 
-	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-				policy->read_mode_sc, buf, size, &pi, as_command_parse_header, rec);
+	status = as_command_execute_read(cluster, err, policy, buf, size, &pi,
+				as_command_parse_header, rec);
 
 	as_command_buffer_free(buf, size);
 
@@ -481,6 +553,7 @@ aerospike_key_exists_async(
 		cluster, &policy->base, ri.replica, pi.ns, pi.partition, false,
 		ri.flags, listener, udata, event_loop, pipe_listener,
 		size, as_event_command_parse_result);
+	as_event_command_init_hedge(cmd, policy);
 
 	uint8_t* p = as_command_write_header_read_header(cmd->buf, &policy->base, policy->read_mode_ap,
 		policy->read_mode_sc, n_fields, 0, AS_MSG_INFO1_READ | AS_MSG_INFO1_GET_NOBINDATA);
@@ -500,6 +573,7 @@ typedef struct as_put_s {
 	const as_key* key;
 	as_record* rec;
 	as_buffer* buffers;
+	as_command_gather* gather;
 	uint32_t filter_size;
 	uint16_t n_fields;
 	uint16_t n_bins;
@@ -508,13 +582,14 @@ typedef struct as_put_s {
 static size_t
 as_put_init(
 	as_put* put, const as_policy_write* policy, const as_key* key, as_record* rec,
-	as_buffer* buffers
+	as_buffer* buffers, as_command_gather* gather
 	)
 {
 	put->policy = policy;
 	put->key = key;
 	put->rec = rec;
 	put->buffers = buffers;
+	put->gather = gather;
 
 	size_t size = as_command_key_size(policy->key, key, &put->n_fields);
 
@@ -530,6 +605,10 @@ as_put_init(
 
 	for (uint16_t i = 0; i < n_bins; i++) {
 		size += as_command_bin_size(&bins[i], &buffers[i]);
+
+		if (gather) {
+			as_command_gather_reserve(gather, &bins[i]);
+		}
 	}
 	return size;
 }
@@ -553,9 +632,9 @@ as_put_write(void* udata, uint8_t* buf)
 	as_buffer* buffers = put->buffers;
 
 	for (uint16_t i = 0; i < n_bins; i++) {
-		p = as_command_write_bin(p, AS_OPERATOR_WRITE, &bins[i], &buffers[i]);
+		p = as_command_write_bin_gather(p, AS_OPERATOR_WRITE, &bins[i], &buffers[i], put->gather);
 	}
-	return as_command_write_end(buf, p);
+	return as_command_write_end_gather(buf, p, put->gather);
 }
 
 as_status
@@ -577,8 +656,11 @@ aerospike_key_put(
 
 	as_buffer* buffers = (as_buffer*)alloca(sizeof(as_buffer) * rec->bins.size);
 
+	as_command_gather gather;
+	as_command_gather_init(&gather, cluster);
+
 	as_put put;
-	size_t size = as_put_init(&put, policy, key, rec, buffers);
+	size_t size = as_put_init(&put, policy, key, rec, buffers, &gather);
 
 	// Support new compress while still being compatible with old XDR compression_threshold.
 	uint32_t compression_threshold = policy->compression_threshold;
@@ -588,8 +670,20 @@ aerospike_key_put(
 	}
 
 	as_command cmd;
-	as_command_init_write(&cmd, cluster, &policy->base, policy->replica, size, &pi,
-						  as_command_parse_header, NULL);
+
+	if (gather.reserved > 0 && (compression_threshold == 0 || size <= compression_threshold)) {
+		// Send large values directly from record bins.
+		as_command_init_write(&cmd, cluster, &policy->base, policy->replica,
+							  size - gather.ext_size, &pi, as_command_parse_header, NULL);
+		cmd.flags |= AS_COMMAND_FLAGS_GATHER;
+		cmd.gather = &gather;
+		compression_threshold = 0;
+	}
+	else {
+		as_command_gather_clear(&gather);
+		as_command_init_write(&cmd, cluster, &policy->base, policy->replica, size, &pi,
+							  as_command_parse_header, NULL);
+	}
 
 	status = as_command_send(&cmd, err, compression_threshold, as_put_write, &put);
 	return status;
@@ -617,7 +711,7 @@ aerospike_key_put_async_ex(
 	as_buffer* buffers = (as_buffer*)alloca(sizeof(as_buffer) * rec->bins.size);
 
 	as_put put;
-	size_t size = as_put_init(&put, policy, key, rec, buffers);
+	size_t size = as_put_init(&put, policy, key, rec, buffers, NULL);
 
 	// Support new compress while still being compatible with old XDR compression_threshold.
 	uint32_t compression_threshold = policy->compression_threshold;
@@ -629,7 +723,7 @@ aerospike_key_put_async_ex(
 	if (compression_threshold == 0 || (size <= compression_threshold)) {
 		// Send uncompressed command.
 		as_event_command* cmd = as_async_write_command_create(
-				cluster, &policy->base, policy->replica, pi.ns, pi.partition, AS_ASYNC_FLAGS_MASTER,
+				cluster, &policy->base, policy->replica, pi.ns, pi.partition, 0,
 				listener, udata, event_loop, pipe_listener, size, as_event_command_parse_header);
 
 		cmd->write_len = (uint32_t)as_put_write(&put, cmd->buf);
@@ -654,7 +748,7 @@ aerospike_key_put_async_ex(
 		// Allocate command with compressed upper bound.
 		size_t comp_size = as_command_compress_max_size(size);
 		as_event_command* cmd = as_async_write_command_create(
-				cluster, &policy->base, policy->replica, pi.ns, pi.partition, AS_ASYNC_FLAGS_MASTER,
+				cluster, &policy->base, policy->replica, pi.ns, pi.partition, 0,
 				listener, udata, event_loop, pipe_listener, comp_size, as_event_command_parse_header);
 
 		// Compress buffer and execute.
@@ -675,7 +769,7 @@ aerospike_key_put_async_ex(
 			return as_event_command_execute(cmd, err);
 		}
 		else {
-			cf_free(cmd);
+			as_slab_free(cmd);
 			return status;
 		}
 	}
@@ -762,7 +856,7 @@ aerospike_key_remove_async_ex(
 	size += filter_size;
 
 	as_event_command* cmd = as_async_write_command_create(
-		cluster, &policy->base, policy->replica, pi.ns, pi.partition, AS_ASYNC_FLAGS_MASTER,
+		cluster, &policy->base, policy->replica, pi.ns, pi.partition, 0,
 		listener, udata, event_loop, pipe_listener, size, as_event_command_parse_header);
 
 	uint8_t* p = as_command_write_header_write(cmd->buf, &policy->base, policy->commit_level,
@@ -799,6 +893,7 @@ typedef struct as_operate_s {
 	const as_key* key;
 	const as_operations* ops;
 	as_buffer* buffers;
+	as_command_gather* gather;
 	uint32_t filter_size;
 	uint16_t n_fields;
 	uint16_t n_operations;
@@ -807,63 +902,18 @@ typedef struct as_operate_s {
 	uint8_t info_attr;
 } as_operate;
 
-static size_t
-as_operate_set_attr(const as_operations* ops, as_buffer* buffers, uint8_t* rattr, uint8_t* wattr)
-{
-	size_t size = 0;
-	uint32_t n_operations = ops->binops.size;
-	uint8_t read_attr = 0;
-	uint8_t write_attr = 0;
-	bool respond_all_ops = false;
-	
-	for (uint32_t i = 0; i < n_operations; i++) {
-		as_binop* op = &ops->binops.entries[i];
-		
-		switch (op->op)	{
-			case AS_OPERATOR_MAP_READ:
-				op->op = AS_OPERATOR_CDT_READ;
-			case AS_OPERATOR_BIT_READ:
-			case AS_OPERATOR_HLL_READ:
-				// Map operations require respond_all_ops to be true.
-				respond_all_ops = true;
-				// Fall through to read.
-			case AS_OPERATOR_CDT_READ:
-			case AS_OPERATOR_READ:
-				read_attr |= AS_MSG_INFO1_READ;
-				break;
-				
-			case AS_OPERATOR_MAP_MODIFY:
-				op->op = AS_OPERATOR_CDT_MODIFY;
-			case AS_OPERATOR_BIT_MODIFY:
-			case AS_OPERATOR_HLL_MODIFY:
-				// Map operations require respond_all_ops to be true.
-				respond_all_ops = true;
-				// Fall through to write.
-			default:
-				write_attr |= AS_MSG_INFO2_WRITE;
-				break;
-		}
-		size += as_command_bin_size(&op->bin, &buffers[i]);
-	}
-	
-	if (respond_all_ops) {
-		write_attr |= AS_MSG_INFO2_RESPOND_ALL_OPS;
-	}
-	*rattr = read_attr;
-	*wattr = write_attr;
-	return size;
-}
-
 static size_t
 as_operate_init(
 	as_operate* oper, aerospike* as, const as_policy_operate* policy,
-	as_policy_operate* policy_local, const as_key* key, const as_operations* ops, as_buffer* buffers
+	as_policy_operate* policy_local, const as_key* key, const as_operations* ops, as_buffer* buffers,
+	as_command_gather* gather
 	)
 {
 	oper->n_operations = ops->binops.size;
 	memset(buffers, 0, sizeof(as_buffer) * oper->n_operations);
 
-	size_t size = as_operate_set_attr(ops, buffers, &oper->read_attr, &oper->write_attr);
+	size_t size = as_command_operate_size(ops, buffers, gather, &oper->read_attr,
+		&oper->write_attr);
 	oper->info_attr = 0;
 
 	if (! policy) {
@@ -883,6 +933,7 @@ as_operate_init(
 	oper->key = key;
 	oper->ops = ops;
 	oper->buffers = buffers;
+	oper->gather = gather;
 
 	as_command_set_attr_read(policy->read_mode_ap, policy->read_mode_sc, policy->base.compress,
 							 &oper->read_attr, &oper->info_attr);
@@ -913,10 +964,10 @@ as_operate_write(void* udata, uint8_t* buf)
 
 	for (uint16_t i = 0; i < n_operations; i++) {
 		as_binop* op = &ops->binops.entries[i];
-		p = as_command_write_bin(p, op->op, &op->bin, &buffers[i]);
+		p = as_command_write_bin_gather(p, as_command_operator(op->op), &op->bin, &buffers[i], oper->gather);
 	}
 
-	return as_command_write_end(buf, p);
+	return as_command_write_end_gather(buf, p, oper->gather);
 }
 
 as_status
@@ -942,11 +993,25 @@ aerospike_key_operate(
 
 	as_buffer* buffers = (as_buffer*)alloca(sizeof(as_buffer) * n_operations);
 
+	as_command_gather gather;
+	as_command_gather_init(&gather, cluster);
+
 	as_policy_operate policy_local;
 	as_operate oper;
-	size_t size = as_operate_init(&oper, as, policy, &policy_local, key, ops, buffers);
+	size_t size = as_operate_init(&oper, as, policy, &policy_local, key, ops, buffers, &gather);
 	policy = oper.policy;
 
+	uint32_t compression_threshold = policy->base.compress ? AS_COMPRESS_THRESHOLD : 0;
+
+	if (gather.reserved > 0 && (compression_threshold == 0 || size <= compression_threshold)) {
+		// Send large values directly from operation bins.
+		size -= gather.ext_size;
+		compression_threshold = 0;
+	}
+	else {
+		as_command_gather_clear(&gather);
+	}
+
 	as_command_parse_result_data data;
 	data.record = rec;
 	data.deserialize = policy->deserialize;
@@ -962,7 +1027,10 @@ aerospike_key_operate(
 							 size, &pi, as_command_parse_result, &data);
 	}
 
-	uint32_t compression_threshold = policy->base.compress ? AS_COMPRESS_THRESHOLD : 0;
+	if (gather.reserved > 0) {
+		cmd.flags |= AS_COMMAND_FLAGS_GATHER;
+		cmd.gather = &gather;
+	}
 
 	status = as_command_send(&cmd, err, compression_threshold, as_operate_write, &oper);
 
@@ -994,7 +1062,7 @@ aerospike_key_operate_async(
 
 	as_policy_operate policy_local;
 	as_operate oper;
-	size_t size = as_operate_init(&oper, as, policy, &policy_local, key, ops, buffers);
+	size_t size = as_operate_init(&oper, as, policy, &policy_local, key, ops, buffers, NULL);
 	policy = oper.policy;
 
 	as_event_command* cmd;
@@ -1004,7 +1072,7 @@ aerospike_key_operate_async(
 		if (oper.write_attr & AS_MSG_INFO2_WRITE) {
 			cmd = as_async_record_command_create(
 				cluster, &policy->base, policy->replica, pi.ns, pi.partition, policy->deserialize,
-				AS_ASYNC_FLAGS_MASTER, listener, udata, event_loop, pipe_listener, size,
+				0, listener, udata, event_loop, pipe_listener, size,
 				as_event_command_parse_result);
 		}
 		else {
@@ -1032,7 +1100,7 @@ aerospike_key_operate_async(
 		if (oper.write_attr & AS_MSG_INFO2_WRITE) {
 			cmd = as_async_record_command_create(
 				cluster, &policy->base, policy->replica, pi.ns, pi.partition, policy->deserialize,
-				AS_ASYNC_FLAGS_MASTER, listener, udata, event_loop, pipe_listener, comp_size,
+				0, listener, udata, event_loop, pipe_listener, comp_size,
 				as_event_command_parse_result);
 		}
 		else {
@@ -1050,7 +1118,7 @@ aerospike_key_operate_async(
 		as_command_buffer_free(buf, capacity);
 
 		if (status != AEROSPIKE_OK) {
-			cf_free(cmd);
+			as_slab_free(cmd);
 			return status;
 		}
 
@@ -1183,7 +1251,7 @@ aerospike_key_apply_async(
 	if (! (policy->base.compress && size > AS_COMPRESS_THRESHOLD)) {
 		// Send uncompressed command.
 		as_event_command* cmd = as_async_value_command_create(cluster, &policy->base,
-			policy->replica, pi.ns, pi.partition, AS_ASYNC_FLAGS_MASTER, listener, udata,
+			policy->replica, pi.ns, pi.partition, 0, listener, udata,
 			event_loop, pipe_listener, size, as_event_command_parse_success_failure);
 
 		cmd->write_len = (uint32_t)as_apply_write(&ap, cmd->buf);
@@ -1206,7 +1274,7 @@ aerospike_key_apply_async(
 		size_t comp_size = as_command_compress_max_size(size);
 
 		as_event_command* cmd = as_async_value_command_create(cluster, &policy->base,
-			policy->replica, pi.ns, pi.partition, AS_ASYNC_FLAGS_MASTER, listener, udata,
+			policy->replica, pi.ns, pi.partition, 0, listener, udata,
 			event_loop, pipe_listener, comp_size, as_event_command_parse_success_failure);
 
 		// Compress buffer and execute.
@@ -1214,7 +1282,7 @@ aerospike_key_apply_async(
 		as_command_buffer_free(buf, capacity);
 
 		if (status != AEROSPIKE_OK) {
-			cf_free(cmd);
+			as_slab_free(cmd);
 			return status;
 		}
 
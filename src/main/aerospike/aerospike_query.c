@@ -30,6 +30,7 @@
 #include <aerospike/as_query.h>
 #include <aerospike/as_query_validate.h>
 #include <aerospike/as_random.h>
+#include <aerospike/as_record_view.h>
 #include <aerospike/as_serializer.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_status.h>
@@ -58,6 +59,7 @@ typedef struct as_query_task_s {
 	const as_policy_write* write_policy;
 	const as_query* query;
 	aerospike_query_foreach_callback callback;
+	as_record_view_callback callback_view;
 	void* udata;
 	uint32_t* error_mutex;
 	as_error* err;
@@ -271,7 +273,41 @@ as_query_parse_records_async(as_event_command* cmd)
 }
 
 static as_status
-as_query_parse_record(uint8_t** pp, as_msg* msg, as_query_task* task, as_error* err)
+as_query_parse_view(uint8_t** pp, uint8_t* end, as_msg* msg, as_query_task* task, as_error* err)
+{
+	as_record_view view;
+	memset(&view, 0, sizeof(as_record_view));
+	view.gen = (uint16_t)msg->generation;
+	view.ttl = cf_server_void_time_to_ttl(msg->record_ttl);
+	*pp = as_command_parse_key(*pp, msg->n_fields, &view.key);
+
+	// View references response buffer directly.  Bin index is on the stack unless the
+	// record has more bins than fit.
+	as_bin_view stack_bins[AS_RECORD_VIEW_STACK_BINS];
+	as_bin_view* bins = (msg->n_ops <= AS_RECORD_VIEW_STACK_BINS)? stack_bins :
+		cf_malloc(sizeof(as_bin_view) * msg->n_ops);
+	as_status status = as_record_view_parse_bins(&view, err, pp, end, bins, msg->n_ops);
+
+	if (status != AEROSPIKE_OK) {
+		as_record_view_destroy(&view);
+
+		if (bins != stack_bins) {
+			cf_free(bins);
+		}
+		return status;
+	}
+
+	bool rv = task->callback_view(&view, task->udata);
+	as_record_view_destroy(&view);
+
+	if (bins != stack_bins) {
+		cf_free(bins);
+	}
+	return rv ? AEROSPIKE_OK : AEROSPIKE_ERR_CLIENT_ABORT;
+}
+
+static as_status
+as_query_parse_record(uint8_t** pp, uint8_t* end, as_msg* msg, as_query_task* task, as_error* err)
 {
 	bool rv = true;
 	
@@ -300,6 +336,10 @@ as_query_parse_record(uint8_t** pp, as_msg* msg, as_query_task* task, as_error*
 										"Server does not support background query with operations");
 		}
 
+		if (task->callback_view) {
+			return as_query_parse_view(pp, end, msg, task, err);
+		}
+
 		// Parse normal record values.
 		as_record rec;
 		as_record_inita(&rec, msg->n_ops);
@@ -353,7 +393,7 @@ as_query_parse_records(as_error* err, as_node* node, uint8_t* buf, size_t size,
 			return AEROSPIKE_NO_MORE_RECORDS;
 		}
 		
-		status = as_query_parse_record(&p, msg, task, err);
+		status = as_query_parse_record(&p, end, msg, task, err);
 		
 		if (status != AEROSPIKE_OK) {
 			return status;
@@ -953,7 +993,10 @@ as_query_execute(as_query_task* task, const as_query* query, as_nodes* nodes, ui
 	}
 	
 	// Make the callback that signals completion.
-	if (task->callback) {
+	if (task->callback_view) {
+		task->callback_view(NULL, task->udata);
+	}
+	else if (task->callback) {
 		task->callback(NULL, task->udata);
 	}
 	
@@ -1098,6 +1141,7 @@ aerospike_query_foreach(
 		.write_policy = 0,
 		.query = query,
 		.callback = 0,
+		.callback_view = 0,
 		.udata = 0,
 		.error_mutex = &error_mutex,
 		.err = err,
@@ -1172,6 +1216,68 @@ aerospike_query_foreach(
 	return status;
 }
 
+as_status
+aerospike_query_foreach_view(
+	aerospike* as, as_error* err, const as_policy_query* policy, const as_query* query,
+	as_record_view_callback callback, void* udata)
+{
+	if (! policy) {
+		policy = &as->config.policies.query;
+	}
+
+	if (query->apply.function[0]) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+									"Aggregate queries do not support record views");
+	}
+
+	as_cluster* cluster = as->cluster;
+
+	// Convert to a scan when filter doesn't exist.
+	if (query->where.size == 0) {
+		as_policy_scan scan_policy;
+		as_scan scan;
+		convert_query_to_scan(policy, query, &scan_policy, &scan);
+
+		return aerospike_scan_foreach_view(as, err, &scan_policy, &scan, callback, udata);
+	}
+
+	as_error_reset(err);
+
+	as_nodes* nodes;
+	as_status status = as_cluster_reserve_all_nodes(cluster, err, &nodes);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	uint32_t error_mutex = 0;
+
+	// Initialize task.
+	as_query_task task = {
+		.node = 0,
+		.cluster = cluster,
+		.query_policy = policy,
+		.write_policy = 0,
+		.query = query,
+		.callback = 0,
+		.callback_view = callback,
+		.udata = udata,
+		.error_mutex = &error_mutex,
+		.err = err,
+		.input_queue = 0,
+		.complete_q = 0,
+		.task_id = as_random_get_uint64(),
+		.cluster_key = 0,
+		.cmd = 0,
+		.cmd_size = 0,
+		.first = true
+	};
+
+	status = as_query_execute(&task, query, nodes, QUERY_FOREGROUND);
+	as_cluster_release_all_nodes(nodes);
+	return status;
+}
+
 as_status
 aerospike_query_async(
 	aerospike* as, as_error* err, const as_policy_query* policy, const as_query* query,
@@ -1246,7 +1352,7 @@ aerospike_query_async(
 	
 	// Create all query commands.
 	for (uint32_t i = 0; i < nodes->size; i++) {
-		as_event_command* cmd = cf_malloc(s);
+		as_event_command* cmd = as_slab_alloc(exec->event_loop->slab, s);
 		cmd->total_deadline = policy->base.total_timeout;
 		cmd->socket_timeout = policy->base.socket_timeout;
 		cmd->max_retries = policy->base.max_retries;
@@ -1266,8 +1372,9 @@ aerospike_query_async(
 		cmd->type = AS_ASYNC_TYPE_QUERY;
 		cmd->proto_type = AS_MESSAGE_TYPE;
 		cmd->state = AS_ASYNC_STATE_UNREGISTERED;
-		cmd->flags = AS_ASYNC_FLAGS_MASTER;
+		cmd->flags = 0;
 		cmd->flags2 = policy->deserialize ? AS_ASYNC_FLAGS2_DESERIALIZE : 0;
+		cmd->replica_index = 0;
 		memcpy(cmd->buf, cmd_buf, size);
 		exec->commands[i] = cmd;
 	}
@@ -1337,6 +1444,7 @@ aerospike_query_background(
 		.write_policy = policy,
 		.query = query,
 		.callback = 0,
+		.callback_view = 0,
 		.udata = 0,
 		.error_mutex = &error_mutex,
 		.err = err,
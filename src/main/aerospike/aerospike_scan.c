@@ -47,6 +47,7 @@ typedef struct as_scan_task_s {
 	const as_policy_scan* policy;
 	const as_scan* scan;
 	aerospike_scan_foreach_callback callback;
+	as_record_view_callback callback_view;
 	void* udata;
 	as_error* err;
 	cf_queue* complete_q;
@@ -247,7 +248,45 @@ as_scan_parse_records_async(as_event_command* cmd)
 }
 
 static as_status
-as_scan_parse_record(uint8_t** pp, as_msg* msg, as_scan_task* task, as_error* err)
+as_scan_parse_view(uint8_t** pp, uint8_t* end, as_msg* msg, as_scan_task* task, as_error* err)
+{
+	as_record_view view;
+	memset(&view, 0, sizeof(as_record_view));
+	view.gen = (uint16_t)msg->generation;
+	view.ttl = cf_server_void_time_to_ttl(msg->record_ttl);
+	*pp = as_command_parse_key(*pp, msg->n_fields, &view.key);
+
+	if (task->pt) {
+		as_partition_tracker_set_digest(task->pt, task->np, &view.key.digest, task->cluster->n_partitions);
+	}
+
+	// View references response buffer directly.  Bin index is on the stack unless the
+	// record has more bins than fit.
+	as_bin_view stack_bins[AS_RECORD_VIEW_STACK_BINS];
+	as_bin_view* bins = (msg->n_ops <= AS_RECORD_VIEW_STACK_BINS)? stack_bins :
+		cf_malloc(sizeof(as_bin_view) * msg->n_ops);
+	as_status status = as_record_view_parse_bins(&view, err, pp, end, bins, msg->n_ops);
+
+	if (status != AEROSPIKE_OK) {
+		as_record_view_destroy(&view);
+
+		if (bins != stack_bins) {
+			cf_free(bins);
+		}
+		return status;
+	}
+
+	bool rv = task->callback_view(&view, task->udata);
+	as_record_view_destroy(&view);
+
+	if (bins != stack_bins) {
+		cf_free(bins);
+	}
+	return rv ? AEROSPIKE_OK : AEROSPIKE_ERR_CLIENT_ABORT;
+}
+
+static as_status
+as_scan_parse_record(uint8_t** pp, uint8_t* end, as_msg* msg, as_scan_task* task, as_error* err)
 {
 	if (task->pt) {
 		if (msg->info3 & AS_MSG_INFO3_PARTITION_DONE) {
@@ -256,6 +295,10 @@ as_scan_parse_record(uint8_t** pp, as_msg* msg, as_scan_task* task, as_error* er
 		}
 	}
 
+	if (task->callback_view) {
+		return as_scan_parse_view(pp, end, msg, task, err);
+	}
+
 	as_record rec;
 	as_record_inita(&rec, msg->n_ops);
 	
@@ -312,7 +355,7 @@ as_scan_parse_records(as_error* err, as_node* node, uint8_t* buf, size_t size, v
 			return AEROSPIKE_NO_MORE_RECORDS;
 		}
 		
-		status = as_scan_parse_record(&p, msg, task, err);
+		status = as_scan_parse_record(&p, end, msg, task, err);
 		
 		if (status != AEROSPIKE_OK) {
 			return status;
@@ -749,6 +792,7 @@ as_scan_generic(
 	task.policy = policy;
 	task.scan = scan;
 	task.callback = callback;
+	task.callback_view = NULL;
 	task.udata = udata;
 	task.err = err;
 	task.error_mutex = &error_mutex;
@@ -838,7 +882,8 @@ as_scan_partitions_validate(
 static as_status
 as_scan_partitions(
 	as_cluster* cluster, as_error* err, const as_policy_scan* policy, const as_scan* scan,
-	as_partition_tracker* pt, aerospike_scan_foreach_callback callback, void* udata)
+	as_partition_tracker* pt, aerospike_scan_foreach_callback callback,
+	as_record_view_callback callback_view, void* udata)
 {
 	as_status status;
 
@@ -860,6 +905,7 @@ as_scan_partitions(
 		task.policy = policy;
 		task.scan = scan;
 		task.callback = callback;
+		task.callback_view = callback_view;
 		task.udata = udata;
 		task.err = err;
 		task.error_mutex = &error_mutex;
@@ -943,7 +989,12 @@ as_scan_partitions(
 	}
 
 	if (status == AEROSPIKE_OK) {
-		callback(NULL, udata);
+		if (callback_view) {
+			callback_view(NULL, udata);
+		}
+		else {
+			callback(NULL, udata);
+		}
 	}
 	return status;
 }
@@ -979,7 +1030,7 @@ as_scan_partition_execute_async(as_async_scan_executor* se, as_partition_tracker
 		// Allocate enough memory to cover, then, round up memory size in 8KB increments to reduce
 		// fragmentation and to allow socket read to reuse buffer.
 		size_t s = (sizeof(as_async_scan_command) + size + AS_AUTHENTICATION_MAX_SIZE + 8191) & ~8191;
-		as_async_scan_command* scmd = cf_malloc(s);
+		as_async_scan_command* scmd = as_slab_alloc(ee->event_loop->slab, s);
 		scmd->np = np;
 
 		as_event_command* cmd = (as_event_command*)scmd;
@@ -1050,8 +1101,9 @@ as_scan_partition_execute_async(as_async_scan_executor* se, as_partition_tracker
 		cmd->type = AS_ASYNC_TYPE_SCAN_PARTITION;
 		cmd->proto_type = AS_MESSAGE_TYPE;
 		cmd->state = AS_ASYNC_STATE_UNREGISTERED;
-		cmd->flags = AS_ASYNC_FLAGS_MASTER;
+		cmd->flags = 0;
 		cmd->flags2 = se->deserialize_list_map ? AS_ASYNC_FLAGS2_DESERIALIZE : 0;
+		cmd->replica_index = 0;
 		ee->commands[i] = cmd;
 	}
 
@@ -1263,7 +1315,32 @@ aerospike_scan_foreach(
 
 	as_partition_tracker pt;
 	as_partition_tracker_init_nodes(&pt, cluster, policy, n_nodes);
-	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, udata);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, NULL, udata);
+	as_partition_tracker_destroy(&pt);
+	return status;
+}
+
+as_status
+aerospike_scan_foreach_view(
+	aerospike* as, as_error* err, const as_policy_scan* policy, const as_scan* scan,
+	as_record_view_callback callback, void* udata
+	)
+{
+	if (! policy) {
+		policy = &as->config.policies.scan;
+	}
+
+	as_cluster* cluster = as->cluster;
+	uint32_t n_nodes;
+	as_status status = as_scan_partitions_validate(cluster, err, policy, scan, &n_nodes);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_partition_tracker pt;
+	as_partition_tracker_init_nodes(&pt, cluster, policy, n_nodes);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, NULL, callback, udata);
 	as_partition_tracker_destroy(&pt);
 	return status;
 }
@@ -1295,7 +1372,7 @@ aerospike_scan_node(
 
 	as_partition_tracker pt;
 	as_partition_tracker_init_node(&pt, cluster, policy, node);
-	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, udata);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, NULL, udata);
 	as_partition_tracker_destroy(&pt);
 	as_node_release(node);
 	return status;
@@ -1327,7 +1404,7 @@ aerospike_scan_partitions(
 		return status;
 	}
 
-	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, udata);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, NULL, udata);
 	as_partition_tracker_destroy(&pt);
 	return status;
 }
@@ -115,6 +115,10 @@ aerospike_cluster_stats(as_cluster* cluster, as_cluster_stats* stats)
 
 	// cf_queue applies locks, so we are safe here.
 	stats->thread_pool_queued_tasks = cf_queue_sz(cluster->thread_pool.dispatch_queue);
+	stats->retries_rejected = as_load_uint32(&cluster->retries_rejected);
+
+	// Command buffer arena stats.
+	as_arena_stats_get(&stats->arena);
 }
 
 void
@@ -149,10 +153,8 @@ aerospike_node_stats(as_node* node, as_node_stats* stats)
 	for (uint32_t i = 0; i < max; i++) {
 		as_conn_pool* pool = &node->sync_conn_pools[i];
 
-		pthread_mutex_lock(&pool->lock);
-		uint32_t in_pool = as_queue_size(&pool->queue);
-		uint32_t total = pool->queue.total;
-		pthread_mutex_unlock(&pool->lock);
+		uint32_t in_pool = as_conn_pool_size(pool);
+		uint32_t total = as_load_uint32(&pool->total);
 
 		stats->sync.in_pool += in_pool;
 		stats->sync.in_use += total - in_pool;
@@ -160,6 +162,11 @@ aerospike_node_stats(as_node* node, as_node_stats* stats)
 	stats->sync.opened = node->sync_conns_opened;
 	stats->sync.closed = node->sync_conns_closed;
 
+	// Circuit breaker summary.
+	stats->circuit_state = (as_circuit_state)as_load_uint8(&node->circuit.state);
+	stats->circuit_opened = as_load_uint32(&node->circuit.opened);
+	stats->circuit_rejected = as_load_uint32(&node->circuit.rejected);
+
 	// Async connection summary.
 	if (as_event_loop_capacity > 0) {
 		for (uint32_t i = 0; i < as_event_loop_size; i++) {
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_arena.h>
+#include <aerospike/as_atomic.h>
+#include <citrusleaf/alloc.h>
+#include <pthread.h>
+#include <string.h>
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+// Buffer state.  Only the owner thread moves a buffer out of AS_ARENA_FREE, so a buffer
+// released on another thread is handed back with a single compare and swap.
+#define AS_ARENA_FREE 0
+#define AS_ARENA_IN_USE 1
+#define AS_ARENA_ORPHAN 2 // Owner thread exited while the buffer was in use.
+#define AS_ARENA_HEAP 3   // Not cached in an arena.
+
+// Block header precedes the buffer and keeps the buffer 16 byte aligned.
+#define AS_ARENA_HEADER_SIZE 16
+#define AS_ARENA_BUF(_block) ((uint8_t*)(_block) + AS_ARENA_HEADER_SIZE)
+#define AS_ARENA_BLOCK(_buf) ((as_arena_block*)((_buf) - AS_ARENA_HEADER_SIZE))
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct as_arena_block_s {
+	size_t capacity;
+	uint8_t state;
+	bool hit;
+} as_arena_block;
+
+typedef struct as_arena_s {
+	as_arena_block* blocks[AS_ARENA_SLOTS];
+	size_t high_water;
+	uint32_t acquires;
+	uint32_t reuses;
+} as_arena;
+
+/******************************************************************************
+ * GLOBALS
+ *****************************************************************************/
+
+#if !defined(_MSC_VER)
+static __thread as_arena* as_arena_current = NULL;
+#else
+static __declspec(thread) as_arena* as_arena_current = NULL;
+#endif
+
+static pthread_key_t as_arena_key;
+static pthread_once_t as_arena_once = PTHREAD_ONCE_INIT;
+
+static uint64_t as_arena_bytes = 0;
+static uint64_t as_arena_reuses = 0;
+static uint64_t as_arena_heap_allocs = 0;
+static uint64_t as_arena_trims = 0;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static inline as_arena_block*
+as_arena_block_create(size_t capacity, uint8_t state)
+{
+	as_arena_block* block = cf_malloc(AS_ARENA_HEADER_SIZE + capacity);
+	block->capacity = capacity;
+	block->state = state;
+	block->hit = true;
+	return block;
+}
+
+static inline void
+as_arena_block_free(as_arena_block* block)
+{
+	as_add_uint64(&as_arena_bytes, -(int64_t)block->capacity);
+	cf_free(block);
+}
+
+static void
+as_arena_destroy(void* udata)
+{
+	as_arena* arena = udata;
+	as_add_uint64(&as_arena_reuses, arena->reuses);
+
+	for (uint32_t i = 0; i < AS_ARENA_SLOTS; i++) {
+		as_arena_block* block = arena->blocks[i];
+
+		// A buffer still in use on another thread is freed when that thread releases it.
+		if (block && ! as_cas_uint8(&block->state, AS_ARENA_IN_USE, AS_ARENA_ORPHAN)) {
+			as_arena_block_free(block);
+		}
+	}
+	cf_free(arena);
+}
+
+static void
+as_arena_key_init(void)
+{
+	pthread_key_create(&as_arena_key, as_arena_destroy);
+}
+
+static as_arena*
+as_arena_create(void)
+{
+	pthread_once(&as_arena_once, as_arena_key_init);
+
+	as_arena* arena = cf_malloc(sizeof(as_arena));
+	memset(arena, 0, sizeof(as_arena));
+
+	// Thread specific value is only used to free the arena on thread exit.
+	pthread_setspecific(as_arena_key, arena);
+	as_arena_current = arena;
+	return arena;
+}
+
+static inline size_t
+as_arena_block_size(size_t size)
+{
+	size_t capacity = AS_ARENA_MIN_BLOCK;
+
+	while (capacity < size) {
+		capacity <<= 1;
+	}
+	return capacity;
+}
+
+static inline bool
+as_arena_block_free_state(as_arena_block* block)
+{
+	return as_load_uint8(&block->state) == AS_ARENA_FREE;
+}
+
+static void
+as_arena_trim(as_arena* arena)
+{
+	// Release idle buffers that were not used since the last check, or are larger than the
+	// largest buffer requested since the last check.
+	size_t limit = as_arena_block_size(arena->high_water);
+
+	for (uint32_t i = 0; i < AS_ARENA_SLOTS; i++) {
+		as_arena_block* block = arena->blocks[i];
+
+		if (! block) {
+			continue;
+		}
+
+		if (as_arena_block_free_state(block) && (!block->hit || block->capacity > limit)) {
+			as_arena_block_free(block);
+			arena->blocks[i] = NULL;
+			as_incr_uint64(&as_arena_trims);
+			continue;
+		}
+		block->hit = false;
+	}
+	arena->high_water = 0;
+	arena->acquires = 0;
+
+	// Reuse count is accumulated per thread to avoid a shared atomic on every command.
+	as_add_uint64(&as_arena_reuses, arena->reuses);
+	arena->reuses = 0;
+}
+
+static inline uint8_t*
+as_arena_heap_acquire(size_t size)
+{
+	as_incr_uint64(&as_arena_heap_allocs);
+	return AS_ARENA_BUF(as_arena_block_create(size, AS_ARENA_HEAP));
+}
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+uint8_t*
+as_arena_acquire(size_t size)
+{
+	if (size > AS_ARENA_MAX_BLOCK) {
+		return as_arena_heap_acquire(size);
+	}
+
+	as_arena* arena = as_arena_current;
+
+	if (! arena) {
+		arena = as_arena_create();
+	}
+
+	if (size > arena->high_water) {
+		arena->high_water = size;
+	}
+
+	if (++arena->acquires >= AS_ARENA_TRIM_INTERVAL) {
+		as_arena_trim(arena);
+	}
+
+	// Find smallest free buffer that fits.  Otherwise, replace the largest free buffer.
+	as_arena_block* fit = NULL;
+	int grow = -1;
+	size_t grow_capacity = 0;
+
+	for (uint32_t i = 0; i < AS_ARENA_SLOTS; i++) {
+		as_arena_block* block = arena->blocks[i];
+
+		if (! block) {
+			if (grow < 0) {
+				grow = (int)i;
+			}
+			continue;
+		}
+
+		if (! as_arena_block_free_state(block)) {
+			continue;
+		}
+
+		if (block->capacity >= size) {
+			if (! fit || block->capacity < fit->capacity) {
+				fit = block;
+			}
+		}
+		else if (grow < 0 || block->capacity > grow_capacity) {
+			grow = (int)i;
+			grow_capacity = block->capacity;
+		}
+	}
+
+	if (fit) {
+		as_store_uint8(&fit->state, AS_ARENA_IN_USE);
+		fit->hit = true;
+		arena->reuses++;
+		return AS_ARENA_BUF(fit);
+	}
+
+	if (grow < 0) {
+		// All buffers are in use.
+		return as_arena_heap_acquire(size);
+	}
+
+	as_incr_uint64(&as_arena_heap_allocs);
+
+	if (arena->blocks[grow]) {
+		as_arena_block_free(arena->blocks[grow]);
+	}
+
+	// Grow geometrically so buffers converge on the thread's working size.
+	as_arena_block* block = as_arena_block_create(as_arena_block_size(size), AS_ARENA_IN_USE);
+	arena->blocks[grow] = block;
+	as_add_uint64(&as_arena_bytes, block->capacity);
+	return AS_ARENA_BUF(block);
+}
+
+void
+as_arena_release(uint8_t* buf)
+{
+	if (! buf) {
+		return;
+	}
+
+	as_arena_block* block = AS_ARENA_BLOCK(buf);
+
+	if (block->state == AS_ARENA_HEAP) {
+		cf_free(block);
+		return;
+	}
+
+	// Return buffer to the arena that owns it, which may belong to another thread.
+	// If the owner thread has exited, the buffer is no longer cached and is freed here.
+	if (! as_cas_uint8(&block->state, AS_ARENA_IN_USE, AS_ARENA_FREE)) {
+		as_arena_block_free(block);
+	}
+}
+
+void
+as_arena_stats_get(as_arena_stats* stats)
+{
+	stats->bytes = as_load_uint64(&as_arena_bytes);
+	stats->reuses = as_load_uint64(&as_arena_reuses);
+	stats->heap_allocs = as_load_uint64(&as_arena_heap_allocs);
+	stats->trims = as_load_uint64(&as_arena_trims);
+}
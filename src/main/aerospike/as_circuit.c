@@ -0,0 +1,66 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_circuit.h>
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+void
+as_circuit_tend(
+	as_circuit* circuit, uint32_t error_rate, uint32_t min_requests, uint32_t open_ms,
+	uint64_t now
+	)
+{
+	// Counters may be incremented concurrently between load and reset.  Those samples are
+	// counted in the next interval or lost, which is acceptable for an estimate.
+	uint32_t requests = as_fas_uint32(&circuit->requests, 0);
+	uint32_t errors = as_fas_uint32(&circuit->errors, 0);
+	bool exceeded = requests > 0 && (uint64_t)errors * 100 >= (uint64_t)requests * error_rate;
+
+	switch (circuit->state) {
+		case AS_CIRCUIT_CLOSED:
+			if (requests >= min_requests && exceeded) {
+				circuit->open_until = now + open_ms;
+				as_incr_uint32(&circuit->opened);
+				as_store_uint8(&circuit->state, AS_CIRCUIT_OPEN);
+			}
+			break;
+
+		case AS_CIRCUIT_OPEN:
+			if (now >= circuit->open_until) {
+				as_store_uint32(&circuit->probes, 0);
+				as_store_uint8(&circuit->state, AS_CIRCUIT_HALF_OPEN);
+			}
+			break;
+
+		case AS_CIRCUIT_HALF_OPEN:
+			if (requests == 0) {
+				// No probes were sent.  Keep waiting for probe results.
+				as_store_uint32(&circuit->probes, 0);
+			}
+			else if (exceeded) {
+				circuit->open_until = now + open_ms;
+				as_incr_uint32(&circuit->opened);
+				as_store_uint8(&circuit->state, AS_CIRCUIT_OPEN);
+			}
+			else {
+				as_store_uint8(&circuit->state, AS_CIRCUIT_CLOSED);
+			}
+			break;
+	}
+}
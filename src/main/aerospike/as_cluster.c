@@ -19,12 +19,14 @@
 #include <aerospike/as_admin.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_cpu.h>
+#include <aerospike/as_epoch.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_lookup.h>
 #include <aerospike/as_password.h>
 #include <aerospike/as_peers.h>
 #include <aerospike/as_shm_cluster.h>
+#include <aerospike/as_snapshot.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_string.h>
 #include <aerospike/as_tls.h>
@@ -33,6 +35,7 @@
 #include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_byte_order.h>
 #include <citrusleaf/cf_clock.h>
+#include <citrusleaf/cf_queue.h>
 
 /******************************************************************************
  * Globals
@@ -58,6 +61,12 @@ as_node_refresh_partitions(as_cluster* cluster, as_error* err, as_node* node, as
 as_status
 as_node_refresh_racks(as_cluster* cluster, as_error* err, as_node* node);
 
+as_status
+as_node_tend_request(as_cluster* cluster, as_node_tend* tend);
+
+as_status
+as_node_tend_process(as_cluster* cluster, as_node_tend* tend, as_peers* peers);
+
 void
 as_event_balance_connections(as_cluster* cluster);
 
@@ -193,10 +202,7 @@ as_cluster_add_nodes_copy(as_cluster* cluster, as_vector* /* <as_node*> */ nodes
 	set_nodes(cluster, nodes_new);
 
 	// Put old nodes on garbage collector stack.
-	as_gc_item item;
-	item.data = nodes_old;
-	item.release_fn = (as_release_fn)release_nodes;
-	as_vector_append(cluster->gc, &item);
+	as_cluster_gc_add(cluster, nodes_old, (as_release_fn)release_nodes);
 }
 
 static void
@@ -464,10 +470,7 @@ as_cluster_remove_nodes_copy(as_cluster* cluster, as_vector* /* <as_node*> */ no
 	}
 
 	// Put old nodes on garbage collector stack.
-	as_gc_item item;
-	item.data = nodes_old;
-	item.release_fn = (as_release_fn)release_nodes;
-	as_vector_append(cluster->gc, &item);
+	as_cluster_gc_add(cluster, nodes_old, (as_release_fn)release_nodes);
 }
 
 static void
@@ -555,17 +558,166 @@ as_cluster_balance_connections(as_cluster* cluster)
 	}
 }
 
+void
+as_cluster_tend_stats(as_cluster* cluster)
+{
+	uint64_t now = cf_getms();
+
+	if (now - cluster->stats_time < cluster->tend_interval) {
+		return;
+	}
+	cluster->stats_time = now;
+
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		as_node_latency_decay(node);
+
+		if (cluster->circuit_error_rate > 0) {
+			as_circuit_tend(&node->circuit, cluster->circuit_error_rate,
+							cluster->circuit_min_requests, cluster->circuit_open_ms, now);
+		}
+	}
+
+	if (cluster->retry_budget > 0) {
+		// Retries allowed in the next interval are based on commands started in this interval.
+		uint64_t requests = as_fas_uint32(&cluster->retry_requests, 0);
+		uint64_t limit = requests * cluster->retry_budget / 100;
+
+		if (limit < cluster->retry_budget_min) {
+			limit = cluster->retry_budget_min;
+		}
+
+		if (limit > UINT32_MAX) {
+			limit = UINT32_MAX;
+		}
+		as_store_uint32(&cluster->retry_limit, (uint32_t)limit);
+		as_store_uint32(&cluster->retry_count, 0);
+	}
+}
+
+void
+as_cluster_signal_tend(as_cluster* cluster)
+{
+	// Only signal when tend not already been requested.
+	if (as_cas_uint8(&cluster->tend_requested, 0, 1)) {
+		// The tender only holds this lock while checking the flag and waiting, so
+		// command threads are not blocked by a running tend.
+		pthread_mutex_lock(&cluster->tend_lock);
+		pthread_cond_signal(&cluster->tend_cond);
+		pthread_mutex_unlock(&cluster->tend_lock);
+	}
+}
+
 /**
- * Release data structures schuleduled for removal in previous cluster tend.
+ * Release data structures scheduled for removal in previous cluster tends that are no
+ * longer referenced by any command.  Release all data when all is true.
  */
 static void
-as_cluster_gc(as_vector* /* <as_gc_item> */ vector)
+as_cluster_gc(as_vector* /* <as_gc_item> */ vector, bool all)
 {
+	// Commands that start after the advance can not see items retired before it.
+	as_epoch_advance();
+
+	uint64_t min = all ? UINT64_MAX : as_epoch_min_active();
+	uint32_t count = 0;
+
 	for (uint32_t i = 0; i < vector->size; i++) {
 		as_gc_item* item = as_vector_get(vector, i);
-		item->release_fn(item->data);
+
+		if (item->epoch < min) {
+			item->release_fn(item->data);
+		}
+		else {
+			// Keep item until the commands that started in its epoch have completed.
+			if (count != i) {
+				*(as_gc_item*)as_vector_get(vector, count) = *item;
+			}
+			count++;
+		}
 	}
-	as_vector_clear(vector);
+	vector->size = count;
+}
+
+void
+as_cluster_gc_add(as_cluster* cluster, void* data, as_release_fn release_fn)
+{
+	// Data was removed from shared structures before the epoch is read.
+	as_fence_memory();
+
+	as_gc_item item;
+	item.data = data;
+	item.release_fn = release_fn;
+	item.epoch = as_epoch_current();
+	as_vector_append(cluster->gc, &item);
+}
+
+typedef struct as_tend_task_s {
+	as_cluster* cluster;
+	as_node_tend* tend;
+	cf_queue* complete_q;
+} as_tend_task;
+
+static void
+as_cluster_tend_worker(void* data)
+{
+	as_tend_task* task = data;
+	as_node_tend_request(task->cluster, task->tend);
+	cf_queue_push(task->complete_q, &task->tend);
+}
+
+/**
+ * Send info requests to nodes in parallel and wait for all round trips to complete.
+ * Responses are left for the caller to process in node order.
+ */
+static void
+as_cluster_tend_requests(as_cluster* cluster, as_vector* /* <as_node_tend> */ tends)
+{
+	if (tends->size <= 1 || cluster->tend_pool.thread_size == 0) {
+		for (uint32_t i = 0; i < tends->size; i++) {
+			as_node_tend_request(cluster, as_vector_get(tends, i));
+		}
+		return;
+	}
+
+	as_tend_task* tasks = cf_malloc(sizeof(as_tend_task) * tends->size);
+	cf_queue* complete_q = cf_queue_create(sizeof(as_node_tend*), true);
+	uint32_t n_wait = 0;
+
+	for (uint32_t i = 0; i < tends->size; i++) {
+		as_tend_task* task = &tasks[i];
+		task->cluster = cluster;
+		task->tend = as_vector_get(tends, i);
+		task->complete_q = complete_q;
+
+		int rc = as_thread_pool_queue_task(&cluster->tend_pool, as_cluster_tend_worker, task);
+
+		if (rc) {
+			// Thread could not be added.  Send request in tend thread.
+			as_node_tend_request(cluster, task->tend);
+			continue;
+		}
+		n_wait++;
+	}
+
+	// Wait for tasks to complete.
+	for (uint32_t i = 0; i < n_wait; i++) {
+		as_node_tend* tend;
+		cf_queue_pop(complete_q, &tend, CF_QUEUE_FOREVER);
+	}
+
+	cf_queue_destroy(complete_q);
+	cf_free(tasks);
+}
+
+static inline void
+as_cluster_tend_add(as_vector* /* <as_node_tend> */ tends, as_node* node, as_node_tend_type type)
+{
+	as_node_tend* tend = as_vector_reserve(tends);
+	tend->node = node;
+	tend->type = type;
 }
 
 /**
@@ -575,14 +727,15 @@ as_status
 as_cluster_tend(as_cluster* cluster, as_error* err, bool enable_seed_warnings)
 {
 	// All node additions/deletions are performed in tend thread.
-	// Garbage collect data structures released in previous tend.
-	// This tend interval delay substantially reduces the chance of
-	// deleting a ref counted data structure when other threads
-	// are stuck between assignment and incrementing the ref count.
-	as_cluster_gc(cluster->gc);
+	// Garbage collect data structures released in previous tends.
+	// Sync commands do not reserve nodes, so data is only released
+	// after every command that started before it was retired has
+	// left its epoch. The tend interval delay also covers async
+	// commands that are between assignment and incrementing the
+	// ref count.
+	as_cluster_gc(cluster->gc, false);
 
 	// Initialize tend iteration node statistics.
-	as_error error_local;
 	as_peers peers;
 	as_vector_inita(&peers.hosts, sizeof(as_host), 16);
 	as_vector_inita(&peers.nodes, sizeof(as_node*), 16);
@@ -591,6 +744,10 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool enable_seed_warnings)
 
 	as_nodes* nodes = cluster->nodes;
 	bool rebalance = false;
+
+	// Tend entries are large, so heap allocate.
+	as_vector tends;
+	as_vector_init(&tends, sizeof(as_node_tend), (nodes->size > 0)? nodes->size : 1);
 	
 	for (uint32_t i = 0; i < nodes->size; i++) {
 		as_node* node = nodes->array[i];
@@ -598,12 +755,15 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool enable_seed_warnings)
 		node->partition_changed = false;
 		node->rebalance_changed = false;
 	}
+
+	as_cluster_tend_stats(cluster);
 	
 	// If active nodes don't exist, seed cluster.
 	if (nodes->size == 0) {
 		as_status status = as_cluster_seed_node(cluster, err, &peers, enable_seed_warnings);
 		
 		if (status != AEROSPIKE_OK) {
+			as_vector_destroy(&tends);
 			return status;
 		}
 
@@ -612,6 +772,7 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool enable_seed_warnings)
 			as_status status = as_cluster_set_partition_size(cluster, err);
 			
 			if (status != AEROSPIKE_OK) {
+				as_vector_destroy(&tends);
 				return status;
 			}
 		}
@@ -622,27 +783,37 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool enable_seed_warnings)
 			as_status status = as_cluster_set_partition_size(cluster, err);
 			
 			if (status != AEROSPIKE_OK) {
+				as_vector_destroy(&tends);
 				return status;
 			}
 		}
 
-		// Refresh all known nodes.
+		// Refresh all known nodes.  Info round trips run in parallel.  Responses are
+		// processed in the tend thread.
 		for (uint32_t i = 0; i < nodes->size; i++) {
 			as_node* node = nodes->array[i];
 
 			if (node->active) {
-				as_status status = as_node_refresh(cluster, &error_local, node, &peers);
+				as_cluster_tend_add(&tends, node, AS_NODE_TEND_REFRESH);
+			}
+		}
+		as_cluster_tend_requests(cluster, &tends);
 
-				if (status != AEROSPIKE_OK) {
-					// Use info level so aql doesn't see message by default.
-					as_log_info("Node %s refresh failed: %s %s",
-						node->name, as_error_string(status), error_local.message);
+		for (uint32_t i = 0; i < tends.size; i++) {
+			as_node_tend* tend = as_vector_get(&tends, i);
+			as_node* node = tend->node;
+			as_status status = as_node_tend_process(cluster, tend, &peers);
 
-					peers.gen_changed = true;
-					node->failures++;
-				}
+			if (status != AEROSPIKE_OK) {
+				// Use info level so aql doesn't see message by default.
+				as_log_info("Node %s refresh failed: %s %s",
+					node->name, as_error_string(status), tend->err.message);
+
+				peers.gen_changed = true;
+				node->failures++;
 			}
 		}
+		as_vector_clear(&tends);
 
 		// Refresh peers when necessary.
 		if (peers.gen_changed) {
@@ -654,16 +825,24 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool enable_seed_warnings)
 				as_node* node = nodes->array[i];
 
 				if (node->failures == 0 && node->active) {
-					as_status status = as_node_refresh_peers(cluster, &error_local, node, &peers);
-	
-					if (status != AEROSPIKE_OK) {
-						as_log_warn("Node %s peers refresh failed: %s %s",
-							node->name, as_error_string(status), error_local.message);
+					as_cluster_tend_add(&tends, node, AS_NODE_TEND_PEERS);
+				}
+			}
+			as_cluster_tend_requests(cluster, &tends);
 
-						node->failures++;
-					}
+			for (uint32_t i = 0; i < tends.size; i++) {
+				as_node_tend* tend = as_vector_get(&tends, i);
+				as_node* node = tend->node;
+				as_status status = as_node_tend_process(cluster, tend, &peers);
+
+				if (status != AEROSPIKE_OK) {
+					as_log_warn("Node %s peers refresh failed: %s %s",
+						node->name, as_error_string(status), tend->err.message);
+
+					node->failures++;
 				}
 			}
+			as_vector_clear(&tends);
 		}
 	}
 
@@ -676,30 +855,51 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool enable_seed_warnings)
 		// nodes to be dropped.
 		if (node->partition_changed && node->failures == 0 && node->active &&
 		   (node->peers_count > 0 || peers.refresh_count == 1)) {
-			as_status status = as_node_refresh_partitions(cluster, &error_local, node, &peers);
-			
-			if (status != AEROSPIKE_OK) {
-				as_log_warn("Node %s partition refresh failed: %s %s",
-							node->name, as_error_string(status), error_local.message);
-				node->failures++;
-			}
+			as_cluster_tend_add(&tends, node, AS_NODE_TEND_PARTITIONS);
 		}
+	}
+	as_cluster_tend_requests(cluster, &tends);
+
+	for (uint32_t i = 0; i < tends.size; i++) {
+		as_node_tend* tend = as_vector_get(&tends, i);
+		as_node* node = tend->node;
+		as_status status = as_node_tend_process(cluster, tend, &peers);
+
+		if (status != AEROSPIKE_OK) {
+			as_log_warn("Node %s partition refresh failed: %s %s",
+						node->name, as_error_string(status), tend->err.message);
+			node->failures++;
+		}
+	}
+	as_vector_clear(&tends);
+
+	// Refresh racks when necessary.
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
 
 		if (node->rebalance_changed && node->failures == 0 && node->active) {
-			as_status status = as_node_refresh_racks(cluster, &error_local, node);
+			as_cluster_tend_add(&tends, node, AS_NODE_TEND_RACKS);
+		}
+	}
+	as_cluster_tend_requests(cluster, &tends);
 
-			if (status == AEROSPIKE_OK) {
-				if (cluster->shm_info && node->racks && node->racks->size > 0) {
-					rebalance = true;
-				}
-			}
-			else {
-				as_log_warn("Node %s rack refresh failed: %s %s",
-							node->name, as_error_string(status), error_local.message);
-				node->failures++;
+	for (uint32_t i = 0; i < tends.size; i++) {
+		as_node_tend* tend = as_vector_get(&tends, i);
+		as_node* node = tend->node;
+		as_status status = as_node_tend_process(cluster, tend, NULL);
+
+		if (status == AEROSPIKE_OK) {
+			if (cluster->shm_info && node->racks && node->racks->size > 0) {
+				rebalance = true;
 			}
 		}
+		else {
+			as_log_warn("Node %s rack refresh failed: %s %s",
+						node->name, as_error_string(status), tend->err.message);
+			node->failures++;
+		}
 	}
+	as_vector_destroy(&tends);
 
 	if (peers.gen_changed) {
 		// Handle nodes changes determined from refreshes.
@@ -777,6 +977,63 @@ as_wait_till_stabilized(as_cluster* cluster, as_error* err)
 	return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Cluster not stabilized after multiple tend attempts");
 }
 
+/**
+ * Sleep for tend interval.  Wake early when a tend is requested, but not before
+ * tend_interval_min has elapsed since the previous tend started.  Statistics that are due
+ * are evaluated while sleeping.  Return if a tend was requested.
+ */
+static bool
+as_cluster_tend_wait(as_cluster* cluster, uint64_t begin, uint32_t interval)
+{
+	struct timespec delta;
+	struct timespec abstime;
+	uint64_t deadline = cf_getms() + interval;
+	bool requested = false;
+
+	pthread_mutex_lock(&cluster->tend_lock);
+
+	while (cluster->valid) {
+		if (! requested && as_load_uint8(&cluster->tend_requested)) {
+			uint64_t limit = begin + cluster->tend_interval_min;
+
+			if (limit < deadline) {
+				deadline = limit;
+			}
+			requested = true;
+		}
+
+		uint64_t now = cf_getms();
+
+		if (now >= deadline) {
+			break;
+		}
+
+		// Statistics windows are measured in wall clock time.  Evaluate them on schedule
+		// while tends are backed off.
+		uint64_t wake = cluster->stats_time + cluster->tend_interval;
+
+		if (wake <= now) {
+			pthread_mutex_unlock(&cluster->tend_lock);
+			as_cluster_tend_stats(cluster);
+			pthread_mutex_lock(&cluster->tend_lock);
+			continue;
+		}
+
+		if (wake > deadline) {
+			wake = deadline;
+		}
+
+		// Convert remaining interval into absolute timeout.
+		cf_clock_set_timespec_ms(wake - now, &delta);
+		cf_clock_current_add(&delta, &abstime);
+
+		// Exit early if condition is signaled.
+		pthread_cond_timedwait(&cluster->tend_cond, &cluster->tend_lock, &abstime);
+	}
+	pthread_mutex_unlock(&cluster->tend_lock);
+	return requested;
+}
+
 static void*
 as_cluster_tender(void* data)
 {
@@ -788,30 +1045,64 @@ as_cluster_tender(void* data)
 		}
 	}
 
-	struct timespec delta;
-	cf_clock_set_timespec_ms(cluster->tend_interval, &delta);
-	
-	struct timespec abstime;
-	
 	as_status status;
 	as_error err;
-	
-	pthread_mutex_lock(&cluster->tend_lock);
+	uint32_t interval = cluster->tend_interval;
+	uint64_t tend_fingerprint = 0;
+	uint64_t snapshot_time = 0;
+	uint64_t snapshot_fingerprint = 0;
 
 	while (cluster->valid) {
+		uint64_t begin = cf_getms();
+
+		// Requests that arrive during this tend trigger another early tend.
+		as_store_uint8(&cluster->tend_requested, 0);
+
 		status = as_cluster_tend(cluster, &err, false);
 		
 		if (status != AEROSPIKE_OK) {
 			as_log_warn("Tend error: %s %s", as_error_string(status), err.message);
 		}
-		
-		// Convert tend interval into absolute timeout.
-		cf_clock_current_add(&delta, &abstime);
-		
-		// Sleep for tend interval and exit early if condition is signaled.
-		pthread_cond_timedwait(&cluster->tend_cond, &cluster->tend_lock, &abstime);
+
+		if (cluster->snapshot_path) {
+			// Write partition map snapshot when cluster has changed since the last write.
+			uint64_t now = cf_getms();
+
+			if (now - snapshot_time >= cluster->snapshot_interval) {
+				uint64_t fingerprint = as_snapshot_fingerprint(cluster);
+
+				if (fingerprint != snapshot_fingerprint) {
+					status = as_snapshot_write(cluster, &err);
+
+					if (status == AEROSPIKE_OK) {
+						snapshot_fingerprint = fingerprint;
+					}
+					else {
+						as_log_warn("Snapshot error: %s %s", as_error_string(status), err.message);
+					}
+					snapshot_time = now;
+				}
+			}
+		}
+
+		if (cluster->tend_interval_max > cluster->tend_interval) {
+			// Back off while nodes and partition maps are unchanged.
+			uint64_t fingerprint = as_snapshot_fingerprint(cluster);
+
+			if (fingerprint == tend_fingerprint) {
+				interval = (interval > cluster->tend_interval_max / 2)?
+					cluster->tend_interval_max : interval * 2;
+			}
+			else {
+				tend_fingerprint = fingerprint;
+				interval = cluster->tend_interval;
+			}
+		}
+
+		if (as_cluster_tend_wait(cluster, begin, interval)) {
+			interval = cluster->tend_interval;
+		}
 	}
-	pthread_mutex_unlock(&cluster->tend_lock);
 
 	as_tls_thread_cleanup();
 	
@@ -901,9 +1192,47 @@ as_cluster_add_seeds(as_cluster* cluster)
 	}
 }
 
+static bool
+as_cluster_restore(as_cluster* cluster)
+{
+	as_error err;
+	as_vector nodes;
+	as_vector_inita(&nodes, sizeof(as_node*), 16);
+
+	as_status status = as_snapshot_load(cluster, &err, &nodes);
+
+	if (status != AEROSPIKE_OK) {
+		as_log_info("Partition map snapshot not loaded: %s", err.message);
+		as_vector_destroy(&nodes);
+		return false;
+	}
+
+	as_cluster_add_nodes(cluster, &nodes);
+	as_vector_destroy(&nodes);
+
+	if (cluster->user) {
+		// Session tokens are not persisted, so commands can not authenticate until nodes
+		// have logged in.  Run a single tend instead of waiting for the cluster to stabilize.
+		status = as_cluster_tend(cluster, &err, true);
+
+		if (status != AEROSPIKE_OK) {
+			as_log_warn("Tend error: %s %s", as_error_string(status), err.message);
+		}
+	}
+	return true;
+}
+
 as_status
 as_cluster_init(as_cluster* cluster, as_error* err, bool fail_if_not_connected)
 {
+	// Route commands with the partition map snapshot.  The tend thread refreshes
+	// nodes and partition maps that have changed since the snapshot was written.
+	if (cluster->snapshot_path && as_cluster_restore(cluster)) {
+		as_cluster_add_seeds(cluster);
+		cluster->valid = true;
+		return AEROSPIKE_OK;
+	}
+
 	// Tend cluster until all nodes identified.
 	as_status status = as_wait_till_stabilized(cluster, err);
 	
@@ -1113,11 +1442,18 @@ as_cluster_create(as_config* config, as_error* err, as_cluster** cluster_out)
 	// Heap allocated cluster_name continues to be owned by as->config.
 	// Make a reference copy here.
 	cluster->cluster_name = config->cluster_name;
+	cluster->snapshot_path = config->use_shm? NULL : config->snapshot_path;
+	cluster->snapshot_interval = config->snapshot_interval;
 	cluster->event_callback = config->event_callback;
 	cluster->event_callback_udata = config->event_callback_udata;
 
 	// Initialize cluster tend and node parameters
 	cluster->tend_interval = (config->tender_interval < 250)? 250 : config->tender_interval;
+
+	// Shared memory followers can not wake the tend master, so only use fixed intervals.
+	cluster->tend_interval_min = config->use_shm? 0 : config->tender_interval_min;
+	cluster->tend_interval_max = config->use_shm? 0 : config->tender_interval_max;
+
 	cluster->min_conns_per_node = config->min_conns_per_node;
 	cluster->max_conns_per_node = config->max_conns_per_node;
 	cluster->async_min_conns_per_node = config->async_min_conns_per_node;
@@ -1127,6 +1463,19 @@ as_cluster_create(as_config* config, as_error* err, as_cluster** cluster_out)
 	cluster->login_timeout_ms = (config->login_timeout_ms == 0) ? 5000 : config->login_timeout_ms;
 	cluster->tend_thread_cpu = config->tend_thread_cpu;
 	cluster->conn_pools_per_node = config->conn_pools_per_node;
+	cluster->sync_pipe_conns_per_node = config->sync_pipe_conns_per_node;
+	cluster->gather_write_threshold = config->gather_write_threshold;
+	cluster->zero_copy_threshold = config->zero_copy_threshold;
+	cluster->circuit_error_rate = config->circuit_error_rate;
+	cluster->circuit_min_requests = config->circuit_min_requests;
+	cluster->circuit_open_ms = config->circuit_open_ms;
+	cluster->stats_time = 0;
+	cluster->retry_budget = config->retry_budget;
+	cluster->retry_budget_min = config->retry_budget_min;
+	cluster->retry_requests = 0;
+	cluster->retry_count = 0;
+	cluster->retry_limit = config->retry_budget_min;
+	cluster->retries_rejected = 0;
 	cluster->use_services_alternate = config->use_services_alternate;
 	cluster->rack_aware = config->rack_aware;
 	cluster->rack_id = config->rack_id;
@@ -1186,6 +1535,18 @@ as_cluster_create(as_config* config, as_error* err, as_cluster** cluster_out)
 		return status;
 	}
 
+	// Initialize tend thread pool.
+	rc = as_thread_pool_init(&cluster->tend_pool, config->tend_thread_pool_size);
+	cluster->tend_pool.fini_fn = as_tls_thread_cleanup;
+
+	if (rc) {
+		as_status status = as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to initialize tend thread pool of size %u: %d",
+				config->tend_thread_pool_size, rc);
+		as_cluster_destroy(cluster);
+		*cluster_out = 0;
+		return status;
+	}
+
 	if (config->tls.enable) {
 		// Initialize TLS parameters.
 		cluster->tls_ctx = cf_malloc(sizeof(as_tls_context));
@@ -1197,6 +1558,12 @@ as_cluster_create(as_config* config, as_error* err, as_cluster** cluster_out)
 			*cluster_out = 0;
 			return status;
 		}
+
+		if (cluster->sync_pipe_conns_per_node > 0 && as_socket_use_tls(cluster->tls_ctx)) {
+			// TLS connections do not support concurrent reads and writes from different threads.
+			as_log_warn("Sync pipelining is not supported with TLS and has been disabled");
+			cluster->sync_pipe_conns_per_node = 0;
+		}
 	}
 	else {
 		if (cluster->auth_mode == AS_AUTH_EXTERNAL) {
@@ -1274,8 +1641,15 @@ as_cluster_destroy(as_cluster* cluster)
 		}
 	}
 
+	// Shutdown tend thread pool after tend thread has stopped using it.
+	rc = as_thread_pool_destroy(&cluster->tend_pool);
+
+	if (rc) {
+		as_log_warn("Failed to destroy tend thread pool: %d", rc);
+	}
+
 	// Release everything in garbage collector.
-	as_cluster_gc(cluster->gc);
+	as_cluster_gc(cluster->gc, true);
 	as_vector_destroy(cluster->gc);
 		
 	// Destroy partition tables.
@@ -16,14 +16,18 @@
  */
 #include <aerospike/as_command.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_epoch.h>
 #include <aerospike/as_event.h>
 #include <aerospike/as_key.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_msgpack.h>
+#include <aerospike/as_poll.h>
 #include <aerospike/as_record.h>
+#include <aerospike/as_record_view.h>
 #include <aerospike/as_serializer.h>
 #include <aerospike/as_sleep.h>
 #include <aerospike/as_socket.h>
+#include <aerospike/as_sync_pipe.h>
 #include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_clock.h>
 #include <citrusleaf/cf_digest.h>
@@ -44,7 +48,7 @@ as_command_read_message(as_error* err, as_command* cmd, as_socket* sock, as_node
 as_status
 as_batch_retry(as_command* cmd, as_error* err);
 
-static size_t
+size_t
 as_command_user_key_size(const as_key* key)
 {
 	size_t size = AS_FIELD_HEADER_SIZE + 1;  // Add 1 for key's value type.
@@ -137,6 +141,58 @@ as_command_value_size(as_val* val, as_buffer* buffer)
 	}
 }
 
+size_t
+as_command_operate_size(
+	const as_operations* ops, as_buffer* buffers, as_command_gather* gather, uint8_t* rattr,
+	uint8_t* wattr
+	)
+{
+	size_t size = 0;
+	uint32_t n_operations = ops->binops.size;
+	uint8_t read_attr = 0;
+	uint8_t write_attr = 0;
+	bool respond_all_ops = false;
+	
+	for (uint32_t i = 0; i < n_operations; i++) {
+		as_binop* op = &ops->binops.entries[i];
+		
+		switch (op->op)	{
+			case AS_OPERATOR_MAP_READ:
+			case AS_OPERATOR_BIT_READ:
+			case AS_OPERATOR_HLL_READ:
+				// Map operations require respond_all_ops to be true.
+				respond_all_ops = true;
+				// Fall through to read.
+			case AS_OPERATOR_CDT_READ:
+			case AS_OPERATOR_READ:
+				read_attr |= AS_MSG_INFO1_READ;
+				break;
+				
+			case AS_OPERATOR_MAP_MODIFY:
+			case AS_OPERATOR_BIT_MODIFY:
+			case AS_OPERATOR_HLL_MODIFY:
+				// Map operations require respond_all_ops to be true.
+				respond_all_ops = true;
+				// Fall through to write.
+			default:
+				write_attr |= AS_MSG_INFO2_WRITE;
+				break;
+		}
+		size += as_command_bin_size(&op->bin, &buffers[i]);
+
+		if (gather) {
+			as_command_gather_reserve(gather, &op->bin);
+		}
+	}
+	
+	if (respond_all_ops) {
+		write_attr |= AS_MSG_INFO2_RESPOND_ALL_OPS;
+	}
+	*rattr = read_attr;
+	*wattr = write_attr;
+	return size;
+}
+
 uint8_t*
 as_command_write_header_write(
 	uint8_t* cmd, const as_policy_base* policy, as_policy_commit_level commit_level,
@@ -145,54 +201,8 @@ as_command_write_header_write(
 	uint8_t info_attr
 	)
 {
-	switch (exists) {
-		default:
-		case AS_POLICY_EXISTS_IGNORE:
-			break;
-			
-		case AS_POLICY_EXISTS_UPDATE:
-			info_attr |= AS_MSG_INFO3_UPDATE_ONLY;
-			break;
-			
-		case AS_POLICY_EXISTS_CREATE_OR_REPLACE:
-			info_attr |= AS_MSG_INFO3_CREATE_OR_REPLACE;
-			break;
-			
-		case AS_POLICY_EXISTS_REPLACE:
-			info_attr |= AS_MSG_INFO3_REPLACE_ONLY;
-			break;
-			
-		case AS_POLICY_EXISTS_CREATE:
-			write_attr |= AS_MSG_INFO2_CREATE_ONLY;
-			break;
-	}
-
-	uint32_t generation;
-
-	switch (gen_policy) {
-		default:
-		case AS_POLICY_GEN_IGNORE:
-			generation = 0;
-			break;
-			
-		case AS_POLICY_GEN_EQ:
-			generation = gen;
-			write_attr |= AS_MSG_INFO2_GENERATION;
-			break;
-			
-		case AS_POLICY_GEN_GT:
-			generation = gen;
-			write_attr |= AS_MSG_INFO2_GENERATION_GT;
-			break;
-	}
-
-	if (commit_level == AS_POLICY_COMMIT_LEVEL_MASTER) {
-		info_attr |= AS_MSG_INFO3_COMMIT_MASTER;
-	}
-
-	if (durable_delete) {
-		write_attr |= AS_MSG_INFO2_DURABLE_DELETE;
-	}
+	uint32_t generation = as_command_set_attr_write(commit_level, exists, gen_policy, gen,
+		durable_delete, &write_attr, &info_attr);
 
 #if defined USE_XDR
 	read_attr |= AS_MSG_INFO1_XDR;
@@ -255,7 +265,7 @@ as_command_write_header_read_header(
 	return cmd + AS_HEADER_SIZE;
 }
 
-static uint8_t*
+uint8_t*
 as_command_write_user_key(uint8_t* begin, const as_key* key)
 {
 	uint8_t* p = begin + AS_FIELD_HEADER_SIZE;
@@ -437,6 +447,45 @@ as_command_write_bin(uint8_t* begin, uint8_t operation_type, const as_bin* bin,
 	return p;
 }
 
+uint8_t*
+as_command_write_bin_gather(
+	uint8_t* begin, uint8_t operation_type, const as_bin* bin, as_buffer* buffer,
+	as_command_gather* gather
+	)
+{
+	uint8_t* data;
+	uint32_t val_len;
+	uint8_t val_type;
+
+	if (! gather || gather->size >= gather->reserved ||
+		! as_command_gather_value(gather, bin, &data, &val_len, &val_type)) {
+		return as_command_write_bin(begin, operation_type, bin, buffer);
+	}
+
+	uint8_t* p = begin + AS_OPERATION_HEADER_SIZE;
+	const char* name = bin->name;
+
+	// Copy string, but do not transfer null byte.
+	while (*name) {
+		*p++ = *name++;
+	}
+	uint8_t name_len = (uint8_t)(p - begin - AS_OPERATION_HEADER_SIZE);
+
+	// Value is written to the socket directly from user memory at this buffer position.
+	as_command_gather_ref* ref = &gather->refs[gather->size++];
+	ref->pos = p;
+	ref->data = data;
+	ref->len = val_len;
+
+	*(uint32_t*)begin = cf_swap_to_be32(name_len + val_len + 4);
+	begin += 4;
+	*begin++ = operation_type;
+	*begin++ = val_type;
+	*begin++ = 0;
+	*begin++ = name_len;
+	return p;
+}
+
 size_t
 as_command_compress_max_size(size_t cmd_sz)
 {
@@ -496,66 +545,332 @@ as_command_send(
 	return status;
 }
 
-as_status
-as_command_execute(as_command* cmd, as_error* err)
+static inline void
+as_command_close_connection(as_node* node, as_socket* socket, as_sync_pipe_ticket* ticket)
+{
+	if (ticket->pipe) {
+		as_sync_pipe_release(node, ticket, false);
+	}
+	else {
+		as_node_close_connection(node, socket, socket->pool);
+	}
+}
+
+static inline void
+as_command_put_connection(as_node* node, as_socket* socket, as_sync_pipe_ticket* ticket)
+{
+	if (ticket->pipe) {
+		as_sync_pipe_release(node, ticket, true);
+	}
+	else {
+		as_node_put_connection(node, socket);
+	}
+}
+
+static as_node*
+as_command_alternate_node(as_command* cmd, as_node* node)
+{
+	// Return the next replica after the command's replica index that is not the given node.
+	// Use sequence order so the alternate replica is deterministic for all replica policies.
+	for (uint32_t i = 1; i < AS_MAX_REPLICAS; i++) {
+		as_node* alt = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition,
+											 AS_POLICY_REPLICA_SEQUENCE,
+											 (uint8_t)(cmd->replica_index + i), true);
+
+		if (alt && alt != node) {
+			return alt;
+		}
+	}
+	return NULL;
+}
+
+static as_status
+as_command_hedge(
+	as_error* err, as_command* cmd, as_node** node_ptr, as_socket* sock, uint32_t delay,
+	uint64_t begin, uint32_t* command_sent_counter
+	)
+{
+	as_node* node = *node_ptr;
+
+	if (cmd->deadline_ms > 0 && cf_getms() + delay >= cmd->deadline_ms) {
+		// Command will time out before a hedged read could help.
+		return AEROSPIKE_OK;
+	}
+
+	// Wait for response from the original node up to the hedge delay.
+	as_poll poll;
+	as_poll_init(&poll, sock->fd);
+	int rv = as_poll_socket(&poll, sock->fd, delay, true);
+	as_poll_destroy(&poll);
+
+	if (rv != 0) {
+		// Response arrived or socket error.  Read normally.
+		return AEROSPIKE_OK;
+	}
+
+	as_node* alt = as_command_alternate_node(cmd, node);
+
+	if (! alt || ! as_node_circuit_allow(cmd->cluster, alt)) {
+		return AEROSPIKE_OK;
+	}
+
+	// Failures on the hedged read are ignored.  The original read is still outstanding.
+	as_error alt_err;
+	as_error_init(&alt_err);
+
+	as_socket alt_sock;
+	as_status status = as_node_get_connection(&alt_err, alt, cmd->socket_timeout,
+											  cmd->deadline_ms, &alt_sock);
+
+	if (status != AEROSPIKE_OK) {
+		return AEROSPIKE_OK;
+	}
+
+	status = as_socket_write_deadline(&alt_err, &alt_sock, alt, cmd->buf, cmd->buf_size,
+									  cmd->socket_timeout, cmd->deadline_ms);
+
+	if (status != AEROSPIKE_OK) {
+		as_node_close_connection(alt, &alt_sock, alt_sock.pool);
+		return AEROSPIKE_OK;
+	}
+	(*command_sent_counter)++;
+
+	uint32_t timeout = cmd->socket_timeout;
+
+	if (cmd->deadline_ms > 0) {
+		uint64_t now = cf_getms();
+		uint32_t remaining = (now < cmd->deadline_ms)? (uint32_t)(cmd->deadline_ms - now) : 1;
+
+		if (timeout == 0 || remaining < timeout) {
+			timeout = remaining;
+		}
+	}
+
+	// Wait for the first response.
+	as_poll_init(&poll, (sock->fd > alt_sock.fd)? sock->fd : alt_sock.fd);
+	rv = as_poll_sockets_read(&poll, sock->fd, alt_sock.fd, timeout);
+	as_poll_destroy(&poll);
+
+	if (rv == 2) {
+		// Hedged read won.  Discard original connection because its response is still pending.
+		as_hedge_latency_add(&node->read_latency, cf_getus() - begin);
+		as_node_close_connection(node, sock, sock->pool);
+		*node_ptr = alt;
+		*sock = alt_sock;
+		return AEROSPIKE_OK;
+	}
+
+	// Original read won, timed out or poll was interrupted.  Discard hedged connection.
+	// Interrupted polls fall back to reading the original connection.
+	as_node_close_connection(alt, &alt_sock, alt_sock.pool);
+
+	if (rv == 0) {
+		// Timeout.  Do not set error string to avoid affecting performance.
+		status = err->code = AEROSPIKE_ERR_TIMEOUT;
+		err->message[0] = 0;
+		return status;
+	}
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_command_write_gather(as_error* err, as_command* cmd, as_socket* sock, as_node* node)
+{
+	as_command_gather* gather = cmd->gather;
+	as_socket_iov iov[AS_COMMAND_GATHER_MAX * 2 + 1];
+	uint32_t n = 0;
+	uint8_t* begin = cmd->buf;
+
+	for (uint32_t i = 0; i < gather->size; i++) {
+		as_command_gather_ref* ref = &gather->refs[i];
+
+		if (ref->pos > begin) {
+			iov[n].data = begin;
+			iov[n].size = ref->pos - begin;
+			n++;
+		}
+
+		if (ref->len > 0) {
+			iov[n].data = ref->data;
+			iov[n].size = ref->len;
+			n++;
+		}
+		begin = ref->pos;
+	}
+
+	uint8_t* end = cmd->buf + cmd->buf_size;
+
+	if (end > begin) {
+		iov[n].data = begin;
+		iov[n].size = end - begin;
+		n++;
+	}
+
+	uint32_t zero_copy_threshold = cmd->cluster->zero_copy_threshold;
+	bool zero_copy = zero_copy_threshold > 0 && gather->ext_size >= zero_copy_threshold;
+
+	return as_socket_writev_deadline(err, sock, node, iov, n, cmd->socket_timeout,
+									 cmd->deadline_ms, zero_copy);
+}
+
+static as_status
+as_command_run(as_command* cmd, as_error* err)
 {
 	as_node* node;
 	uint32_t command_sent_counter = 0;
 	as_status status;
-	bool release_node;
+
+	// Pipeline single record commands when enabled.  Multi-record commands read
+	// multiple response groups and always use pooled connections.  Commands that
+	// reference large values are not worth pipelining and also use pooled connections.
+	// Hedged reads require a dedicated connection that can be abandoned.
+	bool pipeline = cmd->cluster->sync_pipe_conns_per_node > 0 && ! cmd->node &&
+		! (cmd->flags & (AS_COMMAND_FLAGS_BATCH | AS_COMMAND_FLAGS_GATHER | AS_COMMAND_FLAGS_HEDGE));
+
+	// Latency aware replica selection only applies to reads.
+	as_policy_replica replica = (cmd->replica == AS_POLICY_REPLICA_LOWEST_LATENCY &&
+		!(cmd->flags & AS_COMMAND_FLAGS_READ))? AS_POLICY_REPLICA_SEQUENCE : cmd->replica;
+
+	// Track node latency for single record reads that select replicas by latency.
+	bool track = replica == AS_POLICY_REPLICA_LOWEST_LATENCY && ! cmd->node;
+
+	uint64_t start = as_cluster_command_request(cmd->cluster);
 
 	// Execute command until successful, timed out or maximum iterations have been reached.
 	while (true) {
 		if (cmd->node) {
 			node = cmd->node;
-			release_node = false;
 		}
 		else {
-			node = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition, cmd->replica,
-										 cmd->master, cmd->iteration > 0);
+			node = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition, replica,
+										 cmd->replica_index, cmd->iteration > 0);
 
 			if (! node) {
 				return as_error_update(err, AEROSPIKE_ERR_INVALID_NODE,
 									   "Node not found for partition %s:%u",
 									   cmd->ns, cmd->partition_id);
 			}
-			as_node_reserve(node);
-			release_node = true;
+
+			if (! as_node_circuit_allow(cmd->cluster, node)) {
+				// Redirect reads that are allowed to use a replica.  Otherwise, fail fast.
+				as_node* alt = ((cmd->flags & AS_COMMAND_FLAGS_READ) &&
+								!(cmd->flags & AS_COMMAND_FLAGS_LINEARIZE) &&
+								replica != AS_POLICY_REPLICA_MASTER)?
+								as_command_alternate_node(cmd, node) : NULL;
+
+				if (! alt || ! as_node_circuit_allow(cmd->cluster, alt)) {
+					return as_error_update(err, AEROSPIKE_ERR_CIRCUIT_OPEN,
+										   "Circuit open for node %s",
+										   as_node_get_address_string(node));
+				}
+				node = alt;
+			}
 		}
 
 		as_socket socket;
-		status = as_node_get_connection(err, node, cmd->socket_timeout, cmd->deadline_ms, &socket);
-		
-		if (status != AEROSPIKE_OK) {
-			// Do not retry on server error response such as invalid user/password.
-			if (status > 0 && status != AEROSPIKE_ERR_TIMEOUT) {
-				if (release_node) {
-					as_node_release(node);
+		as_sync_pipe_ticket ticket;
+		as_node* tracked = NULL;
+		uint64_t begin = (track || (cmd->flags & AS_COMMAND_FLAGS_HEDGE))? cf_getus() : 0;
+
+		if (pipeline && as_sync_pipe_write(err, node, cmd->buf, cmd->buf_size, cmd->socket_timeout,
+										   cmd->deadline_ms, &ticket, &status)) {
+			// Command was written on a pipeline connection shared with other threads.
+			if (status != AEROSPIKE_OK) {
+				// Do not retry on server error response such as invalid user/password.
+				if (status > 0 && status != AEROSPIKE_ERR_TIMEOUT && ! ticket.pipe) {
+					as_error_set_in_doubt(err, cmd->flags & AS_COMMAND_FLAGS_READ, command_sent_counter);
+					return status;
 				}
-				as_error_set_in_doubt(err, cmd->flags & AS_COMMAND_FLAGS_READ, command_sent_counter);
-				return status;
+				goto Retry;
 			}
-			goto Retry;
-		}
-		
-		// Send command.
-		status = as_socket_write_deadline(err, &socket, node, cmd->buf, cmd->buf_size,
-										  cmd->socket_timeout, cmd->deadline_ms);
-		
-		if (status != AEROSPIKE_OK) {
-			// Socket errors are considered temporary anomalies.  Retry.
-			// Close socket to flush out possible garbage.	Do not put back in pool.
-			as_node_close_connection(node, &socket, socket.pool);
-			goto Retry;
-		}
-		command_sent_counter++;
+			command_sent_counter++;
 
-		// Parse results returned by server.
-		if (cmd->node) {
-			status = as_command_read_messages(err, cmd, &socket, node);
+			if (track) {
+				tracked = node;
+				as_node_latency_begin(node);
+			}
+
+			// Wait for preceding responses on the connection to be read.
+			status = as_sync_pipe_wait(err, node, &ticket, cmd->socket_timeout, cmd->deadline_ms);
+
+			if (status == AEROSPIKE_OK) {
+				status = as_command_read_message(err, cmd, &ticket.pipe->socket, node);
+			}
 		}
 		else {
-			status = as_command_read_message(err, cmd, &socket, node);
+			ticket.pipe = NULL;
+			status = as_node_get_connection(err, node, cmd->socket_timeout, cmd->deadline_ms, &socket);
+
+			if (status != AEROSPIKE_OK) {
+				// Do not retry on server error response such as invalid user/password.
+				if (status > 0 && status != AEROSPIKE_ERR_TIMEOUT) {
+					as_error_set_in_doubt(err, cmd->flags & AS_COMMAND_FLAGS_READ, command_sent_counter);
+					return status;
+				}
+				goto Retry;
+			}
+
+			// Send command.
+			if (cmd->flags & AS_COMMAND_FLAGS_GATHER) {
+				status = as_command_write_gather(err, cmd, &socket, node);
+			}
+			else {
+				status = as_socket_write_deadline(err, &socket, node, cmd->buf, cmd->buf_size,
+												  cmd->socket_timeout, cmd->deadline_ms);
+			}
+
+			if (status != AEROSPIKE_OK) {
+				// Socket errors are considered temporary anomalies.  Retry.
+				// Close socket to flush out possible garbage.	Do not put back in pool.
+				as_node_close_connection(node, &socket, socket.pool);
+				goto Retry;
+			}
+			command_sent_counter++;
+
+			if (track) {
+				tracked = node;
+				as_node_latency_begin(node);
+			}
+
+			if (cmd->flags & AS_COMMAND_FLAGS_HEDGE) {
+				// Only the first attempt is hedged.  Retries already alternate replicas.
+				as_node* orig = node;
+				uint32_t delay = (cmd->iteration == 0)?
+					as_hedge_delay(&node->read_latency, cmd->hedge_delay, cmd->hedge_percentile) : 0;
+
+				if (delay > 0) {
+					status = as_command_hedge(err, cmd, &node, &socket, delay, begin,
+											  &command_sent_counter);
+				}
+
+				if (status == AEROSPIKE_OK) {
+					status = as_command_read_message(err, cmd, &socket, node);
+
+					if (status == AEROSPIKE_OK && node == orig) {
+						as_hedge_latency_add(&node->read_latency, cf_getus() - begin);
+					}
+				}
+
+				if (node != orig) {
+					// Hedged read won.  Original node latency is at least the elapsed time.
+					if (tracked) {
+						as_node_latency_end(orig, cf_getus() - begin, true);
+						tracked = NULL;
+					}
+				}
+			}
+			else if (cmd->node) {
+				// Parse results returned by server.
+				status = as_command_read_messages(err, cmd, &socket, node);
+			}
+			else {
+				status = as_command_read_message(err, cmd, &socket, node);
+			}
+		}
+
+		if (tracked) {
+			// Client side errors such as connection failures are not latency samples.
+			as_node_latency_end(tracked, cf_getus() - begin, status >= 0);
 		}
 
 		if (status == AEROSPIKE_OK) {
@@ -571,7 +886,7 @@ as_command_execute(as_command* cmd, as_error* err)
 			switch (status) {
 				case AEROSPIKE_ERR_CONNECTION:
 				case AEROSPIKE_ERR_TIMEOUT:
-					as_node_close_connection(node, &socket, socket.pool);
+					as_command_close_connection(node, &socket, &ticket);
 					goto Retry;
 
 				case AEROSPIKE_NOT_AUTHENTICATED:
@@ -580,10 +895,7 @@ as_command_execute(as_command* cmd, as_error* err)
 				case AEROSPIKE_ERR_SCAN_ABORTED:
 				case AEROSPIKE_ERR_CLIENT_ABORT:
 				case AEROSPIKE_ERR_CLIENT:
-					as_node_close_connection(node, &socket, socket.pool);
-					if (release_node) {
-						as_node_release(node);
-					}
+					as_command_close_connection(node, &socket, &ticket);
 					as_error_set_in_doubt(err, cmd->flags & AS_COMMAND_FLAGS_READ, command_sent_counter);
 					return status;
 				
@@ -594,29 +906,40 @@ as_command_execute(as_command* cmd, as_error* err)
 		}
 		
 		// Put connection back in pool.
-		as_node_put_connection(node, &socket);
+		as_command_put_connection(node, &socket, &ticket);
+		as_node_circuit_record(cmd->cluster, node, status);
+		as_cluster_command_latency(cmd->cluster, start);
 		
-		// Release resources.
-		if (release_node) {
-			as_node_release(node);
-		}
 		return status;
 
 Retry:
+		as_node_circuit_record(cmd->cluster, node, status);
+
+		if (status == AEROSPIKE_ERR_CONNECTION) {
+			// Node may have failed.  Do not wait for next tend interval to find out.
+			as_cluster_request_tend(cmd->cluster);
+		}
+
 		// Check if max retries reached.
 		if (++cmd->iteration > cmd->policy->max_retries) {
 			break;
 		}
 
+		// Check if cluster retry budget has been exhausted.
+		if (! as_cluster_retry_budget_allow(cmd->cluster)) {
+			break;
+		}
+
 		uint32_t sleep_between_retries;
 
-		// Alternate between master and prole on socket errors or database reads.
-		// Timeouts/NO_MORE_CONNECTIONS are not a good indicator of impending data migration.
+		// Move to the next replica in sequence on socket errors or database reads, so retries
+		// reach every replica.  Timeouts/NO_MORE_CONNECTIONS are not a good indicator of
+		// impending data migration.
 		if (cmd->replica != AS_POLICY_REPLICA_MASTER &&
 			((status != AEROSPIKE_ERR_TIMEOUT && status != AEROSPIKE_ERR_NO_MORE_CONNECTIONS) ||
 			((cmd->flags & AS_COMMAND_FLAGS_READ) && !(cmd->flags & AS_COMMAND_FLAGS_LINEARIZE)))) {
 			// Note: SC session read will ignore this setting because it uses master only.
-			cmd->master = !cmd->master;
+			cmd->replica_index++;
 
 			// Disable sleep on first failure because target node is likely to change.
 			sleep_between_retries = (cmd->iteration == 1)? 0 : cmd->policy->sleep_between_retries;
@@ -643,11 +966,6 @@ Retry:
 			}
 		}
 
-		// Prepare for retry.
-		if (release_node) {
-			as_node_release(node);
-		}
-
 		if (sleep_between_retries > 0) {
 			// Sleep before trying again.
 			as_sleep(sleep_between_retries);
@@ -673,13 +991,28 @@ Retry:
 			as_node_get_address_string(node));
 	}
 
-	if (release_node) {
-		as_node_release(node);
-	}
 	as_error_set_in_doubt(err, cmd->flags & AS_COMMAND_FLAGS_READ, command_sent_counter);
 	return err->code;
 }
 
+as_status
+as_command_execute(as_command* cmd, as_error* err)
+{
+	if (cmd->node) {
+		// Scan, query and batch node commands have already reserved their node.  Run them
+		// outside the epoch, so long running commands and their user callbacks do not
+		// block reclamation of retired nodes.
+		return as_command_run(cmd, err);
+	}
+
+	// Nodes selected from the partition map are not reserved.  The epoch keeps them alive
+	// until the command completes.
+	as_epoch_enter();
+	as_status status = as_command_run(cmd, err);
+	as_epoch_exit();
+	return status;
+}
+
 static as_status
 as_command_read_messages(as_error* err, as_command* cmd, as_socket* sock, as_node* node)
 {
@@ -770,6 +1103,42 @@ as_command_read_messages(as_error* err, as_command* cmd, as_socket* sock, as_nod
 	return status;
 }
 
+static inline uint8_t*
+as_command_read_buffer_init(as_command* cmd, size_t size)
+{
+	// Responses kept by a record view can not be returned to the thread's buffer arena.
+	return (cmd->flags & AS_COMMAND_FLAGS_VIEW)? cf_malloc(size) : as_command_buffer_init(size);
+}
+
+static inline void
+as_command_read_buffer_free(as_command* cmd, uint8_t* buf, size_t size)
+{
+	if (cmd->flags & AS_COMMAND_FLAGS_VIEW) {
+		cf_free(buf);
+	}
+	else {
+		as_command_buffer_free(buf, size);
+	}
+}
+
+static as_status
+as_command_parse_message(
+	as_error* err, as_command* cmd, as_node* node, uint8_t* base, size_t capacity, size_t offset
+	)
+{
+	as_status status = cmd->parse_results_fn(err, node, base + offset, capacity - offset,
+											 cmd->udata);
+
+	if (status == AEROSPIKE_OK && (cmd->flags & AS_COMMAND_FLAGS_VIEW)) {
+		// Record view references bins in the response buffer and frees it on destroy.
+		((as_record_view*)cmd->udata)->buf = base;
+	}
+	else {
+		as_command_read_buffer_free(cmd, base, capacity);
+	}
+	return status;
+}
+
 static as_status
 as_command_read_message(as_error* err, as_command* cmd, as_socket* sock, as_node* node)
 {
@@ -793,43 +1162,38 @@ as_command_read_message(as_error* err, as_command* cmd, as_socket* sock, as_node
 		return as_proto_size_error(err, size);
 	}
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_read_buffer_init(cmd, size);
 	status = as_socket_read_deadline(err, sock, node, buf, size, cmd->socket_timeout, cmd->deadline_ms);
 
 	if (status != AEROSPIKE_OK) {
-		as_command_buffer_free(buf, size);
+		as_command_read_buffer_free(cmd, buf, size);
 		return status;
 	}
 
 	if (proto.type == AS_MESSAGE_TYPE) {
-		status = cmd->parse_results_fn(err, node, buf, size, cmd->udata);
-		as_command_buffer_free(buf, size);
-		return status;
+		return as_command_parse_message(err, cmd, node, buf, size, 0);
 	}
 	else if (proto.type == AS_COMPRESSED_MESSAGE_TYPE) {
 		size_t size2;
 		status = as_compressed_size_parse(err, buf, &size2);
 
 		if (status != AEROSPIKE_OK) {
-			as_command_buffer_free(buf, size);
+			as_command_read_buffer_free(cmd, buf, size);
 			return status;
 		}
 
-		uint8_t* buf2 = as_command_buffer_init(size2);
+		uint8_t* buf2 = as_command_read_buffer_init(cmd, size2);
 		status = as_proto_decompress(err, buf2, size2, buf, size);
-		as_command_buffer_free(buf, size);
+		as_command_read_buffer_free(cmd, buf, size);
 
 		if (status != AEROSPIKE_OK) {
-			as_command_buffer_free(buf2, size2);
+			as_command_read_buffer_free(cmd, buf2, size2);
 			return status;
 		}
-		status = cmd->parse_results_fn(err, node, buf2 + sizeof(as_proto), size2 - sizeof(as_proto),
-									   cmd->udata);
-		as_command_buffer_free(buf2, size2);
-		return status;
+		return as_command_parse_message(err, cmd, node, buf2, size2, sizeof(as_proto));
 	}
 	else {
-		as_command_buffer_free(buf, size);
+		as_command_read_buffer_free(cmd, buf, size);
 		return as_proto_type_error(err, &proto, AS_MESSAGE_TYPE);
 	}
 }
@@ -1399,6 +1763,54 @@ as_command_parse_result(as_error* err, as_node* node, uint8_t* buf, size_t size,
 	return status;
 }
 
+as_status
+as_command_parse_result_view(as_error* err, as_node* node, uint8_t* buf, size_t size, void* udata)
+{
+	as_record_view* view = udata;
+	as_msg* msg = (as_msg*)buf;
+	as_status status = as_msg_parse(err, msg, size);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+	status = msg->result_code;
+
+	uint8_t* p = buf + sizeof(as_msg);
+
+	switch (status) {
+		case AEROSPIKE_OK: {
+			p = as_command_ignore_fields(p, msg->n_fields);
+
+			// Index bins in place.  The caller transfers the response buffer to the view.
+			as_bin_view* bins = (msg->n_ops > 0)?
+				cf_malloc(sizeof(as_bin_view) * msg->n_ops) : NULL;
+
+			view->gen = (uint16_t)msg->generation;
+			view->ttl = cf_server_void_time_to_ttl(msg->record_ttl);
+
+			status = as_record_view_parse_bins(view, err, &p, buf + size, bins, msg->n_ops);
+
+			if (status != AEROSPIKE_OK) {
+				cf_free(bins);
+				view->bins = NULL;
+				view->n_bins = 0;
+			}
+			break;
+		}
+
+		case AEROSPIKE_ERR_UDF: {
+			status = as_command_parse_udf_failure(p, err, msg, status);
+			break;
+		}
+
+		default:
+			as_error_update(err, status, "%s %s", as_node_get_address_string(node),
+							as_error_string(status));
+			break;
+	}
+	return status;
+}
+
 as_status
 as_command_parse_success_failure(
 	as_error* err, as_node* node, uint8_t* buf, size_t size, void* udata
@@ -43,12 +43,25 @@ as_config_init(as_config* c)
 	c->async_max_conns_per_node = 300;
 	c->pipe_max_conns_per_node = 64;
 	c->conn_pools_per_node = 1;
+	c->sync_pipe_conns_per_node = 0;
+	c->gather_write_threshold = 1024 * 128;
+	c->zero_copy_threshold = 0;
+	c->circuit_error_rate = 0;
+	c->circuit_min_requests = 100;
+	c->circuit_open_ms = 5000;
+	c->retry_budget = 0;
+	c->retry_budget_min = 10;
 	c->conn_timeout_ms = 1000;
 	c->login_timeout_ms = 5000;
 	c->max_socket_idle = 55;
 	c->tender_interval = 1000;
+	c->tender_interval_min = 50;
+	c->tender_interval_max = 0;
 	c->thread_pool_size = 16;
 	c->tend_thread_cpu = -1;
+	c->tend_thread_pool_size = 8;
+	c->snapshot_path = NULL;
+	c->snapshot_interval = 10000;
 	as_policies_init(&c->policies);
 	as_config_lua_init(&c->lua);
 	memset(&c->tls, 0, sizeof(as_config_tls));
@@ -62,6 +75,8 @@ as_config_init(as_config* c)
 	c->shm_max_nodes = 16;
 	c->shm_max_namespaces = 8;
 	c->shm_takeover_threshold_sec = 30;
+	c->shm_max_processes = 0;
+	c->shm_huge_pages = false;
 	return c;
 }
 
@@ -85,6 +100,10 @@ as_config_destroy(as_config* config) {
 		cf_free(config->cluster_name);
 	}
 
+	if (config->snapshot_path) {
+		cf_free(config->snapshot_path);
+	}
+
 	as_policies_destroy(&config->policies);
 
 	as_config_tls* tls = &config->tls;
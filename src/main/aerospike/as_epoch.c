@@ -0,0 +1,168 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_epoch.h>
+#include <aerospike/as_atomic.h>
+#include <citrusleaf/alloc.h>
+#include <pthread.h>
+#include <string.h>
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+// Per thread record.  Padded to a cache line so threads never write a shared line when
+// entering or exiting a critical section.
+typedef struct as_epoch_thread_s {
+	uint64_t epoch;
+	uint32_t depth;
+	bool in_use;
+	struct as_epoch_thread_s* next;
+	uint8_t pad[64 - sizeof(uint64_t) - sizeof(uint32_t) - sizeof(bool) - sizeof(void*)];
+} as_epoch_thread;
+
+/******************************************************************************
+ * GLOBALS
+ *****************************************************************************/
+
+#if !defined(_MSC_VER)
+static __thread as_epoch_thread* as_epoch_local = NULL;
+#else
+static __declspec(thread) as_epoch_thread* as_epoch_local = NULL;
+#endif
+
+static pthread_key_t as_epoch_key;
+static pthread_once_t as_epoch_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t as_epoch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Thread records are never freed.  Records of exited threads are reused by new threads.
+static as_epoch_thread* as_epoch_threads = NULL;
+
+// Zero is reserved to mark quiescent threads.
+static uint64_t as_epoch_global = 1;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+as_epoch_thread_release(void* udata)
+{
+	as_epoch_thread* t = udata;
+
+	pthread_mutex_lock(&as_epoch_lock);
+	as_store_uint64(&t->epoch, 0);
+	t->depth = 0;
+	t->in_use = false;
+	pthread_mutex_unlock(&as_epoch_lock);
+}
+
+static void
+as_epoch_key_init(void)
+{
+	pthread_key_create(&as_epoch_key, as_epoch_thread_release);
+}
+
+static as_epoch_thread*
+as_epoch_thread_create(void)
+{
+	pthread_once(&as_epoch_once, as_epoch_key_init);
+	pthread_mutex_lock(&as_epoch_lock);
+
+	as_epoch_thread* t = as_epoch_threads;
+
+	while (t && t->in_use) {
+		t = t->next;
+	}
+
+	if (! t) {
+		t = cf_malloc(sizeof(as_epoch_thread));
+		memset(t, 0, sizeof(as_epoch_thread));
+		t->next = as_epoch_threads;
+		as_epoch_threads = t;
+	}
+	t->in_use = true;
+	pthread_mutex_unlock(&as_epoch_lock);
+
+	// Thread specific value is only used to release the record on thread exit.
+	pthread_setspecific(as_epoch_key, t);
+	as_epoch_local = t;
+	return t;
+}
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+void
+as_epoch_enter(void)
+{
+	as_epoch_thread* t = as_epoch_local;
+
+	if (! t) {
+		t = as_epoch_thread_create();
+	}
+
+	if (t->depth++ == 0) {
+		as_store_uint64(&t->epoch, as_load_uint64(&as_epoch_global));
+
+		// The epoch store must be visible to the tender before any node is read.
+		as_fence_memory();
+	}
+}
+
+void
+as_epoch_exit(void)
+{
+	as_epoch_thread* t = as_epoch_local;
+
+	if (--t->depth == 0) {
+		// Node reads must complete before the thread is seen as quiescent.
+		as_fence_unlock();
+		as_store_uint64(&t->epoch, 0);
+	}
+}
+
+uint64_t
+as_epoch_current(void)
+{
+	return as_load_uint64(&as_epoch_global);
+}
+
+void
+as_epoch_advance(void)
+{
+	as_incr_uint64(&as_epoch_global);
+}
+
+uint64_t
+as_epoch_min_active(void)
+{
+	uint64_t min = UINT64_MAX;
+
+	as_fence_memory();
+	pthread_mutex_lock(&as_epoch_lock);
+
+	for (as_epoch_thread* t = as_epoch_threads; t; t = t->next) {
+		uint64_t epoch = as_load_uint64(&t->epoch);
+
+		if (epoch != 0 && epoch < min) {
+			min = epoch;
+		}
+	}
+	pthread_mutex_unlock(&as_epoch_lock);
+	return min;
+}
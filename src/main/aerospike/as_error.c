@@ -33,6 +33,8 @@ as_error_string(as_status status)
 		CASE_ASSIGN(AEROSPIKE_OK);
 		CASE_ASSIGN(AEROSPIKE_QUERY_END);
 
+		CASE_ASSIGN(AEROSPIKE_NO_RESPONSE);
+		CASE_ASSIGN(AEROSPIKE_ERR_CIRCUIT_OPEN);
 		CASE_ASSIGN(AEROSPIKE_USE_NORMAL_RETRY);
 		CASE_ASSIGN(AEROSPIKE_ERR_MAX_RETRIES_EXCEEDED);
 		CASE_ASSIGN(AEROSPIKE_ERR_ASYNC_QUEUE_FULL);
@@ -21,11 +21,13 @@
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_monitor.h>
+#include <aerospike/as_numa.h>
 #include <aerospike/as_pipe.h>
 #include <aerospike/as_proto.h>
 #include <aerospike/as_query_validate.h>
 #include <aerospike/as_shm_cluster.h>
 #include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
 #include <pthread.h>
 
 /******************************************************************************
@@ -52,6 +54,8 @@ int as_event_send_buffer_size = 0;
 int as_event_recv_buffer_size = 0;
 bool as_event_threads_created = false;
 bool as_event_single_thread = false;
+bool as_event_numa_aware = false;
+static as_event_loop* as_event_numa_loops[AS_NUMA_MAX_NODES];
 static pthread_mutex_t as_event_lock = PTHREAD_MUTEX_INITIALIZER;
 
 as_status aerospike_library_init(as_error* err);
@@ -83,7 +87,10 @@ as_event_initialize_loop(as_policy_event* policy, as_event_loop* event_loop, uin
 		memset(&event_loop->delay_queue, 0, sizeof(as_queue));
 	}
 	as_queue_init(&event_loop->pipe_cb_queue, sizeof(as_queued_pipe_cb), AS_EVENT_QUEUE_INITIAL_CAPACITY);
+	event_loop->slab = as_slab_create(&event_loop->thread);
 	event_loop->index = index;
+	event_loop->numa_node = -1;
+	event_loop->numa_next = NULL;
 	event_loop->max_commands_in_queue = policy->max_commands_in_queue;
 	event_loop->max_commands_in_process = policy->max_commands_in_process;
 	event_loop->pending = 0;
@@ -95,6 +102,40 @@ as_event_initialize_loop(as_policy_event* policy, as_event_loop* event_loop, uin
 // Force link error on event initialization when event library not defined.
 #if AS_EVENT_LIB_DEFINED
 
+static uint32_t
+as_event_numa_init(as_policy_event* policy)
+{
+	if (! policy->numa_aware) {
+		return 0;
+	}
+
+	uint32_t size = as_numa_init();
+
+	if (size <= 1) {
+		as_log_info("Ignore numa_aware. NUMA nodes: %u", size);
+		return 0;
+	}
+	return size;
+}
+
+static void
+as_event_numa_add(as_event_loop* event_loop, uint32_t node)
+{
+	// Insert into circular linked list of event loops on the same node.
+	as_event_loop* head = as_event_numa_loops[node];
+
+	event_loop->numa_node = (int)node;
+
+	if (head) {
+		event_loop->numa_next = head->numa_next;
+		head->numa_next = event_loop;
+	}
+	else {
+		event_loop->numa_next = event_loop;
+		as_event_numa_loops[node] = event_loop;
+	}
+}
+
 static as_status
 as_event_initialize_loops(as_error* err, uint32_t capacity)
 {
@@ -175,9 +216,27 @@ as_create_event_loops(as_error* err, as_policy_event* policy, uint32_t capacity,
 	}
 
 	as_event_threads_created = true;
-	
+
+	uint32_t numa_size = as_event_numa_init(policy);
+	bool numa_aware = false;
+
 	for (uint32_t i = 0; i < capacity; i++) {
 		as_event_loop* event_loop = &as_event_loops[i];
+		as_numa_mask numa_saved;
+		bool numa_bound = false;
+		uint32_t node = 0;
+
+		if (numa_size > 0) {
+			// Bind current thread to node while the event loop is created.  The event loop
+			// thread inherits this affinity and event loop memory is first touched on the node.
+			node = as_numa_node(i);
+			numa_bound = as_numa_bind_thread(node, &numa_saved);
+
+			if (! numa_bound) {
+				as_log_warn("Failed to bind event loop %u to NUMA node %u", i, node);
+			}
+		}
+
 		as_event_initialize_loop(policy, event_loop, i);
 		event_loop->loop = NULL;
 
@@ -187,7 +246,18 @@ as_create_event_loops(as_error* err, as_policy_event* policy, uint32_t capacity,
 		memset(&event_loop->thread, 0, sizeof(pthread_t));
 #endif
 
-		if (! as_event_create_loop(event_loop)) {
+		if (numa_bound) {
+			as_event_numa_add(event_loop, node);
+			numa_aware = true;
+		}
+
+		bool created = as_event_create_loop(event_loop);
+
+		if (numa_bound) {
+			as_numa_restore_thread(&numa_saved);
+		}
+
+		if (! created) {
 			as_event_close_loops();
 			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to create event_loop: %u", i);
 		}
@@ -202,6 +272,9 @@ as_create_event_loops(as_error* err, as_policy_event* policy, uint32_t capacity,
 		as_event_loop_size++;
 	}
 
+	// Enable NUMA routing after all event loops have been created.
+	as_event_numa_aware = numa_aware;
+
 	if (event_loops) {
 		*event_loops = as_event_loops;
 	}
@@ -349,12 +422,35 @@ as_event_destroy_loops()
 #endif
 
 	if (as_event_loops) {
+		as_event_numa_aware = false;
+		memset(as_event_numa_loops, 0, sizeof(as_event_numa_loops));
 		cf_free(as_event_loops);
 		as_event_loops = NULL;
 		as_event_loop_size = 0;
 	}
 }
 
+as_event_loop*
+as_event_loop_get_numa(void)
+{
+	int node = as_numa_current_node();
+
+	if (node >= 0) {
+		// Not atomic because doesn't need to be exactly accurate.
+		as_event_loop* event_loop = as_event_numa_loops[node];
+
+		if (event_loop) {
+			as_event_numa_loops[node] = event_loop->numa_next;
+			return event_loop;
+		}
+	}
+
+	// No event loops on current node.  Use round robin across all event loops.
+	as_event_loop* event_loop = as_event_loop_current;
+	as_event_loop_current = event_loop->next;
+	return event_loop;
+}
+
 /******************************************************************************
  * PRIVATE FUNCTIONS
  *****************************************************************************/
@@ -369,6 +465,8 @@ as_event_command_execute(as_event_command* cmd, as_error* err)
 {
 	as_event_loop* event_loop = cmd->event_loop;
 
+	cmd->stats_begin = as_cluster_command_request(cmd->cluster);
+
 	if (as_in_event_loop(event_loop->thread)) {
 		// We are already in the event loop thread.
 		if (event_loop->errors < 5) {
@@ -397,7 +495,7 @@ as_event_command_execute(as_event_command* cmd, as_error* err)
 			if (cmd->node) {
 				as_node_release(cmd->node);
 			}
-			cf_free(cmd);
+			as_slab_free(cmd);
 			return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to queue command");
 		}
 	}
@@ -574,6 +672,168 @@ as_event_create_connection(as_event_command* cmd, as_async_conn_pool* pool)
 	as_event_connect(cmd, pool);
 }
 
+static inline void
+as_event_latency_end(as_event_command* cmd, bool sample)
+{
+	// Stop tracking node latency for the current attempt.
+	if (cmd->flags2 & AS_ASYNC_FLAGS2_LATENCY) {
+		cmd->flags2 &= ~AS_ASYNC_FLAGS2_LATENCY;
+		as_node_latency_end(cmd->node, cf_getus() - cmd->latency_begin, sample);
+	}
+}
+
+static void
+as_event_hedge_schedule(as_event_command* cmd)
+{
+	cmd->hedge_begin = cf_getus();
+
+	uint32_t delay = as_hedge_delay(&cmd->node->read_latency, cmd->hedge_delay,
+									cmd->hedge_percentile);
+
+	if (delay == 0 || (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF)) {
+		return;
+	}
+
+	if (cmd->total_deadline > 0 && cf_getms() + delay >= cmd->total_deadline) {
+		// Command will time out before a hedged read could help.
+		return;
+	}
+
+	// Copy command including write buffer.  The copy waits in the hedge state until the delay
+	// expires and is discarded if the original command completes first.
+	size_t size = cmd->write_offset + cmd->write_len + cmd->read_capacity;
+	as_event_command* hedge = as_slab_alloc(cmd->event_loop->slab, size);
+	memcpy(hedge, cmd, size);
+	hedge->buf = (uint8_t*)hedge + (cmd->buf - (uint8_t*)cmd);
+	hedge->node = NULL;
+	hedge->conn = NULL;
+	hedge->max_retries = 0;
+	hedge->flags &= ~(AS_ASYNC_FLAGS_HAS_TIMER | AS_ASYNC_FLAGS_USING_SOCKET_TIMER |
+					  AS_ASYNC_FLAGS_EVENT_RECEIVED);
+	hedge->flags2 = (hedge->flags2 | AS_ASYNC_FLAGS2_HEDGE_COPY) & ~AS_ASYNC_FLAGS2_LATENCY;
+	hedge->state = AS_ASYNC_STATE_HEDGE;
+	hedge->hedge = cmd;
+	cmd->hedge = hedge;
+
+	cmd->cluster->pending[cmd->event_loop->index]++;
+	as_event_timer_once(hedge, delay);
+}
+
+static void
+as_event_hedge_cancel(as_event_command* cmd)
+{
+	// Discard peer command.  Must be run in event loop thread.
+	as_event_command* peer = cmd->hedge;
+	cmd->hedge = NULL;
+	peer->hedge = NULL;
+
+	as_event_timer_stop(peer);
+
+	if (peer->state == AS_ASYNC_STATE_HEDGE) {
+		// Hedged read was never started, so it is not counted as pending in the event loop.
+		peer->state = AS_ASYNC_STATE_QUEUE_ERROR;
+	}
+	else if (peer->node) {
+		as_event_connection_timeout(peer, &peer->node->async_conn_pools[peer->event_loop->index]);
+	}
+	as_event_command_release(peer);
+}
+
+static void
+as_event_hedge_complete(as_event_command* cmd)
+{
+	// Response received.  First response wins.
+	as_event_command* orig = (cmd->flags2 & AS_ASYNC_FLAGS2_HEDGE_COPY)? cmd->hedge : cmd;
+
+	if (orig && orig->node && orig->hedge_begin && orig->iteration == 0) {
+		// When the hedged read wins, the original node latency is at least the elapsed time.
+		as_hedge_latency_add(&orig->node->read_latency, cf_getus() - orig->hedge_begin);
+	}
+
+	if (cmd->hedge) {
+		as_event_hedge_cancel(cmd);
+	}
+}
+
+static as_node*
+as_event_alternate_node(as_event_command* cmd, as_node* node, uint8_t* replica_index)
+{
+	// Return the next replica after the command's replica index that is not the given node.
+	// Use sequence order so the alternate replica is deterministic for all replica policies.
+	for (uint32_t i = 1; i < AS_MAX_REPLICAS; i++) {
+		uint8_t index = (uint8_t)(cmd->replica_index + i);
+		as_node* alt = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition,
+											 AS_POLICY_REPLICA_SEQUENCE, index, true);
+
+		if (alt && alt != node) {
+			*replica_index = index;
+			return alt;
+		}
+	}
+	return NULL;
+}
+
+static void
+as_event_hedge_execute(as_event_command* cmd)
+{
+	// Hedge delay expired before the original command received a response.
+	as_event_command* orig = cmd->hedge;
+	uint8_t replica_index;
+	as_node* alt = as_event_alternate_node(orig, orig->node, &replica_index);
+
+	if (alt && ! as_node_circuit_allow(cmd->cluster, alt)) {
+		alt = NULL;
+	}
+
+	uint64_t total_timeout = 0;
+
+	if (cmd->total_deadline > 0) {
+		uint64_t now = cf_getms();
+
+		if (now >= cmd->total_deadline) {
+			alt = NULL;
+		}
+		else {
+			total_timeout = cmd->total_deadline - now;
+		}
+	}
+
+	if (! alt) {
+		// No alternate replica.  Discard hedged read.
+		as_event_hedge_cancel(orig);
+		return;
+	}
+
+	as_event_loop* event_loop = cmd->event_loop;
+
+	if (event_loop->max_commands_in_process > 0) {
+		// Delay queue takes precedence over hedged reads.
+		as_event_execute_from_delay_queue(event_loop);
+
+		if (event_loop->pending >= event_loop->max_commands_in_process) {
+			// Event loop is at its limit.  Hedged reads are optional, so discard instead of
+			// delaying other commands.
+			as_event_hedge_cancel(orig);
+			return;
+		}
+	}
+
+	cmd->replica = AS_POLICY_REPLICA_SEQUENCE;
+	cmd->replica_index = replica_index;
+
+	if (total_timeout > 0 && (cmd->socket_timeout == 0 || cmd->socket_timeout >= total_timeout)) {
+		// Use total timer.
+		as_event_timer_once(cmd, total_timeout);
+	}
+	else if (cmd->socket_timeout > 0) {
+		// Use socket timer.
+		as_event_timer_repeat(cmd, cmd->socket_timeout);
+	}
+
+	event_loop->pending++;
+	as_event_command_begin(event_loop, cmd);
+}
+
 static void
 as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 {
@@ -582,11 +842,16 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 	if (cmd->partition) {
 		// If in retry, need to release node from prior attempt.
 		if (cmd->node) {
+			as_event_latency_end(cmd, false);
 			as_node_release(cmd->node);
 		}
 
-		cmd->node = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition, cmd->replica,
-										  cmd->flags & AS_ASYNC_FLAGS_MASTER, cmd->iteration > 0);
+		// Latency aware replica selection only applies to reads.
+		as_policy_replica replica = (cmd->replica == AS_POLICY_REPLICA_LOWEST_LATENCY &&
+			!(cmd->flags & AS_ASYNC_FLAGS_READ))? AS_POLICY_REPLICA_SEQUENCE : cmd->replica;
+
+		cmd->node = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition, replica,
+										  cmd->replica_index, cmd->iteration > 0);
 
 		if (! cmd->node) {
 			event_loop->errors++;
@@ -599,7 +864,39 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 			as_event_error_callback(cmd, &err);
 			return;
 		}
+
+		if (! as_node_circuit_allow(cmd->cluster, cmd->node)) {
+			// Redirect reads that are allowed to use a replica.  Otherwise, fail fast.
+			uint8_t replica_index;
+			as_node* alt = ((cmd->flags & AS_ASYNC_FLAGS_READ) &&
+							!(cmd->flags & AS_ASYNC_FLAGS_LINEARIZE) &&
+							replica != AS_POLICY_REPLICA_MASTER)?
+							as_event_alternate_node(cmd, cmd->node, &replica_index) : NULL;
+
+			if (! alt || ! as_node_circuit_allow(cmd->cluster, alt)) {
+				as_error err;
+				as_error_update(&err, AEROSPIKE_ERR_CIRCUIT_OPEN, "Circuit open for node %s",
+								as_node_get_address_string(cmd->node));
+
+				cmd->node = NULL;
+				as_event_timer_stop(cmd);
+				as_event_error_callback(cmd, &err);
+				return;
+			}
+			cmd->node = alt;
+		}
 		as_node_reserve(cmd->node);
+
+		if (replica == AS_POLICY_REPLICA_LOWEST_LATENCY && ! cmd->pipe_listener) {
+			cmd->flags2 |= AS_ASYNC_FLAGS2_LATENCY;
+			cmd->latency_begin = cf_getus();
+			as_node_latency_begin(cmd->node);
+		}
+
+		if ((cmd->flags2 & AS_ASYNC_FLAGS2_HEDGE) && cmd->iteration == 0 &&
+			!(cmd->flags2 & AS_ASYNC_FLAGS2_HEDGE_COPY)) {
+			as_event_hedge_schedule(cmd);
+		}
 	}
 
 	if (cmd->pipe_listener) {
@@ -719,16 +1016,16 @@ as_event_decompress(as_event_command* cmd)
 		return false;
 	}
 
-	uint8_t* buf = cf_malloc(size);
+	uint8_t* buf = as_slab_alloc(cmd->event_loop->slab, size);
 
 	if (as_proto_decompress(&err, buf, size, cmd->buf, cmd->len) != AEROSPIKE_OK) {
-		cf_free(buf);
+		as_slab_free(buf);
 		as_event_parse_error(cmd, &err);
 		return false;
 	}
 
 	if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-		cf_free(cmd->buf);
+		as_slab_free(cmd->buf);
 	}
 	cmd->buf = buf;
 	cmd->len = (uint32_t)size;
@@ -779,6 +1076,7 @@ as_event_socket_timeout(as_event_command* cmd)
 	}
 
 	// Node should not be null at this point.
+	as_event_latency_end(cmd, true);
 	as_event_connection_timeout(cmd, &cmd->node->async_conn_pools[cmd->event_loop->index]);
 
 	if (! as_event_command_retry(cmd, true)) {
@@ -823,6 +1121,11 @@ as_event_process_timer(as_event_command* cmd)
 			as_event_execute_retry(cmd);
 			break;
 
+		case AS_ASYNC_STATE_HEDGE:
+			// Start hedged read.
+			as_event_hedge_execute(cmd);
+			break;
+
 		default:
 			// Total timeout.
 			as_event_total_timeout(cmd);
@@ -839,6 +1142,11 @@ as_event_total_timeout(as_event_command* cmd)
 	}
 
 	// Node should not be null at this point.
+	if (cmd->state != AS_ASYNC_STATE_RETRY) {
+		// Retry has already recorded the error.
+		as_node_circuit_record(cmd->cluster, cmd->node, AEROSPIKE_ERR_TIMEOUT);
+	}
+	as_event_latency_end(cmd, true);
 	as_event_connection_timeout(cmd, &cmd->node->async_conn_pools[cmd->event_loop->index]);
 
 	as_error err;
@@ -850,17 +1158,32 @@ as_event_total_timeout(as_event_command* cmd)
 bool
 as_event_command_retry(as_event_command* cmd, bool timeout)
 {
+	if (cmd->node) {
+		as_node_circuit_record(cmd->cluster, cmd->node,
+							   timeout ? AEROSPIKE_ERR_TIMEOUT : AEROSPIKE_ERR_ASYNC_CONNECTION);
+	}
+
+	if (! timeout) {
+		// Node may have failed.  Do not wait for next tend interval to find out.
+		as_cluster_request_tend(cmd->cluster);
+	}
+
 	// Check max retries.
 	if (++(cmd->iteration) > cmd->max_retries) {
 		return false;
 	}
 
-	// Alternate between master and prole on socket errors or database reads.
-	// Timeouts are not a good indicator of impending data migration.
+	// Check if cluster retry budget has been exhausted.
+	if (! as_cluster_retry_budget_allow(cmd->cluster)) {
+		return false;
+	}
+
+	// Move to the next replica in sequence on socket errors or database reads, so retries
+	// reach every replica.  Timeouts are not a good indicator of impending data migration.
 	if (! timeout || ((cmd->flags & AS_ASYNC_FLAGS_READ) &&
 					  !(cmd->flags & AS_ASYNC_FLAGS_LINEARIZE))) {
 		// Note: SC session read will ignore this setting because it uses master only.
-		cmd->flags ^= AS_ASYNC_FLAGS_MASTER;
+		cmd->replica_index++;
 	}
 
 	// Old connection should already be closed or is closing.
@@ -946,10 +1269,19 @@ as_event_put_connection(as_event_command* cmd, as_async_conn_pool* pool)
 static inline void
 as_event_response_complete(as_event_command* cmd)
 {
+	as_node_circuit_record(cmd->cluster, cmd->node, AEROSPIKE_OK);
+	as_cluster_command_latency(cmd->cluster, cmd->stats_begin);
+
 	if (cmd->pipe_listener != NULL) {
 		as_pipe_response_complete(cmd);
 		return;
 	}
+
+	as_event_latency_end(cmd, true);
+
+	if (cmd->flags2 & AS_ASYNC_FLAGS2_HEDGE) {
+		as_event_hedge_complete(cmd);
+	}
 	
 	as_event_timer_stop(cmd);
 	as_event_stop_watcher(cmd, cmd->conn);
@@ -1119,6 +1451,17 @@ as_partition_tracker_should_retry(as_status status);
 void
 as_event_error_callback(as_event_command* cmd, as_error* err)
 {
+	if ((cmd->flags2 & AS_ASYNC_FLAGS2_HEDGE) && cmd->hedge) {
+		if (cmd->hedge->state != AS_ASYNC_STATE_HEDGE) {
+			// Peer command is still in progress and will notify the user.
+			cmd->hedge->hedge = NULL;
+			as_event_command_release(cmd);
+			return;
+		}
+		// Hedged read has not started.  Discard it and report this error.
+		as_event_hedge_cancel(cmd);
+	}
+
 	if (cmd->type == AS_ASYNC_TYPE_SCAN_PARTITION && as_partition_tracker_should_retry(err->code)) {
 		as_event_executor* executor = cmd->udata;
 		as_event_command_release(cmd);
@@ -1178,6 +1521,8 @@ as_event_parse_error(as_event_command* cmd, as_error* err)
 void
 as_event_socket_error(as_event_command* cmd, as_error* err)
 {
+	as_cluster_request_tend(cmd->cluster);
+
 	if (cmd->pipe_listener) {
 		// Retry pipeline commands.
 		as_pipe_socket_error(cmd, err, true);
@@ -1193,6 +1538,8 @@ as_event_socket_error(as_event_command* cmd, as_error* err)
 void
 as_event_response_error(as_event_command* cmd, as_error* err)
 {
+	as_node_circuit_record(cmd->cluster, cmd->node, err->code);
+
 	if (cmd->pipe_listener != NULL) {
 		as_pipe_response_error(cmd, err);
 		return;
@@ -1200,6 +1547,12 @@ as_event_response_error(as_event_command* cmd, as_error* err)
 	
 	// Server sent back error.
 	// Release resources, make callback and free command.
+	as_event_latency_end(cmd, true);
+
+	if (cmd->flags2 & AS_ASYNC_FLAGS2_HEDGE) {
+		as_event_hedge_complete(cmd);
+	}
+
 	as_event_timer_stop(cmd);
 	as_event_stop_watcher(cmd, cmd->conn);
 	
@@ -1379,14 +1732,15 @@ as_event_command_free(as_event_command* cmd)
 	cmd->cluster->pending[event_loop->index]--;
 
 	if (cmd->node) {
+		as_event_latency_end(cmd, false);
 		as_node_release(cmd->node);
 	}
 
 	if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-		cf_free(cmd->buf);
+		as_slab_free(cmd->buf);
 	}
 
-	cf_free(cmd);
+	as_slab_free(cmd);
 
 	if (event_loop->max_commands_in_process > 0 && ! event_loop->using_delay_queue) {
 		// Try executing commands from the delay queue.
@@ -1504,7 +1858,7 @@ connector_execute_command(as_event_loop* event_loop, connector_shared* cs)
 	event_loop->pending++;
 
 	size_t s = (sizeof(connector_command) + AS_AUTHENTICATION_MAX_SIZE + 1023) & ~1023;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	as_event_command* cmd = (as_event_command*)as_slab_alloc(event_loop->slab, s);
 	connector_command* cc = (connector_command*)cmd;
 
 	cmd->socket_timeout = 0;
@@ -1528,8 +1882,10 @@ connector_execute_command(as_event_loop* event_loop, connector_shared* cs)
 	cmd->proto_type = AS_MESSAGE_TYPE;
 	cmd->proto_type_rcv = 0;
 	cmd->state = AS_ASYNC_STATE_CONNECT;
-	cmd->flags = AS_ASYNC_FLAGS_MASTER;
+	cmd->flags = 0;
 	cmd->flags2 = 0;
+	cmd->replica_index = 0;
+	cmd->stats_begin = 0;
 
 	cmd->total_deadline = cf_getms() + cs->timeout_ms;
 	as_event_timer_once(cmd, cs->timeout_ms);
@@ -468,9 +468,9 @@ as_ev_command_peek_block(as_event_command* cmd)
 		// till next iteration.
 		if (cmd->len > cmd->read_capacity) {
 			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-				cf_free(cmd->buf);
+				as_slab_free(cmd->buf);
 			}
-			cmd->buf = cf_malloc(size);
+			cmd->buf = as_slab_alloc(cmd->event_loop->slab, size);
 			cmd->read_capacity = cmd->len;
 			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
 		}
@@ -554,9 +554,9 @@ as_ev_command_read(as_event_command* cmd)
 		
 		if (cmd->len > cmd->read_capacity) {
 			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-				cf_free(cmd->buf);
+				as_slab_free(cmd->buf);
 			}
-			cmd->buf = cf_malloc(size);
+			cmd->buf = as_slab_alloc(cmd->event_loop->slab, size);
 			cmd->read_capacity = cmd->len;
 			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
 		}
@@ -0,0 +1,1682 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_event.h>
+#include <aerospike/as_event_internal.h>
+#include <aerospike/as_admin.h>
+#include <aerospike/as_async.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_pipe.h>
+#include <aerospike/as_proto.h>
+#include <aerospike/as_socket.h>
+#include <aerospike/as_status.h>
+#include <aerospike/as_tls.h>
+#include <aerospike/as_vector.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+
+#if defined(AS_USE_LIBURING)
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+/******************************************************************************
+ * GLOBALS
+ *****************************************************************************/
+
+extern int as_event_send_buffer_size;
+extern int as_event_recv_buffer_size;
+extern bool as_event_threads_created;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+// Ring sizes.
+#define AS_URING_ENTRIES 4096
+#define AS_URING_FILES 4096
+
+// Provided receive buffers.  Buffer count must be a power of 2.
+#define AS_URING_BUF_GROUP 0
+#define AS_URING_BUF_COUNT 256
+#define AS_URING_BUF_SIZE (16 * 1024)
+
+// Operation type is stored in the low bits of the completion user data.
+#define AS_URING_OP_RECV 1
+#define AS_URING_OP_SEND 2
+#define AS_URING_OP_POLL 3
+#define AS_URING_OP_WAKEUP 4
+#define AS_URING_OP_MASK 7
+
+// Completions that do not need processing (cancel, poll update/remove).
+#define AS_URING_IGNORE 0
+
+// Armed connection operations.
+#define AS_URING_ARMED_RECV 1
+#define AS_URING_ARMED_SEND 2
+#define AS_URING_ARMED_POLL 4
+
+// Connection receive error when socket was closed by peer.
+#define AS_URING_EOF -1
+
+#define AS_EVENT_WRITE_COMPLETE 0
+#define AS_EVENT_WRITE_INCOMPLETE 1
+#define AS_EVENT_WRITE_ERROR 2
+
+#define AS_EVENT_READ_COMPLETE 3
+#define AS_EVENT_READ_INCOMPLETE 4
+#define AS_EVENT_READ_ERROR 5
+
+#define AS_EVENT_TLS_NEED_READ 6
+#define AS_EVENT_TLS_NEED_WRITE 7
+
+#define AS_EVENT_COMMAND_DONE 8
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct as_uring_loop {
+	struct io_uring ring;
+	struct io_uring_buf_ring* buf_ring;
+	uint8_t* bufs;
+	as_event_command** timers;
+	uint32_t timer_size;
+	uint32_t timer_capacity;
+	int* files;  // Free registered file indexes.
+	uint32_t files_size;
+	as_vector ready;  // Connections that need to be driven after completions are processed.
+	uint64_t wakeup_value;
+	int wakeup_fd;
+	bool stop;
+} as_uring_loop;
+
+/******************************************************************************
+ * LOOP FUNCTIONS
+ *****************************************************************************/
+
+static struct io_uring_sqe*
+as_uring_get_sqe(as_uring_loop* ul)
+{
+	struct io_uring_sqe* sqe = io_uring_get_sqe(&ul->ring);
+
+	if (! sqe) {
+		// Submission queue is full.  Flush it to the kernel and try again.
+		io_uring_submit(&ul->ring);
+		sqe = io_uring_get_sqe(&ul->ring);
+	}
+	return sqe;
+}
+
+static inline void
+as_uring_set_fd(struct io_uring_sqe* sqe, as_event_connection* conn)
+{
+	if (conn->fixed >= 0) {
+		sqe->flags |= IOSQE_FIXED_FILE;
+	}
+}
+
+static inline int
+as_uring_fd(as_event_connection* conn)
+{
+	return (conn->fixed >= 0)? conn->fixed : conn->socket.fd;
+}
+
+static void
+as_uring_wakeup_arm(as_uring_loop* ul)
+{
+	struct io_uring_sqe* sqe = as_uring_get_sqe(ul);
+	io_uring_prep_read(sqe, ul->wakeup_fd, &ul->wakeup_value, sizeof(ul->wakeup_value), 0);
+	io_uring_sqe_set_data64(sqe, AS_URING_OP_WAKEUP);
+}
+
+static void
+as_uring_loop_destroy(as_uring_loop* ul)
+{
+	if (ul->buf_ring) {
+		io_uring_free_buf_ring(&ul->ring, ul->buf_ring, AS_URING_BUF_COUNT, AS_URING_BUF_GROUP);
+	}
+	io_uring_queue_exit(&ul->ring);
+	close(ul->wakeup_fd);
+	as_vector_destroy(&ul->ready);
+	cf_free(ul->files);
+	cf_free(ul->timers);
+	cf_free(ul->bufs);
+	cf_free(ul);
+}
+
+static as_uring_loop*
+as_uring_loop_create(void)
+{
+	as_uring_loop* ul = cf_malloc(sizeof(as_uring_loop));
+	memset(ul, 0, sizeof(as_uring_loop));
+
+	ul->wakeup_fd = eventfd(0, EFD_CLOEXEC);
+
+	if (ul->wakeup_fd < 0) {
+		as_log_error("Failed to create io_uring wakeup: %d", errno);
+		cf_free(ul);
+		return NULL;
+	}
+
+	int rv = io_uring_queue_init(AS_URING_ENTRIES, &ul->ring, 0);
+
+	if (rv < 0) {
+		as_log_error("Failed to create io_uring: %d", -rv);
+		close(ul->wakeup_fd);
+		cf_free(ul);
+		return NULL;
+	}
+
+	as_vector_init(&ul->ready, sizeof(as_event_connection*), 64);
+
+	// Register provided receive buffers.  The kernel picks a buffer when socket data arrives,
+	// so receive operations can be armed on idle connections without reserving memory.
+	ul->buf_ring = io_uring_setup_buf_ring(&ul->ring, AS_URING_BUF_COUNT, AS_URING_BUF_GROUP, 0, &rv);
+
+	if (! ul->buf_ring) {
+		as_log_error("Failed to register io_uring buffers: %d", -rv);
+		as_uring_loop_destroy(ul);
+		return NULL;
+	}
+
+	ul->bufs = cf_malloc((size_t)AS_URING_BUF_COUNT * AS_URING_BUF_SIZE);
+
+	int mask = io_uring_buf_ring_mask(AS_URING_BUF_COUNT);
+
+	for (uint32_t i = 0; i < AS_URING_BUF_COUNT; i++) {
+		io_uring_buf_ring_add(ul->buf_ring, ul->bufs + (size_t)i * AS_URING_BUF_SIZE,
+							  AS_URING_BUF_SIZE, (unsigned short)i, mask, (int)i);
+	}
+	io_uring_buf_ring_advance(ul->buf_ring, AS_URING_BUF_COUNT);
+
+	// Register sparse file table.  Connections fall back to raw file descriptors when
+	// registered files are not supported or the table is full.
+	if (io_uring_register_files_sparse(&ul->ring, AS_URING_FILES) == 0) {
+		ul->files = cf_malloc(sizeof(int) * AS_URING_FILES);
+
+		for (uint32_t i = 0; i < AS_URING_FILES; i++) {
+			ul->files[i] = AS_URING_FILES - 1 - i;
+		}
+		ul->files_size = AS_URING_FILES;
+	}
+
+	as_uring_wakeup_arm(ul);
+	return ul;
+}
+
+void
+as_event_close_loop(as_event_loop* event_loop)
+{
+	// Ring is destroyed after the event loop exits.
+	event_loop->loop->stop = true;
+}
+
+static void
+as_uring_wakeup(as_event_loop* event_loop)
+{
+	// Read command pointers from queue.
+	as_event_commander cmd;
+	uint32_t i = 0;
+
+	// Only process original size of queue.  Recursive pre-registration errors can
+	// result in new commands being added while the loop is in process.  If we process
+	// them, we could end up in an infinite loop.
+	pthread_mutex_lock(&event_loop->lock);
+	uint32_t size = as_queue_size(&event_loop->queue);
+	bool status = as_queue_pop(&event_loop->queue, &cmd);
+	pthread_mutex_unlock(&event_loop->lock);
+
+	while (status) {
+		if (! cmd.executable) {
+			// Received stop signal.
+			as_event_close_loop(event_loop);
+			return;
+		}
+		cmd.executable(event_loop, cmd.udata);
+
+		if (++i < size) {
+			pthread_mutex_lock(&event_loop->lock);
+			status = as_queue_pop(&event_loop->queue, &cmd);
+			pthread_mutex_unlock(&event_loop->lock);
+		}
+		else {
+			break;
+		}
+	}
+
+	// Commands queued after the wakeup read completed have signaled the eventfd again.
+	as_uring_wakeup_arm(event_loop->loop);
+}
+
+bool
+as_event_execute(as_event_loop* event_loop, as_event_executable executable, void* udata)
+{
+	// Send command through queue so it can be executed in event loop thread.
+	pthread_mutex_lock(&event_loop->lock);
+	as_event_commander qcmd = {.executable = executable, .udata = udata};
+	bool queued = as_queue_push(&event_loop->queue, &qcmd);
+	pthread_mutex_unlock(&event_loop->lock);
+
+	if (queued) {
+		eventfd_write(event_loop->loop->wakeup_fd, 1);
+	}
+	return queued;
+}
+
+/******************************************************************************
+ * TIMER FUNCTIONS
+ *****************************************************************************/
+
+static inline void
+as_uring_timer_set(as_uring_loop* ul, uint32_t i, as_event_command* cmd)
+{
+	ul->timers[i] = cmd;
+	cmd->timer.index = i + 1;
+}
+
+static void
+as_uring_timer_up(as_uring_loop* ul, uint32_t i)
+{
+	as_event_command* cmd = ul->timers[i];
+
+	while (i > 0) {
+		uint32_t parent = (i - 1) / 2;
+		as_event_command* p = ul->timers[parent];
+
+		if (p->timer.deadline <= cmd->timer.deadline) {
+			break;
+		}
+		as_uring_timer_set(ul, i, p);
+		i = parent;
+	}
+	as_uring_timer_set(ul, i, cmd);
+}
+
+static void
+as_uring_timer_down(as_uring_loop* ul, uint32_t i)
+{
+	as_event_command* cmd = ul->timers[i];
+
+	while (true) {
+		uint32_t child = i * 2 + 1;
+
+		if (child >= ul->timer_size) {
+			break;
+		}
+
+		if (child + 1 < ul->timer_size &&
+			ul->timers[child + 1]->timer.deadline < ul->timers[child]->timer.deadline) {
+			child++;
+		}
+
+		if (cmd->timer.deadline <= ul->timers[child]->timer.deadline) {
+			break;
+		}
+		as_uring_timer_set(ul, i, ul->timers[child]);
+		i = child;
+	}
+	as_uring_timer_set(ul, i, cmd);
+}
+
+void
+as_uring_timer_start(as_event_command* cmd, uint64_t timeout, uint64_t repeat)
+{
+	as_uring_loop* ul = cmd->event_loop->loop;
+
+	if (!(cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Timer fields are not initialized.
+		cmd->timer.index = 0;
+	}
+
+	cmd->timer.deadline = cf_getms() + timeout;
+	cmd->timer.repeat = repeat;
+
+	if (cmd->timer.index == 0) {
+		if (ul->timer_size == ul->timer_capacity) {
+			ul->timer_capacity = ul->timer_capacity ? ul->timer_capacity * 2 : 256;
+			ul->timers = cf_realloc(ul->timers, sizeof(as_event_command*) * ul->timer_capacity);
+		}
+		as_uring_timer_set(ul, ul->timer_size++, cmd);
+		as_uring_timer_up(ul, ul->timer_size - 1);
+	}
+	else {
+		as_uring_timer_up(ul, cmd->timer.index - 1);
+		as_uring_timer_down(ul, cmd->timer.index - 1);
+	}
+}
+
+void
+as_uring_timer_stop(as_event_command* cmd)
+{
+	if (cmd->timer.index == 0) {
+		return;
+	}
+
+	as_uring_loop* ul = cmd->event_loop->loop;
+	uint32_t i = cmd->timer.index - 1;
+
+	cmd->timer.index = 0;
+
+	if (--ul->timer_size == i) {
+		return;
+	}
+
+	// Move last timer into the vacated slot.
+	as_uring_timer_set(ul, i, ul->timers[ul->timer_size]);
+	as_uring_timer_up(ul, i);
+	as_uring_timer_down(ul, i);
+}
+
+static void
+as_uring_process_timers(as_uring_loop* ul)
+{
+	uint64_t now = cf_getms();
+
+	while (ul->timer_size > 0 && ! ul->stop) {
+		as_event_command* cmd = ul->timers[0];
+
+		if (cmd->timer.deadline > now) {
+			break;
+		}
+
+		if (cmd->timer.repeat) {
+			// Reschedule socket timer before the callback, which may stop it.
+			cmd->timer.deadline = now + cmd->timer.repeat;
+			as_uring_timer_down(ul, 0);
+			as_event_socket_timeout(cmd);
+		}
+		else {
+			as_uring_timer_stop(cmd);
+			as_event_process_timer(cmd);
+		}
+	}
+}
+
+/******************************************************************************
+ * CONNECTION FUNCTIONS
+ *****************************************************************************/
+
+static void
+as_uring_buf_return(as_uring_loop* ul, uint16_t bid)
+{
+	io_uring_buf_ring_add(ul->buf_ring, ul->bufs + (size_t)bid * AS_URING_BUF_SIZE,
+						  AS_URING_BUF_SIZE, bid, io_uring_buf_ring_mask(AS_URING_BUF_COUNT), 0);
+	io_uring_buf_ring_advance(ul->buf_ring, 1);
+}
+
+static void
+as_uring_rx_clear(as_uring_loop* ul, as_event_connection* conn)
+{
+	while (conn->rx_count > 0) {
+		as_uring_buf_return(ul, conn->rx[conn->rx_head].bid);
+		conn->rx_head = (conn->rx_head + 1) % AS_URING_RX_MAX;
+		conn->rx_count--;
+	}
+}
+
+static inline void
+as_uring_conn_reserve(as_event_connection* conn)
+{
+	conn->ops++;
+}
+
+static inline bool
+as_uring_conn_release(as_event_connection* conn)
+{
+	if (--conn->ops == 0 && conn->closed) {
+		// Last ring reference to a closed connection.
+		as_socket_close(&conn->socket);
+		cf_free(conn);
+		return false;
+	}
+	return true;
+}
+
+static void
+as_uring_cancel(as_uring_loop* ul, as_event_connection* conn, uint32_t op)
+{
+	struct io_uring_sqe* sqe = as_uring_get_sqe(ul);
+	io_uring_prep_cancel64(sqe, (uint64_t)(uintptr_t)conn | op, 0);
+	io_uring_sqe_set_data64(sqe, AS_URING_IGNORE);
+}
+
+static void
+as_uring_close(as_event_connection* conn)
+{
+	as_uring_loop* ul = conn->event_loop->loop;
+
+	if (conn->fixed >= 0) {
+		// Submit pending operations before the registered file is released, so they do not
+		// resolve to a different socket that reuses the file index.
+		io_uring_submit(&ul->ring);
+
+		int fd = -1;
+		io_uring_register_files_update(&ul->ring, (unsigned)conn->fixed, &fd, 1);
+		ul->files[ul->files_size++] = conn->fixed;
+		conn->fixed = -1;
+	}
+
+	as_uring_rx_clear(ul, conn);
+
+	if (conn->ops == 0) {
+		as_socket_close(&conn->socket);
+		cf_free(conn);
+		return;
+	}
+
+	// Ring operations are still in flight.  Abort them and free connection when the last
+	// operation completes.
+	conn->closed = true;
+	shutdown(conn->socket.fd, SHUT_RDWR);
+
+	if (conn->armed & AS_URING_ARMED_RECV) {
+		as_uring_cancel(ul, conn, AS_URING_OP_RECV);
+	}
+
+	if (conn->armed & AS_URING_ARMED_SEND) {
+		as_uring_cancel(ul, conn, AS_URING_OP_SEND);
+	}
+
+	if (conn->armed & AS_URING_ARMED_POLL) {
+		as_uring_cancel(ul, conn, AS_URING_OP_POLL);
+	}
+}
+
+static void
+as_uring_close_cb(as_event_loop* event_loop, as_event_connection* conn)
+{
+	as_uring_close(conn);
+}
+
+void
+as_event_close_connection(as_event_connection* conn)
+{
+	as_event_loop* event_loop = conn->event_loop;
+
+	if (! pthread_equal(event_loop->thread, pthread_self())) {
+		// Ring state can only be modified in the event loop thread.  This happens when a node
+		// is destroyed from another thread and its idle connections are closed.
+		if (as_event_execute(event_loop, (as_event_executable)as_uring_close_cb, conn)) {
+			return;
+		}
+		as_log_error("Failed to queue connection close");
+		shutdown(conn->socket.fd, SHUT_RDWR);
+		return;
+	}
+	as_uring_close(conn);
+}
+
+static void
+as_uring_schedule(as_event_connection* conn)
+{
+	if (conn->scheduled) {
+		return;
+	}
+
+	as_uring_loop* ul = conn->event_loop->loop;
+	conn->scheduled = true;
+	as_uring_conn_reserve(conn);
+	as_vector_append(&ul->ready, &conn);
+}
+
+static void
+as_uring_arm_recv(as_event_connection* conn)
+{
+	// Apply backpressure when received data queue is full.  Receive is armed again after
+	// commands have consumed queued data.  A single shot receive completes into at most
+	// one buffer, so an armed receive always has room in the queue.
+	if ((conn->armed & AS_URING_ARMED_RECV) || conn->rx_count == AS_URING_RX_MAX) {
+		return;
+	}
+
+	as_uring_loop* ul = conn->event_loop->loop;
+	struct io_uring_sqe* sqe = as_uring_get_sqe(ul);
+
+	io_uring_prep_recv(sqe, as_uring_fd(conn), NULL, 0, 0);
+	as_uring_set_fd(sqe, conn);
+	sqe->flags |= IOSQE_BUFFER_SELECT;
+	sqe->buf_group = AS_URING_BUF_GROUP;
+	io_uring_sqe_set_data64(sqe, (uint64_t)(uintptr_t)conn | AS_URING_OP_RECV);
+
+	conn->armed |= AS_URING_ARMED_RECV;
+	as_uring_conn_reserve(conn);
+}
+
+static void
+as_uring_arm_send(as_event_command* cmd)
+{
+	as_event_connection* conn = cmd->conn;
+	as_uring_loop* ul = conn->event_loop->loop;
+	struct io_uring_sqe* sqe = as_uring_get_sqe(ul);
+	uint8_t* buf = (uint8_t*)cmd + cmd->write_offset;
+
+	io_uring_prep_send(sqe, as_uring_fd(conn), buf + cmd->pos, cmd->len - cmd->pos, MSG_NOSIGNAL);
+	as_uring_set_fd(sqe, conn);
+	io_uring_sqe_set_data64(sqe, (uint64_t)(uintptr_t)conn | AS_URING_OP_SEND);
+
+	conn->send_cmd = cmd;
+	conn->armed |= AS_URING_ARMED_SEND;
+	as_uring_conn_reserve(conn);
+}
+
+static void
+as_uring_watch(as_event_connection* conn, uint32_t mask)
+{
+	// Poll readiness is used for connect and TLS sockets.
+	if (mask == conn->poll && (conn->armed & AS_URING_ARMED_POLL)) {
+		return;
+	}
+
+	as_uring_loop* ul = conn->event_loop->loop;
+	struct io_uring_sqe* sqe = as_uring_get_sqe(ul);
+	uint64_t data = (uint64_t)(uintptr_t)conn | AS_URING_OP_POLL;
+
+	if (conn->armed & AS_URING_ARMED_POLL) {
+		io_uring_prep_poll_update(sqe, data, data, mask, IORING_POLL_UPDATE_EVENTS);
+		io_uring_sqe_set_data64(sqe, AS_URING_IGNORE);
+	}
+	else {
+		io_uring_prep_poll_add(sqe, as_uring_fd(conn), mask);
+		as_uring_set_fd(sqe, conn);
+		io_uring_sqe_set_data64(sqe, data);
+		conn->armed |= AS_URING_ARMED_POLL;
+		as_uring_conn_reserve(conn);
+	}
+	conn->poll = mask;
+}
+
+void
+as_event_stop_watcher(as_event_command* cmd, as_event_connection* conn)
+{
+	conn->watching = 0;
+	conn->poll = 0;
+
+	if (conn->armed & AS_URING_ARMED_POLL) {
+		as_uring_loop* ul = conn->event_loop->loop;
+		struct io_uring_sqe* sqe = as_uring_get_sqe(ul);
+		io_uring_prep_poll_remove(sqe, (uint64_t)(uintptr_t)conn | AS_URING_OP_POLL);
+		io_uring_sqe_set_data64(sqe, AS_URING_IGNORE);
+	}
+}
+
+static inline void
+as_uring_watch_write(as_event_command* cmd)
+{
+	as_uring_watch(cmd->conn, cmd->pipe_listener != NULL ? POLLOUT | POLLIN : POLLOUT);
+}
+
+static inline void
+as_uring_watch_read(as_event_command* cmd)
+{
+	as_uring_watch(cmd->conn, POLLIN);
+}
+
+/******************************************************************************
+ * COMMAND FUNCTIONS
+ *****************************************************************************/
+
+static void
+as_uring_write_error(as_event_command* cmd, int e)
+{
+	int fd = cmd->conn->socket.fd;
+
+	if (! as_event_socket_retry(cmd)) {
+		as_error err;
+
+		if (e) {
+			as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket write failed", e);
+		}
+		else {
+			as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket write closed by peer", 0);
+		}
+		as_event_socket_error(cmd, &err);
+	}
+}
+
+static int
+as_uring_write(as_event_command* cmd)
+{
+	if (cmd->conn->socket.ctx) {
+		uint8_t* buf = (uint8_t*)cmd + cmd->write_offset;
+
+		do {
+			int rv = as_tls_write_once(&cmd->conn->socket, buf + cmd->pos, cmd->len - cmd->pos);
+			if (rv > 0) {
+				as_uring_watch_write(cmd);
+				cmd->pos += rv;
+				continue;
+			}
+			else if (rv == -1) {
+				// TLS sometimes need to read even when we are writing.
+				as_uring_watch_read(cmd);
+				return AS_EVENT_TLS_NEED_READ;
+			}
+			else if (rv == -2) {
+				// TLS wants a write, we're all set for that.
+				as_uring_watch_write(cmd);
+				return AS_EVENT_WRITE_INCOMPLETE;
+			}
+			else if (rv < -2) {
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+					as_socket_error(cmd->conn->socket.fd, cmd->node, &err, AEROSPIKE_ERR_TLS_ERROR, "TLS write failed", rv);
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_WRITE_ERROR;
+			}
+			// as_tls_write_once can't return 0
+		} while (cmd->pos < cmd->len);
+	}
+	else {
+		if (cmd->conn->armed & AS_URING_ARMED_SEND) {
+			// Wait for send in progress.
+			return AS_EVENT_WRITE_INCOMPLETE;
+		}
+
+		if (cmd->pos < cmd->len) {
+			// Send completion continues the write.
+			as_uring_arm_send(cmd);
+			return AS_EVENT_WRITE_INCOMPLETE;
+		}
+	}
+
+	// Socket timeout applies only to read events.
+	// Reset event received because we are switching from a write to a read state.
+	// This handles case where write succeeds and read event does not occur.  If we didn't reset,
+	// the socket timeout would go through two iterations (double the timeout) because a write
+	// event occurred in the first timeout period.
+	cmd->flags &= ~AS_ASYNC_FLAGS_EVENT_RECEIVED;
+	return AS_EVENT_WRITE_COMPLETE;
+}
+
+static int
+as_uring_read(as_event_command* cmd)
+{
+	cmd->flags |= AS_ASYNC_FLAGS_EVENT_RECEIVED;
+
+	as_event_connection* conn = cmd->conn;
+
+	if (conn->socket.ctx) {
+		do {
+			int rv = as_tls_read_once(&conn->socket, cmd->buf + cmd->pos, cmd->len - cmd->pos);
+			if (rv > 0) {
+				as_uring_watch_read(cmd);
+				cmd->pos += rv;
+				continue;
+			}
+			else if (rv == -1) {
+				// TLS wants a read
+				as_uring_watch_read(cmd);
+				return AS_EVENT_READ_INCOMPLETE;
+			}
+			else if (rv == -2) {
+				// TLS sometimes needs to write, even when the app is reading.
+				as_uring_watch_write(cmd);
+				return AS_EVENT_TLS_NEED_WRITE;
+			}
+			else if (rv < -2) {
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+					as_socket_error(conn->socket.fd, cmd->node, &err, AEROSPIKE_ERR_TLS_ERROR, "TLS read failed", rv);
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_READ_ERROR;
+			}
+			// as_tls_read_once doesn't return 0
+		} while (cmd->pos < cmd->len);
+
+		return AS_EVENT_READ_COMPLETE;
+	}
+
+	// Copy from received buffers.
+	as_uring_loop* ul = conn->event_loop->loop;
+
+	while (cmd->pos < cmd->len) {
+		if (conn->rx_count == 0) {
+			if (conn->rx_error) {
+				int fd = conn->socket.fd;
+				int e = conn->rx_error;
+
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+
+					if (e == AS_URING_EOF) {
+						as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket read closed by peer", 0);
+					}
+					else {
+						as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket read failed", e);
+					}
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_READ_ERROR;
+			}
+
+			as_uring_arm_recv(conn);
+			return AS_EVENT_READ_INCOMPLETE;
+		}
+
+		as_uring_chunk* chunk = &conn->rx[conn->rx_head];
+		uint32_t len = cmd->len - cmd->pos;
+
+		if (len > chunk->len) {
+			len = chunk->len;
+		}
+
+		memcpy(cmd->buf + cmd->pos, ul->bufs + (size_t)chunk->bid * AS_URING_BUF_SIZE + chunk->offset, len);
+		cmd->pos += len;
+		chunk->offset += len;
+		chunk->len -= len;
+
+		if (chunk->len == 0) {
+			as_uring_buf_return(ul, chunk->bid);
+			conn->rx_head = (conn->rx_head + 1) % AS_URING_RX_MAX;
+			conn->rx_count--;
+		}
+	}
+	return AS_EVENT_READ_COMPLETE;
+}
+
+static inline void
+as_uring_watch_response(as_event_command* cmd)
+{
+	as_event_connection* conn = cmd->conn;
+
+	if (conn->socket.ctx) {
+		as_uring_watch_read(cmd);
+	}
+	else if (conn->rx_count > 0 || conn->rx_error) {
+		// Response data was received before the write completion was processed.
+		as_uring_schedule(conn);
+	}
+	else {
+		as_uring_arm_recv(conn);
+	}
+}
+
+static inline void
+as_uring_command_read_start(as_event_command* cmd)
+{
+	cmd->command_sent_counter++;
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+	if (cmd->pipe_listener != NULL) {
+		as_pipe_read_start(cmd);
+	}
+	as_uring_watch_response(cmd);
+}
+
+static inline void
+as_uring_command_write(as_event_command* cmd)
+{
+	if (as_uring_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
+		// Done with write. Register for read.
+		as_uring_command_read_start(cmd);
+	}
+}
+
+void
+as_event_command_write_start(as_event_command* cmd)
+{
+	cmd->conn->watching = 1;
+	cmd->state = AS_ASYNC_STATE_COMMAND_WRITE;
+	as_event_set_write(cmd);
+	as_uring_command_write(cmd);
+}
+
+static inline void
+as_uring_command_auth_write(as_event_command* cmd)
+{
+	if (as_uring_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
+		// Done with auth write. Register for auth read.
+		as_event_set_auth_read_header(cmd);
+		as_uring_watch_response(cmd);
+	}
+}
+
+static inline void
+as_uring_command_auth_write_start(as_event_command* cmd)
+{
+	cmd->state = AS_ASYNC_STATE_AUTH_WRITE;
+	as_event_set_auth_write(cmd);
+	as_uring_command_auth_write(cmd);
+}
+
+static inline void
+as_uring_command_start(as_event_command* cmd)
+{
+	cmd->conn->watching = 1;
+
+	if (cmd->cluster->user) {
+		as_uring_command_auth_write_start(cmd);
+	}
+	else if (cmd->type == AS_ASYNC_TYPE_CONNECTOR) {
+		as_event_connector_success(cmd);
+	}
+	else {
+		as_event_command_write_start(cmd);
+	}
+}
+
+static int
+as_uring_command_peek_block(as_event_command* cmd)
+{
+	// Batch, scan, query may be waiting on end block.
+	// Prepare for next message block.
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+	int rv = as_uring_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+
+	as_proto* proto = (as_proto*)cmd->buf;
+
+	if (! as_event_proto_parse(cmd, proto)) {
+		return AS_EVENT_READ_ERROR;
+	}
+
+	size_t size = proto->sz;
+
+	cmd->len = (uint32_t)size;
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
+
+	// Check for end block size.
+	if (cmd->len == sizeof(as_msg) && cmd->proto_type_rcv != AS_COMPRESSED_MESSAGE_TYPE) {
+		// Look like we received end block.  Read and parse to make sure.
+		rv = as_uring_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+		cmd->pos = 0;
+
+		if (! cmd->parse_results(cmd)) {
+			// We did not finish after all. Prepare to read next header.
+			cmd->len = sizeof(as_proto);
+			cmd->pos = 0;
+			cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+		}
+		else {
+			return AS_EVENT_COMMAND_DONE;
+		}
+	}
+	else {
+		// Received normal data block.  Stop reading for fairness reasons and wait
+		// till next iteration.
+		if (cmd->len > cmd->read_capacity) {
+			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
+				as_slab_free(cmd->buf);
+			}
+			cmd->buf = as_slab_alloc(cmd->event_loop->slab, size);
+			cmd->read_capacity = cmd->len;
+			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
+		}
+	}
+
+	return AS_EVENT_READ_COMPLETE;
+}
+
+static int
+as_uring_parse_authentication(as_event_command* cmd)
+{
+	int rv;
+	if (cmd->state == AS_ASYNC_STATE_AUTH_READ_HEADER) {
+		// Read response length
+		rv = as_uring_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+
+		if (! as_event_set_auth_parse_header(cmd)) {
+			return AS_EVENT_READ_ERROR;
+		}
+
+		if (cmd->len > cmd->read_capacity) {
+			as_error err;
+			as_error_update(&err, AEROSPIKE_ERR_CLIENT, "Authenticate response size is corrupt: %u", cmd->len);
+			as_event_parse_error(cmd, &err);
+			return AS_EVENT_READ_ERROR;
+		}
+	}
+
+	rv = as_uring_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+
+	// Parse authentication response.
+	uint8_t code = cmd->buf[AS_ASYNC_AUTH_RETURN_CODE];
+
+	if (code && code != AEROSPIKE_SECURITY_NOT_ENABLED) {
+		// Can't authenticate socket, so must close it.
+		as_node_signal_login(cmd->node);
+		as_error err;
+		as_error_update(&err, code, "Authentication failed: %s", as_error_string(code));
+		as_event_parse_error(cmd, &err);
+		return AS_EVENT_READ_ERROR;
+	}
+
+	if (cmd->type == AS_ASYNC_TYPE_CONNECTOR) {
+		as_event_connector_success(cmd);
+		return AS_EVENT_COMMAND_DONE;
+	}
+
+	as_event_command_write_start(cmd);
+	return AS_EVENT_READ_COMPLETE;
+}
+
+static int
+as_uring_command_read(as_event_command* cmd)
+{
+	int rv;
+
+	if (cmd->state == AS_ASYNC_STATE_COMMAND_READ_HEADER) {
+		// Read response length
+		rv = as_uring_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+
+		as_proto* proto = (as_proto*)cmd->buf;
+
+		if (! as_event_proto_parse(cmd, proto)) {
+			return AS_EVENT_READ_ERROR;
+		}
+
+		size_t size = proto->sz;
+
+		cmd->len = (uint32_t)size;
+		cmd->pos = 0;
+		cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
+
+		if (cmd->len > cmd->read_capacity) {
+			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
+				as_slab_free(cmd->buf);
+			}
+			cmd->buf = as_slab_alloc(cmd->event_loop->slab, size);
+			cmd->read_capacity = cmd->len;
+			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
+		}
+	}
+
+	// Read response body
+	rv = as_uring_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+	cmd->pos = 0;
+
+	if (cmd->proto_type_rcv == AS_COMPRESSED_MESSAGE_TYPE) {
+		if (! as_event_decompress(cmd)) {
+			return AS_EVENT_READ_ERROR;
+		}
+	}
+
+	if (! cmd->parse_results(cmd)) {
+		// Batch, scan, query is not finished.
+		return as_uring_command_peek_block(cmd);
+	}
+
+	return AS_EVENT_COMMAND_DONE;
+}
+
+static bool
+as_uring_tls_connect(as_event_command* cmd, as_event_connection* conn)
+{
+	int rv = as_tls_connect_once(&conn->socket);
+
+	if (rv < -2) {
+		if (! as_event_socket_retry(cmd)) {
+			// Failed, error has been logged.
+			as_error err;
+			as_error_set_message(&err, AEROSPIKE_ERR_TLS_ERROR, "TLS connection failed");
+			as_event_socket_error(cmd, &err);
+		}
+		return false;
+	}
+
+	if (rv == -1) {
+		// TLS needs a read.
+		as_uring_watch_read(cmd);
+		return true;
+	}
+
+	if (rv == -2) {
+		// TLS needs a write.
+		as_uring_watch_write(cmd);
+		return true;
+	}
+
+	if (rv == 0) {
+		if (! as_event_socket_retry(cmd)) {
+			as_error err;
+			as_error_set_message(&err, AEROSPIKE_ERR_TLS_ERROR, "TLS connection shutdown");
+			as_event_socket_error(cmd, &err);
+		}
+		return false;
+	}
+
+	// TLS connection established.
+	as_uring_command_start(cmd);
+	return false;
+}
+
+static void
+as_uring_callback_common(as_event_command* cmd, as_event_connection* conn)
+{
+	switch (cmd->state) {
+	case AS_ASYNC_STATE_CONNECT:
+		if (! conn->socket.ctx) {
+			// Plain sockets only poll for connect.
+			conn->poll = 0;
+		}
+		as_uring_command_start(cmd);
+		break;
+
+	case AS_ASYNC_STATE_TLS_CONNECT:
+		do {
+			if (! as_uring_tls_connect(cmd, conn)) {
+				return;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	case AS_ASYNC_STATE_AUTH_WRITE:
+		as_uring_command_auth_write(cmd);
+		break;
+
+	case AS_ASYNC_STATE_AUTH_READ_HEADER:
+	case AS_ASYNC_STATE_AUTH_READ_BODY:
+		// If we're using TLS we must loop until there are no bytes
+		// left in the encryption buffer because we won't get another
+		// poll event.
+		do {
+			switch (as_uring_parse_authentication(cmd)) {
+				case AS_EVENT_COMMAND_DONE:
+				case AS_EVENT_READ_ERROR:
+					// Do not touch cmd again because it's been deallocated.
+					return;
+
+				default:
+					break;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	case AS_ASYNC_STATE_COMMAND_WRITE:
+		as_uring_command_write(cmd);
+		break;
+
+	case AS_ASYNC_STATE_COMMAND_READ_HEADER:
+	case AS_ASYNC_STATE_COMMAND_READ_BODY:
+		// If we're using TLS we must loop until there are no bytes
+		// left in the encryption buffer because we won't get another
+		// poll event.
+		do {
+			switch (as_uring_command_read(cmd)) {
+			case AS_EVENT_COMMAND_DONE:
+			case AS_EVENT_READ_ERROR:
+				// Do not touch cmd again because it's been deallocated.
+				return;
+
+			default:
+				break;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	default:
+		as_log_error("unexpected cmd state %d", cmd->state);
+		break;
+	}
+}
+
+static inline bool
+as_uring_read_state(as_event_command* cmd)
+{
+	switch (cmd->state) {
+	case AS_ASYNC_STATE_AUTH_READ_HEADER:
+	case AS_ASYNC_STATE_AUTH_READ_BODY:
+	case AS_ASYNC_STATE_COMMAND_READ_HEADER:
+	case AS_ASYNC_STATE_COMMAND_READ_BODY:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+static as_event_command*
+as_uring_reader(as_event_connection* conn)
+{
+	if (conn->pipeline) {
+		as_pipe_connection* pipe = (as_pipe_connection*)conn;
+
+		if (pipe->writer && cf_ll_size(&pipe->readers) == 0) {
+			// Authentication response will only have a writer.
+			return pipe->writer;
+		}
+
+		// Next response is at head of reader linked list.
+		cf_ll_element* link = cf_ll_get_head(&pipe->readers);
+		return link ? as_pipe_link_to_command(link) : NULL;
+	}
+
+	// Command is only valid while the connection is in use.
+	return conn->watching ? ((as_async_connection*)conn)->cmd : NULL;
+}
+
+static as_event_command*
+as_uring_writer(as_event_connection* conn)
+{
+	if (conn->pipeline) {
+		return ((as_pipe_connection*)conn)->writer;
+	}
+	return conn->watching ? ((as_async_connection*)conn)->cmd : NULL;
+}
+
+static void
+as_uring_drive(as_event_connection* conn)
+{
+	// Deliver received data to commands waiting for a response.  A pipeline connection
+	// may hold responses for several commands.
+	while (! conn->closed && (conn->rx_count > 0 || conn->rx_error)) {
+		as_event_command* cmd = as_uring_reader(conn);
+
+		if (! cmd || ! as_uring_read_state(cmd)) {
+			if (conn->pipeline && conn->rx_count > 0) {
+				as_log_debug("Pipeline read event ignored");
+			}
+			return;
+		}
+
+		uint8_t count = conn->rx_count;
+		uint32_t len = count ? conn->rx[conn->rx_head].len : 0;
+		int error = conn->rx_error;
+
+		as_uring_callback_common(cmd, conn);
+
+		if (conn->closed) {
+			break;
+		}
+
+		if (count == conn->rx_count && error == conn->rx_error &&
+			(count == 0 || len == conn->rx[conn->rx_head].len) &&
+			cmd == as_uring_reader(conn)) {
+			// No progress.
+			break;
+		}
+	}
+
+	if (! conn->closed && ! conn->rx_error && (conn->rx_count == 0 || conn->pipeline)) {
+		// Pipeline responses may follow the queued data, so receive while there is room.
+		as_event_command* cmd = as_uring_reader(conn);
+
+		if (cmd && as_uring_read_state(cmd)) {
+			as_uring_arm_recv(conn);
+		}
+	}
+}
+
+static void
+as_uring_recv_complete(as_uring_loop* ul, as_event_connection* conn, int res, uint32_t flags)
+{
+	// Operation reference is transferred to this callback.
+	conn->armed &= ~AS_URING_ARMED_RECV;
+
+	if (res > 0) {
+		uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+
+		if (conn->closed) {
+			as_uring_buf_return(ul, bid);
+		}
+		else {
+			uint8_t tail = (conn->rx_head + conn->rx_count) % AS_URING_RX_MAX;
+			conn->rx[tail].bid = bid;
+			conn->rx[tail].offset = 0;
+			conn->rx[tail].len = (uint32_t)res;
+			conn->rx_count++;
+		}
+	}
+	else if (res == 0) {
+		conn->rx_error = AS_URING_EOF;
+	}
+	else if (res == -ENOBUFS) {
+		// Provided buffers are exhausted.  Receive again after completions have been processed.
+		if (! conn->closed) {
+			as_uring_schedule(conn);
+		}
+	}
+	else if (res != -ECANCELED) {
+		conn->rx_error = -res;
+	}
+
+	if (! conn->closed) {
+		as_uring_drive(conn);
+	}
+	as_uring_conn_release(conn);
+}
+
+static void
+as_uring_send_complete(as_event_connection* conn, int res)
+{
+	conn->armed &= ~AS_URING_ARMED_SEND;
+
+	if (conn->closed) {
+		as_uring_conn_release(conn);
+		return;
+	}
+
+	as_event_command* cmd = as_uring_writer(conn);
+
+	if (cmd && cmd == conn->send_cmd &&
+		(cmd->state == AS_ASYNC_STATE_COMMAND_WRITE || cmd->state == AS_ASYNC_STATE_AUTH_WRITE)) {
+		if (res > 0) {
+			cmd->pos += res;
+			as_uring_callback_common(cmd, conn);
+		}
+		else {
+			as_uring_write_error(cmd, -res);
+		}
+	}
+
+	if (! conn->closed) {
+		// Deliver responses that arrived before the send completion.
+		as_uring_drive(conn);
+	}
+	as_uring_conn_release(conn);
+}
+
+static void
+as_uring_poll_complete(as_event_connection* conn, int res)
+{
+	conn->armed &= ~AS_URING_ARMED_POLL;
+
+	if (conn->closed || res == -ECANCELED || ! conn->poll) {
+		// Connection closed or watcher stopped before the completion was processed.
+		as_uring_conn_release(conn);
+		return;
+	}
+
+	as_event_command* cmd;
+
+	if (res < 0 || (res & (POLLIN | POLLERR | POLLHUP))) {
+		cmd = as_uring_reader(conn);
+
+		if (! cmd) {
+			cmd = as_uring_writer(conn);
+		}
+	}
+	else {
+		cmd = as_uring_writer(conn);
+	}
+
+	if (cmd) {
+		as_uring_callback_common(cmd, conn);
+	}
+
+	if (! conn->closed && conn->poll && !(conn->armed & AS_URING_ARMED_POLL)) {
+		// Poll is one-shot.  Rearm while the command still waits for readiness.
+		as_uring_watch(conn, conn->poll);
+	}
+	as_uring_conn_release(conn);
+}
+
+static void
+as_uring_complete(as_event_loop* event_loop, uint64_t data, int res, uint32_t flags)
+{
+	uint32_t op = (uint32_t)(data & AS_URING_OP_MASK);
+
+	if (op == AS_URING_OP_WAKEUP) {
+		as_uring_wakeup(event_loop);
+		return;
+	}
+
+	as_event_connection* conn = (as_event_connection*)(uintptr_t)(data & ~(uint64_t)AS_URING_OP_MASK);
+
+	switch (op) {
+	case AS_URING_OP_RECV:
+		as_uring_recv_complete(event_loop->loop, conn, res, flags);
+		break;
+
+	case AS_URING_OP_SEND:
+		as_uring_send_complete(conn, res);
+		break;
+
+	case AS_URING_OP_POLL:
+		as_uring_poll_complete(conn, res);
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void
+as_uring_process_ready(as_uring_loop* ul)
+{
+	for (uint32_t i = 0; i < ul->ready.size; i++) {
+		as_event_connection* conn = *(as_event_connection**)as_vector_get(&ul->ready, i);
+		conn->scheduled = false;
+
+		if (! conn->closed) {
+			as_uring_drive(conn);
+		}
+		as_uring_conn_release(conn);
+	}
+	ul->ready.size = 0;
+}
+
+static void
+as_uring_run(as_event_loop* event_loop)
+{
+	as_uring_loop* ul = event_loop->loop;
+
+	while (! ul->stop) {
+		struct __kernel_timespec ts;
+		struct __kernel_timespec* tsp = NULL;
+
+		if (ul->timer_size > 0) {
+			uint64_t deadline = ul->timers[0]->timer.deadline;
+			uint64_t now = cf_getms();
+			uint64_t wait = (deadline > now)? deadline - now : 0;
+
+			ts.tv_sec = (long long)(wait / 1000);
+			ts.tv_nsec = (long long)((wait % 1000) * 1000 * 1000);
+			tsp = &ts;
+		}
+
+		// Submit all writes and reads queued in the previous iteration with one system call.
+		struct io_uring_cqe* cqe;
+		int rv = io_uring_submit_and_wait_timeout(&ul->ring, &cqe, 1, tsp, NULL);
+
+		if (rv < 0 && rv != -ETIME && rv != -EINTR && rv != -EBUSY) {
+			as_log_error("io_uring wait failed: %d", -rv);
+		}
+
+		while (! ul->stop && io_uring_peek_cqe(&ul->ring, &cqe) == 0) {
+			uint64_t data = io_uring_cqe_get_data64(cqe);
+			int res = cqe->res;
+			uint32_t flags = cqe->flags;
+
+			io_uring_cqe_seen(&ul->ring, cqe);
+
+			if (data != AS_URING_IGNORE) {
+				as_uring_complete(event_loop, data, res, flags);
+			}
+		}
+
+		if (ul->stop) {
+			break;
+		}
+
+		as_uring_process_ready(ul);
+		as_uring_process_timers(ul);
+	}
+
+	// Cleanup event loop resources.
+	as_uring_loop_destroy(ul);
+	as_event_loop_destroy(event_loop);
+}
+
+static void*
+as_uring_worker(void* udata)
+{
+	as_uring_run(udata);
+	as_tls_thread_cleanup();
+	return NULL;
+}
+
+bool
+as_event_create_loop(as_event_loop* event_loop)
+{
+	event_loop->loop = as_uring_loop_create();
+
+	if (! event_loop->loop) {
+		return false;
+	}
+
+	return pthread_create(&event_loop->thread, NULL, as_uring_worker, event_loop) == 0;
+}
+
+void
+as_event_register_external_loop(as_event_loop* event_loop)
+{
+	// This method is only called when user sets an external event loop.
+	// The client owns the ring, so the user supplied loop is replaced.
+	event_loop->loop = as_uring_loop_create();
+
+	if (! event_loop->loop) {
+		as_log_error("Failed to create external io_uring event loop");
+	}
+}
+
+void
+as_event_uring_run(as_event_loop* event_loop)
+{
+	as_uring_run(event_loop);
+}
+
+/******************************************************************************
+ * CONNECT FUNCTIONS
+ *****************************************************************************/
+
+static void
+as_uring_connection_init(as_event_command* cmd, as_socket* sock)
+{
+	as_event_connection* conn = cmd->conn;
+	as_uring_loop* ul = cmd->event_loop->loop;
+
+	memcpy(&conn->socket, sock, sizeof(as_socket));
+	conn->event_loop = cmd->event_loop;
+	conn->send_cmd = NULL;
+	conn->fixed = -1;
+	conn->ops = 0;
+	conn->poll = 0;
+	conn->armed = 0;
+	conn->closed = false;
+	conn->scheduled = false;
+	conn->rx_error = 0;
+	conn->rx_head = 0;
+	conn->rx_count = 0;
+	conn->watching = 1;
+
+	if (ul->files_size > 0) {
+		int slot = ul->files[--ul->files_size];
+
+		if (io_uring_register_files_update(&ul->ring, (unsigned)slot, &conn->socket.fd, 1) == 1) {
+			conn->fixed = slot;
+		}
+		else {
+			ul->files[ul->files_size++] = slot;
+		}
+	}
+
+	// Change state if using TLS.
+	if (as_socket_use_tls(cmd->cluster->tls_ctx)) {
+		cmd->state = AS_ASYNC_STATE_TLS_CONNECT;
+	}
+
+	// Wait for connect to complete.
+	as_uring_watch_write(cmd);
+}
+
+static int
+as_uring_try_connections(int fd, as_address* addresses, socklen_t size, int i, int max)
+{
+	while (i < max) {
+		if (as_socket_connect_fd(fd, (struct sockaddr*)&addresses[i].addr, size)) {
+			return i;
+		}
+		i++;
+	}
+	return -1;
+}
+
+static int
+as_uring_try_family_connections(as_event_command* cmd, int family, int begin, int end, int index, as_address* primary, as_socket* sock)
+{
+	// Create a non-blocking socket.
+	as_socket_fd fd;
+	int rv = as_socket_create_fd(family, &fd);
+
+	if (rv < 0) {
+		return rv;
+	}
+
+	if (cmd->pipe_listener && ! as_pipe_modify_fd(fd)) {
+		return -1000;
+	}
+
+	as_tls_context* ctx = as_socket_get_tls_context(cmd->cluster->tls_ctx);
+
+	if (! as_socket_wrap(sock, family, fd, ctx, cmd->node->tls_name)) {
+		return -1001;
+	}
+
+	// Try addresses.
+	as_address* addresses = cmd->node->addresses;
+	socklen_t size = (family == AF_INET)? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+
+	if (index >= 0) {
+		// Try primary address.
+		if (as_socket_connect_fd(fd, (struct sockaddr*)&primary->addr, size)) {
+			return index;
+		}
+
+		// Start from current index + 1 to end.
+		rv = as_uring_try_connections(fd, addresses, size, index + 1, end);
+
+		if (rv < 0) {
+			// Start from begin to index.
+			rv = as_uring_try_connections(fd, addresses, size, begin, index);
+		}
+	}
+	else {
+		rv = as_uring_try_connections(fd, addresses, size, begin, end);
+	}
+
+	if (rv < 0) {
+		// Couldn't start a connection on any socket address - close the socket.
+		as_socket_close(sock);
+		return -1002;
+	}
+	return rv;
+}
+
+static void
+as_uring_connect_error(as_event_command* cmd, as_address* primary, int rv)
+{
+	// Socket has already been closed. Release connection.
+	cf_free(cmd->conn);
+	as_event_decr_conn(cmd);
+	cmd->event_loop->errors++;
+
+	if (as_event_command_retry(cmd, false)) {
+		return;
+	}
+
+	as_error err;
+	as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Connect failed: %d %s %s", rv, cmd->node->name, primary->name);
+
+	// Only timer needs to be released on socket connection failure.
+	// Connection has not been registered with the ring yet.
+	as_event_timer_stop(cmd);
+	as_event_error_callback(cmd, &err);
+}
+
+void
+as_event_connect(as_event_command* cmd, as_async_conn_pool* pool)
+{
+	// Try addresses.
+	as_socket sock;
+	as_node* node = cmd->node;
+	uint32_t index = node->address_index;
+	as_address* primary = &node->addresses[index];
+	int rv;
+	int first_rv;
+
+	if (primary->addr.ss_family == AF_INET) {
+		// Try IPv4 addresses first.
+		rv = as_uring_try_family_connections(cmd, AF_INET, 0, node->address4_size, index, primary, &sock);
+
+		if (rv < 0) {
+			// Try IPv6 addresses.
+			first_rv = rv;
+			rv = as_uring_try_family_connections(cmd, AF_INET6, AS_ADDRESS4_MAX, AS_ADDRESS4_MAX + node->address6_size, -1, NULL, &sock);
+		}
+	}
+	else {
+		// Try IPv6 addresses first.
+		rv = as_uring_try_family_connections(cmd, AF_INET6, AS_ADDRESS4_MAX, AS_ADDRESS4_MAX + node->address6_size, index, primary, &sock);
+
+		if (rv < 0) {
+			// Try IPv4 addresses.
+			first_rv = rv;
+			rv = as_uring_try_family_connections(cmd, AF_INET, 0, node->address4_size, -1, NULL, &sock);
+		}
+	}
+
+	if (rv < 0) {
+		as_uring_connect_error(cmd, primary, first_rv);
+		return;
+	}
+
+	if (rv != index) {
+		// Replace invalid primary address with valid alias.
+		// Other threads may not see this change immediately.
+		// It's just a hint, not a requirement to try this new address first.
+		as_store_uint32(&node->address_index, rv);
+		as_log_debug("Change node address %s %s", node->name, as_node_get_address_string(node));
+	}
+
+	pool->opened++;
+	as_uring_connection_init(cmd, &sock);
+	cmd->event_loop->errors = 0; // Reset errors on valid connection.
+}
+
+static void
+as_uring_close_connections(as_node* node, as_async_conn_pool* pool)
+{
+	as_event_connection* conn;
+
+	while (as_queue_pop(&pool->queue, &conn)) {
+		as_event_release_connection(conn, pool);
+	}
+	as_queue_destroy(&pool->queue);
+}
+
+void
+as_event_node_destroy(as_node* node)
+{
+	// Close connections.
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		as_uring_close_connections(node, &node->async_conn_pools[i]);
+		as_uring_close_connections(node, &node->pipe_conn_pools[i]);
+	}
+	cf_free(node->async_conn_pools);
+	cf_free(node->pipe_conn_pools);
+}
+
+#endif
@@ -335,9 +335,9 @@ as_uv_command_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf)
 		
 		if (cmd->len > cmd->read_capacity) {
 			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-				cf_free(cmd->buf);
+				as_slab_free(cmd->buf);
 			}
-			cmd->buf = cf_malloc(size);
+			cmd->buf = as_slab_alloc(cmd->event_loop->slab, size);
 			cmd->read_capacity = cmd->len;
 			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
 		}
@@ -1053,9 +1053,9 @@ as_uv_tls_read(as_event_command* cmd)
 
 				if (cmd->len > cmd->read_capacity) {
 					if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-						cf_free(cmd->buf);
+						as_slab_free(cmd->buf);
 					}
-					cmd->buf = cf_malloc(size);
+					cmd->buf = as_slab_alloc(cmd->event_loop->slab, size);
 					cmd->read_capacity = cmd->len;
 					cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
 				}
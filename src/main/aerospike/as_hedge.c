@@ -0,0 +1,89 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_hedge.h>
+#include <aerospike/as_atomic.h>
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+void
+as_hedge_latency_add(as_hedge_latency* lat, uint64_t elapsed_us)
+{
+	uint32_t index = 0;
+
+	while ((elapsed_us >>= 1) != 0 && index < AS_HEDGE_BUCKETS - 1) {
+		index++;
+	}
+
+	as_incr_uint32(&lat->buckets[index]);
+
+	if (as_aaf_uint32(&lat->count, 1) == AS_HEDGE_WINDOW) {
+		// Decay older samples.  Concurrent adds may be lost or counted twice, which is
+		// acceptable for an estimate.
+		for (uint32_t i = 0; i < AS_HEDGE_BUCKETS; i++) {
+			as_store_uint32(&lat->buckets[i], as_load_uint32(&lat->buckets[i]) / 2);
+		}
+		as_store_uint32(&lat->count, AS_HEDGE_WINDOW / 2);
+	}
+}
+
+uint32_t
+as_hedge_delay(as_hedge_latency* lat, uint32_t delay, uint32_t percentile)
+{
+	if (percentile == 0) {
+		return delay;
+	}
+
+	uint32_t buckets[AS_HEDGE_BUCKETS];
+	uint64_t total = 0;
+
+	for (uint32_t i = 0; i < AS_HEDGE_BUCKETS; i++) {
+		buckets[i] = as_load_uint32(&lat->buckets[i]);
+		total += buckets[i];
+	}
+
+	if (total < AS_HEDGE_MIN_SAMPLES) {
+		return delay;
+	}
+
+	uint64_t target = (total * percentile + 999) / 1000;
+	uint64_t sum = 0;
+	uint32_t i = 0;
+
+	for (; i < AS_HEDGE_BUCKETS - 1; i++) {
+		if (sum + buckets[i] >= target) {
+			break;
+		}
+		sum += buckets[i];
+	}
+
+	// Interpolate within bucket.
+	uint64_t lower = (uint64_t)1 << i;
+	uint64_t us = lower;
+
+	if (buckets[i] > 0) {
+		us += lower * (target - sum) / buckets[i];
+	}
+
+	uint32_t ms = (uint32_t)((us + 999) / 1000);
+
+	if (delay > 0 && ms > delay) {
+		ms = delay;
+	}
+	return ms;
+}
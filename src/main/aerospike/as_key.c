@@ -17,6 +17,7 @@
 #include <aerospike/as_key.h>
 #include <aerospike/as_double.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_ripemd160.h>
 #include <aerospike/as_string.h>
 #include <aerospike/as_bytes.h>
 
@@ -46,6 +47,7 @@ as_key_cons(
 
 	key->_free = free;
 	key->valuep = (as_key_value *) valuep;
+	key->ns_id = 0;
 	
 	if (digest == NULL) {
 		key->digest.init = false;
@@ -58,6 +60,78 @@ as_key_cons(
 	return key;
 }
 
+static bool
+as_key_value_size(as_val* val, size_t* size)
+{
+	switch (val->type) {
+		case AS_INTEGER:
+		case AS_DOUBLE:
+			*size = 9;
+			return true;
+
+		case AS_STRING:
+			*size = as_string_len(as_string_fromval(val)) + 1;
+			return true;
+
+		case AS_BYTES:
+			*size = as_bytes_fromval(val)->size + 1;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static void
+as_key_value_write(as_val* val, uint8_t* buf)
+{
+	switch (val->type) {
+		case AS_INTEGER: {
+			as_integer* v = as_integer_fromval(val);
+			buf[0] = AS_BYTES_INTEGER;
+			*(uint64_t*)&buf[1] = cf_swap_to_be64(v->value);
+			break;
+		}
+		case AS_DOUBLE: {
+			as_double* v = as_double_fromval(val);
+			buf[0] = AS_BYTES_DOUBLE;
+			*(double*)&buf[1] = cf_swap_to_big_float64(v->value);
+			break;
+		}
+		case AS_STRING: {
+			as_string* v = as_string_fromval(val);
+			buf[0] = AS_BYTES_STRING;
+			memcpy(&buf[1], v->value, as_string_len(v));
+			break;
+		}
+		case AS_BYTES: {
+			as_bytes* v = as_bytes_fromval(val);
+			// Note: v->type must be a blob type (AS_BYTES_BLOB, AS_BYTES_JAVA, AS_BYTES_PYTHON ...).
+			// Otherwise, the particle type will be reassigned to a non-blob which causes a
+			// mismatch between type and value.
+			buf[0] = v->type;
+			memcpy(&buf[1], v->value, v->size);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+static void
+as_key_set_lane_digests(
+	as_key** keys, const uint8_t** msgs, uint32_t* lens, uint32_t n_keys,
+	uint8_t digests[][AS_RIPEMD160_SIZE]
+	)
+{
+	as_ripemd160_multi(msgs, lens, n_keys, digests);
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		memcpy(keys[i]->digest.value, digests[i], AS_DIGEST_VALUE_SIZE);
+		keys[i]->digest.init = true;
+	}
+}
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -245,54 +319,98 @@ as_key_set_digest(as_error* err, as_key* key)
 	}
 	
 	size_t set_len = strlen(key->set);
-	size_t size;
-	
 	as_val* val = (as_val*)key->valuep;
-	uint8_t* buf;
-	
-	switch (val->type) {
-		case AS_INTEGER: {
-			as_integer* v = as_integer_fromval(val);
-			size = 9;
-			buf = alloca(size);
-			buf[0] = AS_BYTES_INTEGER;
-			*(uint64_t*)&buf[1] = cf_swap_to_be64(v->value);
-			break;
+	size_t size;
+
+	if (! as_key_value_size(val, &size)) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid key type: %d", val->type);
+	}
+
+	uint8_t* buf = alloca(size);
+	as_key_value_write(val, buf);
+
+	cf_digest_compute2(key->set, set_len, buf, size, (cf_digest*)key->digest.value);
+	key->digest.init = true;
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_keys_set_digests(as_error* err, as_key* keys, uint32_t n_keys)
+{
+	as_key* list[AS_RIPEMD160_LANES];
+	uint32_t offset = 0;
+
+	while (offset < n_keys) {
+		uint32_t n = n_keys - offset;
+
+		if (n > AS_RIPEMD160_LANES) {
+			n = AS_RIPEMD160_LANES;
 		}
-		case AS_DOUBLE: {
-			as_double* v = as_double_fromval(val);
-			size = 9;
-			buf = alloca(size);
-			buf[0] = AS_BYTES_DOUBLE;
-			*(double*)&buf[1] = cf_swap_to_big_float64(v->value);
-			break;
+
+		for (uint32_t i = 0; i < n; i++) {
+			list[i] = &keys[offset + i];
 		}
-		case AS_STRING: {
-			as_string* v = as_string_fromval(val);
-			size_t len = as_string_len(v);
-			size = len + 1;
-			buf = alloca(size);
-			buf[0] = AS_BYTES_STRING;
-			memcpy(&buf[1], v->value, len);
-			break;
+
+		as_status status = as_keys_set_digests_ptr(err, list, n);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
 		}
-		case AS_BYTES: {
-			as_bytes* v = as_bytes_fromval(val);
-			size = v->size + 1;
-			buf = alloca(size);
-			// Note: v->type must be a blob type (AS_BYTES_BLOB, AS_BYTES_JAVA, AS_BYTES_PYTHON ...).
-			// Otherwise, the particle type will be reassigned to a non-blob which causes a
-			// mismatch between type and value.
-			buf[0] = v->type;
-			memcpy(&buf[1], v->value, v->size);
-			break;
+		offset += n;
+	}
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_keys_set_digests_ptr(as_error* err, as_key** keys, uint32_t n_keys)
+{
+	uint8_t bufs[AS_RIPEMD160_LANES][AS_RIPEMD160_MULTI_MAX];
+	uint8_t digests[AS_RIPEMD160_LANES][AS_RIPEMD160_SIZE];
+	const uint8_t* msgs[AS_RIPEMD160_LANES];
+	uint32_t lens[AS_RIPEMD160_LANES];
+	as_key* lane_keys[AS_RIPEMD160_LANES];
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		as_key* key = keys[i];
+
+		if (key->digest.init) {
+			continue;
 		}
-		default: {
+
+		size_t set_len = strlen(key->set);
+		as_val* val = (as_val*)key->valuep;
+		size_t size;
+
+		if (! as_key_value_size(val, &size)) {
 			return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid key type: %d", val->type);
 		}
+
+		if (set_len + size > AS_RIPEMD160_MULTI_MAX) {
+			// Large keys are hashed individually.
+			as_status status = as_key_set_digest(err, key);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+			continue;
+		}
+
+		uint8_t* p = bufs[n];
+		memcpy(p, key->set, set_len);
+		as_key_value_write(val, p + set_len);
+		msgs[n] = p;
+		lens[n] = (uint32_t)(set_len + size);
+		lane_keys[n] = key;
+
+		if (++n == AS_RIPEMD160_LANES) {
+			as_key_set_lane_digests(lane_keys, msgs, lens, n, digests);
+			n = 0;
+		}
+	}
+
+	if (n > 0) {
+		as_key_set_lane_digests(lane_keys, msgs, lens, n, digests);
 	}
-		
-	cf_digest_compute2(key->set, set_len, buf, size, (cf_digest*)key->digest.value);
-	key->digest.init = true;
 	return AEROSPIKE_OK;
 }
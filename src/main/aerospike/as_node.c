@@ -23,14 +23,20 @@
 #include <aerospike/as_event_internal.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_numa.h>
 #include <aerospike/as_peers.h>
 #include <aerospike/as_queue.h>
 #include <aerospike/as_shm_cluster.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_string.h>
+#include <aerospike/as_sync_pipe.h>
 #include <aerospike/as_tls.h>
 #include <citrusleaf/cf_byte_order.h>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 // Replicas take ~2K per namespace, so this will cover most deployments:
 #define INFO_STACK_BUF_SIZE (16 * 1024)
 
@@ -78,7 +84,20 @@ as_node_create_async_pools(uint32_t min_conns_per_node, uint32_t max_conns_per_n
 		as_async_conn_pool* pool = &pools[i];
 		uint32_t min_size = i < rem_min ? min + 1 : min;
 		uint32_t max_size = i < rem_max ? max + 1 : max;
+		as_numa_mask numa_saved;
+		bool numa_bound = false;
+
+		if (as_event_numa_aware && i < as_event_loop_size && as_event_loops[i].numa_node >= 0) {
+			// Bind tend thread to the event loop's node while the pool is allocated, so the
+			// pool's connection queue is first touched on the node that uses it.
+			numa_bound = as_numa_bind_thread((uint32_t)as_event_loops[i].numa_node, &numa_saved);
+		}
+
 		as_async_conn_pool_init(pool, min_size, max_size);
+
+		if (numa_bound) {
+			as_numa_restore_thread(&numa_saved);
+		}
 	}
 	return pools;
 }
@@ -131,10 +150,14 @@ as_node_create(as_cluster* cluster, as_node_info* node_info)
 	node->rebalance_changed = false;
 
 	// Create sync connection pools.
-	node->sync_conn_pools = cf_malloc(sizeof(as_conn_pool) * cluster->conn_pools_per_node);
+	node->sync_conn_pools = as_conn_pools_create(cluster->conn_pools_per_node);
 	node->sync_conns_opened = 1;
 	node->sync_conns_closed = 0;
-	node->conn_iter = 0;
+	as_hedge_latency_init(&node->read_latency);
+	node->latency_ewma = 0;
+	node->latency_in_flight = 0;
+	node->batch_key_ns = 0;
+	as_circuit_init(&node->circuit);
 
 	uint32_t min = cluster->min_conns_per_node / cluster->conn_pools_per_node;
 	uint32_t rem_min = cluster->min_conns_per_node - (min * cluster->conn_pools_per_node);
@@ -145,7 +168,19 @@ as_node_create(as_cluster* cluster, as_node_info* node_info)
 		as_conn_pool* pool = &node->sync_conn_pools[i];
 		uint32_t min_size = i < rem_min ? min + 1 : min;
 		uint32_t max_size = i < rem_max ? max + 1 : max;
-		as_conn_pool_init(pool, sizeof(as_socket), min_size, max_size);
+		as_conn_pool_init(pool, min_size, max_size);
+	}
+
+	// Create sync pipeline connections.
+	if (cluster->sync_pipe_conns_per_node > 0) {
+		node->sync_pipes = cf_malloc(sizeof(as_sync_pipe) * cluster->sync_pipe_conns_per_node);
+
+		for (uint32_t i = 0; i < cluster->sync_pipe_conns_per_node; i++) {
+			as_sync_pipe_init(&node->sync_pipes[i]);
+		}
+	}
+	else {
+		node->sync_pipes = NULL;
 	}
 
 	if (as_event_loop_capacity == 0) {
@@ -176,7 +211,15 @@ as_node_destroy(as_node* node)
 	for (uint32_t i = 0; i < max; i++) {
 		as_conn_pool_destroy(&node->sync_conn_pools[i]);
 	}
-	cf_free(node->sync_conn_pools);
+	as_conn_pools_destroy(node->sync_conn_pools);
+
+	// Close sync pipeline connections.
+	if (node->sync_pipes) {
+		for (uint32_t i = 0; i < node->cluster->sync_pipe_conns_per_node; i++) {
+			as_sync_pipe_destroy(node, &node->sync_pipes[i]);
+		}
+		cf_free(node->sync_pipes);
+	}
 
 	// Drain async connection pools.
 	if (as_event_loop_capacity > 0) {
@@ -247,15 +290,14 @@ release_node(as_node* node)
  *
  * Solve by delaying the tend thread node release until the next tend
  * iteration. This minimum 1 second delay is enough time close the race 
- * condition loophole.
+ * condition loophole. Sync commands do not reserve nodes at all. The
+ * release is further delayed until those commands have left the epoch
+ * in which the node was retired.
  */
 void
 as_node_release_delayed(as_node* node)
 {
-	as_gc_item item;
-	item.data = node;
-	item.release_fn = (as_release_fn)release_node;
-	as_vector_append(node->cluster->gc, &item);
+	as_cluster_gc_add(node->cluster, node, (as_release_fn)release_node);
 }
 
 void
@@ -419,7 +461,7 @@ as_node_create_socket(
 	return AEROSPIKE_OK;
 }
 
-static as_status
+as_status
 as_node_create_connection(
 	as_error* err, as_node* node, uint32_t socket_timeout, uint64_t deadline_ms, as_conn_pool* pool,
 	as_socket* sock
@@ -431,9 +473,16 @@ as_node_create_connection(
 		return status;
 	}
 
-	// Authenticate connection.
 	as_cluster* cluster = node->cluster;
 
+	if (cluster->zero_copy_threshold > 0 && ! sock->ctx) {
+		// Only command connections send large bins.  Tend and info sockets do not need
+		// zero-copy completion notifications.
+		as_socket_enable_zero_copy(sock);
+	}
+
+	// Authenticate connection.
+
 	if (cluster->user) {
 		as_status status = as_authenticate(cluster, err, sock, node, node->session_token,
 										   node->session_token_length, socket_timeout, deadline_ms);
@@ -499,47 +548,82 @@ as_node_authenticate_connection(as_cluster* cluster, uint64_t deadline_ms)
 	return status;
 }
 
+#if !defined(_MSC_VER)
+static __thread uint32_t as_conn_shard_hint = 0;
+#else
+static __declspec(thread) uint32_t as_conn_shard_hint = 0;
+#endif
+
+static uint32_t as_conn_shard_seq = 0;
+
+uint32_t
+as_node_get_shard(uint32_t max)
+{
+#if defined(__linux__)
+	int cpu = sched_getcpu();
+
+	if (cpu >= 0) {
+		return (uint32_t)cpu % max;
+	}
+#endif
+
+	if (as_conn_shard_hint == 0) {
+		as_conn_shard_hint = as_aaf_uint32(&as_conn_shard_seq, 1);
+	}
+	return as_conn_shard_hint % max;
+}
+
+static inline as_status
+as_node_validate_connection(as_node* node, as_conn_pool* pool, as_socket* s, as_socket* sock)
+{
+	// Verify that socket is active and receive buffer is empty.
+	int len = as_socket_validate(s, node->cluster->max_socket_idle_ns_tran);
+
+	if (len == 0) {
+		*sock = *s;
+		sock->pool = pool;
+		return AEROSPIKE_OK;
+	}
+
+	as_log_debug("Invalid socket %d from pool: %d", s->fd, len);
+	as_node_close_connection(node, s, pool);
+	return AEROSPIKE_ERR_CONNECTION;
+}
+
 as_status
 as_node_get_connection(as_error* err, as_node* node, uint32_t socket_timeout, uint64_t deadline_ms, as_socket* sock)
 {
 	as_conn_pool* pools = node->sync_conn_pools;
 	as_cluster* cluster = node->cluster;
 	uint32_t max = cluster->conn_pools_per_node;
-	uint32_t initial_index;
-	bool backward;
+	uint32_t initial_index = (max == 1) ? 0 : as_node_get_shard(max);
+	as_conn_pool* pool = &pools[initial_index];
+	as_socket s;
 
-	if (max == 1) {
-		initial_index = 0;
-		backward = false;
-	}
-	else {
-		uint32_t iter = node->conn_iter++; // not atomic by design
-		initial_index = iter % max;
-		backward = true;
+	// Try thread's own shard first.
+	while (as_conn_pool_pop_head(pool, &s)) {
+		if (as_node_validate_connection(node, pool, &s, sock) == AEROSPIKE_OK) {
+			return AEROSPIKE_OK;
+		}
 	}
 
-	as_socket s;
-	as_conn_pool* pool = &pools[initial_index];
-	uint32_t pool_index = initial_index;
-
-	while (true) {
-		if (as_conn_pool_pop_head(pool, &s)) {
-			// Found socket.
-			// Verify that socket is active and receive buffer is empty.
-			int len = as_socket_validate(&s, cluster->max_socket_idle_ns_tran);
+	// Own shard is empty.  Steal pooled connection from neighboring shards.
+	for (uint32_t i = 1; i < max; i++) {
+		as_conn_pool* p = &pools[(initial_index + i) % max];
 
-			if (len == 0) {
-				*sock = s;
-				sock->pool = pool;
+		while (as_conn_pool_pop_head(p, &s)) {
+			if (as_node_validate_connection(node, p, &s, sock) == AEROSPIKE_OK) {
 				return AEROSPIKE_OK;
 			}
-
-			as_log_debug("Invalid socket %d from pool: %d", s.fd, len);
-			as_node_close_connection(node, &s, pool);
 		}
-		else if (as_conn_pool_incr(pool)) {
-			// Socket not found and queue has available slot.
-			// Create new connection.
+	}
+
+	// No pooled connections available.  Create new connection in first shard with an
+	// available slot, starting with thread's own shard.
+	for (uint32_t i = 0; i < max; i++) {
+		pool = &pools[(initial_index + i) % max];
+
+		if (as_conn_pool_incr(pool)) {
 			as_status status = as_node_create_connection(err, node, socket_timeout, deadline_ms,
 														 pool, sock);
 
@@ -548,30 +632,10 @@ as_node_get_connection(as_error* err, as_node* node, uint32_t socket_timeout, ui
 			}
 			return status;
 		}
-		else {
-			// Socket not found and queue is full.  Try another queue.
-			as_conn_pool_decr(pool);
-
-			if (backward) {
-				if (pool_index > 0) {
-					pool_index--;
-				}
-				else {
-					pool_index = initial_index;
-
-					if (++pool_index >= max) {
-						break;
-					}
-					backward = false;
-				}
-			}
-			else if (++pool_index >= max) {
-				break;
-			}
-			pool = &pool[pool_index];
-		}
+		as_conn_pool_decr(pool);
 	}
-	// All queues full.
+
+	// All shards full.
 	return as_error_update(err, AEROSPIKE_ERR_NO_MORE_CONNECTIONS,
 						   "Max node %s connections would be exceeded: %u",
 						   node->name, cluster->max_conns_per_node);
@@ -581,21 +645,56 @@ static void
 as_node_close_idle_connections(as_node* node, as_conn_pool* pool, int count)
 {
 	uint64_t max_socket_idle_ns = node->cluster->max_socket_idle_ns_trim;
-	as_socket s;
 
-	while (count > 0) {
-		if (! as_conn_pool_pop_tail(pool, &s)) {
-			break;
+	// Detach pooled connections, so least recently used connections at the end of the chain
+	// can be examined.  Concurrent transactions see an empty pool in the meantime and will
+	// either steal from other shards or create a new connection.
+	uint32_t first = as_conn_pool_detach(pool);
+
+	if (first == 0) {
+		return;
+	}
+
+	// Find chain length and position of last connection that is still current.
+	uint32_t size = 0;
+	uint32_t keep = 0;
+	uint32_t index = first;
+
+	while (index != 0) {
+		size++;
+
+		if (as_socket_current_trim(pool->sockets[index - 1].last_used, max_socket_idle_ns)) {
+			keep = size;
 		}
+		index = pool->links[index - 1];
+	}
 
-		if (as_socket_current_trim(s.last_used, max_socket_idle_ns)) {
-			if (! as_conn_pool_push_tail(pool, &s)) {
-				as_node_close_connection(node, &s, pool);
-			}
-			break;
+	// Close up to count idle connections from the end of the chain.
+	if (size - keep > (uint32_t)count) {
+		keep = size - count;
+	}
+
+	uint32_t last = 0;
+	uint32_t pos = 0;
+	index = first;
+
+	while (index != 0) {
+		uint32_t next = pool->links[index - 1];
+
+		if (pos < keep) {
+			last = index;
 		}
-		as_node_close_connection(node, &s, pool);
-		count--;
+		else {
+			as_node_close_connection(node, &pool->sockets[index - 1], pool);
+			as_conn_pool_release_slot(pool, index);
+		}
+		pos++;
+		index = next;
+	}
+
+	// Put remaining connections back into pool.
+	if (keep > 0) {
+		as_conn_pool_attach(pool, first, last);
 	}
 }
 
@@ -628,6 +727,7 @@ as_node_signal_login(as_node* node)
 		// Signal tend thread to wake up from sleep, so node tend will occur faster.
 		as_cluster* cluster = node->cluster;
 
+		as_store_uint8(&cluster->tend_requested, 1);
 		pthread_mutex_lock(&cluster->tend_lock);
 		pthread_cond_signal(&cluster->tend_cond);
 		pthread_mutex_unlock(&cluster->tend_lock);
@@ -917,65 +1017,6 @@ as_node_process_response(as_cluster* cluster, as_error* err, as_node* node, as_v
 	return AEROSPIKE_OK;
 }
 
-/**
- * Request current status from server node.
- */
-as_status
-as_node_refresh(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
-{
-	as_status status = as_node_get_tend_connection(err, node);
-	
-	if (status != AEROSPIKE_OK) {
-		return status;
-	}
-
-	// Set new deadline because login may have occurred which can take a long time.
-	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
-
-	const char* command;
-	size_t command_len;
-	
-	if (cluster->rack_aware) {
-		command = INFO_STR_CHECK_RACK;
-		command_len = sizeof(INFO_STR_CHECK_RACK) - 1;
-	}
-	else {
-		command = INFO_STR_CHECK_PEERS;
-		command_len = sizeof(INFO_STR_CHECK_PEERS) - 1;
-	}
-
-	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, command, command_len, deadline_ms, stack_buf);
-	
-	if (! buf) {
-		as_node_close_socket(node, &node->info_socket);
-		return err->code;
-	}
-	
-	as_vector values;
-	as_vector_inita(&values, sizeof(as_name_value), 4);
-	
-	as_info_parse_multi_response((char*)buf, &values);
-
-	status = as_node_process_response(cluster, err, node, &values, peers);
-
-	if (status == AEROSPIKE_ERR_CLIENT) {
-		as_node_close_socket(node, &node->info_socket);
-	}
-		
-	if (buf != stack_buf) {
-		cf_free(buf);
-	}
-
-	as_vector_destroy(&values);
-
-	if (status == AEROSPIKE_OK) {
-		node->failures = 0;
-		peers->refresh_count++;
-	}
-	return status;
-}
-
 static const char INFO_STR_PEERS_TLS_ALT[] = "peers-tls-alt\n";
 static const char INFO_STR_PEERS_TLS_STD[] = "peers-tls-std\n";
 static const char INFO_STR_PEERS_CLEAR_ALT[] = "peers-clear-alt\n";
@@ -1005,60 +1046,6 @@ as_node_process_peers(as_cluster* cluster, as_error* err, as_node* node, as_vect
 	return AEROSPIKE_OK;
 }
 
-as_status
-as_node_refresh_peers(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
-{
-	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
-	const char* command;
-	size_t command_len;
-
-	if (cluster->tls_ctx) {
-		if (cluster->use_services_alternate) {
-			command = INFO_STR_PEERS_TLS_ALT;
-			command_len = sizeof(INFO_STR_PEERS_TLS_ALT) - 1;
-		}
-		else {
-			command = INFO_STR_PEERS_TLS_STD;
-			command_len = sizeof(INFO_STR_PEERS_TLS_STD) - 1;
-		}
-	}
-	else {
-		if (cluster->use_services_alternate) {
-			command = INFO_STR_PEERS_CLEAR_ALT;
-			command_len = sizeof(INFO_STR_PEERS_CLEAR_ALT) - 1;
-		}
-		else {
-			command = INFO_STR_PEERS_CLEAR_STD;
-			command_len = sizeof(INFO_STR_PEERS_CLEAR_STD) - 1;
-		}
-	}
-	
-	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, command, command_len, deadline_ms, stack_buf);
-	
-	if (! buf) {
-		as_node_close_socket(node, &node->info_socket);
-		return err->code;
-	}
-	
-	as_vector values;
-	as_vector_inita(&values, sizeof(as_name_value), 4);
-	
-	as_info_parse_multi_response((char*)buf, &values);
-	as_status status = as_node_process_peers(cluster, err, node, &values, peers);
-	
-	if (buf != stack_buf) {
-		cf_free(buf);
-	}
-	
-	as_vector_destroy(&values);
-
-	if (status == AEROSPIKE_OK) {
-		peers->refresh_count++;
-	}
-	return status;
-}
-
 static const char INFO_STR_GET_REPLICAS_REGIME[] = "partition-generation\nreplicas\n";
 
 static as_status
@@ -1083,35 +1070,6 @@ as_node_process_partitions(as_cluster* cluster, as_error* err, as_node* node, as
 	return AEROSPIKE_OK;
 }
 
-as_status
-as_node_refresh_partitions(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
-{
-	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
-	const char* command = INFO_STR_GET_REPLICAS_REGIME;
-	size_t command_len = sizeof(INFO_STR_GET_REPLICAS_REGIME) - 1;
-
-	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, command, command_len, deadline_ms, stack_buf);
-
-	if (! buf) {
-		as_node_close_socket(node, &node->info_socket);
-		return err->code;
-	}
-
-	as_vector values;
-	as_vector_inita(&values, sizeof(as_name_value), 4);
-
-	as_info_parse_multi_response((char*)buf, &values);
-	as_status status = as_node_process_partitions(cluster, err, node, &values);
-
-	if (buf != stack_buf) {
-		cf_free(buf);
-	}
-
-	as_vector_destroy(&values);
-	return status;
-}
-
 /**
  * Use non-inline function for garbarge collector function pointer reference.
  * Forward to inlined release.
@@ -1139,10 +1097,7 @@ as_node_replace_racks(as_cluster* cluster, as_node* node, as_racks* racks)
 
 	if (old) {
 		// Put old racks on garbage collector stack.
-		as_gc_item item;
-		item.data = old;
-		item.release_fn = (as_release_fn)release_racks;
-		as_vector_append(cluster->gc, &item);
+		as_cluster_gc_add(cluster, old, (as_release_fn)release_racks);
 	}
 }
 
@@ -1260,28 +1215,185 @@ as_node_process_racks(as_cluster* cluster, as_error* err, as_node* node, as_vect
 static const char INFO_STR_GET_RACKS[] = "rebalance-generation\nrack-ids\n";
 
 as_status
-as_node_refresh_racks(as_cluster* cluster, as_error* err, as_node* node)
+as_node_tend_request(as_cluster* cluster, as_node_tend* tend)
 {
+	as_node* node = tend->node;
+	as_error* err = &tend->err;
+	const char* command;
+	size_t command_len;
+
+	as_error_init(err);
+	tend->response = NULL;
+
+	switch (tend->type) {
+		case AS_NODE_TEND_REFRESH:
+			tend->status = as_node_get_tend_connection(err, node);
+
+			if (tend->status != AEROSPIKE_OK) {
+				return tend->status;
+			}
+
+			if (cluster->rack_aware) {
+				command = INFO_STR_CHECK_RACK;
+				command_len = sizeof(INFO_STR_CHECK_RACK) - 1;
+			}
+			else {
+				command = INFO_STR_CHECK_PEERS;
+				command_len = sizeof(INFO_STR_CHECK_PEERS) - 1;
+			}
+			break;
+
+		case AS_NODE_TEND_PEERS:
+			if (cluster->tls_ctx) {
+				if (cluster->use_services_alternate) {
+					command = INFO_STR_PEERS_TLS_ALT;
+					command_len = sizeof(INFO_STR_PEERS_TLS_ALT) - 1;
+				}
+				else {
+					command = INFO_STR_PEERS_TLS_STD;
+					command_len = sizeof(INFO_STR_PEERS_TLS_STD) - 1;
+				}
+			}
+			else {
+				if (cluster->use_services_alternate) {
+					command = INFO_STR_PEERS_CLEAR_ALT;
+					command_len = sizeof(INFO_STR_PEERS_CLEAR_ALT) - 1;
+				}
+				else {
+					command = INFO_STR_PEERS_CLEAR_STD;
+					command_len = sizeof(INFO_STR_PEERS_CLEAR_STD) - 1;
+				}
+			}
+			break;
+
+		case AS_NODE_TEND_PARTITIONS:
+			command = INFO_STR_GET_REPLICAS_REGIME;
+			command_len = sizeof(INFO_STR_GET_REPLICAS_REGIME) - 1;
+			break;
+
+		default:
+			command = INFO_STR_GET_RACKS;
+			command_len = sizeof(INFO_STR_GET_RACKS) - 1;
+			break;
+	}
+
+	// Set new deadline because login may have occurred which can take a long time.
 	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
 
 	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, INFO_STR_GET_RACKS, sizeof(INFO_STR_GET_RACKS) - 1, deadline_ms, stack_buf);
+	uint8_t* buf = as_node_get_info(err, node, command, command_len, deadline_ms, stack_buf);
 
 	if (! buf) {
 		as_node_close_socket(node, &node->info_socket);
-		return err->code;
+		return tend->status = err->code;
+	}
+
+	if (buf == stack_buf) {
+		// Response is processed after this thread's stack frame is gone.
+		size_t len = strlen((char*)buf) + 1;
+		tend->response = cf_malloc(len);
+		memcpy(tend->response, buf, len);
+	}
+	else {
+		tend->response = (char*)buf;
+	}
+	return tend->status = AEROSPIKE_OK;
+}
+
+as_status
+as_node_tend_process(as_cluster* cluster, as_node_tend* tend, as_peers* peers)
+{
+	if (tend->status != AEROSPIKE_OK) {
+		return tend->status;
 	}
 
+	as_node* node = tend->node;
+	as_error* err = &tend->err;
+	as_status status;
+
 	as_vector values;
 	as_vector_inita(&values, sizeof(as_name_value), 4);
 
-	as_info_parse_multi_response((char*)buf, &values);
-	as_status status = as_node_process_racks(cluster, err, node, &values);
+	as_info_parse_multi_response(tend->response, &values);
+
+	switch (tend->type) {
+		case AS_NODE_TEND_REFRESH:
+			status = as_node_process_response(cluster, err, node, &values, peers);
+
+			if (status == AEROSPIKE_OK) {
+				node->failures = 0;
+				peers->refresh_count++;
+			}
+			else if (status == AEROSPIKE_ERR_CLIENT) {
+				as_node_close_socket(node, &node->info_socket);
+			}
+			break;
+
+		case AS_NODE_TEND_PEERS:
+			status = as_node_process_peers(cluster, err, node, &values, peers);
+
+			if (status == AEROSPIKE_OK) {
+				peers->refresh_count++;
+			}
+			break;
+
+		case AS_NODE_TEND_PARTITIONS:
+			status = as_node_process_partitions(cluster, err, node, &values);
+			break;
 
-	if (buf != stack_buf) {
-		cf_free(buf);
+		default:
+			status = as_node_process_racks(cluster, err, node, &values);
+			break;
 	}
 
+	cf_free(tend->response);
+	tend->response = NULL;
 	as_vector_destroy(&values);
+	return tend->status = status;
+}
+
+static as_status
+as_node_tend_execute(
+	as_cluster* cluster, as_error* err, as_node* node, as_node_tend_type type, as_peers* peers
+	)
+{
+	as_node_tend tend;
+	tend.node = node;
+	tend.type = type;
+
+	as_node_tend_request(cluster, &tend);
+
+	as_status status = as_node_tend_process(cluster, &tend, peers);
+
+	if (status != AEROSPIKE_OK) {
+		as_error_copy(err, &tend.err);
+	}
 	return status;
 }
+
+/**
+ * Request current status from server node.
+ */
+as_status
+as_node_refresh(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
+{
+	return as_node_tend_execute(cluster, err, node, AS_NODE_TEND_REFRESH, peers);
+}
+
+as_status
+as_node_refresh_peers(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
+{
+	return as_node_tend_execute(cluster, err, node, AS_NODE_TEND_PEERS, peers);
+}
+
+as_status
+as_node_refresh_partitions(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
+{
+	return as_node_tend_execute(cluster, err, node, AS_NODE_TEND_PARTITIONS, peers);
+}
+
+as_status
+as_node_refresh_racks(as_cluster* cluster, as_error* err, as_node* node)
+{
+	return as_node_tend_execute(cluster, err, node, AS_NODE_TEND_RACKS, NULL);
+}
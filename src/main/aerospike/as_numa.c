@@ -0,0 +1,212 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_numa.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define AS_NUMA_SYSFS "/sys/devices/system/node"
+#define AS_NUMA_NO_NODE 0xff
+
+/******************************************************************************
+ * STATIC VARIABLES
+ *****************************************************************************/
+
+static cpu_set_t as_numa_cpus[AS_NUMA_MAX_NODES];
+static uint8_t as_numa_cpu_node[CPU_SETSIZE];
+static uint8_t as_numa_nodes[AS_NUMA_MAX_NODES];
+static uint32_t as_numa_size = 0;
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+bool
+as_numa_read_list(const char* path, cpu_set_t* set)
+{
+	// Parse sysfs list format.  Example: "0-15,32-47".
+	FILE* fp = fopen(path, "r");
+
+	if (! fp) {
+		return false;
+	}
+
+	char buf[4096];
+	char* p = fgets(buf, sizeof(buf), fp);
+
+	fclose(fp);
+
+	if (! p) {
+		return false;
+	}
+
+	CPU_ZERO(set);
+
+	while (*p >= '0' && *p <= '9') {
+		char* end;
+		long begin = strtol(p, &end, 10);
+		long last = begin;
+
+		p = end;
+
+		if (*p == '-') {
+			last = strtol(p + 1, &end, 10);
+			p = end;
+		}
+
+		for (long i = begin; i <= last && i < CPU_SETSIZE; i++) {
+			CPU_SET(i, set);
+		}
+
+		if (*p != ',') {
+			break;
+		}
+		p++;
+	}
+	return true;
+}
+
+uint32_t
+as_numa_init(void)
+{
+	as_numa_size = 0;
+	memset(as_numa_cpu_node, AS_NUMA_NO_NODE, sizeof(as_numa_cpu_node));
+
+	// Online node list has the same format as cpu lists.
+	cpu_set_t online;
+
+	if (! as_numa_read_list(AS_NUMA_SYSFS "/online", &online)) {
+		return 0;
+	}
+
+	cpu_set_t allowed;
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+		return 0;
+	}
+
+	char path[128];
+
+	for (uint32_t node = 0; node < AS_NUMA_MAX_NODES; node++) {
+		if (! CPU_ISSET(node, &online)) {
+			continue;
+		}
+
+		cpu_set_t* cpus = &as_numa_cpus[node];
+
+		snprintf(path, sizeof(path), AS_NUMA_SYSFS "/node%u/cpulist", node);
+
+		if (! as_numa_read_list(path, cpus)) {
+			continue;
+		}
+
+		for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, cpus)) {
+				as_numa_cpu_node[cpu] = (uint8_t)node;
+			}
+		}
+
+		// Skip nodes without cpus available to this process (memory only nodes
+		// or cpus excluded by taskset/cgroups).
+		CPU_AND(cpus, cpus, &allowed);
+
+		if (CPU_COUNT(cpus) > 0) {
+			as_numa_nodes[as_numa_size++] = (uint8_t)node;
+		}
+	}
+	return as_numa_size;
+}
+
+uint32_t
+as_numa_node(uint32_t index)
+{
+	return as_numa_nodes[index % as_numa_size];
+}
+
+int
+as_numa_current_node(void)
+{
+	int cpu = sched_getcpu();
+
+	if (cpu < 0 || cpu >= CPU_SETSIZE) {
+		return -1;
+	}
+
+	uint8_t node = as_numa_cpu_node[cpu];
+	return (node == AS_NUMA_NO_NODE)? -1 : node;
+}
+
+bool
+as_numa_bind_thread(uint32_t node, as_numa_mask* saved)
+{
+	pthread_t thread = pthread_self();
+
+	if (pthread_getaffinity_np(thread, sizeof(cpu_set_t), saved) != 0) {
+		return false;
+	}
+	return pthread_setaffinity_np(thread, sizeof(cpu_set_t), &as_numa_cpus[node]) == 0;
+}
+
+void
+as_numa_restore_thread(as_numa_mask* saved)
+{
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), saved);
+}
+
+#else
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+uint32_t
+as_numa_init(void)
+{
+	return 0;
+}
+
+uint32_t
+as_numa_node(uint32_t index)
+{
+	return 0;
+}
+
+int
+as_numa_current_node(void)
+{
+	return -1;
+}
+
+bool
+as_numa_bind_thread(uint32_t node, as_numa_mask* saved)
+{
+	return false;
+}
+
+void
+as_numa_restore_thread(as_numa_mask* saved)
+{
+}
+
+#endif
@@ -24,12 +24,130 @@
 #include <aerospike/as_shm_cluster.h>
 #include <aerospike/as_string.h>
 #include <citrusleaf/cf_b64.h>
+#include <citrusleaf/cf_byte_order.h>
 #include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && \
+	__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define AS_B64_VECTOR 1
+#endif
+
+/******************************************************************************
+ * Static Functions
+ *****************************************************************************/
+
+static inline uint32_t
+as_b64_value(uint8_t c)
+{
+	if (c >= 'a') {
+		return c - 71;
+	}
+
+	if (c >= 'A') {
+		return c - 65;
+	}
+
+	if (c >= '0' && c <= '9') {
+		return c + 4;
+	}
+
+	if (c == '+') {
+		return 62;
+	}
+
+	if (c == '/') {
+		return 63;
+	}
+	return 0; // Padding.
+}
+
+#if AS_B64_VECTOR
+typedef uint8_t as_b64_v16 __attribute__((vector_size(16)));
+typedef uint32_t as_b64_v4 __attribute__((vector_size(16)));
+
+// Decode 16 characters into 12 bytes.  Characters are mapped to 6 bit values with range
+// masks instead of a table lookup, so all 16 lanes are translated at once.
+static inline void
+as_b64_decode16(const char* src, uint8_t* dst)
+{
+	as_b64_v16 c;
+	memcpy(&c, src, sizeof(c));
+
+	as_b64_v16 upper = (as_b64_v16)((c >= 'A') & (c <= 'Z'));
+	as_b64_v16 lower = (as_b64_v16)((c >= 'a') & (c <= 'z'));
+	as_b64_v16 digit = (as_b64_v16)((c >= '0') & (c <= '9'));
+	as_b64_v16 plus = (as_b64_v16)(c == '+');
+	as_b64_v16 slash = (as_b64_v16)(c == '/');
+
+	as_b64_v16 v = (upper & (c - 65)) | (lower & (c - 71)) | (digit & (c + 4)) |
+		(plus & 62) | (slash & 63);
+
+	// Each 32 bit lane holds four 6 bit values in little endian order.
+	as_b64_v4 q;
+	memcpy(&q, &v, sizeof(q));
+
+	as_b64_v4 n = ((q & 0x3f) << 18) | (((q >> 8) & 0x3f) << 12) |
+		(((q >> 16) & 0x3f) << 6) | (q >> 24);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		dst[0] = (uint8_t)(n[i] >> 16);
+		dst[1] = (uint8_t)(n[i] >> 8);
+		dst[2] = (uint8_t)n[i];
+		dst += 3;
+	}
+}
+#endif
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
 
+void
+as_partition_bitmap_decode(const char* b64, uint32_t len, uint32_t n_partitions, uint64_t* words)
+{
+	uint32_t n_words = as_partition_bitmap_words(len);
+	uint8_t* dst = (uint8_t*)words;
+	uint32_t i = 0;
+
+	memset(words, 0, sizeof(uint64_t) * n_words);
+
+#if AS_B64_VECTOR
+	for (; i + 16 <= len; i += 16) {
+		as_b64_decode16(b64 + i, dst);
+		dst += 12;
+	}
+#endif
+
+	for (; i + 4 <= len; i += 4) {
+		uint32_t n = (as_b64_value((uint8_t)b64[i]) << 18) |
+			(as_b64_value((uint8_t)b64[i + 1]) << 12) |
+			(as_b64_value((uint8_t)b64[i + 2]) << 6) |
+			as_b64_value((uint8_t)b64[i + 3]);
+
+		dst[0] = (uint8_t)(n >> 16);
+		dst[1] = (uint8_t)(n >> 8);
+		dst[2] = (uint8_t)n;
+		dst += 3;
+	}
+
+	// Bitmap bytes are in partition order.  Load words as big endian so partition order
+	// runs from the most significant bit.
+	for (uint32_t w = 0; w < n_words; w++) {
+		words[w] = cf_swap_from_be64(words[w]);
+	}
+
+	// Clear padding bits.
+	for (uint32_t w = n_partitions >> 6; w < n_words; w++) {
+		uint32_t bits = n_partitions - (w << 6);
+		words[w] &= (bits >= 64)? ~0ULL : (bits == 0)? 0 : ~0ULL << (64 - bits);
+	}
+}
+
 /* Used for debugging only.
 static void
 as_partition_table_print(as_partition_table* table)
@@ -37,8 +155,8 @@ as_partition_table_print(as_partition_table* table)
 	for (uint32_t i = 0; i < table->size; i++) {
 		as_partition* p = &table->partitions[i];
 		
-		if (p->master) {
-			printf("%u %s\n", i, p->master->name);
+		if (p->nodes[0]) {
+			printf("%u %s\n", i, p->nodes[0]->name);
 		}
 		else {
 			printf("%u null\n", i);
@@ -131,13 +249,11 @@ as_partition_table_destroy(as_partition_table* table)
 {
 	for (uint32_t i = 0; i < table->size; i++) {
 		as_partition* p = &table->partitions[i];
-		
-		if (p->master) {
-			as_partition_release_node_now(p->master);
-		}
-		
-		if (p->prole) {
-			as_partition_release_node_now(p->prole);
+
+		for (uint32_t j = 0; j < AS_MAX_REPLICAS; j++) {
+			if (p->nodes[j]) {
+				as_partition_release_node_now(p->nodes[j]);
+			}
 		}
 	}
 	cf_free(table);
@@ -174,34 +290,28 @@ try_node(as_cluster* cluster, as_node* node)
 	return NULL;
 }
 
-static as_node*
-try_node_alternate(as_cluster* cluster, as_node* chosen, as_node* alternate)
+static inline uint32_t
+replica_count(as_partition* p)
 {
-	// Make volatile reference so changes to tend thread will be reflected in this thread.
-	if (as_load_uint8(&chosen->active)) {
-		return chosen;
-	}
-	return try_node(cluster, alternate);
+	uint32_t count = as_load_uint8(&p->replica_count);
+	return (count > 0)? count : 1;
 }
 
 static as_node*
-get_sequence_node(as_cluster* cluster, as_partition* p, bool use_master)
+get_sequence_node(as_cluster* cluster, as_partition* p, uint32_t start)
 {
-	as_node* master = (as_node*)as_load_ptr(&p->master);
-	as_node* prole = (as_node*)as_load_ptr(&p->prole);
+	// Walk replicas in sequence order beginning at start and wrapping around to the master.
+	uint32_t count = replica_count(p);
 
-	if (! prole) {
-		return try_node(cluster, master);
-	}
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t index = (start + i) % count;
+		as_node* node = try_node(cluster, (as_node*)as_load_ptr(&p->nodes[index]));
 
-	if (! master) {
-		return try_node(cluster, prole);
-	}
-	
-	if (use_master) {
-		return try_node_alternate(cluster, master, prole);
+		if (node) {
+			return node;
+		}
 	}
-	return try_node_alternate(cluster, prole, master);
+	return NULL;
 }
 
 static inline bool
@@ -215,51 +325,37 @@ try_rack_node(as_cluster* cluster, const char* ns, as_node* node)
 }
 
 static as_node*
-prefer_rack_node(as_cluster* cluster, const char* ns, as_partition* p, bool use_master)
+prefer_rack_node(as_cluster* cluster, const char* ns, as_partition* p, uint32_t start)
 {
-	as_node* master;
-	as_node* prole;
-
-	if (use_master) {
-		master = (as_node*)as_load_ptr(&p->master);
-
-		if (try_rack_node(cluster, ns, master)) {
-			return master;
-		}
+	uint32_t count = replica_count(p);
 
-		prole = (as_node*)as_load_ptr(&p->prole);
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t index = (start + i) % count;
+		as_node* node = (as_node*)as_load_ptr(&p->nodes[index]);
 
-		if (try_rack_node(cluster, ns, prole)) {
-			return prole;
-		}
-	}
-	else {
-		prole = (as_node*)as_load_ptr(&p->prole);
-
-		if (try_rack_node(cluster, ns, prole)) {
-			return prole;
-		}
-
-		master = (as_node*)as_load_ptr(&p->master);
-
-		if (try_rack_node(cluster, ns, master)) {
-			return master;
+		if (try_rack_node(cluster, ns, node)) {
+			return node;
 		}
 	}
 
 	// Default to sequence mode.
-	if (! prole) {
-		return try_node(cluster, master);
-	}
+	return get_sequence_node(cluster, p, start);
+}
 
-	if (! master) {
-		return try_node(cluster, prole);
-	}
+static as_node*
+get_latency_node(as_cluster* cluster, as_partition* p)
+{
+	uint32_t count = replica_count(p);
+	as_node* best = NULL;
 
-	if (use_master) {
-		return try_node_alternate(cluster, master, prole);
+	for (uint32_t i = 0; i < count; i++) {
+		as_node* node = try_node(cluster, (as_node*)as_load_ptr(&p->nodes[i]));
+
+		if (node) {
+			best = best? as_node_latency_select(best, node) : node;
+		}
 	}
-	return try_node_alternate(cluster, prole, master);
+	return best;
 }
 
 static uint32_t g_randomizer = 0;
@@ -267,34 +363,42 @@ static uint32_t g_randomizer = 0;
 as_node*
 as_partition_reg_get_node(
 	as_cluster* cluster, const char* ns, as_partition* p, as_policy_replica replica,
-	bool use_master, bool is_retry
+	uint8_t replica_index, bool is_retry
 	)
 {
 	switch (replica) {
 		case AS_POLICY_REPLICA_MASTER: {
 			// Make volatile reference so changes to tend thread will be reflected in this thread.
-			as_node* master = (as_node*)as_load_ptr(&p->master);
+			as_node* master = (as_node*)as_load_ptr(&p->nodes[0]);
 			return try_master(cluster, master);
 		}
 
 		case AS_POLICY_REPLICA_ANY: {
-			// Alternate between master and prole for reads with global iterator.
+			// Rotate between all replicas for reads with global iterator.
 			uint32_t r = as_faa_uint32(&g_randomizer, 1);
-			use_master = (r & 1);
-			return get_sequence_node(cluster, p, use_master);
+			return get_sequence_node(cluster, p, r % replica_count(p));
 		}
 
 		default:
 		case AS_POLICY_REPLICA_SEQUENCE: {
-			return get_sequence_node(cluster, p, use_master);
+			return get_sequence_node(cluster, p, replica_index);
 		}
 
 		case AS_POLICY_REPLICA_PREFER_RACK: {
 			if (!is_retry) {
-				return prefer_rack_node(cluster, ns, p, use_master);
+				return prefer_rack_node(cluster, ns, p, replica_index);
+			}
+			else {
+				return get_sequence_node(cluster, p, replica_index);
+			}
+		}
+
+		case AS_POLICY_REPLICA_LOWEST_LATENCY: {
+			if (!is_retry) {
+				return get_latency_node(cluster, p);
 			}
 			else {
-				return get_sequence_node(cluster, p, use_master);
+				return get_sequence_node(cluster, p, replica_index);
 			}
 		}
 	}
@@ -305,7 +409,7 @@ as_partition_info_init(as_partition_info* pi, as_cluster* cluster, as_error* err
 {
 	if (cluster->shm_info) {
 		as_cluster_shm* cluster_shm = cluster->shm_info->cluster_shm;
-		as_partition_table_shm* table = as_shm_find_partition_table(cluster_shm, key->ns);
+		as_partition_table_shm* table = as_shm_get_key_partition_table(cluster->shm_info, key);
 
 		if (! table) {
 			as_nodes* nodes = as_nodes_reserve(cluster);
@@ -323,7 +427,7 @@ as_partition_info_init(as_partition_info* pi, as_cluster* cluster, as_error* err
 		pi->sc_mode = table->sc_mode;
 	}
 	else {
-		as_partition_table* table = as_partition_tables_get(&cluster->partition_tables, key->ns);
+		as_partition_table* table = as_partition_tables_get_key(&cluster->partition_tables, key);
 
 		if (! table) {
 			as_nodes* nodes = as_nodes_reserve(cluster);
@@ -343,19 +447,105 @@ as_partition_info_init(as_partition_info* pi, as_cluster* cluster, as_error* err
 	return AEROSPIKE_OK;
 }
 
+static as_partition_table*
+as_partition_tables_find(as_partition_tables* tables, const char* ns, uint32_t* index)
+{
+	uint32_t mask = AS_PARTITION_HASH_SIZE - 1;
+	uint32_t i = as_partition_ns_hash(ns) & mask;
+
+	// The hash is never more than half full, so an empty slot is always found.
+	while (true) {
+		uint32_t id = as_load_uint8(&tables->hash[i]);
+
+		if (id == 0) {
+			return NULL;
+		}
+
+		as_partition_table* table = (as_partition_table*)as_load_ptr(&tables->tables[id - 1]);
+
+		if (strcmp(table->ns, ns) == 0) {
+			*index = id - 1;
+			return table;
+		}
+		i = (i + 1) & mask;
+	}
+}
+
+static void
+as_partition_tables_add(as_partition_tables* tables, as_partition_table* table)
+{
+	// Only called from the tend thread.
+	uint32_t index = tables->size;
+	uint32_t mask = AS_PARTITION_HASH_SIZE - 1;
+	uint32_t i = as_partition_ns_hash(table->ns) & mask;
+
+	while (tables->hash[i]) {
+		i = (i + 1) & mask;
+	}
+
+	// Publish table before the hash slot that references it.
+	tables->tables[index] = table;
+	as_fence_store();
+	tables->size++;
+	as_store_uint8(&tables->hash[i], (uint8_t)(index + 1));
+}
+
 as_partition_table*
 as_partition_tables_get(as_partition_tables* tables, const char* ns)
 {
-	uint32_t max = as_load_uint32(&tables->size);
-	
-	for (uint32_t i = 0; i < max; i++) {
-		as_partition_table* table = tables->tables[i];
+	uint32_t index;
+	return as_partition_tables_find(tables, ns, &index);
+}
 
-		if (strcmp(table->ns, ns) == 0) {
+as_partition_table*
+as_partition_tables_get_key(as_partition_tables* tables, const as_key* key)
+{
+	uint32_t id = key->ns_id;
+
+	// The key may have been resolved by another cluster, so verify the namespace.
+	if (id && id <= as_load_uint32(&tables->size)) {
+		as_partition_table* table = (as_partition_table*)as_load_ptr(&tables->tables[id - 1]);
+
+		if (strcmp(table->ns, key->ns) == 0) {
 			return table;
 		}
 	}
-	return NULL;
+
+	uint32_t index;
+	as_partition_table* table = as_partition_tables_find(tables, key->ns, &index);
+
+	if (table) {
+		// Cache in key like the digest.  Concurrent commands on the same key store the same value.
+		((as_key*)key)->ns_id = (uint16_t)(index + 1);
+	}
+	return table;
+}
+
+as_partition_table*
+as_partition_tables_restore(as_partition_tables* tables, const char* ns, uint32_t capacity, bool sc_mode)
+{
+	if (tables->size >= AS_MAX_NAMESPACES || as_partition_tables_get(tables, ns)) {
+		return NULL;
+	}
+
+	as_partition_table* table = as_partition_table_create(ns, capacity, sc_mode);
+	as_partition_tables_add(tables, table);
+	return table;
+}
+
+void
+as_partition_restore(as_partition* p, as_node** nodes, uint8_t replica_count, uint32_t regime)
+{
+	for (uint32_t i = 0; i < AS_MAX_REPLICAS; i++) {
+		as_node* node = nodes[i];
+
+		if (node) {
+			as_partition_reserve_node(node);
+			set_node(&p->nodes[i], node);
+		}
+	}
+	p->regime = regime;
+	as_store_uint8(&p->replica_count, replica_count);
 }
 
 static inline void
@@ -366,22 +556,28 @@ force_replicas_refresh(as_node* node)
 
 static void
 decode_and_update(
-	char* bitmap_b64, uint32_t len, as_partition_table* table, as_node* node, bool master,
-	uint32_t regime, bool* regime_error
+	char* bitmap_b64, uint32_t len, as_partition_table* table, as_node* node,
+	uint32_t replica_index, uint8_t replica_count, uint32_t regime, bool* regime_error
 	)
 {
-	// Size allows for padding - is actual size rounded up to multiple of 3.
-	uint8_t* bitmap = (uint8_t*)alloca(cf_b64_decoded_buf_size(len));
+	uint32_t n_words = as_partition_bitmap_words(len);
+	uint64_t* words = (uint64_t*)alloca(sizeof(uint64_t) * n_words);
 
 	// For now - for speed - trust validity of encoded characters.
-	cf_b64_decode(bitmap_b64, len, bitmap, NULL);
+	as_partition_bitmap_decode(bitmap_b64, len, table->size, words);
+
+	// Visit only partitions claimed by this node, skipping unclaimed words.
+	for (uint32_t w = 0; w < n_words; w++) {
+		uint64_t bits = words[w];
+
+		while (bits) {
+			uint32_t b = as_partition_clz64(bits);
+			uint32_t i = (w << 6) + b;
+
+			bits &= ~(0x8000000000000000ULL >> b);
 
-	// Expand the bitmap.
-	for (uint32_t i = 0; i < table->size; i++) {
-		if ((bitmap[i >> 3] & (0x80 >> (i & 7))) != 0) {
 			// This node claims ownership of partition.
-			// as_log_debug("Set partition %s:%s:%u:%s", master? "master" : "prole", table->ns, i,
-			//				node->name);
+			// as_log_debug("Set partition %s:%u:%u:%s", table->ns, replica_index, i, node->name);
 
 			// Volatile reads are not necessary because the tend thread exclusively modifies
 			// partition.  Volatile writes are used so other threads can view change.
@@ -392,28 +588,18 @@ decode_and_update(
 					p->regime = regime;
 				}
 
-				if (master) {
-					if (node != p->master) {
-						as_node* tmp = p->master;
-						as_partition_reserve_node(node);
-						set_node(&p->master, node);
-
-						if (tmp) {
-							force_replicas_refresh(tmp);
-							as_partition_release_node_delayed(tmp);
-						}
-					}
+				if (replica_count != p->replica_count) {
+					as_store_uint8(&p->replica_count, replica_count);
 				}
-				else {
-					if (node != p->prole) {
-						as_node* tmp = p->prole;
-						as_partition_reserve_node(node);
-						set_node(&p->prole, node);
-
-						if (tmp) {
-							force_replicas_refresh(tmp);
-							as_partition_release_node_delayed(tmp);
-						}
+
+				if (node != p->nodes[replica_index]) {
+					as_node* tmp = p->nodes[replica_index];
+					as_partition_reserve_node(node);
+					set_node(&p->nodes[replica_index], node);
+
+					if (tmp) {
+						force_replicas_refresh(tmp);
+						as_partition_release_node_delayed(tmp);
 					}
 				}
 			}
@@ -481,8 +667,14 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf, bo
 			}
 			
 			int replica_count = atoi(begin);
-			
-			// Parse master and one prole partition bitmaps.
+			uint8_t max_replicas = (uint8_t)((replica_count < AS_MAX_REPLICAS)?
+				replica_count : AS_MAX_REPLICAS);
+
+			// Shared memory partitions are updated after all replica bitmaps are parsed.
+			char* bitmaps[AS_MAX_REPLICAS];
+			uint32_t n_bitmaps = 0;
+
+			// Parse master and prole partition bitmaps.
 			for (int i = 0; i < replica_count; i++) {
 				begin = ++p;
 				
@@ -502,15 +694,12 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf, bo
 					return false;
 				}
 				
-				// Only handle first two levels.  Do not process other proles.
+				// Only handle first AS_MAX_REPLICAS levels.  Do not process other proles.
 				// Level 0: master
-				// Level 1: prole 1
-				if (i < 2) {
-					bool master = (i == 0);
-					
+				// Level 1..n: prole 1..n
+				if (i < AS_MAX_REPLICAS) {
 					if (cluster->shm_info) {
-						as_shm_update_partitions(cluster->shm_info, ns, begin, len, node, master,
-												 regime);
+						bitmaps[n_bitmaps++] = begin;
 					}
 					else {
 						as_partition_table* table = as_partition_tables_get(tables, ns);
@@ -528,17 +717,20 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf, bo
 						}
 						
 						// Decode partition bitmap and update client's view.
-						decode_and_update(begin, (uint32_t)len, table, node, master, regime,
-										  &regime_error);
+						decode_and_update(begin, (uint32_t)len, table, node, (uint32_t)i,
+										  max_replicas, regime, &regime_error);
 
 						if (create) {
-							tables->tables[tables->size] = table;
-							as_fence_store();
-							tables->size++;
+							as_partition_tables_add(tables, table);
 						}
 					}
 				}
 			}
+
+			if (n_bitmaps > 0) {
+				as_shm_update_partitions(cluster->shm_info, ns, bitmaps, n_bitmaps,
+										 expected_len, node, max_replicas, regime);
+			}
 			ns = ++p;
 		}
 		else {
@@ -202,7 +202,7 @@ as_partition_tracker_assign(
 			as_partition_status* ps = &pt->parts_all[i];
 
 			if (!ps->done) {
-				as_node* node = table->partitions[ps->part_id].master;
+				as_node* node = table->partitions[ps->part_id].nodes[0];
 
 				if (! node) {
 					return as_error_update(err, AEROSPIKE_ERR_INVALID_NODE,
@@ -221,8 +221,7 @@ as_partition_tracker_assign(
 		}
 	}
 	else {
-		as_cluster_shm* cluster_shm = cluster->shm_info->cluster_shm;
-		as_partition_table_shm* table = as_shm_find_partition_table(cluster_shm, ns);
+		as_partition_table_shm* table = as_shm_find_partition_table(cluster->shm_info, ns);
 
 		if (! table) {
 			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Invalid namespace: %s", ns);
@@ -234,7 +233,7 @@ as_partition_tracker_assign(
 			as_partition_status* ps = &pt->parts_all[i];
 
 			if (!ps->done) {
-				uint32_t master = as_load_uint32(&table->partitions[ps->part_id].master);
+				uint32_t master = as_load_uint32(&table->partitions[ps->part_id].nodes[0]);
 
 				// node index zero indicates unset.
 				if (master == 0) {
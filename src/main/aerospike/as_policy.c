@@ -31,6 +31,7 @@ as_policies_init(as_policies* p)
 	as_policy_remove_init(&p->remove);
 	as_policy_apply_init(&p->apply);
 	as_policy_batch_init(&p->batch);
+	as_policy_batch_write_init(&p->batch_write);
 	as_policy_scan_init(&p->scan);
 	as_policy_query_init(&p->query);
 	as_policy_info_init(&p->info);
@@ -47,6 +48,7 @@ as_policies_destroy(as_policies* p)
 	as_exp_destroy(p->remove.base.filter_exp);
 	as_exp_destroy(p->apply.base.filter_exp);
 	as_exp_destroy(p->batch.base.filter_exp);
+	as_exp_destroy(p->batch_write.filter_exp);
 	as_exp_destroy(p->scan.base.filter_exp);
 	as_exp_destroy(p->query.base.filter_exp);
 
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_record_view.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_double.h>
+#include <aerospike/as_geojson.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_msgpack.h>
+#include <aerospike/as_nil.h>
+#include <aerospike/as_serializer.h>
+#include <aerospike/as_string.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <string.h>
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static inline bool
+as_bin_view_to_int64(const as_bin_view* bin, int64_t* value)
+{
+	// The server always returns 8 byte integers.
+	if (bin->type != AS_BYTES_INTEGER || bin->size != 8) {
+		return false;
+	}
+	*value = (int64_t)cf_swap_from_be64(*(uint64_t*)bin->data);
+	return true;
+}
+
+static inline bool
+as_bin_view_to_double(const as_bin_view* bin, double* value)
+{
+	if (bin->type != AS_BYTES_DOUBLE || bin->size != 8) {
+		return false;
+	}
+	*value = cf_swap_from_big_float64(*(double*)bin->data);
+	return true;
+}
+
+static as_val*
+as_bin_view_decode(const as_bin_view* bin)
+{
+	switch (bin->type) {
+		case AS_BYTES_UNDEF: {
+			return (as_val*)&as_nil;
+		}
+		case AS_BYTES_INTEGER: {
+			int64_t value;
+
+			if (! as_bin_view_to_int64(bin, &value)) {
+				return NULL;
+			}
+			return (as_val*)as_integer_new(value);
+		}
+		case AS_BYTES_DOUBLE: {
+			double value;
+
+			if (! as_bin_view_to_double(bin, &value)) {
+				return NULL;
+			}
+			return (as_val*)as_double_new(value);
+		}
+		case AS_BYTES_STRING: {
+			char* value = cf_malloc(bin->size + 1);
+			memcpy(value, bin->data, bin->size);
+			value[bin->size] = 0;
+			return (as_val*)as_string_new_wlen(value, bin->size, true);
+		}
+		case AS_BYTES_GEOJSON: {
+			const uint8_t* p = bin->data;
+
+			// Flags and cell count.
+			if (bin->size < 1 + sizeof(uint16_t)) {
+				return NULL;
+			}
+
+			// Skip flags.
+			p++;
+
+			// Skip cells.
+			uint16_t ncells = cf_swap_from_be16(*(uint16_t*)p);
+
+			if (1 + sizeof(uint16_t) + (sizeof(uint64_t) * (size_t)ncells) > bin->size) {
+				return NULL;
+			}
+			p += sizeof(uint16_t) + (sizeof(uint64_t) * ncells);
+
+			size_t len = bin->size - (p - bin->data);
+			char* value = cf_malloc(len + 1);
+			memcpy(value, p, len);
+			value[len] = 0;
+			return (as_val*)as_geojson_new_wlen(value, len, true);
+		}
+		case AS_BYTES_LIST:
+		case AS_BYTES_MAP: {
+			as_val* value = NULL;
+
+			as_buffer buffer;
+			buffer.data = (uint8_t*)bin->data;
+			buffer.size = bin->size;
+
+			as_serializer ser;
+			as_msgpack_init(&ser);
+			int rv = as_serializer_deserialize(&ser, &buffer, &value);
+			as_serializer_destroy(&ser);
+			return (rv == 0)? value : NULL;
+		}
+		default: {
+			uint8_t* value = cf_malloc(bin->size);
+			memcpy(value, bin->data, bin->size);
+			as_bytes* bytes = as_bytes_new_wrap(value, bin->size, true);
+			bytes->type = (as_bytes_type)bin->type;
+			return (as_val*)bytes;
+		}
+	}
+}
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+as_status
+as_record_view_parse_bins(
+	as_record_view* view, as_error* err, uint8_t** pp, uint8_t* end, as_bin_view* bins,
+	uint16_t n_bins
+	)
+{
+	uint8_t* p = *pp;
+
+	view->bins = bins;
+	view->n_bins = 0;
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		if (p + 8 > end) {
+			return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Record view bin exceeds buffer");
+		}
+
+		uint32_t op_size = cf_swap_from_be32(*(uint32_t*)p);
+		p += 5;
+		uint8_t type = *p;
+		p += 2;
+
+		uint8_t name_size = *p++;
+
+		if (op_size < (uint32_t)name_size + 4 || p + op_size - 4 > end) {
+			return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Record view bin exceeds buffer");
+		}
+
+		as_bin_view* bin = &bins[i];
+		bin->name = p;
+		bin->name_len = name_size;
+		p += name_size;
+
+		bin->type = type;
+		bin->data = p;
+		bin->size = op_size - (name_size + 4);
+		bin->val = NULL;
+		p += bin->size;
+		view->n_bins++;
+	}
+	*pp = p;
+	return AEROSPIKE_OK;
+}
+
+void
+as_record_view_destroy(as_record_view* view)
+{
+	for (uint16_t i = 0; i < view->n_bins; i++) {
+		as_bin_view* bin = &view->bins[i];
+
+		if (bin->val) {
+			as_val_destroy(bin->val);
+			bin->val = NULL;
+		}
+	}
+	as_key_destroy(&view->key);
+
+	if (view->buf) {
+		// Owned views allocate the bin index separately from the response buffer.
+		cf_free(view->bins);
+		cf_free(view->buf);
+		view->buf = NULL;
+	}
+	view->bins = NULL;
+	view->n_bins = 0;
+}
+
+const as_bin_view*
+as_record_view_get(const as_record_view* view, const char* name)
+{
+	size_t len = strlen(name);
+
+	for (uint16_t i = 0; i < view->n_bins; i++) {
+		const as_bin_view* bin = &view->bins[i];
+
+		if (bin->name_len == len && memcmp(bin->name, name, len) == 0) {
+			return bin;
+		}
+	}
+	return NULL;
+}
+
+bool
+as_record_view_get_int64(const as_record_view* view, const char* name, int64_t* value)
+{
+	const as_bin_view* bin = as_record_view_get(view, name);
+	return bin && as_bin_view_to_int64(bin, value);
+}
+
+bool
+as_record_view_get_double(const as_record_view* view, const char* name, double* value)
+{
+	const as_bin_view* bin = as_record_view_get(view, name);
+	return bin && as_bin_view_to_double(bin, value);
+}
+
+const char*
+as_record_view_get_str(const as_record_view* view, const char* name, uint32_t* len)
+{
+	const as_bin_view* bin = as_record_view_get(view, name);
+
+	if (! bin || bin->type != AS_BYTES_STRING) {
+		return NULL;
+	}
+	*len = bin->size;
+	return (const char*)bin->data;
+}
+
+const uint8_t*
+as_record_view_get_bytes(const as_record_view* view, const char* name, uint32_t* size)
+{
+	const as_bin_view* bin = as_record_view_get(view, name);
+
+	if (! bin) {
+		return NULL;
+	}
+
+	switch (bin->type) {
+		case AS_BYTES_UNDEF:
+		case AS_BYTES_INTEGER:
+		case AS_BYTES_DOUBLE:
+		case AS_BYTES_STRING:
+		case AS_BYTES_GEOJSON:
+		case AS_BYTES_LIST:
+		case AS_BYTES_MAP:
+			return NULL;
+
+		default:
+			*size = bin->size;
+			return bin->data;
+	}
+}
+
+as_val*
+as_record_view_get_val(as_record_view* view, const char* name)
+{
+	as_bin_view* bin = (as_bin_view*)as_record_view_get(view, name);
+
+	if (! bin) {
+		return NULL;
+	}
+
+	if (! bin->val) {
+		bin->val = as_bin_view_decode(bin);
+	}
+	return bin->val;
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_ripemd160.h>
+#include <string.h>
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define AS_RMD_BLOCKS 4
+
+// Below this count, hashing messages one at a time is faster than filling vector lanes.
+#define AS_RMD_MIN_LANES 4
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AS_RMD_VECTOR 1
+#endif
+
+#if AS_RMD_VECTOR && (defined(__x86_64__) || defined(__i386__))
+#define AS_RMD_X86 1
+#endif
+
+#define AS_RMD_ROL(_x, _n) (((_x) << (_n)) | ((_x) >> (32 - (_n))))
+
+// Define RIPEMD-160 compression function that operates on one 64 byte block per lane.
+// _T is either uint32_t (one lane) or a vector of uint32_t (one lane per element).
+#define AS_RMD_COMPRESS(_name, _T, _attr) \
+_attr static void \
+_name(_T* h, const _T* x) \
+{ \
+	_T al = h[0], bl = h[1], cl = h[2], dl = h[3], el = h[4]; \
+	_T ar = al, br = bl, cr = cl, dr = dl, er = el; \
+	_T fl, fr, t; \
+	for (uint32_t j = 0; j < 80; j++) { \
+		uint32_t k = j >> 4; \
+		switch (k) { \
+			case 0: \
+				fl = bl ^ cl ^ dl; \
+				fr = br ^ (cr | ~dr); \
+				break; \
+			case 1: \
+				fl = (bl & cl) | (~bl & dl); \
+				fr = (br & dr) | (cr & ~dr); \
+				break; \
+			case 2: \
+				fl = (bl | ~cl) ^ dl; \
+				fr = (br | ~cr) ^ dr; \
+				break; \
+			case 3: \
+				fl = (bl & dl) | (cl & ~dl); \
+				fr = (br & cr) | (~br & dr); \
+				break; \
+			default: \
+				fl = bl ^ (cl | ~dl); \
+				fr = br ^ cr ^ dr; \
+				break; \
+		} \
+		t = al + fl + x[as_rmd_rl[j]] + as_rmd_kl[k]; \
+		t = AS_RMD_ROL(t, as_rmd_sl[j]) + el; \
+		al = el; el = dl; dl = AS_RMD_ROL(cl, 10); cl = bl; bl = t; \
+		t = ar + fr + x[as_rmd_rr[j]] + as_rmd_kr[k]; \
+		t = AS_RMD_ROL(t, as_rmd_sr[j]) + er; \
+		ar = er; er = dr; dr = AS_RMD_ROL(cr, 10); cr = br; br = t; \
+	} \
+	t = h[1] + cl + dr; \
+	h[1] = h[2] + dl + er; \
+	h[2] = h[3] + el + ar; \
+	h[3] = h[4] + al + br; \
+	h[4] = h[0] + bl + cr; \
+	h[0] = t; \
+}
+
+/******************************************************************************
+ * STATIC VARIABLES
+ *****************************************************************************/
+
+static const uint8_t as_rmd_rl[80] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+	3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+	1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+	4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13
+};
+
+static const uint8_t as_rmd_rr[80] = {
+	5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+	6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+	15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+	8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+	12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11
+};
+
+static const uint8_t as_rmd_sl[80] = {
+	11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+	7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+	11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+	11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+	9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6
+};
+
+static const uint8_t as_rmd_sr[80] = {
+	8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+	9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+	9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+	15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+	8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11
+};
+
+static const uint32_t as_rmd_kl[5] = {
+	0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e
+};
+
+static const uint32_t as_rmd_kr[5] = {
+	0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000
+};
+
+static const uint32_t as_rmd_init[5] = {
+	0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+};
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+AS_RMD_COMPRESS(as_rmd_compress, uint32_t, )
+
+#if AS_RMD_VECTOR
+typedef uint32_t as_rmd_v16 __attribute__((vector_size(64)));
+typedef void (*as_rmd_compress_fn)(as_rmd_v16* h, const as_rmd_v16* x);
+
+AS_RMD_COMPRESS(as_rmd_compress16, as_rmd_v16, )
+
+#if AS_RMD_X86
+AS_RMD_COMPRESS(as_rmd_compress16_avx2, as_rmd_v16, __attribute__((target("avx2"))))
+AS_RMD_COMPRESS(as_rmd_compress16_avx512, as_rmd_v16, __attribute__((target("avx512f"))))
+#endif
+
+static inline as_rmd_compress_fn
+as_rmd_select(void)
+{
+#if AS_RMD_X86
+	if (__builtin_cpu_supports("avx512f")) {
+		return as_rmd_compress16_avx512;
+	}
+
+	if (__builtin_cpu_supports("avx2")) {
+		return as_rmd_compress16_avx2;
+	}
+#endif
+	return as_rmd_compress16;
+}
+#endif
+
+static inline uint32_t
+as_rmd_load(const uint8_t* p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+		((uint32_t)p[3] << 24);
+}
+
+static inline void
+as_rmd_store(uint8_t* p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t
+as_rmd_pad(uint8_t* buf, const uint8_t* msg, uint32_t len)
+{
+	// Append 0x80, zero fill and the message bit length in little endian.
+	uint32_t n_blocks = (len + 9 + 63) / 64;
+	uint32_t end = n_blocks * 64;
+	uint64_t bits = (uint64_t)len * 8;
+
+	memcpy(buf, msg, len);
+	buf[len] = 0x80;
+	memset(buf + len + 1, 0, end - len - 9);
+	as_rmd_store(buf + end - 8, (uint32_t)bits);
+	as_rmd_store(buf + end - 4, (uint32_t)(bits >> 32));
+	return n_blocks;
+}
+
+static void
+as_rmd_hash(const uint8_t* msg, uint32_t len, uint8_t* digest)
+{
+	uint8_t buf[AS_RMD_BLOCKS * 64];
+	uint32_t n_blocks = as_rmd_pad(buf, msg, len);
+	uint32_t h[5];
+	uint32_t x[16];
+
+	memcpy(h, as_rmd_init, sizeof(h));
+
+	for (uint32_t b = 0; b < n_blocks; b++) {
+		const uint8_t* p = buf + b * 64;
+
+		for (uint32_t w = 0; w < 16; w++) {
+			x[w] = as_rmd_load(p + w * 4);
+		}
+		as_rmd_compress(h, x);
+	}
+
+	for (uint32_t i = 0; i < 5; i++) {
+		as_rmd_store(digest + i * 4, h[i]);
+	}
+}
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+void
+as_ripemd160_multi(
+	const uint8_t** msgs, const uint32_t* lens, uint32_t n_msgs,
+	uint8_t digests[][AS_RIPEMD160_SIZE]
+	)
+{
+#if AS_RMD_VECTOR
+	if (n_msgs >= AS_RMD_MIN_LANES) {
+		uint8_t bufs[AS_RIPEMD160_LANES][AS_RMD_BLOCKS * 64];
+		uint32_t n_blocks[AS_RIPEMD160_LANES];
+		uint32_t max_blocks = 0;
+
+		for (uint32_t l = 0; l < n_msgs; l++) {
+			n_blocks[l] = as_rmd_pad(bufs[l], msgs[l], lens[l]);
+
+			if (n_blocks[l] > max_blocks) {
+				max_blocks = n_blocks[l];
+			}
+		}
+
+		as_rmd_v16 h[5];
+		as_rmd_v16 x[16];
+
+		memset(x, 0, sizeof(x));
+
+		for (uint32_t i = 0; i < 5; i++) {
+			for (uint32_t l = 0; l < AS_RIPEMD160_LANES; l++) {
+				h[i][l] = as_rmd_init[i];
+			}
+		}
+
+		as_rmd_compress_fn compress = as_rmd_select();
+
+		// Lanes that finish early keep hashing stale blocks.  Their digests are saved
+		// after their last block and later results are ignored.
+		for (uint32_t b = 0; b < max_blocks; b++) {
+			for (uint32_t l = 0; l < n_msgs; l++) {
+				if (b < n_blocks[l]) {
+					const uint8_t* p = bufs[l] + b * 64;
+
+					for (uint32_t w = 0; w < 16; w++) {
+						x[w][l] = as_rmd_load(p + w * 4);
+					}
+				}
+			}
+
+			compress(h, x);
+
+			for (uint32_t l = 0; l < n_msgs; l++) {
+				if (b + 1 == n_blocks[l]) {
+					for (uint32_t i = 0; i < 5; i++) {
+						as_rmd_store(digests[l] + i * 4, h[i][l]);
+					}
+				}
+			}
+		}
+		return;
+	}
+#endif
+
+	for (uint32_t l = 0; l < n_msgs; l++) {
+		as_rmd_hash(msgs[l], lens[l], digests[l]);
+	}
+}
@@ -15,15 +15,16 @@
  * the License.
  */
 #include <aerospike/as_shm_cluster.h>
+#include <aerospike/aerospike_stats.h>
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_cpu.h>
+#include <aerospike/as_key.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_node.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_sleep.h>
 #include <aerospike/as_string.h>
-#include <citrusleaf/cf_b64.h>
 #include <citrusleaf/cf_byte_order.h>
 #include <citrusleaf/cf_clock.h>
 #include <errno.h>
@@ -43,6 +44,9 @@
 #include <sys/sysctl.h>
 #endif
 
+// Maximum attempts to read a partition while the tender is updating it.
+#define AS_SHM_SEQ_RETRIES 64
+
 /******************************************************************************
  * DECLARATIONS
  ******************************************************************************/
@@ -90,7 +94,7 @@ as_shm_dump_partition_table(as_partition_table_shm* table, uint32_t n_partitions
 
 	for (uint32_t i = 0; i < n_partitions; i++) {
 		as_partition_shm* p = &table->partitions[i];
-		printf("%d %d\n", i, p->master);
+		printf("%d %d\n", i, p->nodes[0]);
 	}
 }
 
@@ -417,14 +421,32 @@ as_shm_node_replace_racks(as_cluster_shm* cluster_shm, as_node* node, as_racks*
 	as_swlock_write_unlock(&node_shm->lock);
 }
 
-as_partition_table_shm*
-as_shm_find_partition_table(as_cluster_shm* cluster_shm, const char* ns)
+static as_partition_table_shm*
+as_shm_find_partition_table_index(as_shm_info* shm_info, const char* ns, uint32_t* index)
 {
-	as_partition_table_shm* table = as_shm_get_partition_tables(cluster_shm);
-	uint32_t max = cluster_shm->partition_tables_size;
+	as_cluster_shm* cluster_shm = shm_info->cluster_shm;
+	as_partition_table_shm* tables = as_shm_get_partition_tables(cluster_shm);
+	uint32_t max = as_load_uint32(&cluster_shm->partition_tables_size);
+	uint32_t slot = as_partition_ns_hash(ns) & (AS_PARTITION_HASH_SIZE - 1);
+	uint32_t id = as_load_uint16(&shm_info->ns_cache[slot]);
+
+	if (id && id <= max) {
+		as_partition_table_shm* table = as_shm_get_partition_table(cluster_shm, tables, id - 1);
+
+		if (strcmp(table->ns, ns) == 0) {
+			*index = id - 1;
+			return table;
+		}
+	}
+
+	as_partition_table_shm* table = tables;
 	
 	for (uint32_t i = 0; i < max; i++) {
 		if (strcmp(table->ns, ns) == 0) {
+			if (i < UINT16_MAX) {
+				as_store_uint16(&shm_info->ns_cache[slot], (uint16_t)(i + 1));
+			}
+			*index = i;
 			return table;
 		}
 		table = as_shm_next_partition_table(cluster_shm, table);
@@ -432,6 +454,38 @@ as_shm_find_partition_table(as_cluster_shm* cluster_shm, const char* ns)
 	return 0;
 }
 
+as_partition_table_shm*
+as_shm_find_partition_table(as_shm_info* shm_info, const char* ns)
+{
+	uint32_t index;
+	return as_shm_find_partition_table_index(shm_info, ns, &index);
+}
+
+as_partition_table_shm*
+as_shm_get_key_partition_table(as_shm_info* shm_info, const as_key* key)
+{
+	as_cluster_shm* cluster_shm = shm_info->cluster_shm;
+	uint32_t id = key->ns_id;
+
+	// The key may have been resolved by another cluster, so verify the namespace.
+	if (id && id <= as_load_uint32(&cluster_shm->partition_tables_size)) {
+		as_partition_table_shm* tables = as_shm_get_partition_tables(cluster_shm);
+		as_partition_table_shm* table = as_shm_get_partition_table(cluster_shm, tables, id - 1);
+
+		if (strcmp(table->ns, key->ns) == 0) {
+			return table;
+		}
+	}
+
+	uint32_t index;
+	as_partition_table_shm* table = as_shm_find_partition_table_index(shm_info, key->ns, &index);
+
+	if (table && index < UINT16_MAX) {
+		((as_key*)key)->ns_id = (uint16_t)(index + 1);
+	}
+	return table;
+}
+
 static as_partition_table_shm*
 as_shm_add_partition_table(as_cluster_shm* cluster_shm, const char* ns, bool sc_mode)
 {
@@ -464,61 +518,100 @@ as_shm_force_replicas_refresh(as_shm_info* shm_info, uint32_t node_index)
 }
 
 static void
-as_shm_decode_and_update(as_shm_info* shm_info, char* bitmap_b64, int64_t len, as_partition_table_shm* table, uint32_t node_index, bool master, uint32_t regime)
+as_shm_decode_and_update(as_shm_info* shm_info, char** bitmaps, uint32_t n_bitmaps, int64_t len, as_partition_table_shm* table, uint32_t node_index, uint8_t replica_count, uint32_t regime)
 {
-	// Size allows for padding - is actual size rounded up to multiple of 3.
-	uint8_t* bitmap = (uint8_t*)alloca(cf_b64_decoded_buf_size((uint32_t)len));
-	
+	uint32_t n_words = as_partition_bitmap_words((uint32_t)len);
+	uint64_t* words = (uint64_t*)alloca(sizeof(uint64_t) * n_words * n_bitmaps);
+
 	// For now - for speed - trust validity of encoded characters.
-	cf_b64_decode(bitmap_b64, (uint32_t)len, bitmap, NULL);
-	
-	// Expand the bitmap.
-	uint32_t max = shm_info->cluster_shm->n_partitions;
+	for (uint32_t r = 0; r < n_bitmaps; r++) {
+		as_partition_bitmap_decode(bitmaps[r], (uint32_t)len, shm_info->cluster_shm->n_partitions,
+								   &words[r * n_words]);
+	}
+
+	// Visit only partitions claimed by this node at any replica level, skipping unclaimed words.
+	for (uint32_t w = 0; w < n_words; w++) {
+		uint64_t bits = 0;
+
+		for (uint32_t r = 0; r < n_bitmaps; r++) {
+			bits |= words[r * n_words + w];
+		}
+
+		while (bits) {
+			uint32_t b = as_partition_clz64(bits);
+			uint32_t i = (w << 6) + b;
+			uint64_t mask = 0x8000000000000000ULL >> b;
+
+			bits &= ~mask;
 
-	for (uint32_t i = 0; i < max; i++) {
-		if ((bitmap[i >> 3] & (0x80 >> (i & 7))) != 0) {
 			// This node claims ownership of partition.
 			as_partition_shm* p = &table->partitions[i];
 
-			if (regime >= as_load_uint32(&p->regime)) {
-				if (regime > p->regime) {
-					as_store_uint32(&p->regime, regime);
-				}
+			if (regime < p->regime) {
+				continue;
+			}
 
-				if (master) {
-					// node_index starts at one (zero indicates unset).
-					if (node_index != p->master) {
-						if (p->master) {
-							as_shm_force_replicas_refresh(shm_info, p->master);
-						}
-						as_store_uint32(&p->master, node_index);
-					}
+			// Build the new replica set before publishing, so readers never see a partially
+			// updated replica set.  Only the tender process writes partitions, so plain reads
+			// are sufficient here.
+			uint32_t nodes[AS_MAX_REPLICAS];
+			bool changed = regime != p->regime || replica_count != p->replica_count;
+
+			for (uint32_t r = 0; r < AS_MAX_REPLICAS; r++) {
+				nodes[r] = p->nodes[r];
+			}
+
+			for (uint32_t r = 0; r < n_bitmaps; r++) {
+				if (! (words[r * n_words + w] & mask)) {
+					continue;
 				}
-				else {
-					if (node_index != p->prole) {
-						if (p->prole) {
-							as_shm_force_replicas_refresh(shm_info, p->prole);
-						}
-						as_store_uint32(&p->prole, node_index);
+
+				// node_index starts at one (zero indicates unset).
+				uint32_t old = nodes[r];
+
+				if (node_index != old) {
+					if (old) {
+						as_shm_force_replicas_refresh(shm_info, old);
 					}
+					nodes[r] = node_index;
+					changed = true;
 				}
 			}
+
+			if (! changed) {
+				continue;
+			}
+
+			// A sequence left odd by a tender that died during an update is reused.
+			uint32_t seq = as_load_uint32(&p->seq) | 1;
+
+			as_store_uint32(&p->seq, seq);
+			as_fence_store();
+			as_store_uint32(&p->regime, regime);
+			as_store_uint8(&p->replica_count, replica_count);
+
+			for (uint32_t r = 0; r < AS_MAX_REPLICAS; r++) {
+				as_store_uint32(&p->nodes[r], nodes[r]);
+			}
+			as_fence_store();
+			as_store_uint32(&p->seq, seq + 1);
 		}
 	}
 }
 
 void
-as_shm_update_partitions(as_shm_info* shm_info, const char* ns, char* bitmap_b64, int64_t len, as_node* node, bool master, uint32_t regime)
+as_shm_update_partitions(as_shm_info* shm_info, const char* ns, char** bitmaps, uint32_t n_bitmaps, int64_t len, as_node* node, uint8_t replica_count, uint32_t regime)
 {
 	as_cluster_shm* cluster_shm = shm_info->cluster_shm;
-	as_partition_table_shm* table = as_shm_find_partition_table(cluster_shm, ns);
+	as_partition_table_shm* table = as_shm_find_partition_table(shm_info, ns);
 	
 	if (! table) {
 		table = as_shm_add_partition_table(cluster_shm, ns, regime != 0);
 	}
 	
 	if (table) {
-		as_shm_decode_and_update(shm_info, bitmap_b64, len, table, node->index + 1, master, regime);
+		as_shm_decode_and_update(shm_info, bitmaps, n_bitmaps, len, table, node->index + 1,
+								 replica_count, regime);
 	}
 }
 
@@ -551,41 +644,53 @@ as_shm_try_node(as_cluster* cluster, as_node** local_nodes, uint32_t node_index)
 	return NULL;
 }
 
-static as_node*
-as_shm_try_node_alternate(
-	as_cluster* cluster, as_node** local_nodes, uint32_t chosen_index, uint32_t alternate_index
-	)
+static inline void
+shm_read_partition(as_partition_shm* p, as_partition_shm* copy)
 {
-	// index values start at one (zero indicates unset).
-	as_node* chosen = (as_node*)as_load_ptr(&local_nodes[chosen_index-1]);
-	
-	// Make volatile reference so changes to tend thread will be reflected in this thread.
-	if (chosen && as_load_uint8(&chosen->active)) {
-		return chosen;
+	// Copy partition when no update is in progress, so replicas and regime are consistent.
+	// Give up after a limited number of retries in case the tender process died during an
+	// update, and use the last copy.
+	for (uint32_t i = 0; i < AS_SHM_SEQ_RETRIES; i++) {
+		uint32_t seq = as_load_uint32(&p->seq);
+		as_fence_lock();
+
+		for (uint32_t j = 0; j < AS_MAX_REPLICAS; j++) {
+			copy->nodes[j] = as_load_uint32(&p->nodes[j]);
+		}
+		copy->regime = as_load_uint32(&p->regime);
+		copy->replica_count = as_load_uint8(&p->replica_count);
+		as_fence_lock();
+
+		if ((seq & 1) == 0 && as_load_uint32(&p->seq) == seq) {
+			return;
+		}
 	}
-	return as_shm_try_node(cluster, local_nodes, alternate_index);
+}
+
+static inline uint32_t
+shm_replica_count(as_partition_shm* p)
+{
+	uint32_t count = p->replica_count;
+	return (count > 0)? count : 1;
 }
 
 static as_node*
 shm_get_sequence_node(
-	as_cluster* cluster, as_node** local_nodes, as_partition_shm* p, bool use_master
+	as_cluster* cluster, as_node** local_nodes, as_partition_shm* p, uint32_t start
 	)
 {
-	uint32_t master = as_load_uint32(&p->master);
-	uint32_t prole = as_load_uint32(&p->prole);
+	// Walk replicas in sequence order beginning at start and wrapping around to the master.
+	uint32_t count = shm_replica_count(p);
 
-	if (! prole) {
-		return as_shm_try_node(cluster, local_nodes, master);
-	}
-
-	if (! master) {
-		return as_shm_try_node(cluster, local_nodes, prole);
-	}
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t index = (start + i) % count;
+		as_node* node = as_shm_try_node(cluster, local_nodes, p->nodes[index]);
 
-	if (use_master) {
-		return as_shm_try_node_alternate(cluster, local_nodes, master, prole);
+		if (node) {
+			return node;
+		}
 	}
-	return as_shm_try_node_alternate(cluster, local_nodes, prole, master);
+	return NULL;
 }
 
 static inline as_node*
@@ -634,58 +739,39 @@ shm_try_rack_node(
 
 static as_node*
 shm_prefer_rack_node(
-	as_cluster* cluster, as_node** local_nodes, const char* ns, as_partition_shm* p, bool use_master
+	as_cluster* cluster, as_node** local_nodes, const char* ns, as_partition_shm* p, uint32_t start
 	)
 {
 	as_node_shm* nodes_shm = cluster->shm_info->cluster_shm->nodes;
-	as_node* node;
-	uint32_t master;
-	uint32_t prole;
+	uint32_t count = shm_replica_count(p);
 
-	if (use_master) {
-		master = as_load_uint32(&p->master);
-		node = shm_try_rack_node(cluster, nodes_shm, local_nodes, ns, master);
-
-		if (node) {
-			return node;
-		}
-
-		prole = as_load_uint32(&p->prole);
-		node = shm_try_rack_node(cluster, nodes_shm, local_nodes, ns, prole);
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t index = (start + i) % count;
+		as_node* node = shm_try_rack_node(cluster, nodes_shm, local_nodes, ns, p->nodes[index]);
 
 		if (node) {
 			return node;
 		}
 	}
-	else {
-		prole = as_load_uint32(&p->prole);
-		node = shm_try_rack_node(cluster, nodes_shm, local_nodes, ns, prole);
 
-		if (node) {
-			return node;
-		}
+	// Default to sequence mode.
+	return shm_get_sequence_node(cluster, local_nodes, p, start);
+}
+
+static as_node*
+shm_get_latency_node(as_cluster* cluster, as_node** local_nodes, as_partition_shm* p)
+{
+	uint32_t count = shm_replica_count(p);
+	as_node* best = NULL;
 
-		master = as_load_uint32(&p->master);
-		node = shm_try_rack_node(cluster, nodes_shm, local_nodes, ns, master);
+	for (uint32_t i = 0; i < count; i++) {
+		as_node* node = as_shm_try_node(cluster, local_nodes, p->nodes[i]);
 
 		if (node) {
-			return node;
+			best = best? as_node_latency_select(best, node) : node;
 		}
 	}
-
-	// Default to sequence mode.
-	if (! prole) {
-		return as_shm_try_node(cluster, local_nodes, master);
-	}
-
-	if (! master) {
-		return as_shm_try_node(cluster, local_nodes, prole);
-	}
-
-	if (use_master) {
-		return as_shm_try_node_alternate(cluster, local_nodes, master, prole);
-	}
-	return as_shm_try_node_alternate(cluster, local_nodes, prole, master);
+	return best;
 }
 
 static uint32_t g_shm_randomizer = 0;
@@ -693,36 +779,50 @@ static uint32_t g_shm_randomizer = 0;
 as_node*
 as_partition_shm_get_node(
 	as_cluster* cluster, const char* ns, as_partition_shm* p, as_policy_replica replica,
-	bool use_master, bool is_retry
+	uint8_t replica_index, bool is_retry
 	)
 {
 	as_node** local_nodes = cluster->shm_info->local_nodes;
 
-	switch (replica) {
-		case AS_POLICY_REPLICA_MASTER: {
-			// Make volatile reference so changes to tend thread will be reflected in this thread.
-			uint32_t master = as_load_uint32(&p->master);
-			return as_shm_try_master(cluster, local_nodes, master);
-		}
+	if (replica == AS_POLICY_REPLICA_MASTER) {
+		// Make volatile reference so changes to tend thread will be reflected in this thread.
+		// A single field does not need the sequence lock.
+		uint32_t master = as_load_uint32(&p->nodes[0]);
+		return as_shm_try_master(cluster, local_nodes, master);
+	}
 
+	// Route with a consistent copy of the partition replicas.
+	as_partition_shm copy;
+	shm_read_partition(p, &copy);
+	p = &copy;
+
+	switch (replica) {
 		case AS_POLICY_REPLICA_ANY: {
-			// Alternate between master and prole for reads with global iterator.
+			// Rotate between all replicas for reads with global iterator.
 			uint32_t r = as_faa_uint32(&g_shm_randomizer, 1);
-			use_master = (r & 1);
-			return shm_get_sequence_node(cluster, local_nodes, p, use_master);
+			return shm_get_sequence_node(cluster, local_nodes, p, r % shm_replica_count(p));
 		}
 
 		default:
 		case AS_POLICY_REPLICA_SEQUENCE: {
-			return shm_get_sequence_node(cluster, local_nodes, p, use_master);
+			return shm_get_sequence_node(cluster, local_nodes, p, replica_index);
 		}
 
 		case AS_POLICY_REPLICA_PREFER_RACK: {
 			if (!is_retry) {
-				return shm_prefer_rack_node(cluster, local_nodes, ns, p, use_master);
+				return shm_prefer_rack_node(cluster, local_nodes, ns, p, replica_index);
+			}
+			else {
+				return shm_get_sequence_node(cluster, local_nodes, p, replica_index);
+			}
+		}
+
+		case AS_POLICY_REPLICA_LOWEST_LATENCY: {
+			if (!is_retry) {
+				return shm_get_latency_node(cluster, local_nodes, p);
 			}
 			else {
-				return shm_get_sequence_node(cluster, local_nodes, p, use_master);
+				return shm_get_sequence_node(cluster, local_nodes, p, replica_index);
 			}
 		}
 	}
@@ -775,6 +875,73 @@ as_process_exists(uint32_t pid)
 #endif
 }
 
+static void
+as_shm_claim_process(as_shm_info* shm_info, as_cluster_shm* cluster_shm, uint32_t pid)
+{
+	as_process_shm* processes = as_shm_get_processes(cluster_shm);
+	uint32_t max = as_load_uint32(&cluster_shm->processes_capacity);
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_process_shm* process = &processes[i];
+		uint32_t owner = as_load_uint32(&process->pid);
+
+		// Reuse slots of processes that exited without releasing their slot.
+		if ((owner == 0 || !as_process_exists(owner)) &&
+			as_cas_uint32(&process->pid, owner, pid)) {
+			// Hide stale statistics of a previous owner until the first publish.
+			as_store_uint64(&process->timestamp, 0);
+			shm_info->process = process;
+			return;
+		}
+	}
+	as_log_warn("Shared memory process stats slots are full: %u pid: %d", max, pid);
+}
+
+static void
+as_shm_publish_stats(as_cluster* cluster, as_process_shm* process)
+{
+	as_process_shm stats;
+	memset(&stats, 0, sizeof(stats));
+
+	// Only the tend thread modifies the cluster node array.
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+		as_node_stats ns;
+
+		aerospike_node_stats(node, &ns);
+		stats.sync_in_use += ns.sync.in_use;
+		stats.sync_in_pool += ns.sync.in_pool;
+		stats.async_in_use += ns.async.in_use;
+		stats.async_in_pool += ns.async.in_pool;
+		stats.pipe_in_use += ns.pipeline.in_use;
+		stats.pipe_in_pool += ns.pipeline.in_pool;
+		stats.conns_opened += ns.sync.opened;
+		stats.conns_closed += ns.sync.closed;
+		aerospike_node_stats_destroy(&ns);
+	}
+
+	for (uint32_t i = 0; i < AS_HEDGE_BUCKETS; i++) {
+		stats.latency[i] = as_load_uint32(&cluster->latency.buckets[i]);
+	}
+	stats.commands = as_load_uint64(&cluster->commands);
+	stats.retries_rejected = as_load_uint32(&cluster->retries_rejected);
+	stats.timestamp = cf_getms();
+
+	// Only the owner process writes its slot.
+	uint32_t seq = as_load_uint32(&process->seq) | 1;
+
+	as_store_uint32(&process->seq, seq);
+	as_fence_store();
+	memcpy(&process->sync_in_use, &stats.sync_in_use,
+		   sizeof(as_process_shm) - offsetof(as_process_shm, sync_in_use));
+	as_store_uint64(&process->commands, stats.commands);
+	as_store_uint64(&process->timestamp, stats.timestamp);
+	as_fence_store();
+	as_store_uint32(&process->seq, seq + 1);
+}
+
 static void*
 as_shm_tender(void* userdata)
 {
@@ -878,9 +1045,14 @@ as_shm_tender(void* userdata)
 				}
 			}
 
+			as_cluster_tend_stats(cluster);
 			as_cluster_balance_connections(cluster);
 		}
 
+		if (shm_info->process) {
+			as_shm_publish_stats(cluster, shm_info->process);
+		}
+
 		// Convert tend interval into absolute timeout.
 		cf_clock_current_add(&delta, &abstime);
 		
@@ -896,6 +1068,20 @@ as_shm_tender(void* userdata)
 	return 0;
 }
 
+static as_status
+as_shm_validate_version(as_error* err, as_cluster_shm* cluster_shm, uint32_t pid)
+{
+	uint32_t version = as_load_uint16(&cluster_shm->version);
+
+	if (version != AS_SHM_VERSION) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+			"Shared memory layout version %u does not match client layout version %u. "
+			"Use a different shm_key for clients with different versions. pid: %d",
+			version, AS_SHM_VERSION, pid);
+	}
+	return AEROSPIKE_OK;
+}
+
 static void
 as_shm_wait_till_ready(as_cluster* cluster, as_cluster_shm* cluster_shm, uint32_t pid)
 {
@@ -923,14 +1109,35 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 	// Hard code value for now.
 	uint32_t n_partitions = 4096;
 	
-	uint32_t size = sizeof(as_cluster_shm) + (sizeof(as_node_shm) * config->shm_max_nodes) +
+	uint32_t processes_offset = sizeof(as_cluster_shm) + (sizeof(as_node_shm) * config->shm_max_nodes) +
 		((sizeof(as_partition_table_shm) + (sizeof(as_partition_shm) * n_partitions)) * config->shm_max_namespaces);
+
+	uint32_t size = processes_offset + (sizeof(as_process_shm) * config->shm_max_processes);
 	
 	uint32_t pid = getpid();
 
 #if !defined(_MSC_VER)
+	int flags = IPC_CREAT | IPC_EXCL | 0666;
+
+	if (config->shm_huge_pages) {
+#if defined(__linux__) && defined(SHM_HUGETLB)
+		// The kernel rounds the segment up to a multiple of the huge page size.
+		flags |= SHM_HUGETLB;
+#else
+		as_log_warn("Shared memory huge pages are not supported on this platform");
+#endif
+	}
+
 	// Create shared memory segment.  Only one process will succeed.
-	int id = shmget(config->shm_key, size, IPC_CREAT | IPC_EXCL | 0666);
+	int id = shmget(config->shm_key, size, flags);
+
+#if defined(__linux__) && defined(SHM_HUGETLB)
+	if (id < 0 && (flags & SHM_HUGETLB) && errno != EEXIST) {
+		// Huge pages are not available.  Use regular pages.
+		as_log_warn("Shared memory huge pages failed: %s pid: %d", strerror(errno), pid);
+		id = shmget(config->shm_key, size, IPC_CREAT | IPC_EXCL | 0666);
+	}
+#endif
 
 	if (id >= 0) {
 		// Exclusive shared memory lock succeeded.
@@ -979,6 +1186,10 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 	DWORD code;
 	int i;
 
+	if (config->shm_huge_pages) {
+		as_log_warn("Shared memory huge pages are not supported on this platform");
+	}
+
 	for (i = 0; i < 2; i++) {
 		// Try global shared memory namespace first.  This will fail with 
 		// ERROR_ACCESS_DENIED if the process is not run with administrator
@@ -1023,16 +1234,32 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 	shm_info->shm_id = id;
 	shm_info->takeover_threshold_ms = config->shm_takeover_threshold_sec * 1000;
 	shm_info->is_tend_master = as_cas_uint8(&cluster_shm->lock, 0, 1);
+	memset(shm_info->ns_cache, 0, sizeof(shm_info->ns_cache));
+	shm_info->process = NULL;
 	cluster->shm_info = shm_info;
 
 	if (shm_info->is_tend_master) {
 		as_log_info("Take over shared memory cluster: %d", pid);
 		as_fence_lock();
+
+		// Do not modify shared memory initialized with a different layout.
+		if (as_load_uint8(&cluster_shm->ready)) {
+			as_status status = as_shm_validate_version(err, cluster_shm, pid);
+
+			if (status != AEROSPIKE_OK) {
+				as_store_uint8(&cluster_shm->lock, 0);
+				as_shm_destroy(cluster);
+				return status;
+			}
+		}
+
 		cluster_shm->n_partitions = n_partitions;
 		cluster_shm->nodes_capacity = config->shm_max_nodes;
 		cluster_shm->partition_tables_capacity = config->shm_max_namespaces;
 		cluster_shm->partition_tables_offset = sizeof(as_cluster_shm) + (sizeof(as_node_shm) * config->shm_max_nodes);
 		cluster_shm->partition_table_byte_size = sizeof(as_partition_table_shm) + (sizeof(as_partition_shm) * n_partitions);
+		cluster_shm->processes_offset = processes_offset;
+		cluster_shm->processes_capacity = config->shm_max_processes;
 		cluster_shm->timestamp = cf_getms();
 
 		as_store_uint32(&cluster_shm->owner_pid, pid);
@@ -1046,6 +1273,8 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 		}
 		else {
 			as_log_info("Initialize cluster: %d", pid);
+			as_store_uint16(&cluster_shm->version, AS_SHM_VERSION);
+
 			as_status status = as_cluster_init(cluster, err, true);
 			
 			if (status != AEROSPIKE_OK) {
@@ -1067,10 +1296,24 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 		}
 		as_fence_unlock();
 
+		if (as_load_uint8(&cluster_shm->ready)) {
+			as_status status = as_shm_validate_version(err, cluster_shm, pid);
+
+			if (status != AEROSPIKE_OK) {
+				as_shm_destroy(cluster);
+				return status;
+			}
+		}
+
 		// Copy shared memory nodes to local nodes.
 		as_shm_reset_nodes(cluster);
 		as_cluster_add_seeds(cluster);
 	}
+
+	if (config->shm_max_processes > 0) {
+		as_shm_claim_process(shm_info, cluster_shm, pid);
+		cluster->count_commands = shm_info->process != NULL;
+	}
 	cluster->valid = true;
 	
 	// Run tending thread which handles both master and prole tending.
@@ -1101,6 +1344,11 @@ as_shm_destroy(as_cluster* cluster)
 		return;
 	}
 
+	if (shm_info->process) {
+		// Release process statistics slot.
+		as_store_uint32(&shm_info->process->pid, 0);
+	}
+
 #if !defined(_MSC_VER)
 	// Detach shared memory.
 	shmdt(shm_info->cluster_shm);
@@ -1120,3 +1368,41 @@ as_shm_destroy(as_cluster* cluster)
 	cf_free(shm_info);
 	cluster->shm_info = 0;
 }
+
+uint32_t
+as_shm_get_process_stats(as_cluster* cluster, as_process_shm* stats, uint32_t capacity)
+{
+	as_shm_info* shm_info = cluster->shm_info;
+
+	if (! shm_info) {
+		return 0;
+	}
+
+	as_cluster_shm* cluster_shm = shm_info->cluster_shm;
+	as_process_shm* processes = as_shm_get_processes(cluster_shm);
+	uint32_t max = as_load_uint32(&cluster_shm->processes_capacity);
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < max && count < capacity; i++) {
+		as_process_shm* process = &processes[i];
+		as_process_shm* trg = &stats[count];
+
+		// Copy slot when its owner is not writing it.  Give up after limited retries in case
+		// the owner died during a write.
+		for (uint32_t j = 0; j < AS_SHM_SEQ_RETRIES; j++) {
+			uint32_t seq = as_load_uint32(&process->seq);
+			as_fence_lock();
+			memcpy(trg, process, sizeof(as_process_shm));
+			as_fence_lock();
+
+			if ((seq & 1) == 0 && as_load_uint32(&process->seq) == seq) {
+				break;
+			}
+		}
+
+		if (trg->pid != 0 && trg->timestamp != 0) {
+			count++;
+		}
+	}
+	return count;
+}
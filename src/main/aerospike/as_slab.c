@@ -0,0 +1,214 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_slab.h>
+#include <aerospike/as_atomic.h>
+#include <citrusleaf/alloc.h>
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+// Object header.  Sized to preserve 16 byte alignment of the object that follows.
+typedef struct as_slab_header_s {
+	union {
+		as_slab* slab;
+		struct as_slab_header_s* next;
+	};
+	uint32_t size_class;
+	uint32_t pad;
+} as_slab_header;
+
+#define AS_SLAB_CLASS_NONE 0xFF
+#define AS_SLAB_MIN_SHIFT 10
+#define AS_SLAB_MIN_COUNT 8
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static inline uint32_t
+as_slab_class_index(size_t size)
+{
+	uint32_t index = 0;
+	size_t cap = (size_t)1 << AS_SLAB_MIN_SHIFT;
+
+	while (cap < size) {
+		cap <<= 1;
+		index++;
+	}
+	return index;
+}
+
+static inline bool
+as_slab_owner(as_slab* slab)
+{
+	return pthread_equal(*slab->thread, pthread_self());
+}
+
+static inline void*
+as_slab_object(as_slab* slab, as_slab_header* h, uint32_t index)
+{
+	if (! h) {
+		return NULL;
+	}
+	h->slab = slab;
+	h->size_class = index;
+	return h + 1;
+}
+
+static void
+as_slab_list_destroy(as_slab_header* h)
+{
+	while (h) {
+		as_slab_header* next = h->next;
+		cf_free(h);
+		h = next;
+	}
+}
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+as_slab*
+as_slab_create(const pthread_t* thread)
+{
+	as_slab* slab = cf_malloc(sizeof(as_slab));
+
+	pthread_mutex_init(&slab->lock, NULL);
+	slab->thread = thread;
+
+	for (uint32_t i = 0; i < AS_SLAB_CLASSES; i++) {
+		as_slab_class* sc = &slab->classes[i];
+		uint32_t max = AS_SLAB_CLASS_BYTES >> (AS_SLAB_MIN_SHIFT + i);
+
+		sc->local = NULL;
+		sc->shared = NULL;
+		sc->local_size = 0;
+		sc->shared_size = 0;
+		sc->max = (max < AS_SLAB_MIN_COUNT)? AS_SLAB_MIN_COUNT : max;
+	}
+	return slab;
+}
+
+void
+as_slab_destroy(as_slab* slab)
+{
+	for (uint32_t i = 0; i < AS_SLAB_CLASSES; i++) {
+		as_slab_class* sc = &slab->classes[i];
+		as_slab_list_destroy(sc->local);
+		as_slab_list_destroy(sc->shared);
+	}
+	pthread_mutex_destroy(&slab->lock);
+	cf_free(slab);
+}
+
+void*
+as_slab_alloc(as_slab* slab, size_t size)
+{
+	if (! slab || size > AS_SLAB_MAX_SIZE) {
+		as_slab_header* h = cf_malloc(sizeof(as_slab_header) + size);
+		return as_slab_object(NULL, h, AS_SLAB_CLASS_NONE);
+	}
+
+	uint32_t index = as_slab_class_index(size);
+	as_slab_class* sc = &slab->classes[index];
+	as_slab_header* h;
+
+	if (as_slab_owner(slab)) {
+		h = sc->local;
+
+		if (h) {
+			sc->local = h->next;
+			sc->local_size--;
+			return as_slab_object(slab, h, index);
+		}
+
+		// Local list is empty.  Move objects freed by other threads to the local list.
+		if (as_load_ptr(&sc->shared)) {
+			pthread_mutex_lock(&slab->lock);
+			h = sc->shared;
+			sc->local_size = sc->shared_size;
+			sc->shared = NULL;
+			sc->shared_size = 0;
+			pthread_mutex_unlock(&slab->lock);
+
+			if (h) {
+				sc->local = h->next;
+				sc->local_size--;
+				return as_slab_object(slab, h, index);
+			}
+			sc->local_size = 0;
+		}
+	}
+	else if (as_load_ptr(&sc->shared)) {
+		pthread_mutex_lock(&slab->lock);
+		h = sc->shared;
+
+		if (h) {
+			sc->shared = h->next;
+			sc->shared_size--;
+		}
+		pthread_mutex_unlock(&slab->lock);
+
+		if (h) {
+			return as_slab_object(slab, h, index);
+		}
+	}
+
+	h = cf_malloc(sizeof(as_slab_header) + ((size_t)1 << (AS_SLAB_MIN_SHIFT + index)));
+	return as_slab_object(slab, h, index);
+}
+
+void
+as_slab_free(void* ptr)
+{
+	if (! ptr) {
+		return;
+	}
+
+	as_slab_header* h = (as_slab_header*)ptr - 1;
+
+	if (h->size_class == AS_SLAB_CLASS_NONE) {
+		cf_free(h);
+		return;
+	}
+
+	as_slab* slab = h->slab;
+	as_slab_class* sc = &slab->classes[h->size_class];
+
+	if (as_slab_owner(slab) && sc->local_size < sc->max) {
+		h->next = sc->local;
+		sc->local = h;
+		sc->local_size++;
+		return;
+	}
+
+	pthread_mutex_lock(&slab->lock);
+
+	if (sc->shared_size < sc->max) {
+		h->next = sc->shared;
+		sc->shared = h;
+		sc->shared_size++;
+		h = NULL;
+	}
+	pthread_mutex_unlock(&slab->lock);
+
+	if (h) {
+		cf_free(h);
+	}
+}
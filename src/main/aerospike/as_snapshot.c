@@ -0,0 +1,602 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_snapshot.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_string.h>
+#include <aerospike/as_string_builder.h>
+#include <citrusleaf/alloc.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+// Snapshot files are only read by clients on the same host, so fields are stored in native
+// byte order.  Each segment is zero padded to 8 bytes, so records stay aligned when the file
+// is loaded into memory.  The layout is:
+//
+// as_snapshot_header
+// cluster name (cluster_name_len bytes)
+// seeds (seeds_len bytes, one "host:port\n" line per seed)
+// n_nodes * (as_snapshot_node, tls name (tls_name_len bytes), n_racks * as_rack)
+// n_tables * (as_snapshot_table, n_partitions * as_snapshot_partition)
+
+#define AS_SNAPSHOT_MAGIC 0x504e5341 // "ASNP"
+#define AS_SNAPSHOT_VERSION 2
+#define AS_SNAPSHOT_N_PARTITIONS 4096
+#define AS_SNAPSHOT_ALIGN(_len) (((_len) + 7) & ~(size_t)7)
+
+typedef struct as_snapshot_header_s {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t n_partitions;
+	uint32_t max_replicas;
+	uint32_t n_nodes;
+	uint32_t n_tables;
+	uint32_t cluster_name_len;
+	uint32_t seeds_len;
+} as_snapshot_header;
+
+typedef struct as_snapshot_node_s {
+	char name[AS_NODE_NAME_SIZE];
+	uint32_t features;
+	uint32_t tls_name_len;
+	uint32_t has_racks;
+	int rack_id;
+	uint32_t n_racks;
+	struct sockaddr_storage addr;
+} as_snapshot_node;
+
+typedef struct as_snapshot_table_s {
+	char ns[AS_MAX_NAMESPACE_SIZE];
+	uint8_t sc_mode;
+	uint8_t pad[3];
+} as_snapshot_table;
+
+typedef struct as_snapshot_partition_s {
+	uint32_t regime;
+	uint16_t nodes[AS_MAX_REPLICAS]; // Node index + 1.  Zero if replica is not assigned.
+	uint8_t replica_count;
+	uint8_t pad[3];
+} as_snapshot_partition;
+
+typedef struct as_snapshot_reader_s {
+	uint8_t* p;
+	uint8_t* end;
+} as_snapshot_reader;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static inline uint64_t
+as_snapshot_hash(uint64_t h, const void* data, size_t len)
+{
+	// FNV-1a.
+	const uint8_t* p = data;
+
+	for (size_t i = 0; i < len; i++) {
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static bool
+as_snapshot_put(FILE* fp, const void* data, size_t len)
+{
+	static const uint8_t zeros[8] = {0};
+	size_t pad = AS_SNAPSHOT_ALIGN(len) - len;
+
+	if (len > 0 && fwrite(data, len, 1, fp) != 1) {
+		return false;
+	}
+	return pad == 0 || fwrite(zeros, pad, 1, fp) == 1;
+}
+
+static inline void*
+as_snapshot_get(as_snapshot_reader* r, size_t len)
+{
+	size_t size = AS_SNAPSHOT_ALIGN(len);
+
+	if ((size_t)(r->end - r->p) < size) {
+		return NULL;
+	}
+
+	void* data = r->p;
+	r->p += size;
+	return data;
+}
+
+static void
+as_snapshot_append_seed(as_string_builder* sb, as_host* seed)
+{
+	as_string_builder_append(sb, seed->name);
+	as_string_builder_append_char(sb, ':');
+	as_string_builder_append_uint(sb, seed->port);
+	as_string_builder_append_char(sb, '\n');
+}
+
+static void
+as_snapshot_seeds(as_cluster* cluster, as_string_builder* sb)
+{
+	pthread_mutex_lock(&cluster->seed_lock);
+
+	as_vector* seeds = cluster->seeds;
+
+	for (uint32_t i = 0; i < seeds->size; i++) {
+		as_snapshot_append_seed(sb, as_vector_get(seeds, i));
+	}
+
+	pthread_mutex_unlock(&cluster->seed_lock);
+}
+
+static bool
+as_snapshot_has_seed(const char* seeds, uint32_t len, const char* line, uint32_t line_len)
+{
+	const char* p = seeds;
+	const char* end = seeds + len;
+
+	while (p < end) {
+		const char* eol = memchr(p, '\n', end - p);
+
+		if (! eol) {
+			return false;
+		}
+
+		uint32_t size = (uint32_t)(eol - p + 1);
+
+		if (size == line_len && memcmp(p, line, size) == 0) {
+			return true;
+		}
+		p = eol + 1;
+	}
+	return false;
+}
+
+static bool
+as_snapshot_match_seeds(as_cluster* cluster, const char* seeds, uint32_t len)
+{
+	// Seeds grow as the tender adds node addresses, so the snapshot may contain more seeds
+	// than the configuration.  Every configured seed must be in the snapshot.  A snapshot
+	// written by a client of another cluster with the same cluster name is then rejected.
+	char line[512];
+
+	pthread_mutex_lock(&cluster->seed_lock);
+
+	as_vector* hosts = cluster->seeds;
+	bool rv = hosts->size > 0;
+
+	for (uint32_t i = 0; i < hosts->size && rv; i++) {
+		as_host* seed = as_vector_get(hosts, i);
+		int line_len = snprintf(line, sizeof(line), "%s:%u\n", seed->name, seed->port);
+
+		rv = line_len > 0 && line_len < (int)sizeof(line) &&
+			 as_snapshot_has_seed(seeds, len, line, (uint32_t)line_len);
+	}
+
+	pthread_mutex_unlock(&cluster->seed_lock);
+	return rv;
+}
+
+static uint16_t
+as_snapshot_node_index(as_nodes* nodes, as_node* node)
+{
+	if (! node) {
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		if (nodes->array[i] == node) {
+			return (uint16_t)(i + 1);
+		}
+	}
+	// Node has been removed from the cluster, but not yet from the partition map.
+	return 0;
+}
+
+static bool
+as_snapshot_write_file(as_cluster* cluster, FILE* fp, as_string_builder* seeds)
+{
+	as_nodes* nodes = cluster->nodes;
+	as_partition_tables* tables = &cluster->partition_tables;
+	const char* cluster_name = cluster->cluster_name;
+
+	as_snapshot_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = AS_SNAPSHOT_MAGIC;
+	header.version = AS_SNAPSHOT_VERSION;
+	header.n_partitions = cluster->n_partitions;
+	header.max_replicas = AS_MAX_REPLICAS;
+	header.n_nodes = nodes->size;
+	header.n_tables = tables->size;
+	header.cluster_name_len = (uint32_t)strlen(cluster_name);
+	header.seeds_len = seeds->length;
+
+	if (! (as_snapshot_put(fp, &header, sizeof(header)) &&
+		   as_snapshot_put(fp, cluster_name, header.cluster_name_len) &&
+		   as_snapshot_put(fp, seeds->data, header.seeds_len))) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+		as_address* address = as_node_get_address(node);
+		as_racks* racks = node->racks;
+
+		as_snapshot_node sn;
+		memset(&sn, 0, sizeof(sn));
+		memcpy(sn.name, node->name, AS_NODE_NAME_SIZE);
+		sn.features = node->features;
+		sn.tls_name_len = node->tls_name ? (uint32_t)strlen(node->tls_name) : 0;
+		memcpy(&sn.addr, &address->addr, sizeof(address->addr));
+
+		if (racks) {
+			sn.has_racks = 1;
+			sn.rack_id = racks->rack_id;
+			sn.n_racks = racks->size;
+		}
+
+		if (! (as_snapshot_put(fp, &sn, sizeof(sn)) &&
+			   as_snapshot_put(fp, node->tls_name, sn.tls_name_len) &&
+			   (! racks || as_snapshot_put(fp, racks->racks, sizeof(as_rack) * racks->size)))) {
+			return false;
+		}
+	}
+
+	as_snapshot_partition* parts = cf_malloc(sizeof(as_snapshot_partition) * cluster->n_partitions);
+	bool rv = true;
+
+	for (uint32_t i = 0; i < tables->size && rv; i++) {
+		as_partition_table* table = tables->tables[i];
+
+		as_snapshot_table st;
+		memset(&st, 0, sizeof(st));
+		as_strncpy(st.ns, table->ns, AS_MAX_NAMESPACE_SIZE);
+		st.sc_mode = table->sc_mode;
+
+		for (uint32_t j = 0; j < cluster->n_partitions; j++) {
+			as_partition* p = &table->partitions[j];
+			as_snapshot_partition* sp = &parts[j];
+
+			sp->regime = p->regime;
+			sp->replica_count = p->replica_count;
+			memset(sp->pad, 0, sizeof(sp->pad));
+
+			for (uint32_t k = 0; k < AS_MAX_REPLICAS; k++) {
+				sp->nodes[k] = as_snapshot_node_index(nodes, p->nodes[k]);
+			}
+		}
+
+		rv = as_snapshot_put(fp, &st, sizeof(st)) &&
+			 as_snapshot_put(fp, parts, sizeof(as_snapshot_partition) * cluster->n_partitions);
+	}
+	cf_free(parts);
+	return rv;
+}
+
+static bool
+as_snapshot_rename(const char* src, const char* trg)
+{
+#if !defined(_MSC_VER)
+	return rename(src, trg) == 0;
+#else
+	return MoveFileExA(src, trg, MOVEFILE_REPLACE_EXISTING) != 0;
+#endif
+}
+
+static uint8_t*
+as_snapshot_read_file(as_error* err, const char* path, size_t* size)
+{
+	FILE* fp = fopen(path, "rb");
+
+	if (! fp) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to open snapshot %s: %s",
+			path, strerror(errno));
+		return NULL;
+	}
+
+	uint8_t* buf = NULL;
+	long len = 0;
+
+	if (fseek(fp, 0, SEEK_END) == 0 && (len = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+		buf = cf_malloc(len);
+
+		if (fread(buf, len, 1, fp) != 1) {
+			cf_free(buf);
+			buf = NULL;
+		}
+	}
+	fclose(fp);
+
+	if (! buf) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to read snapshot %s", path);
+		return NULL;
+	}
+	*size = (size_t)len;
+	return buf;
+}
+
+static as_node*
+as_snapshot_create_node(as_cluster* cluster, as_snapshot_reader* r)
+{
+	as_snapshot_node* sn = as_snapshot_get(r, sizeof(as_snapshot_node));
+
+	if (! sn || sn->name[AS_NODE_NAME_SIZE - 1] != 0 || sn->n_racks > AS_MAX_NAMESPACES ||
+		(sn->addr.ss_family != AF_INET && sn->addr.ss_family != AF_INET6)) {
+		return NULL;
+	}
+
+	char* tls_name = as_snapshot_get(r, sn->tls_name_len);
+	as_rack* racks = as_snapshot_get(r, sizeof(as_rack) * sn->n_racks);
+
+	if (! tls_name || ! racks) {
+		return NULL;
+	}
+
+	as_node_info node_info;
+	memset(&node_info, 0, sizeof(node_info));
+	memcpy(node_info.name, sn->name, AS_NODE_NAME_SIZE);
+	node_info.features = sn->features;
+	memcpy(&node_info.addr, &sn->addr, sizeof(sn->addr));
+
+	// Tend connection is opened on first tend.
+	node_info.socket.fd = -1;
+
+	if (sn->tls_name_len > 0) {
+		node_info.host.tls_name = cf_malloc(sn->tls_name_len + 1);
+		memcpy(node_info.host.tls_name, tls_name, sn->tls_name_len);
+		node_info.host.tls_name[sn->tls_name_len] = 0;
+	}
+
+	as_node* node = as_node_create(cluster, &node_info);
+
+	if (node_info.host.tls_name) {
+		cf_free(node_info.host.tls_name);
+	}
+
+	if (cluster->user) {
+		// Session tokens are not persisted.  Login on first tend.
+		node->perform_login = 1;
+	}
+
+	if (sn->has_racks) {
+		as_racks* rs = cf_malloc(sizeof(as_racks) + (sizeof(as_rack) * sn->n_racks));
+		rs->ref_count = 1;
+		rs->rack_id = sn->rack_id;
+		rs->size = sn->n_racks;
+		rs->pad = 0;
+		memcpy(rs->racks, racks, sizeof(as_rack) * sn->n_racks);
+		node->racks = rs;
+	}
+	return node;
+}
+
+static bool
+as_snapshot_validate_tables(as_snapshot_reader* r, as_snapshot_header* header)
+{
+	// Validate all tables before any table is restored.
+	as_snapshot_reader v = *r;
+
+	for (uint32_t i = 0; i < header->n_tables; i++) {
+		as_snapshot_table* st = as_snapshot_get(&v, sizeof(as_snapshot_table));
+		as_snapshot_partition* parts = as_snapshot_get(&v,
+			sizeof(as_snapshot_partition) * header->n_partitions);
+
+		if (! st || ! parts || memchr(st->ns, 0, AS_MAX_NAMESPACE_SIZE) == NULL || st->ns[0] == 0) {
+			return false;
+		}
+
+		for (uint32_t j = 0; j < header->n_partitions; j++) {
+			as_snapshot_partition* sp = &parts[j];
+
+			for (uint32_t k = 0; k < AS_MAX_REPLICAS; k++) {
+				if (sp->nodes[k] > header->n_nodes) {
+					return false;
+				}
+			}
+		}
+	}
+	return v.p == v.end;
+}
+
+static void
+as_snapshot_restore_tables(as_cluster* cluster, as_snapshot_reader* r, as_snapshot_header* header,
+	as_vector* nodes)
+{
+	as_node* replicas[AS_MAX_REPLICAS];
+
+	for (uint32_t i = 0; i < header->n_tables; i++) {
+		as_snapshot_table* st = as_snapshot_get(r, sizeof(as_snapshot_table));
+		as_snapshot_partition* parts = as_snapshot_get(r,
+			sizeof(as_snapshot_partition) * header->n_partitions);
+
+		as_partition_table* table = as_partition_tables_restore(&cluster->partition_tables, st->ns,
+			header->n_partitions, st->sc_mode != 0);
+
+		if (! table) {
+			continue;
+		}
+
+		for (uint32_t j = 0; j < header->n_partitions; j++) {
+			as_snapshot_partition* sp = &parts[j];
+
+			for (uint32_t k = 0; k < AS_MAX_REPLICAS; k++) {
+				uint16_t index = sp->nodes[k];
+				replicas[k] = index ? as_vector_get_ptr(nodes, index - 1) : NULL;
+			}
+			as_partition_restore(&table->partitions[j], replicas, sp->replica_count, sp->regime);
+		}
+	}
+}
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+uint64_t
+as_snapshot_fingerprint(as_cluster* cluster)
+{
+	as_nodes* nodes = cluster->nodes;
+	uint64_t h = 14695981039346656037ULL;
+
+	h = as_snapshot_hash(h, &nodes->size, sizeof(nodes->size));
+	h = as_snapshot_hash(h, &cluster->partition_tables.size, sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		h = as_snapshot_hash(h, node->name, strlen(node->name));
+		h = as_snapshot_hash(h, &node->partition_generation, sizeof(uint32_t));
+		h = as_snapshot_hash(h, &node->rebalance_generation, sizeof(uint32_t));
+	}
+	return h;
+}
+
+as_status
+as_snapshot_write(as_cluster* cluster, as_error* err)
+{
+	as_error_reset(err);
+
+	if (cluster->nodes->size == 0 || cluster->n_partitions == 0) {
+		// Do not overwrite a previous snapshot with an empty cluster.
+		return AEROSPIKE_OK;
+	}
+
+	if (! cluster->cluster_name || cluster->cluster_name[0] == 0) {
+		// Snapshot can not be matched to a cluster on load.
+		return AEROSPIKE_OK;
+	}
+
+	size_t len = strlen(cluster->snapshot_path);
+	char* tmp = cf_malloc(len + 5);
+	memcpy(tmp, cluster->snapshot_path, len);
+	memcpy(tmp + len, ".tmp", 5);
+
+	FILE* fp = fopen(tmp, "wb");
+
+	if (! fp) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to create snapshot %s: %s",
+			tmp, strerror(errno));
+		cf_free(tmp);
+		return err->code;
+	}
+
+	as_string_builder seeds;
+	as_string_builder_init(&seeds, 512, true);
+	as_snapshot_seeds(cluster, &seeds);
+
+	bool rv = as_snapshot_write_file(cluster, fp, &seeds);
+
+	as_string_builder_destroy(&seeds);
+
+	if (fclose(fp) != 0) {
+		rv = false;
+	}
+
+	if (! rv) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to write snapshot %s", tmp);
+	}
+	else if (! as_snapshot_rename(tmp, cluster->snapshot_path)) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to rename snapshot %s",
+			cluster->snapshot_path);
+		rv = false;
+	}
+
+	if (! rv) {
+		remove(tmp);
+	}
+	cf_free(tmp);
+	return err->code;
+}
+
+as_status
+as_snapshot_load(as_cluster* cluster, as_error* err, as_vector* nodes)
+{
+	as_error_reset(err);
+
+	if (! cluster->cluster_name || cluster->cluster_name[0] == 0) {
+		// Without a cluster name, a snapshot of another cluster can not be detected.
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT,
+			"Snapshot requires cluster_name");
+	}
+
+	size_t size = 0;
+	uint8_t* buf = as_snapshot_read_file(err, cluster->snapshot_path, &size);
+
+	if (! buf) {
+		return err->code;
+	}
+
+	as_snapshot_reader r = {buf, buf + size};
+	as_snapshot_header* header = as_snapshot_get(&r, sizeof(as_snapshot_header));
+
+	if (! header || header->magic != AS_SNAPSHOT_MAGIC ||
+		header->version != AS_SNAPSHOT_VERSION || header->max_replicas != AS_MAX_REPLICAS ||
+		header->n_partitions != AS_SNAPSHOT_N_PARTITIONS || header->n_nodes == 0 || header->n_nodes > 0xFFFF ||
+		header->n_tables > AS_MAX_NAMESPACES) {
+		cf_free(buf);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Invalid snapshot %s",
+			cluster->snapshot_path);
+	}
+
+	const char* cluster_name = cluster->cluster_name;
+	char* name = as_snapshot_get(&r, header->cluster_name_len);
+	char* seeds = name ? as_snapshot_get(&r, header->seeds_len) : NULL;
+
+	if (! name || ! seeds || header->cluster_name_len != strlen(cluster_name) ||
+		memcmp(name, cluster_name, header->cluster_name_len) != 0 ||
+		! as_snapshot_match_seeds(cluster, seeds, header->seeds_len)) {
+		cf_free(buf);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Snapshot %s is from a different cluster",
+			cluster->snapshot_path);
+	}
+
+	for (uint32_t i = 0; i < header->n_nodes; i++) {
+		as_node* node = as_snapshot_create_node(cluster, &r);
+
+		if (! node) {
+			break;
+		}
+		as_vector_append(nodes, &node);
+	}
+
+	if (nodes->size != header->n_nodes || ! as_snapshot_validate_tables(&r, header)) {
+		for (uint32_t i = 0; i < nodes->size; i++) {
+			as_node* node = as_vector_get_ptr(nodes, i);
+			as_node_release(node);
+		}
+		as_vector_clear(nodes);
+		cf_free(buf);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Invalid snapshot %s",
+			cluster->snapshot_path);
+	}
+
+	cluster->n_partitions = header->n_partitions;
+	as_snapshot_restore_tables(cluster, &r, header, nodes);
+	cf_free(buf);
+	return AEROSPIKE_OK;
+}
@@ -29,6 +29,7 @@
 #include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 
 #define AS_EINTR EINTR
 
@@ -53,6 +54,7 @@ as_socket_is_error(int e)
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/epoll.h>
+#include <linux/errqueue.h>
 #endif // __linux__
 
 // May want to specify preference for permanent public addresses sometime in the future.
@@ -152,6 +154,17 @@ as_socket_create(as_socket* sock, int family, as_tls_context* ctx, const char* t
 	return 0;
 }
 
+void
+as_socket_enable_zero_copy(as_socket* sock)
+{
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+	// Allow MSG_ZEROCOPY writes.  This does not affect regular writes.  Older kernels reject
+	// this option and then ignore MSG_ZEROCOPY, so failure is not an error.
+	int f = 1;
+	setsockopt(sock->fd, SOL_SOCKET, SO_ZEROCOPY, &f, sizeof(f));
+#endif
+}
+
 bool
 as_socket_wrap(as_socket* sock, int family, as_socket_fd fd, as_tls_context* ctx, const char* tls_name)
 {
@@ -291,9 +304,18 @@ as_socket_validate_fd(as_socket_fd fd)
 	// Return size of data available if peek succeeded.
 	return (rv > 0) ? (int)rv : -1;
 #else
-	unsigned long bytes;
-	int rv = ioctlsocket(fd, FIONREAD, &bytes);
-	return (rv == 0) ? bytes : -1;
+	// FIONREAD reports zero bytes when the peer has closed the connection, which can not be
+	// distinguished from an idle connection.  Peek instead.  Sockets are non-blocking.
+	char buf[8];
+	int rv = recv(fd, buf, sizeof(buf), MSG_PEEK);
+
+	if (rv == SOCKET_ERROR) {
+		// Return zero if valid and no data available.
+		return (WSAGetLastError() == WSAEWOULDBLOCK) ? 0 : -1;
+	}
+
+	// Return size of data available if peek succeeded.
+	return (rv > 0) ? rv : -1;
 #endif
 }
 
@@ -400,6 +422,222 @@ as_socket_write_deadline(
 	return status;
 }
 
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#define AS_SOCKET_ZERO_COPY 1
+
+static uint32_t
+as_socket_zero_copy_drain(as_socket_fd fd)
+{
+	// Read zero-copy completion notifications.  Pending notifications make select() report
+	// the socket readable even when there is no data to read.  Return number of sends that
+	// the kernel no longer references.
+	char control[128];
+	struct msghdr msg;
+	uint32_t completed = 0;
+
+	for (int i = 0; i < 64; i++) {
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+			break;
+		}
+
+		for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+			struct sock_extended_err* serr = (struct sock_extended_err*)CMSG_DATA(cm);
+
+			if (serr->ee_errno == 0 && serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+				// Notification covers the inclusive range of send counters [ee_info, ee_data].
+				completed += serr->ee_data - serr->ee_info + 1;
+			}
+		}
+	}
+	return completed;
+}
+
+static void
+as_socket_zero_copy_abort(as_socket_fd fd)
+{
+	// The kernel may still transmit from the caller's pages after control is returned.
+	// Reset the connection on close, so queued data is discarded instead of sent.
+	struct linger lg = {1, 0};
+	setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+}
+#endif
+
+static int
+as_socket_writev(as_socket_fd fd, as_socket_iov* iov, uint32_t iov_size, size_t offset, int flags)
+{
+#if !defined(_MSC_VER)
+	struct iovec vec[AS_SOCKET_IOV_MAX];
+#else
+	WSABUF vec[AS_SOCKET_IOV_MAX];
+#endif
+
+	for (uint32_t i = 0; i < iov_size; i++) {
+#if !defined(_MSC_VER)
+		vec[i].iov_base = iov[i].data + offset;
+		vec[i].iov_len = iov[i].size - offset;
+#else
+		vec[i].buf = (CHAR*)(iov[i].data + offset);
+		vec[i].len = (ULONG)(iov[i].size - offset);
+#endif
+		offset = 0;
+	}
+
+#if defined(__linux__)
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = vec;
+	msg.msg_iovlen = iov_size;
+	return (int)sendmsg(fd, &msg, MSG_NOSIGNAL | flags);
+#elif defined(_MSC_VER)
+	DWORD sent;
+	return (WSASend(fd, vec, iov_size, &sent, 0, NULL, NULL) == 0)? (int)sent : -1;
+#else
+	return (int)writev(fd, vec, iov_size);
+#endif
+}
+
+as_status
+as_socket_writev_deadline(
+	as_error* err, as_socket* sock, as_node* node, as_socket_iov* iov, uint32_t iov_size,
+	uint32_t socket_timeout, uint64_t deadline, bool zero_copy
+	)
+{
+	if (sock->ctx) {
+		// TLS encrypts into its own buffers, so write each segment separately.
+		for (uint32_t i = 0; i < iov_size; i++) {
+			as_status status = as_socket_write_deadline(err, sock, node, iov[i].data, iov[i].size,
+														socket_timeout, deadline);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+		}
+		return AEROSPIKE_OK;
+	}
+
+	int flags = 0;
+
+#if AS_SOCKET_ZERO_COPY
+	if (zero_copy) {
+		flags = MSG_ZEROCOPY;
+	}
+#endif
+
+	as_poll poll;
+	as_poll_init(&poll, sock->fd);
+
+	uint32_t index = 0;
+	size_t offset = 0;
+	as_status status = AEROSPIKE_OK;
+	uint32_t timeout;
+	uint32_t sends = 0;
+
+	do {
+		if (deadline > 0) {
+			uint64_t now = cf_getms();
+
+			if (now >= deadline) {
+				// Timeout.  Do not set error string to avoid affecting performance.
+				// Calling functions usually retry, so the error string is not used anyway.
+				status = err->code = AEROSPIKE_ERR_TIMEOUT;
+				err->message[0] = 0;
+				break;
+			}
+
+			timeout = (uint32_t)(deadline - now);
+
+			if (socket_timeout > 0 && socket_timeout < timeout) {
+				timeout = socket_timeout;
+			}
+		}
+		else {
+			timeout = socket_timeout;
+		}
+
+		int rv = as_poll_socket(&poll, sock->fd, timeout, false);
+
+		if (rv > 0) {
+			int w_bytes = as_socket_writev(sock->fd, iov + index, iov_size - index, offset, flags);
+
+			if (w_bytes > 0) {
+				if (flags) {
+					sends++;
+				}
+
+				// Advance past written segments.
+				size_t len = w_bytes;
+
+				while (len > 0) {
+					size_t remaining = iov[index].size - offset;
+
+					if (len < remaining) {
+						offset += len;
+						break;
+					}
+					len -= remaining;
+					index++;
+					offset = 0;
+				}
+			}
+			else if (w_bytes == 0) {
+				// We shouldn't see 0 returned unless we try to write 0 bytes, which we don't.
+				status = as_error_set_message(err, AEROSPIKE_ERR_CONNECTION, "Bad file descriptor");
+				break;
+			}
+			else {
+				int e = as_last_error();
+#if defined(__linux__) && defined(MSG_ZEROCOPY)
+				if (e == ENOBUFS && flags) {
+					// Zero-copy notification memory is exhausted.  Fall back to regular copy.
+					flags = 0;
+					continue;
+				}
+#endif
+				if (as_socket_is_error(e)) {
+					status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "Socket write error", e);
+					break;
+				}
+			}
+		}
+		else if (rv == 0) {
+			// Timeout.  Do not set error string to avoid affecting performance.
+			// Calling functions usually retry, so the error string is not used anyway.
+			status = err->code = AEROSPIKE_ERR_TIMEOUT;
+			err->message[0] = 0;
+			break;
+		}
+		else if (rv == -1) {
+			int e = as_last_error();
+			if (e != AS_EINTR || as_socket_stop_on_interrupt) {
+				status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "Socket write error", e);
+				break;
+			}
+		}
+	} while (index < iov_size);
+
+#if AS_SOCKET_ZERO_COPY
+	if (sends > 0) {
+		// Remove notifications that have already arrived before waiting for the response.
+		// Notifications of previous writes are counted here when they arrive late, but the
+		// connection was already set to reset on close when those writes did not complete.
+		uint32_t completed = as_socket_zero_copy_drain(sock->fd);
+
+		if (completed < sends) {
+			// The kernel still references caller memory.  If this write or the response
+			// read fails, the connection is closed before the data is fully sent.
+			as_socket_zero_copy_abort(sock->fd);
+		}
+	}
+#endif
+
+	as_poll_destroy(&poll);
+	return status;
+}
+
 as_status
 as_socket_read_deadline(
 	as_error* err, as_socket* sock, as_node* node, uint8_t *buf, size_t buf_len,
@@ -476,6 +714,11 @@ as_socket_read_deadline(
 					status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "Socket read error", e);
 					break;
 				}
+#if AS_SOCKET_ZERO_COPY
+				// Socket may have been reported readable because zero-copy completion
+				// notifications arrived.  Remove them, so the next wait blocks.
+				as_socket_zero_copy_drain(sock->fd);
+#endif
 			}
 		}
 		else if (rv == 0) {
@@ -500,3 +743,73 @@ as_socket_read_deadline(
 	as_poll_destroy(&poll);
 	return status;
 }
+
+as_status
+as_socket_wait_readable(
+	as_error* err, as_socket* sock, as_node* node, uint32_t socket_timeout, uint64_t deadline
+	)
+{
+	as_poll poll;
+	as_poll_init(&poll, sock->fd);
+
+	as_status status = AEROSPIKE_OK;
+	uint32_t timeout;
+
+	while (true) {
+		if (deadline > 0) {
+			uint64_t now = cf_getms();
+
+			if (now >= deadline) {
+				// Timeout.  Do not set error string to avoid affecting performance.
+				status = err->code = AEROSPIKE_ERR_TIMEOUT;
+				err->message[0] = 0;
+				break;
+			}
+
+			timeout = (uint32_t)(deadline - now);
+
+			if (socket_timeout > 0 && socket_timeout < timeout) {
+				timeout = socket_timeout;
+			}
+		}
+		else {
+			timeout = socket_timeout;
+		}
+
+		int rv = as_poll_socket(&poll, sock->fd, timeout, true);
+
+		if (rv > 0) {
+			int available = as_socket_validate_fd(sock->fd);
+
+			if (available > 0) {
+				break;
+			}
+
+			if (available < 0) {
+				status = as_error_set_message(err, AEROSPIKE_ERR_CONNECTION, "Bad file descriptor");
+				break;
+			}
+#if AS_SOCKET_ZERO_COPY
+			// Socket may have been reported readable because zero-copy completion
+			// notifications arrived.  Remove them, so the next wait blocks.
+			as_socket_zero_copy_drain(sock->fd);
+#endif
+		}
+		else if (rv == 0) {
+			// Timeout.  Do not set error string to avoid affecting performance.
+			status = err->code = AEROSPIKE_ERR_TIMEOUT;
+			err->message[0] = 0;
+			break;
+		}
+		else if (rv == -1) {
+			int e = as_last_error();
+			if (e != AS_EINTR || as_socket_stop_on_interrupt) {
+				status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "Socket read error", e);
+				break;
+			}
+		}
+	}
+
+	as_poll_destroy(&poll);
+	return status;
+}
@@ -0,0 +1,378 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_sync_pipe.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_proto.h>
+#include <citrusleaf/cf_clock.h>
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static inline uint64_t
+as_sync_pipe_deadline(uint32_t socket_timeout, uint64_t deadline_ms)
+{
+	uint64_t socket_deadline = as_socket_deadline(socket_timeout);
+
+	if (socket_deadline == 0 || (deadline_ms > 0 && deadline_ms < socket_deadline)) {
+		return deadline_ms;
+	}
+	return socket_deadline;
+}
+
+// Must hold pipe->lock.
+static void
+as_sync_pipe_invalidate(as_sync_pipe* pipe)
+{
+	if (pipe->valid) {
+		pipe->valid = false;
+		pipe->generation++;
+
+		// Abandoned responses will never be discarded.  Release their positions.  The caller
+		// still holds its own position, so inflight does not drop to zero here.
+		for (uint64_t seq = pipe->read_seq; seq < pipe->write_seq; seq++) {
+			uint8_t* abandoned = &pipe->abandoned[seq % AS_SYNC_PIPE_WINDOW];
+
+			if (*abandoned) {
+				*abandoned = 0;
+				pipe->inflight--;
+			}
+		}
+		pthread_cond_broadcast(&pipe->cond);
+	}
+}
+
+// Must hold pipe->lock.
+static void
+as_sync_pipe_leave(as_node* node, as_sync_pipe* pipe)
+{
+	if (--pipe->inflight == 0) {
+		if (pipe->valid) {
+			pipe->socket.last_used = cf_getns();
+		}
+		else if (pipe->socket.fd >= 0) {
+			// Last command has left invalid connection.  Close socket now that no other thread
+			// can be reading or writing it.
+			as_node_close_socket(node, &pipe->socket);
+			pipe->socket.fd = -1;
+		}
+	}
+}
+
+// Must hold pipe->lock.
+static bool
+as_sync_pipe_abandon(as_sync_pipe* pipe, as_sync_pipe_ticket* ticket)
+{
+	if (pipe->generation != ticket->generation ||
+		ticket->seq - pipe->read_seq >= AS_SYNC_PIPE_WINDOW) {
+		return false;
+	}
+
+	// Give up turn.  The position is released when the response is discarded.
+	pipe->abandoned[ticket->seq % AS_SYNC_PIPE_WINDOW] = 1;
+	ticket->abandoned = true;
+	pthread_cond_broadcast(&pipe->cond);
+	return true;
+}
+
+// Read and discard one response.
+static as_status
+as_sync_pipe_skip(
+	as_error* err, as_node* node, as_socket* sock, uint32_t socket_timeout, uint64_t deadline_ms
+	)
+{
+	as_proto proto;
+	as_status status = as_socket_read_deadline(err, sock, node, (uint8_t*)&proto,
+											   sizeof(as_proto), socket_timeout, deadline_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	status = as_proto_parse(err, &proto);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	uint8_t buf[4096];
+	size_t size = proto.sz;
+
+	while (size > 0) {
+		size_t n = (size < sizeof(buf))? size : sizeof(buf);
+
+		status = as_socket_read_deadline(err, sock, node, buf, n, socket_timeout, deadline_ms);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+		size -= n;
+	}
+	return AEROSPIKE_OK;
+}
+
+// Must hold pipe->lock.  Discard response of the command that gave up its turn at read_seq.
+// The lock is released while reading.
+static void
+as_sync_pipe_drain(
+	as_node* node, as_sync_pipe* pipe, uint32_t socket_timeout, uint64_t deadline_ms
+	)
+{
+	uint32_t generation = pipe->generation;
+
+	pipe->draining = true;
+	pthread_mutex_unlock(&pipe->lock);
+
+	as_error err;
+	as_error_init(&err);
+
+	as_status status = as_socket_wait_readable(&err, &pipe->socket, node, socket_timeout, deadline_ms);
+
+	if (status == AEROSPIKE_OK) {
+		status = as_sync_pipe_skip(&err, node, &pipe->socket, socket_timeout, deadline_ms);
+
+		if (status == AEROSPIKE_ERR_TIMEOUT) {
+			// Response was partially read.
+			status = AEROSPIKE_ERR_CONNECTION;
+		}
+	}
+
+	pthread_mutex_lock(&pipe->lock);
+	pipe->draining = false;
+
+	if (pipe->generation == generation) {
+		if (status == AEROSPIKE_OK) {
+			// Response discarded.  Release abandoned position and pass turn to next command.
+			pipe->abandoned[pipe->read_seq % AS_SYNC_PIPE_WINDOW] = 0;
+			pipe->read_seq++;
+			as_sync_pipe_leave(node, pipe);
+		}
+		else if (status != AEROSPIKE_ERR_TIMEOUT) {
+			as_sync_pipe_invalidate(pipe);
+		}
+		// On timeout, no data was read.  Another waiting command may try again.
+	}
+	pthread_cond_broadcast(&pipe->cond);
+}
+
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+void
+as_sync_pipe_init(as_sync_pipe* pipe)
+{
+	pthread_mutex_init(&pipe->write_lock, NULL);
+	pthread_mutex_init(&pipe->lock, NULL);
+	pthread_cond_init(&pipe->cond, NULL);
+	memset(&pipe->socket, 0, sizeof(as_socket));
+	pipe->socket.fd = -1;
+	pipe->write_seq = 0;
+	pipe->read_seq = 0;
+	pipe->generation = 0;
+	pipe->inflight = 0;
+	pipe->valid = false;
+	pipe->connecting = false;
+	pipe->draining = false;
+	memset(pipe->abandoned, 0, sizeof(pipe->abandoned));
+}
+
+void
+as_sync_pipe_destroy(as_node* node, as_sync_pipe* pipe)
+{
+	if (pipe->socket.fd >= 0) {
+		as_node_close_socket(node, &pipe->socket);
+	}
+	pthread_cond_destroy(&pipe->cond);
+	pthread_mutex_destroy(&pipe->lock);
+	pthread_mutex_destroy(&pipe->write_lock);
+}
+
+bool
+as_sync_pipe_write(
+	as_error* err, as_node* node, uint8_t* buf, size_t size, uint32_t socket_timeout,
+	uint64_t deadline_ms, as_sync_pipe_ticket* ticket, as_status* status
+	)
+{
+	as_cluster* cluster = node->cluster;
+	uint32_t max = cluster->sync_pipe_conns_per_node;
+	as_sync_pipe* pipe = &node->sync_pipes[(max == 1) ? 0 : as_node_get_shard(max)];
+
+	pthread_mutex_lock(&pipe->lock);
+
+	if (! pipe->valid || (pipe->inflight == 0 &&
+		as_socket_validate(&pipe->socket, cluster->max_socket_idle_ns_tran) != 0)) {
+		if (pipe->inflight > 0 || pipe->connecting) {
+			// Invalid connection is still draining or another thread is connecting.
+			// Use pooled connection instead.
+			pthread_mutex_unlock(&pipe->lock);
+			return false;
+		}
+
+		// Replace idle, stale or invalid connection.
+		if (pipe->socket.fd >= 0) {
+			as_node_close_socket(node, &pipe->socket);
+			pipe->socket.fd = -1;
+		}
+		pipe->valid = false;
+		pipe->connecting = true;
+		pthread_mutex_unlock(&pipe->lock);
+
+		// Connect without holding locks.  Other commands use pooled connections meanwhile.
+		as_socket sock;
+		*status = as_node_create_connection(err, node, socket_timeout, deadline_ms, NULL, &sock);
+
+		pthread_mutex_lock(&pipe->lock);
+		pipe->connecting = false;
+
+		if (*status != AEROSPIKE_OK) {
+			pthread_mutex_unlock(&pipe->lock);
+			ticket->pipe = NULL;
+			return true;
+		}
+
+		pipe->socket = sock;
+		pipe->socket.last_used = cf_getns();
+		pipe->read_seq = pipe->write_seq;
+		pipe->valid = true;
+		memset(pipe->abandoned, 0, sizeof(pipe->abandoned));
+	}
+	pthread_mutex_unlock(&pipe->lock);
+
+	// Assign sequence number and write while holding write lock, so commands appear on the
+	// wire in sequence order.
+	pthread_mutex_lock(&pipe->write_lock);
+	pthread_mutex_lock(&pipe->lock);
+
+	if (! pipe->valid) {
+		// Connection was invalidated by another command meanwhile.
+		pthread_mutex_unlock(&pipe->lock);
+		pthread_mutex_unlock(&pipe->write_lock);
+		return false;
+	}
+
+	ticket->pipe = pipe;
+	ticket->seq = pipe->write_seq++;
+	ticket->generation = pipe->generation;
+	ticket->abandoned = false;
+	pipe->inflight++;
+	pthread_mutex_unlock(&pipe->lock);
+
+	*status = as_socket_write_deadline(err, &pipe->socket, node, buf, size, socket_timeout,
+									   deadline_ms);
+	pthread_mutex_unlock(&pipe->write_lock);
+
+	if (*status != AEROSPIKE_OK) {
+		as_sync_pipe_release(node, ticket, false);
+	}
+	return true;
+}
+
+as_status
+as_sync_pipe_wait(
+	as_error* err, as_node* node, as_sync_pipe_ticket* ticket, uint32_t socket_timeout,
+	uint64_t deadline_ms
+	)
+{
+	as_sync_pipe* pipe = ticket->pipe;
+	uint64_t wait_deadline = as_sync_pipe_deadline(socket_timeout, deadline_ms);
+	as_status status = AEROSPIKE_OK;
+
+	pthread_mutex_lock(&pipe->lock);
+
+	while (pipe->read_seq != ticket->seq) {
+		if (pipe->generation != ticket->generation) {
+			status = as_error_set_message(err, AEROSPIKE_ERR_CONNECTION,
+										  "Pipeline connection failed");
+			break;
+		}
+
+		if (! pipe->draining && pipe->abandoned[pipe->read_seq % AS_SYNC_PIPE_WINDOW]) {
+			// Preceding command gave up its turn.  Discard its response.
+			as_sync_pipe_drain(node, pipe, socket_timeout, deadline_ms);
+			continue;
+		}
+
+		if (wait_deadline == 0) {
+			pthread_cond_wait(&pipe->cond, &pipe->lock);
+			continue;
+		}
+
+		int64_t remaining = (int64_t)(wait_deadline - cf_getms());
+
+		if (remaining <= 0) {
+			status = err->code = AEROSPIKE_ERR_TIMEOUT;
+			break;
+		}
+
+		struct timespec delta;
+		struct timespec abstime;
+		cf_clock_set_timespec_ms(remaining, &delta);
+		cf_clock_current_add(&delta, &abstime);
+		pthread_cond_timedwait(&pipe->cond, &pipe->lock, &abstime);
+	}
+
+	if (status == AEROSPIKE_OK && pipe->generation != ticket->generation) {
+		status = as_error_set_message(err, AEROSPIKE_ERR_CONNECTION, "Pipeline connection failed");
+	}
+
+	if (status == AEROSPIKE_OK) {
+		// It is this command's turn.  Wait for the response to arrive before reading, so a
+		// timeout does not leave a partially read response on the connection.
+		pthread_mutex_unlock(&pipe->lock);
+		status = as_socket_wait_readable(err, &pipe->socket, node, socket_timeout, deadline_ms);
+		pthread_mutex_lock(&pipe->lock);
+	}
+
+	if (status == AEROSPIKE_ERR_TIMEOUT) {
+		// Give up turn without invalidating the connection.  If the position is too far
+		// behind to be tracked, as_sync_pipe_release() invalidates the connection instead.
+		as_sync_pipe_abandon(pipe, ticket);
+	}
+	pthread_mutex_unlock(&pipe->lock);
+	return status;
+}
+
+void
+as_sync_pipe_release(as_node* node, as_sync_pipe_ticket* ticket, bool ok)
+{
+	if (ticket->abandoned) {
+		// Position is released when the response is discarded.
+		return;
+	}
+
+	as_sync_pipe* pipe = ticket->pipe;
+
+	pthread_mutex_lock(&pipe->lock);
+
+	if (pipe->generation == ticket->generation) {
+		if (ok && pipe->read_seq == ticket->seq) {
+			// Response fully read.  Pass turn to next command.
+			pipe->read_seq++;
+			pthread_cond_broadcast(&pipe->cond);
+		}
+		else {
+			// Response was not read or was partially read.  The byte stream is no longer in
+			// sync with command sequence numbers.
+			as_sync_pipe_invalidate(pipe);
+		}
+	}
+	as_sync_pipe_leave(node, pipe);
+	pthread_mutex_unlock(&pipe->lock);
+}
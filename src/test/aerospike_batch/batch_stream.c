@@ -0,0 +1,219 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike* as;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_batch_stream"
+#define N_KEYS 200
+#define ABORT_AFTER 10
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	uint32_t calls[N_KEYS];
+	uint32_t count;
+	uint32_t errors;
+	uint32_t abort_after;
+} stream_data;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+stream_missing(uint32_t i)
+{
+	// Some records are not written to test not found results.
+	return i % 20 == 0;
+}
+
+static void
+stream_records_init(as_batch_read_records* records)
+{
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_batch_read_record* record = as_batch_read_reserve(records);
+		as_key_init_int64(&record->key, NAMESPACE, SET, (int64_t)i);
+		record->read_all_bins = true;
+	}
+}
+
+static bool
+stream_callback(as_batch_read_record* record, uint32_t index, void* udata)
+{
+	stream_data* data = udata;
+
+	if (index >= N_KEYS) {
+		as_incr_uint32(&data->errors);
+		return false;
+	}
+
+	as_incr_uint32(&data->calls[index]);
+
+	if (stream_missing(index)) {
+		if (record->result != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+			as_incr_uint32(&data->errors);
+		}
+	}
+	else if (record->result != AEROSPIKE_OK ||
+			 as_record_get_int64(&record->record, "val", -1) != (int64_t)index) {
+		as_incr_uint32(&data->errors);
+	}
+
+	uint32_t count = as_aaf_uint32(&data->count, 1);
+	return data->abort_after == 0 || count < data->abort_after;
+}
+
+static void
+stream_read(atf_test_result* __result__, bool concurrent)
+{
+	as_policy_batch policy;
+	as_policy_batch_init(&policy);
+	policy.concurrent = concurrent;
+
+	as_batch_read_records records;
+	as_batch_read_inita(&records, N_KEYS);
+	stream_records_init(&records);
+
+	stream_data data;
+	memset(&data, 0, sizeof(data));
+
+	as_error err;
+	as_status status = aerospike_batch_read_stream(as, &err, &policy, &records, stream_callback,
+												   &data);
+	as_batch_read_destroy(&records);
+
+	if (status != AEROSPIKE_OK) {
+		info("error(%d): %s", err.code, err.message);
+	}
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_int_eq(data.errors, 0);
+	assert_int_eq(data.count, N_KEYS);
+
+	// Every record is delivered exactly once.
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		assert_int_eq(data.calls[i], 1);
+	}
+}
+
+static void
+stream_abort(atf_test_result* __result__, bool concurrent)
+{
+	as_policy_batch policy;
+	as_policy_batch_init(&policy);
+	policy.concurrent = concurrent;
+
+	as_batch_read_records records;
+	as_batch_read_inita(&records, N_KEYS);
+	stream_records_init(&records);
+
+	stream_data data;
+	memset(&data, 0, sizeof(data));
+	data.abort_after = ABORT_AFTER;
+
+	as_error err;
+	as_status status = aerospike_batch_read_stream(as, &err, &policy, &records, stream_callback,
+												   &data);
+	as_batch_read_destroy(&records);
+
+	assert_int_eq(status, AEROSPIKE_ERR_CLIENT_ABORT);
+	assert_int_eq(data.errors, 0);
+
+	// Other node commands may deliver records before they see the abort, but not all of them.
+	assert_true(data.count >= ABORT_AFTER);
+	assert_true(data.count < N_KEYS);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(batch_stream_put, "write batch stream records")
+{
+	as_error err;
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, (int64_t)i);
+
+		if (stream_missing(i)) {
+			aerospike_key_remove(as, &err, NULL, &key);
+			continue;
+		}
+
+		as_record rec;
+		as_record_inita(&rec, 1);
+		as_record_set_int64(&rec, "val", (int64_t)i);
+
+		as_status status = aerospike_key_put(as, &err, NULL, &key, &rec);
+		as_record_destroy(&rec);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+}
+
+TEST(batch_stream_seq, "batch read stream sequential")
+{
+	stream_read(__result__, false);
+}
+
+TEST(batch_stream_concurrent, "batch read stream concurrent")
+{
+	stream_read(__result__, true);
+}
+
+TEST(batch_stream_abort_seq, "batch read stream abort sequential")
+{
+	stream_abort(__result__, false);
+}
+
+TEST(batch_stream_abort_concurrent, "batch read stream abort concurrent")
+{
+	stream_abort(__result__, true);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(batch_stream, "aerospike_batch_read_stream tests")
+{
+	suite_add(batch_stream_put);
+	suite_add(batch_stream_seq);
+	suite_add(batch_stream_concurrent);
+	suite_add(batch_stream_abort_seq);
+	suite_add(batch_stream_abort_concurrent);
+}
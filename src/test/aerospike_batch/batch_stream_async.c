@@ -0,0 +1,209 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_monitor.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike* as;
+static as_monitor monitor;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_batch_stream_async"
+#define N_KEYS 200
+#define ABORT_AFTER 10
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	uint32_t calls[N_KEYS];
+	uint32_t count;
+	uint32_t errors;
+	uint32_t abort_after;
+	as_status status;
+} stream_data;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+before(atf_suite* suite)
+{
+	as_monitor_init(&monitor);
+	return true;
+}
+
+static bool
+after(atf_suite* suite)
+{
+	as_monitor_destroy(&monitor);
+	return true;
+}
+
+static bool
+stream_missing(uint32_t i)
+{
+	// Some records are not written to test not found results.
+	return i % 20 == 0;
+}
+
+static bool
+stream_listener(as_error* err, as_batch_read_record* record, uint32_t index, void* udata,
+	as_event_loop* event_loop)
+{
+	stream_data* data = udata;
+
+	if (! record) {
+		// Final call.  Listener calls are serialized on the batch's event loop.
+		data->status = err ? err->code : AEROSPIKE_OK;
+		as_monitor_notify(&monitor);
+		return false;
+	}
+
+	if (index >= N_KEYS) {
+		data->errors++;
+		return false;
+	}
+
+	data->calls[index]++;
+
+	if (stream_missing(index)) {
+		if (record->result != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+			data->errors++;
+		}
+	}
+	else if (record->result != AEROSPIKE_OK ||
+			 as_record_get_int64(&record->record, "val", -1) != (int64_t)index) {
+		data->errors++;
+	}
+
+	data->count++;
+	return data->abort_after == 0 || data->count < data->abort_after;
+}
+
+static as_status
+stream_read(stream_data* data)
+{
+	as_batch_read_records* records = as_batch_read_create(N_KEYS);
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_batch_read_record* record = as_batch_read_reserve(records);
+		as_key_init_int64(&record->key, NAMESPACE, SET, (int64_t)i);
+		record->read_all_bins = true;
+	}
+
+	as_error err;
+
+	as_monitor_begin(&monitor);
+
+	as_status status = aerospike_batch_read_stream_async(as, &err, NULL, records,
+		stream_listener, data, NULL);
+
+	if (status != AEROSPIKE_OK) {
+		as_batch_read_destroy(records);
+		return status;
+	}
+	as_monitor_wait(&monitor);
+	as_batch_read_destroy(records);
+	return data->status;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(batch_stream_async_put, "write async batch stream records")
+{
+	as_error err;
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, (int64_t)i);
+
+		if (stream_missing(i)) {
+			aerospike_key_remove(as, &err, NULL, &key);
+			continue;
+		}
+
+		as_record rec;
+		as_record_inita(&rec, 1);
+		as_record_set_int64(&rec, "val", (int64_t)i);
+
+		as_status status = aerospike_key_put(as, &err, NULL, &key, &rec);
+		as_record_destroy(&rec);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+}
+
+TEST(batch_stream_async_read, "async batch read stream")
+{
+	stream_data data;
+	memset(&data, 0, sizeof(data));
+
+	as_status status = stream_read(&data);
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_int_eq(data.errors, 0);
+	assert_int_eq(data.count, N_KEYS);
+
+	// Every record is delivered exactly once.
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		assert_int_eq(data.calls[i], 1);
+	}
+}
+
+TEST(batch_stream_async_abort, "async batch read stream abort")
+{
+	stream_data data;
+	memset(&data, 0, sizeof(data));
+	data.abort_after = ABORT_AFTER;
+
+	as_status status = stream_read(&data);
+	assert_int_eq(status, AEROSPIKE_ERR_CLIENT_ABORT);
+	assert_int_eq(data.errors, 0);
+	assert_int_eq(data.count, ABORT_AFTER);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(batch_stream_async, "aerospike_batch_read_stream_async tests")
+{
+	suite_before(before);
+	suite_after(after);
+
+	suite_add(batch_stream_async_put);
+	suite_add(batch_stream_async_read);
+	suite_add(batch_stream_async_abort);
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_map_operations.h>
+#include <aerospike/as_operations.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+#include <aerospike/as_string.h>
+#include <aerospike/as_stringmap.h>
+#include <stdlib.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike * as;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_batch_write"
+#define N_KEYS 50
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+batch_write_init_keys(as_batch_write_records* records, as_batch_write_type type)
+{
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_batch_write_record* r = as_batch_write_reserve(records);
+		as_key_init_int64(&r->key, NAMESPACE, SET, (int64_t)i);
+		r->type = type;
+	}
+}
+
+static void
+batch_operate_map_read(atf_test_result* __result__, bool concurrent)
+{
+	as_error err;
+
+	as_policy_batch policy;
+	as_policy_batch_init(&policy);
+	policy.concurrent = concurrent;
+
+	// The same operations are applied to every record.  Map reads require respond all ops,
+	// which must be set for every record, not just the first one.
+	as_string mkey;
+	as_string_init(&mkey, "k", false);
+
+	as_operations ops;
+	as_operations_inita(&ops, 2);
+	as_operations_map_get_by_key(&ops, "map", NULL, (as_val*)&mkey, AS_MAP_RETURN_VALUE);
+	as_operations_add_read(&ops, "val");
+
+	as_batch_write_records records;
+	as_batch_write_inita(&records, N_KEYS);
+	batch_write_init_keys(&records, AS_BATCH_WRITE_OPERATE);
+
+	as_status status = aerospike_batch_operate(as, &err, &policy, NULL, &records, &ops);
+
+	if (status != AEROSPIKE_OK) {
+		info("error(%d): %s", err.code, err.message);
+	}
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	// Operations must not be modified by the batch.
+	assert_int_eq(ops.binops.entries[0].op, AS_OPERATOR_MAP_READ);
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_batch_write_record* r = as_vector_get(&records.list, i);
+
+		assert_int_eq(r->result, AEROSPIKE_OK);
+		assert_int_eq(as_record_get_int64(&r->record, "map", -1), (int64_t)i);
+		assert_int_eq(as_record_get_int64(&r->record, "val", -1), (int64_t)i);
+	}
+
+	as_batch_write_destroy(&records);
+	as_operations_destroy(&ops);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(batch_write_put, "Batch write put")
+{
+	as_error err;
+
+	as_record* recs = malloc(sizeof(as_record) * N_KEYS);
+	as_batch_write_records records;
+	as_batch_write_inita(&records, N_KEYS);
+	batch_write_init_keys(&records, AS_BATCH_WRITE_PUT);
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_hashmap* map = as_hashmap_new(1);
+		as_stringmap_set_int64((as_map*)map, "k", (int64_t)i);
+
+		as_record* rec = &recs[i];
+		as_record_init(rec, 2);
+		as_record_set_int64(rec, "val", (int64_t)i);
+		as_record_set_map(rec, "map", (as_map*)map);
+
+		as_batch_write_record* r = as_vector_get(&records.list, i);
+		r->rec = rec;
+	}
+
+	as_status status = aerospike_batch_write(as, &err, NULL, &records);
+
+	if (status != AEROSPIKE_OK) {
+		info("error(%d): %s", err.code, err.message);
+	}
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_batch_write_record* r = as_vector_get(&records.list, i);
+		assert_int_eq(r->result, AEROSPIKE_OK);
+		as_record_destroy(&recs[i]);
+	}
+
+	as_batch_write_destroy(&records);
+	free(recs);
+}
+
+TEST(batch_operate_map_read_seq, "Batch operate map read sequential")
+{
+	batch_operate_map_read(__result__, false);
+}
+
+TEST(batch_operate_map_read_concurrent, "Batch operate map read concurrent")
+{
+	batch_operate_map_read(__result__, true);
+}
+
+TEST(batch_write_remove, "Batch remove")
+{
+	as_error err;
+
+	as_batch_write_records records;
+	as_batch_write_inita(&records, N_KEYS);
+	batch_write_init_keys(&records, AS_BATCH_WRITE_REMOVE);
+
+	as_status status = aerospike_batch_remove(as, &err, NULL, NULL, &records);
+
+	if (status != AEROSPIKE_OK) {
+		info("error(%d): %s", err.code, err.message);
+	}
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_batch_write_record* r = as_vector_get(&records.list, i);
+		assert_int_eq(r->result, AEROSPIKE_OK);
+
+		as_record* rec = NULL;
+		status = aerospike_key_get(as, &err, NULL, &r->key, &rec);
+		assert_int_eq(status, AEROSPIKE_ERR_RECORD_NOT_FOUND);
+	}
+
+	as_batch_write_destroy(&records);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(batch_write, "aerospike_batch_write tests")
+{
+	suite_add(batch_write_put);
+	suite_add(batch_operate_map_read_seq);
+	suite_add(batch_operate_map_read_concurrent);
+	suite_add(batch_write_remove);
+}
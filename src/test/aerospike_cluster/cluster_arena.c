@@ -0,0 +1,170 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_arena.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define BUF_SIZE 1000
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint8_t* buf;
+	uint8_t* reused;
+	int step;
+} arena_owner;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+arena_owner_signal(arena_owner* owner, int step)
+{
+	pthread_mutex_lock(&owner->lock);
+	owner->step = step;
+	pthread_cond_broadcast(&owner->cond);
+	pthread_mutex_unlock(&owner->lock);
+}
+
+static void
+arena_owner_wait(arena_owner* owner, int step)
+{
+	pthread_mutex_lock(&owner->lock);
+
+	while (owner->step < step) {
+		pthread_cond_wait(&owner->cond, &owner->lock);
+	}
+	pthread_mutex_unlock(&owner->lock);
+}
+
+static void*
+arena_owner_run(void* udata)
+{
+	arena_owner* owner = udata;
+
+	// Hand buffer to the test thread and wait for it to be released there.
+	owner->buf = as_arena_acquire(BUF_SIZE);
+	memset(owner->buf, 1, BUF_SIZE);
+	arena_owner_signal(owner, 1);
+	arena_owner_wait(owner, 2);
+
+	// Released buffer must be back in this thread's arena.
+	owner->reused = as_arena_acquire(BUF_SIZE);
+	as_arena_release(owner->reused);
+	return NULL;
+}
+
+static void*
+arena_exit_run(void* udata)
+{
+	// Thread exits while its buffer is still in use.
+	uint8_t** buf = udata;
+	*buf = as_arena_acquire(BUF_SIZE);
+	return NULL;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_arena_reuse, "released buffer is reused by the same thread")
+{
+	uint8_t* buf = as_arena_acquire(BUF_SIZE);
+	assert_not_null(buf);
+	memset(buf, 1, BUF_SIZE);
+	as_arena_release(buf);
+
+	uint8_t* buf2 = as_arena_acquire(BUF_SIZE);
+	assert_true(buf2 == buf);
+
+	// Second buffer is a different block while the first is in use.
+	uint8_t* buf3 = as_arena_acquire(BUF_SIZE);
+	assert_true(buf3 != buf2);
+
+	as_arena_release(buf3);
+	as_arena_release(buf2);
+
+	// Oversized buffers are not cached.
+	uint8_t* big = as_arena_acquire(AS_ARENA_MAX_BLOCK + 1);
+	assert_not_null(big);
+	big[AS_ARENA_MAX_BLOCK] = 1;
+	as_arena_release(big);
+}
+
+TEST(cluster_arena_other_thread, "buffer released on another thread returns to its owner")
+{
+	arena_owner owner;
+	memset(&owner, 0, sizeof(owner));
+	pthread_mutex_init(&owner.lock, NULL);
+	pthread_cond_init(&owner.cond, NULL);
+
+	pthread_t thread;
+	assert_int_eq(pthread_create(&thread, NULL, arena_owner_run, &owner), 0);
+
+	arena_owner_wait(&owner, 1);
+	assert_int_eq(owner.buf[BUF_SIZE - 1], 1);
+	as_arena_release(owner.buf);
+
+	// Buffer is not cached in this thread's arena.
+	uint8_t* buf = as_arena_acquire(BUF_SIZE);
+	assert_true(buf != owner.buf);
+	as_arena_release(buf);
+
+	arena_owner_signal(&owner, 2);
+	pthread_join(thread, NULL);
+
+	assert_true(owner.reused == owner.buf);
+
+	pthread_cond_destroy(&owner.cond);
+	pthread_mutex_destroy(&owner.lock);
+}
+
+TEST(cluster_arena_owner_exit, "buffer in use when its owner exits stays valid")
+{
+	uint8_t* buf = NULL;
+
+	pthread_t thread;
+	assert_int_eq(pthread_create(&thread, NULL, arena_exit_run, &buf), 0);
+	pthread_join(thread, NULL);
+
+	// Owner arena is destroyed.  Buffer is freed on release.
+	assert_not_null(buf);
+	memset(buf, 1, BUF_SIZE);
+	as_arena_release(buf);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_arena, "command buffer arena tests")
+{
+	suite_add(cluster_arena_reuse);
+	suite_add(cluster_arena_other_thread);
+	suite_add(cluster_arena_owner_exit);
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_circuit.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_circuit"
+#define ERROR_RATE 50
+#define MIN_REQUESTS 10
+#define OPEN_MS 1000
+#define BUDGET_MIN 5
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+circuit_config(as_config* config)
+{
+	config->circuit_error_rate = ERROR_RATE;
+
+	// Circuits are only evaluated once per tend interval, so the test controls them.
+	config->tender_interval = 60000;
+}
+
+static void
+retry_budget_config(as_config* config)
+{
+	config->retry_budget = 10;
+	config->retry_budget_min = BUDGET_MIN;
+	config->tender_interval = 60000;
+}
+
+static void
+circuit_run(as_circuit* circuit, uint32_t requests, uint32_t errors)
+{
+	for (uint32_t i = 0; i < requests; i++) {
+		as_circuit_record(circuit, i < errors ? AEROSPIKE_ERR_TIMEOUT : AEROSPIKE_OK);
+	}
+}
+
+static void
+circuit_tend(as_circuit* circuit, uint64_t now)
+{
+	as_circuit_tend(circuit, ERROR_RATE, MIN_REQUESTS, OPEN_MS, now);
+}
+
+static void
+circuit_set_nodes(aerospike* client, uint8_t state)
+{
+	as_nodes* nodes = as_nodes_reserve(client->cluster);
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_circuit* circuit = &nodes->array[i]->circuit;
+		circuit->open_until = UINT64_MAX;
+		as_store_uint8(&circuit->state, state);
+	}
+	as_nodes_release(nodes);
+}
+
+static as_status
+circuit_put(aerospike* client)
+{
+	as_key key;
+	as_key_init_int64(&key, NAMESPACE, SET, 1);
+
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_int64(&rec, "a", 1);
+
+	as_error err;
+	as_status status = aerospike_key_put(client, &err, NULL, &key, &rec);
+	as_record_destroy(&rec);
+	return status;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_circuit_states, "circuit breaker state transitions")
+{
+	as_circuit circuit;
+	as_circuit_init(&circuit);
+	uint64_t now = 1000;
+
+	// Error rate is exceeded, but too few requests were recorded.
+	circuit_run(&circuit, MIN_REQUESTS - 1, MIN_REQUESTS - 1);
+	circuit_tend(&circuit, now);
+	assert_int_eq(circuit.state, AS_CIRCUIT_CLOSED);
+
+	// Error rate below limit.
+	circuit_run(&circuit, MIN_REQUESTS * 2, MIN_REQUESTS - 1);
+	circuit_tend(&circuit, now);
+	assert_int_eq(circuit.state, AS_CIRCUIT_CLOSED);
+
+	// Error rate reaches limit.
+	circuit_run(&circuit, MIN_REQUESTS * 2, MIN_REQUESTS);
+	circuit_tend(&circuit, now);
+	assert_int_eq(circuit.state, AS_CIRCUIT_OPEN);
+	assert_int_eq(circuit.opened, 1);
+	assert_false(as_circuit_allow(&circuit));
+	assert_int_eq(circuit.rejected, 1);
+
+	// Circuit stays open until the open period expires.
+	circuit_tend(&circuit, now + OPEN_MS - 1);
+	assert_int_eq(circuit.state, AS_CIRCUIT_OPEN);
+
+	circuit_tend(&circuit, now + OPEN_MS);
+	assert_int_eq(circuit.state, AS_CIRCUIT_HALF_OPEN);
+
+	// Half open circuit allows a limited number of probes.
+	for (uint32_t i = 0; i < AS_CIRCUIT_PROBES; i++) {
+		assert_true(as_circuit_allow(&circuit));
+	}
+	assert_false(as_circuit_allow(&circuit));
+
+	// Failed probes open the circuit again.
+	circuit_run(&circuit, AS_CIRCUIT_PROBES, AS_CIRCUIT_PROBES);
+	now += OPEN_MS;
+	circuit_tend(&circuit, now);
+	assert_int_eq(circuit.state, AS_CIRCUIT_OPEN);
+	assert_int_eq(circuit.opened, 2);
+
+	// Half open circuit without probe results keeps waiting.
+	now += OPEN_MS;
+	circuit_tend(&circuit, now);
+	assert_int_eq(circuit.state, AS_CIRCUIT_HALF_OPEN);
+	circuit_tend(&circuit, now);
+	assert_int_eq(circuit.state, AS_CIRCUIT_HALF_OPEN);
+
+	// Successful probes close the circuit.
+	circuit_run(&circuit, AS_CIRCUIT_PROBES, 0);
+	circuit_tend(&circuit, now);
+	assert_int_eq(circuit.state, AS_CIRCUIT_CLOSED);
+	assert_true(as_circuit_allow(&circuit));
+}
+
+TEST(cluster_circuit_open, "open circuit fails commands fast")
+{
+	aerospike* client = test_client_create(circuit_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	assert_int_eq(circuit_put(client), AEROSPIKE_OK);
+
+	// Writes can not be redirected to another replica.
+	circuit_set_nodes(client, AS_CIRCUIT_OPEN);
+	as_status status = circuit_put(client);
+	circuit_set_nodes(client, AS_CIRCUIT_CLOSED);
+	assert_int_eq(status, AEROSPIKE_ERR_CIRCUIT_OPEN);
+
+	assert_int_eq(circuit_put(client), AEROSPIKE_OK);
+	test_client_destroy(client);
+}
+
+TEST(cluster_retry_budget, "retries are limited by the retry budget")
+{
+	aerospike* client = test_client_create(retry_budget_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	// No commands were started in the first interval, so only the minimum is allowed.
+	as_cluster* cluster = client->cluster;
+	assert_int_eq(as_load_uint32(&cluster->retry_limit), BUDGET_MIN);
+
+	uint32_t rejected = as_load_uint32(&cluster->retries_rejected);
+
+	for (uint32_t i = 0; i < BUDGET_MIN; i++) {
+		assert_true(as_cluster_retry_budget_allow(cluster));
+	}
+	assert_false(as_cluster_retry_budget_allow(cluster));
+	assert_int_eq(as_load_uint32(&cluster->retries_rejected), rejected + 1);
+
+	test_client_destroy(client);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_circuit, "circuit breaker and retry budget tests")
+{
+	suite_add(cluster_circuit_states);
+	suite_add(cluster_circuit_open);
+	suite_add(cluster_retry_budget);
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/aerospike_scan.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_epoch.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_scan.h>
+#include <aerospike/as_sleep.h>
+#include <aerospike/as_status.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike* as;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_epoch"
+#define N_KEYS 20
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	uint32_t blocked;
+	uint64_t epoch;
+	uint64_t advanced;
+	uint64_t min_active;
+} epoch_data;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+epoch_config(as_config* config)
+{
+	// Every tend advances the epoch and reclaims retired nodes.
+	config->tender_interval = 250;
+}
+
+static bool
+epoch_scan_callback(const as_val* val, void* udata)
+{
+	epoch_data* data = udata;
+
+	if (! val || ! as_cas_uint32(&data->blocked, 0, 1)) {
+		return true;
+	}
+
+	// Block the first callback across several tends.  A node retired now is stamped with
+	// this epoch and can only be released when no command thread still holds it.
+	uint64_t epoch = as_epoch_current();
+
+	for (uint32_t i = 0; i < 40 && as_epoch_current() < epoch + 2; i++) {
+		as_sleep(100);
+	}
+
+	data->epoch = epoch;
+	data->advanced = as_epoch_current();
+	data->min_active = as_epoch_min_active();
+	return true;
+}
+
+static void
+epoch_scan(atf_test_result* __result__, aerospike* client, bool concurrent)
+{
+	as_policy_scan policy;
+	as_policy_scan_init(&policy);
+	policy.base.socket_timeout = 0;
+	policy.base.total_timeout = 0;
+
+	as_scan scan;
+	as_scan_init(&scan, NAMESPACE, SET);
+	as_scan_set_concurrent(&scan, concurrent);
+
+	epoch_data data = {0};
+	as_error err;
+
+	as_status status = aerospike_scan_foreach(client, &err, &policy, &scan, epoch_scan_callback,
+											  &data);
+	as_scan_destroy(&scan);
+
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_int_eq(data.blocked, 1);
+
+	// Tends kept running while the callback was blocked.
+	assert_true(data.advanced >= data.epoch + 2);
+
+	// The scan thread does not hold an epoch, so nodes retired while it runs are reclaimed.
+	assert_true(data.min_active > data.epoch);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_epoch_put, "write epoch records")
+{
+	as_error err;
+
+	for (int64_t i = 0; i < N_KEYS; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, i);
+
+		as_record rec;
+		as_record_inita(&rec, 1);
+		as_record_set_int64(&rec, "a", i);
+
+		as_status status = aerospike_key_put(as, &err, NULL, &key, &rec);
+		as_record_destroy(&rec);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+}
+
+TEST(cluster_epoch_scan, "blocked scan callback does not hold back node reclamation")
+{
+	aerospike* client = test_client_create(epoch_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	epoch_scan(__result__, client, false);
+	epoch_scan(__result__, client, true);
+	test_client_destroy(client);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_epoch, "node reclamation epoch tests")
+{
+	suite_add(cluster_epoch_put);
+	suite_add(cluster_epoch_scan);
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_key.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_shm_cluster.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_COLLISIONS 4
+#define N_PARTITIONS 1
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+// Namespaces that share one hash slot.  The last one is never added to a table.
+typedef struct {
+	char ns[N_COLLISIONS + 1][AS_MAX_NAMESPACE_SIZE];
+} ns_collisions;
+
+// Shared memory cluster with partition tables only.
+typedef struct {
+	as_cluster_shm* cluster_shm;
+	as_shm_info shm_info;
+} ns_shm;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static uint32_t
+ns_slot(const char* ns)
+{
+	return as_partition_ns_hash(ns) & (AS_PARTITION_HASH_SIZE - 1);
+}
+
+static void
+ns_collisions_init(ns_collisions* c)
+{
+	uint32_t slot = ns_slot("test");
+	uint32_t n = 0;
+
+	strcpy(c->ns[n++], "test");
+
+	for (uint32_t i = 0; n <= N_COLLISIONS; i++) {
+		char ns[AS_MAX_NAMESPACE_SIZE];
+		snprintf(ns, sizeof(ns), "ns%u", i);
+
+		if (ns_slot(ns) == slot) {
+			strcpy(c->ns[n++], ns);
+		}
+	}
+}
+
+static void
+ns_shm_init(ns_shm* shm, const char** ns, uint32_t n_ns)
+{
+	uint32_t offset = sizeof(as_cluster_shm);
+	uint32_t table_size = sizeof(as_partition_table_shm) + sizeof(as_partition_shm) * N_PARTITIONS;
+
+	as_cluster_shm* cluster_shm = calloc(1, offset + table_size * n_ns);
+	cluster_shm->n_partitions = N_PARTITIONS;
+	cluster_shm->partition_tables_capacity = n_ns;
+	cluster_shm->partition_tables_offset = offset;
+	cluster_shm->partition_table_byte_size = table_size;
+
+	as_partition_table_shm* tables = as_shm_get_partition_tables(cluster_shm);
+
+	for (uint32_t i = 0; i < n_ns; i++) {
+		as_partition_table_shm* table = as_shm_get_partition_table(cluster_shm, tables, i);
+		strcpy(table->ns, ns[i]);
+	}
+	cluster_shm->partition_tables_size = n_ns;
+
+	memset(&shm->shm_info, 0, sizeof(as_shm_info));
+	shm->shm_info.cluster_shm = cluster_shm;
+	shm->cluster_shm = cluster_shm;
+}
+
+static void
+ns_shm_destroy(ns_shm* shm)
+{
+	free(shm->cluster_shm);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_namespace_collision, "namespaces with colliding hashes are found")
+{
+	ns_collisions c;
+	ns_collisions_init(&c);
+
+	as_partition_tables tables;
+	memset(&tables, 0, sizeof(as_partition_tables));
+
+	// A namespace whose home slot is taken by a probed collision.
+	char probed[AS_MAX_NAMESPACE_SIZE] = "";
+	uint32_t next_slot = (ns_slot(c.ns[0]) + 1) & (AS_PARTITION_HASH_SIZE - 1);
+
+	for (uint32_t i = 0; ! probed[0]; i++) {
+		char ns[AS_MAX_NAMESPACE_SIZE];
+		snprintf(ns, sizeof(ns), "probe%u", i);
+
+		if (ns_slot(ns) == next_slot) {
+			strcpy(probed, ns);
+		}
+	}
+
+	for (uint32_t i = 0; i < N_COLLISIONS; i++) {
+		assert_not_null(as_partition_tables_restore(&tables, c.ns[i], N_PARTITIONS, false));
+	}
+	assert_not_null(as_partition_tables_restore(&tables, probed, N_PARTITIONS, false));
+
+	// Duplicates are rejected.
+	assert_true(as_partition_tables_restore(&tables, c.ns[1], N_PARTITIONS, false) == NULL);
+
+	for (uint32_t i = 0; i < N_COLLISIONS; i++) {
+		as_partition_table* table = as_partition_tables_get(&tables, c.ns[i]);
+		assert_not_null(table);
+		assert_int_eq(strcmp(table->ns, c.ns[i]), 0);
+
+		as_key key;
+		as_key_init_int64(&key, c.ns[i], "set", 1);
+		assert_true(as_partition_tables_get_key(&tables, &key) == table);
+		assert_int_eq(key.ns_id, i + 1);
+
+		// Second lookup uses the cached table index.
+		assert_true(as_partition_tables_get_key(&tables, &key) == table);
+	}
+
+	as_partition_table* table = as_partition_tables_get(&tables, probed);
+	assert_not_null(table);
+	assert_int_eq(strcmp(table->ns, probed), 0);
+
+	// A colliding namespace that was never added probes past all collisions to an empty slot.
+	assert_true(as_partition_tables_get(&tables, c.ns[N_COLLISIONS]) == NULL);
+
+	as_key key;
+	as_key_init_int64(&key, c.ns[N_COLLISIONS], "set", 1);
+	assert_true(as_partition_tables_get_key(&tables, &key) == NULL);
+	assert_int_eq(key.ns_id, 0);
+
+	as_partition_tables_destroy(&tables);
+}
+
+TEST(cluster_namespace_reorder, "cached namespace index is verified on another client")
+{
+	as_partition_tables t1;
+	memset(&t1, 0, sizeof(as_partition_tables));
+	as_partition_tables_restore(&t1, "ns1", N_PARTITIONS, false);
+	as_partition_tables_restore(&t1, "ns2", N_PARTITIONS, false);
+	as_partition_tables_restore(&t1, "ns3", N_PARTITIONS, false);
+
+	// Same namespaces in a different order.
+	as_partition_tables t2;
+	memset(&t2, 0, sizeof(as_partition_tables));
+	as_partition_tables_restore(&t2, "ns3", N_PARTITIONS, false);
+	as_partition_tables_restore(&t2, "ns1", N_PARTITIONS, false);
+	as_partition_tables_restore(&t2, "ns2", N_PARTITIONS, false);
+
+	// Only one namespace, so the cached index is out of range.
+	as_partition_tables t3;
+	memset(&t3, 0, sizeof(as_partition_tables));
+	as_partition_tables_restore(&t3, "ns2", N_PARTITIONS, false);
+
+	as_key key;
+	as_key_init_int64(&key, "ns2", "set", 1);
+
+	as_partition_table* table = as_partition_tables_get_key(&t1, &key);
+	assert_true(table == as_partition_tables_get(&t1, "ns2"));
+	assert_int_eq(key.ns_id, 2);
+
+	// Index 2 is ns1 in the second client.  The namespace check rejects it.
+	table = as_partition_tables_get_key(&t2, &key);
+	assert_true(table == as_partition_tables_get(&t2, "ns2"));
+	assert_int_eq(strcmp(table->ns, "ns2"), 0);
+	assert_int_eq(key.ns_id, 3);
+
+	table = as_partition_tables_get_key(&t3, &key);
+	assert_true(table == as_partition_tables_get(&t3, "ns2"));
+	assert_int_eq(key.ns_id, 1);
+
+	table = as_partition_tables_get_key(&t1, &key);
+	assert_true(table == as_partition_tables_get(&t1, "ns2"));
+	assert_int_eq(key.ns_id, 2);
+
+	as_partition_tables_destroy(&t1);
+	as_partition_tables_destroy(&t2);
+	as_partition_tables_destroy(&t3);
+}
+
+TEST(cluster_namespace_shm, "shared memory namespace cache handles collisions and reordering")
+{
+	ns_collisions c;
+	ns_collisions_init(&c);
+
+	// All namespaces share one ns_cache slot, so each lookup replaces the cached index.
+	const char* ns1[] = {c.ns[0], c.ns[1], c.ns[2]};
+	const char* ns2[] = {c.ns[2], c.ns[0], c.ns[1]};
+
+	ns_shm shm1;
+	ns_shm_init(&shm1, ns1, 3);
+
+	ns_shm shm2;
+	ns_shm_init(&shm2, ns2, 3);
+
+	as_partition_table_shm* tables = as_shm_get_partition_tables(shm1.cluster_shm);
+
+	for (uint32_t round = 0; round < 2; round++) {
+		for (uint32_t i = 0; i < 3; i++) {
+			as_partition_table_shm* table = as_shm_find_partition_table(&shm1.shm_info, ns1[i]);
+			assert_true(table == as_shm_get_partition_table(shm1.cluster_shm, tables, i));
+			assert_int_eq(shm1.shm_info.ns_cache[ns_slot(ns1[i])], i + 1);
+		}
+	}
+
+	// Cached index points at another namespace.
+	assert_true(as_shm_find_partition_table(&shm1.shm_info, c.ns[0]) == tables);
+	assert_true(as_shm_find_partition_table(&shm1.shm_info, c.ns[N_COLLISIONS]) == NULL);
+	assert_int_eq(shm1.shm_info.ns_cache[ns_slot(c.ns[0])], 1);
+
+	// Key resolved on the first client and reused on a client with different table order.
+	as_key key;
+	as_key_init_int64(&key, c.ns[1], "set", 1);
+
+	as_partition_table_shm* table = as_shm_get_key_partition_table(&shm1.shm_info, &key);
+	assert_true(table == as_shm_get_partition_table(shm1.cluster_shm, tables, 1));
+	assert_int_eq(key.ns_id, 2);
+
+	as_partition_table_shm* tables2 = as_shm_get_partition_tables(shm2.cluster_shm);
+	table = as_shm_get_key_partition_table(&shm2.shm_info, &key);
+	assert_true(table == as_shm_get_partition_table(shm2.cluster_shm, tables2, 2));
+	assert_int_eq(strcmp(table->ns, c.ns[1]), 0);
+	assert_int_eq(key.ns_id, 3);
+
+	table = as_shm_get_key_partition_table(&shm1.shm_info, &key);
+	assert_true(table == as_shm_get_partition_table(shm1.cluster_shm, tables, 1));
+	assert_int_eq(key.ns_id, 2);
+
+	ns_shm_destroy(&shm1);
+	ns_shm_destroy(&shm2);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_namespace, "namespace lookup tests")
+{
+	suite_add(cluster_namespace_collision);
+	suite_add(cluster_namespace_reorder);
+	suite_add(cluster_namespace_shm);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_numa.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "../test.h"
+
+#if defined(__linux__)
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+numa_read(const char* content, cpu_set_t* set)
+{
+	char path[] = "/tmp/as_numa_test_XXXXXX";
+	int fd = mkstemp(path);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	size_t len = strlen(content);
+	bool written = write(fd, content, len) == (ssize_t)len;
+	close(fd);
+
+	bool rv = written && as_numa_read_list(path, set);
+	unlink(path);
+	return rv;
+}
+
+static void
+numa_check(atf_test_result* __result__, cpu_set_t* set, const int* cpus, int n_cpus)
+{
+	assert_int_eq(CPU_COUNT(set), n_cpus);
+
+	for (int i = 0; i < n_cpus; i++) {
+		assert_true(CPU_ISSET(cpus[i], set));
+	}
+}
+
+#endif
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_numa_list, "parse sysfs cpu lists")
+{
+#if defined(__linux__)
+	cpu_set_t set;
+
+	static const int mixed[] = {0, 1, 2, 3, 8, 10, 11};
+	assert_true(numa_read("0-3,8,10-11\n", &set));
+	numa_check(__result__, &set, mixed, 7);
+	assert_false(CPU_ISSET(4, &set));
+	assert_false(CPU_ISSET(9, &set));
+	assert_false(CPU_ISSET(12, &set));
+
+	static const int single[] = {5};
+	assert_true(numa_read("5\n", &set));
+	numa_check(__result__, &set, single, 1);
+
+	// Missing trailing newline.
+	static const int ranges[] = {0, 1, 32, 33};
+	assert_true(numa_read("0-1,32-33", &set));
+	numa_check(__result__, &set, ranges, 4);
+
+	// Cpus beyond the cpu set size are ignored.
+	char buf[64];
+	snprintf(buf, sizeof(buf), "0,%d-%d\n", CPU_SETSIZE - 1, CPU_SETSIZE + 2);
+
+	static const int limit[] = {0, CPU_SETSIZE - 1};
+	assert_true(numa_read(buf, &set));
+	numa_check(__result__, &set, limit, 2);
+
+	// Empty list, for example a memory only node.
+	assert_true(numa_read("\n", &set));
+	assert_int_eq(CPU_COUNT(&set), 0);
+
+	// Empty or missing file.
+	assert_false(numa_read("", &set));
+	assert_false(as_numa_read_list("/tmp/as_numa_test_missing", &set));
+#else
+	info("skipped");
+#endif
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_numa, "NUMA topology tests")
+{
+	suite_add(cluster_numa_list);
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_partition.h>
+#include <citrusleaf/cf_b64.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define MAX_PARTITIONS 4096
+#define MAX_BYTES (MAX_PARTITIONS / 8)
+#define MAX_CHARS cf_b64_encoded_len(MAX_BYTES)
+#define MAX_WORDS (MAX_PARTITIONS / 64 + 1)
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+bitmap_bit(const uint8_t* bytes, uint32_t i)
+{
+	return (bytes[i >> 3] & (0x80 >> (i & 7))) != 0;
+}
+
+static bool
+bitmap_word_bit(const uint64_t* words, uint32_t i)
+{
+	return (words[i >> 6] & (0x8000000000000000ULL >> (i & 63))) != 0;
+}
+
+static void
+bitmap_check(atf_test_result* __result__, uint32_t n_partitions, uint32_t seed)
+{
+	uint32_t n_bytes = (n_partitions + 7) / 8;
+	uint8_t bytes[MAX_BYTES];
+
+	// Random bitmap including bits beyond n_partitions in the last byte.
+	srand(seed);
+
+	for (uint32_t i = 0; i < n_bytes; i++) {
+		bytes[i] = (uint8_t)rand();
+	}
+
+	char b64[MAX_CHARS];
+	uint32_t len = cf_b64_encoded_len(n_bytes);
+	cf_b64_encode(bytes, n_bytes, b64);
+
+	uint32_t n_words = as_partition_bitmap_words(len);
+	assert_true(n_words <= MAX_WORDS);
+
+	// Full decode.  Vector builds decode 16 character blocks and finish with the scalar loop.
+	uint64_t words[MAX_WORDS];
+	as_partition_bitmap_decode(b64, len, n_partitions, words);
+
+	// Scalar reference.  Decoding one 4 character group at a time never uses the vector loop.
+	uint8_t scalar[MAX_BYTES + 2];
+
+	for (uint32_t i = 0; i < len; i += 4) {
+		uint64_t group[1];
+		as_partition_bitmap_decode(b64 + i, 4, 24, group);
+
+		uint8_t* dst = &scalar[(i / 4) * 3];
+		dst[0] = (uint8_t)(group[0] >> 56);
+		dst[1] = (uint8_t)(group[0] >> 48);
+		dst[2] = (uint8_t)(group[0] >> 40);
+	}
+
+	assert_bytes_eq(scalar, n_bytes, bytes, n_bytes);
+
+	for (uint32_t i = 0; i < n_partitions; i++) {
+		assert_true(bitmap_word_bit(words, i) == bitmap_bit(scalar, i));
+	}
+
+	// Bits beyond n_partitions are cleared.
+	for (uint32_t i = n_partitions; i < n_words * 64; i++) {
+		assert_false(bitmap_word_bit(words, i));
+	}
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_partition_bitmap, "vector and scalar partition bitmap decode match")
+{
+	// Cover lengths that are not a multiple of 16, padding in both loops and partition
+	// counts that are not a multiple of 64.
+	// 4096: 684 chars, no padding.  4000: 668 chars, "=" in scalar tail.
+	// 376: 64 chars, "=" in vector block.  368: 64 chars, "==" in vector block.
+	// 88: 16 chars, "=" in only vector block.  80: 16 chars, "==" in only vector block.
+	// 200: 36 chars, "==".  100: 20 chars, "==".  65: 12 chars, scalar only.  63: 12 chars, "=".
+	static const uint32_t n_partitions[] = {
+		4096, 4095, 4000, 1024, 1000, 376, 368, 200, 129, 128, 100, 88, 80, 65, 64, 63, 17, 1
+	};
+
+	for (uint32_t i = 0; i < sizeof(n_partitions) / sizeof(uint32_t); i++) {
+		bitmap_check(__result__, n_partitions[i], i + 1);
+	}
+}
+
+TEST(cluster_partition_bitmap_full, "all partitions owned")
+{
+	static const uint32_t n_partitions[] = {4096, 4000, 100, 63};
+
+	for (uint32_t i = 0; i < sizeof(n_partitions) / sizeof(uint32_t); i++) {
+		uint32_t n_bytes = (n_partitions[i] + 7) / 8;
+		uint8_t bytes[MAX_BYTES];
+		memset(bytes, 0xff, n_bytes);
+
+		char b64[MAX_CHARS];
+		uint32_t len = cf_b64_encoded_len(n_bytes);
+		cf_b64_encode(bytes, n_bytes, b64);
+
+		uint64_t words[MAX_WORDS];
+		as_partition_bitmap_decode(b64, len, n_partitions[i], words);
+
+		uint32_t count = 0;
+		uint32_t n_bits = as_partition_bitmap_words(len) * 64;
+
+		for (uint32_t p = 0; p < n_bits; p++) {
+			if (bitmap_word_bit(words, p)) {
+				count++;
+			}
+		}
+		assert_int_eq(count, n_partitions[i]);
+	}
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_partition, "partition bitmap decode tests")
+{
+	suite_add(cluster_partition_bitmap);
+	suite_add(cluster_partition_bitmap_full);
+}
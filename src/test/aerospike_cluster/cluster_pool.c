@@ -0,0 +1,335 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_conn_pool.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_socket.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_POOLS 4
+#define POOL_CAPACITY 16
+#define N_SOCKETS (N_POOLS * POOL_CAPACITY)
+#define N_THREADS 8
+#define N_ITERATIONS 100000
+#define N_TRIMS 10000
+
+#define N_CONNS 6
+#define N_IDLE 3
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	as_conn_pool* pools;
+	uint32_t in_use[N_SOCKETS + 1];
+	uint32_t duplicates;
+	uint32_t oversize;
+	uint32_t lost;
+	uint32_t gets;
+	uint32_t running;
+} pool_stress;
+
+typedef struct {
+	pool_stress* stress;
+	uint32_t id;
+} pool_worker;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+pool_config(as_config* config)
+{
+	// Connections are only trimmed by the test.
+	config->tender_interval = 60000;
+	config->conn_pools_per_node = 1;
+	config->min_conns_per_node = 0;
+	config->max_conns_per_node = 20;
+	config->max_socket_idle = 30;
+}
+
+static uint32_t
+pool_socket_shard(as_socket* sock)
+{
+	// Fake sockets are numbered from one and belong to a fixed shard.
+	return ((uint32_t)sock->fd - 1) / POOL_CAPACITY;
+}
+
+static void*
+pool_worker_run(void* udata)
+{
+	pool_worker* worker = udata;
+	pool_stress* stress = worker->stress;
+	as_socket sock;
+
+	for (uint32_t i = 0; i < N_ITERATIONS; i++) {
+		uint32_t shard = (worker->id + i) % N_POOLS;
+		bool found = false;
+
+		// Get from own shard first, then steal from neighbors like as_node_get_connection().
+		for (uint32_t j = 0; j < N_POOLS; j++) {
+			if (as_conn_pool_pop_head(&stress->pools[(shard + j) % N_POOLS], &sock)) {
+				found = true;
+				break;
+			}
+		}
+
+		if (! found) {
+			continue;
+		}
+
+		as_incr_uint32(&stress->gets);
+
+		// Each socket may only be handed out to one thread at a time.
+		if (! as_cas_uint32(&stress->in_use[sock.fd], 0, 1)) {
+			as_incr_uint32(&stress->duplicates);
+			continue;
+		}
+
+		as_store_uint32(&stress->in_use[sock.fd], 0);
+
+		if (! as_conn_pool_push_head(&stress->pools[pool_socket_shard(&sock)], &sock)) {
+			as_incr_uint32(&stress->lost);
+		}
+	}
+	return NULL;
+}
+
+static void*
+pool_trim_run(void* udata)
+{
+	pool_stress* stress = udata;
+	uint32_t count = 0;
+
+	// Detach and reattach shards like the tend thread does when no connections are idle.
+	while (as_load_uint32(&stress->running) && count < N_TRIMS) {
+		as_conn_pool* pool = &stress->pools[count++ % N_POOLS];
+
+		// Size is only incremented after a slot is taken and decremented after a socket
+		// is popped, so it stays within capacity.
+		if (as_conn_pool_size(pool) > POOL_CAPACITY) {
+			as_incr_uint32(&stress->oversize);
+		}
+
+		uint32_t first = as_conn_pool_detach(pool);
+
+		if (first == 0) {
+			continue;
+		}
+
+		uint32_t last = first;
+
+		while (pool->links[last - 1] != 0) {
+			last = pool->links[last - 1];
+		}
+		as_conn_pool_attach(pool, first, last);
+	}
+	return NULL;
+}
+
+static as_node*
+pool_node_get(aerospike* client)
+{
+	as_node* node = as_node_get_random(client->cluster);
+
+	if (node) {
+		// Nodes are still referenced by the cluster, so the test does not hold a reservation.
+		as_node_release(node);
+	}
+	return node;
+}
+
+static void
+pool_mark_idle(as_conn_pool* pool, uint32_t n_current)
+{
+	// Pool is ordered from most to least recently used.  Make all but the first n_current
+	// connections idle.
+	uint32_t index = (uint32_t)as_load_uint64(&pool->head);
+	uint32_t pos = 0;
+
+	while (index != 0) {
+		if (pos++ >= n_current) {
+			pool->sockets[index - 1].last_used = 0;
+		}
+		index = pool->links[index - 1];
+	}
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_pool_stress, "concurrent pool get/put never hands out a connection twice")
+{
+	pool_stress stress;
+	memset(&stress, 0, sizeof(pool_stress));
+	stress.pools = as_conn_pools_create(N_POOLS);
+
+	// Shards must not share cache lines.
+	assert_int_eq(sizeof(as_conn_pool), AS_CONN_POOL_ALIGN);
+	assert_int_eq((uintptr_t)stress.pools % AS_CONN_POOL_ALIGN, 0);
+
+	for (uint32_t i = 0; i < N_POOLS; i++) {
+		as_conn_pool_init(&stress.pools[i], 0, POOL_CAPACITY);
+	}
+
+	for (uint32_t i = 1; i <= N_SOCKETS; i++) {
+		as_socket sock;
+		memset(&sock, 0, sizeof(as_socket));
+		sock.fd = (as_socket_fd)i;
+		assert_true(as_conn_pool_push_head(&stress.pools[pool_socket_shard(&sock)], &sock));
+	}
+
+	stress.running = 1;
+
+	pool_worker workers[N_THREADS];
+	pthread_t threads[N_THREADS];
+	pthread_t trim_thread;
+
+	for (uint32_t i = 0; i < N_THREADS; i++) {
+		workers[i].stress = &stress;
+		workers[i].id = i;
+		pthread_create(&threads[i], NULL, pool_worker_run, &workers[i]);
+	}
+	pthread_create(&trim_thread, NULL, pool_trim_run, &stress);
+
+	for (uint32_t i = 0; i < N_THREADS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	as_store_uint32(&stress.running, 0);
+	pthread_join(trim_thread, NULL);
+
+	assert_true(stress.gets > 0);
+	assert_int_eq(stress.duplicates, 0);
+	assert_int_eq(stress.lost, 0);
+	assert_int_eq(stress.oversize, 0);
+
+	// Every socket is back in its own shard exactly once.
+	uint32_t seen[N_SOCKETS + 1];
+	memset(seen, 0, sizeof(seen));
+
+	for (uint32_t i = 0; i < N_POOLS; i++) {
+		as_conn_pool* pool = &stress.pools[i];
+		assert_int_eq(as_conn_pool_size(pool), POOL_CAPACITY);
+
+		as_socket sock;
+		uint32_t count = 0;
+
+		while (as_conn_pool_pop_head(pool, &sock)) {
+			assert_int_eq(pool_socket_shard(&sock), i);
+			seen[sock.fd]++;
+			count++;
+		}
+		assert_int_eq(count, POOL_CAPACITY);
+		assert_int_eq(as_conn_pool_size(pool), 0);
+
+		// Pool is empty, so no fake sockets are closed.
+		as_conn_pool_destroy(pool);
+	}
+
+	for (uint32_t i = 1; i <= N_SOCKETS; i++) {
+		assert_int_eq(seen[i], 1);
+	}
+	as_conn_pools_destroy(stress.pools);
+}
+
+TEST(cluster_pool_trim, "idle connections are trimmed from a live node's pool")
+{
+	aerospike* client = test_client_create(pool_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_node* node = pool_node_get(client);
+	assert_not_null(node);
+
+	as_conn_pool* pool = &node->sync_conn_pools[0];
+	assert_int_eq((uintptr_t)node->sync_conn_pools % AS_CONN_POOL_ALIGN, 0);
+
+	as_socket socks[N_CONNS];
+	as_error err;
+
+	for (uint32_t i = 0; i < N_CONNS; i++) {
+		as_status status = as_node_get_connection(&err, node, 0, as_socket_deadline(1000),
+												  &socks[i]);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+
+	uint32_t total = as_load_uint32(&pool->total);
+	assert_true(total >= N_CONNS);
+
+	for (uint32_t i = 0; i < N_CONNS; i++) {
+		as_node_put_connection(node, &socks[i]);
+	}
+
+	uint32_t size = as_conn_pool_size(pool);
+	assert_true(size >= N_CONNS);
+	assert_int_eq(size, total);
+
+	// Least recently used connections are at the end of the detached chain.
+	pool_mark_idle(pool, size - N_IDLE);
+
+	uint32_t closed = as_load_uint32(&node->sync_conns_closed);
+	as_node_balance_connections(node);
+
+	assert_int_eq(as_conn_pool_size(pool), size - N_IDLE);
+	assert_int_eq(as_load_uint32(&pool->total), total - N_IDLE);
+	assert_int_eq(as_load_uint32(&node->sync_conns_closed), closed + N_IDLE);
+
+	// Current connections are reattached and stay usable in most recently used order.
+	as_socket sock;
+	as_status status = as_node_get_connection(&err, node, 0, as_socket_deadline(1000), &sock);
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_int_eq(sock.fd, socks[N_CONNS - 1].fd);
+	as_node_put_connection(node, &sock);
+
+	// Trim never closes more than the connections above min_size.
+	uint32_t min_size = pool->min_size;
+	pool->min_size = as_load_uint32(&pool->total) - 1;
+	pool_mark_idle(pool, 0);
+	as_node_balance_connections(node);
+	pool->min_size = min_size;
+
+	assert_int_eq(as_conn_pool_size(pool), size - N_IDLE - 1);
+	assert_int_eq(as_load_uint32(&pool->total), total - N_IDLE - 1);
+
+	test_client_destroy(client);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_pool, "lock-free connection pool tests")
+{
+	suite_add(cluster_pool_stress);
+	suite_add(cluster_pool_trim);
+}
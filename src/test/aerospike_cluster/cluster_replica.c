@@ -0,0 +1,145 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_shm_cluster.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define N_REPLICAS 3
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+// Partition maps with three replicas.  Nodes are only checked for the active flag.
+typedef struct {
+	as_cluster cluster;
+	as_shm_info shm_info;
+	as_node* nodes[N_REPLICAS];
+	as_partition p;
+	as_partition_shm p_shm;
+} replica_map;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+replica_map_init(replica_map* map)
+{
+	memset(map, 0, sizeof(replica_map));
+
+	for (uint32_t i = 0; i < N_REPLICAS; i++) {
+		as_node* node = calloc(1, sizeof(as_node));
+		node->active = true;
+		map->nodes[i] = node;
+		map->p.nodes[i] = node;
+
+		// Shared memory node offsets start at one.
+		map->p_shm.nodes[i] = i + 1;
+	}
+	map->p.replica_count = N_REPLICAS;
+	map->p_shm.replica_count = N_REPLICAS;
+	map->shm_info.local_nodes = map->nodes;
+}
+
+static void
+replica_map_destroy(replica_map* map)
+{
+	for (uint32_t i = 0; i < N_REPLICAS; i++) {
+		free(map->nodes[i]);
+	}
+}
+
+static as_node*
+replica_get_node(replica_map* map, bool shm, as_policy_replica replica, uint8_t replica_index)
+{
+	if (shm) {
+		map->cluster.shm_info = &map->shm_info;
+		return as_partition_get_node(&map->cluster, NAMESPACE, &map->p_shm, replica,
+									 replica_index, true);
+	}
+	else {
+		map->cluster.shm_info = NULL;
+		return as_partition_get_node(&map->cluster, NAMESPACE, &map->p, replica,
+									 replica_index, true);
+	}
+}
+
+static void
+replica_walk(atf_test_result* __result__, bool shm)
+{
+	replica_map map;
+	replica_map_init(&map);
+
+	// Each retry increments the replica index, so retries reach every replica in turn.
+	for (uint8_t i = 0; i < N_REPLICAS * 2; i++) {
+		as_node* expected = map.nodes[i % N_REPLICAS];
+
+		assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_SEQUENCE, i) == expected);
+		assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_PREFER_RACK, i) == expected);
+		assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_LOWEST_LATENCY, i) == expected);
+		assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_MASTER, i) == map.nodes[0]);
+	}
+
+	// Inactive replicas are skipped in sequence order.
+	map.nodes[1]->active = false;
+	assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_SEQUENCE, 0) == map.nodes[0]);
+	assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_SEQUENCE, 1) == map.nodes[2]);
+	assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_SEQUENCE, 2) == map.nodes[2]);
+	assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_SEQUENCE, 3) == map.nodes[0]);
+
+	// The third replica is still reached when the first two are unavailable.
+	map.nodes[0]->active = false;
+	assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_SEQUENCE, 0) == map.nodes[2]);
+	assert_true(replica_get_node(&map, shm, AS_POLICY_REPLICA_MASTER, 0) == NULL);
+
+	replica_map_destroy(&map);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_replica_local, "retries walk all replicas in local partition map")
+{
+	replica_walk(__result__, false);
+}
+
+TEST(cluster_replica_shm, "retries walk all replicas in shared memory partition map")
+{
+	replica_walk(__result__, true);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_replica, "replica sequence tests")
+{
+	suite_add(cluster_replica_local);
+	suite_add(cluster_replica_shm);
+}
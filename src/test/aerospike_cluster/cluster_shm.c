@@ -0,0 +1,213 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_shm_cluster.h>
+#include <aerospike/as_sleep.h>
+#include <aerospike/as_status.h>
+#include <string.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_shm"
+#define SHM_KEY 0xA9C00100
+#define SHM_STATS_KEY 0xA9C00101
+#define MAX_PROCESSES 8
+#define N_KEYS 100
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+shm_config(as_config* config)
+{
+	config->use_shm = true;
+	config->shm_key = SHM_KEY;
+}
+
+static void
+shm_stats_config(as_config* config)
+{
+	config->use_shm = true;
+	config->shm_key = SHM_STATS_KEY;
+	config->shm_max_processes = MAX_PROCESSES;
+	config->tender_interval = 100;
+}
+
+static as_partition_table_shm*
+shm_find_table(as_cluster_shm* cluster_shm, const char* ns)
+{
+	as_partition_table_shm* table = as_shm_get_partition_tables(cluster_shm);
+	uint32_t max = as_load_uint32(&cluster_shm->partition_tables_size);
+
+	for (uint32_t i = 0; i < max; i++) {
+		if (strcmp(table->ns, ns) == 0) {
+			return table;
+		}
+		table = as_shm_next_partition_table(cluster_shm, table);
+	}
+	return NULL;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_shm_partitions, "shared memory partition replicas are complete")
+{
+	aerospike* client = test_client_create(shm_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_cluster_shm* cluster_shm = client->cluster->shm_info->cluster_shm;
+	assert_int_eq(cluster_shm->version, AS_SHM_VERSION);
+
+	as_partition_table_shm* table = shm_find_table(cluster_shm, NAMESPACE);
+	assert_not_null(table);
+
+	for (uint32_t i = 0; i < cluster_shm->n_partitions; i++) {
+		as_partition_shm* p = &table->partitions[i];
+
+		// Every partition has a master and a node is never both master and prole.
+		assert_true(p->nodes[0] != 0);
+		assert_int_eq(p->seq & 1, 0);
+
+		for (uint32_t r = 1; r < p->replica_count && r < AS_MAX_REPLICAS; r++) {
+			assert_true(p->nodes[r] == 0 || p->nodes[r] != p->nodes[0]);
+		}
+	}
+
+	as_error err;
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, (int64_t)i);
+
+		as_record rec;
+		as_record_inita(&rec, 1);
+		as_record_set_int64(&rec, "a", (int64_t)i);
+
+		as_status status = aerospike_key_put(client, &err, NULL, &key, &rec);
+		as_record_destroy(&rec);
+		assert_int_eq(status, AEROSPIKE_OK);
+
+		as_record* r = NULL;
+		status = aerospike_key_get(client, &err, NULL, &key, &r);
+		assert_int_eq(status, AEROSPIKE_OK);
+		assert_int_eq(as_record_get_int64(r, "a", -1), (int64_t)i);
+		as_record_destroy(r);
+
+		status = aerospike_key_remove(client, &err, NULL, &key);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+	test_client_destroy(client);
+}
+
+TEST(cluster_shm_version, "shared memory with different layout version is rejected")
+{
+	aerospike* client = test_client_create(shm_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	// Simulate shared memory created by a client with an older layout.
+	as_cluster_shm* cluster_shm = client->cluster->shm_info->cluster_shm;
+	as_store_uint16(&cluster_shm->version, 0);
+
+	aerospike* client2 = test_client_create(shm_config);
+
+	as_store_uint16(&cluster_shm->version, AS_SHM_VERSION);
+
+	if (client2) {
+		test_client_destroy(client2);
+	}
+	test_client_destroy(client);
+	assert_null(client2);
+}
+
+TEST(cluster_shm_process_stats, "process statistics include latency of all commands")
+{
+	aerospike* client = test_client_create(shm_stats_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_error err;
+
+	// Commands without hedged reads or latency based replica selection.
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, (int64_t)i);
+
+		as_record rec;
+		as_record_inita(&rec, 1);
+		as_record_set_int64(&rec, "a", (int64_t)i);
+
+		as_status status = aerospike_key_put(client, &err, NULL, &key, &rec);
+		as_record_destroy(&rec);
+		assert_int_eq(status, AEROSPIKE_OK);
+
+		status = aerospike_key_remove(client, &err, NULL, &key);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+
+	// Wait for the tender to publish statistics.
+	as_sleep(500);
+
+	as_process_shm stats[MAX_PROCESSES];
+	uint32_t n = as_shm_get_process_stats(client->cluster, stats, MAX_PROCESSES);
+	test_client_destroy(client);
+
+	assert_true(n >= 1);
+
+	uint64_t samples = 0;
+
+	for (uint32_t i = 0; i < AS_HEDGE_BUCKETS; i++) {
+		samples += stats[0].latency[i];
+	}
+
+	assert_true(stats[0].commands >= N_KEYS * 2);
+	assert_true(samples > 0);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_shm, "shared memory cluster tests")
+{
+	suite_add(cluster_shm_partitions);
+	suite_add(cluster_shm_version);
+	suite_add(cluster_shm_process_stats);
+}
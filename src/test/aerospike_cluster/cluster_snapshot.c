@@ -0,0 +1,300 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_info.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_info.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_sleep.h>
+#include <aerospike/as_snapshot.h>
+#include <aerospike/as_status.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike* as;
+
+static char g_cluster_name[64];
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_snapshot"
+#define SNAPSHOT_PATH "as_test_snapshot.bin"
+#define SNAPSHOT_HEADER_SIZE 32
+#define SNAPSHOT_N_PARTITIONS_OFFSET 8
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+snapshot_config(as_config* config)
+{
+	as_config_set_snapshot_path(config, SNAPSHOT_PATH);
+	as_config_set_cluster_name(config, g_cluster_name);
+
+	// Only the first tend writes a snapshot.
+	config->snapshot_interval = 3600 * 1000;
+}
+
+static void
+snapshot_no_name_config(as_config* config)
+{
+	as_config_set_snapshot_path(config, SNAPSHOT_PATH);
+}
+
+static bool
+snapshot_cluster_name(void)
+{
+	// Snapshots are only used with a cluster name, so use the name the server reports.
+	as_error err;
+	char* res = NULL;
+
+	if (aerospike_info_any(as, &err, NULL, "cluster-name", &res) != AEROSPIKE_OK) {
+		return false;
+	}
+
+	char* value = NULL;
+	bool rv = false;
+
+	if (as_info_parse_single_response(res, &value) == AEROSPIKE_OK && value &&
+		value[0] != 0 && strcmp(value, "null") != 0 && strlen(value) < sizeof(g_cluster_name)) {
+		strcpy(g_cluster_name, value);
+		rv = true;
+	}
+	free(res);
+	return rv;
+}
+
+static bool
+snapshot_exists(void)
+{
+	FILE* fp = fopen(SNAPSHOT_PATH, "rb");
+
+	if (! fp) {
+		return false;
+	}
+	fclose(fp);
+	return true;
+}
+
+static aerospike*
+snapshot_client_create(void)
+{
+	remove(SNAPSHOT_PATH);
+
+	aerospike* client = test_client_create(snapshot_config);
+
+	if (! client) {
+		return NULL;
+	}
+
+	// Wait for the tend thread to write its snapshot, so it does not race with the test.
+	for (uint32_t i = 0; i < 100 && ! snapshot_exists(); i++) {
+		as_sleep(50);
+	}
+	return client;
+}
+
+static bool
+snapshot_patch(size_t offset, const void* data, size_t len)
+{
+	FILE* fp = fopen(SNAPSHOT_PATH, "r+b");
+
+	if (! fp) {
+		return false;
+	}
+
+	bool rv = fseek(fp, (long)offset, SEEK_SET) == 0 && fwrite(data, len, 1, fp) == 1;
+
+	if (fclose(fp) != 0) {
+		rv = false;
+	}
+	return rv;
+}
+
+static as_status
+snapshot_load(aerospike* client, uint32_t* n_nodes)
+{
+	as_error err;
+	as_vector nodes;
+	as_vector_inita(&nodes, sizeof(as_node*), 16);
+
+	// Partition tables of a connected client already exist, so only nodes are restored.
+	as_status status = as_snapshot_load(client->cluster, &err, &nodes);
+	*n_nodes = nodes.size;
+
+	for (uint32_t i = 0; i < nodes.size; i++) {
+		as_node* node = as_vector_get_ptr(&nodes, i);
+		as_node_release(node);
+	}
+	as_vector_destroy(&nodes);
+	return status;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_snapshot_no_name, "snapshot is not written or loaded without cluster name")
+{
+	remove(SNAPSHOT_PATH);
+
+	aerospike* client = test_client_create(snapshot_no_name_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_error err;
+	as_status status = as_snapshot_write(client->cluster, &err);
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_false(snapshot_exists());
+
+	uint32_t n_nodes = 0;
+	status = snapshot_load(client, &n_nodes);
+	assert_int_ne(status, AEROSPIKE_OK);
+	assert_int_eq(n_nodes, 0);
+
+	test_client_destroy(client);
+}
+
+TEST(cluster_snapshot_load, "snapshot of the same cluster is loaded")
+{
+	if (! snapshot_cluster_name()) {
+		info("skipped: server has no cluster name");
+		return;
+	}
+
+	aerospike* client = snapshot_client_create();
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+	assert_true(snapshot_exists());
+
+	uint32_t n_nodes = 0;
+	as_status status = snapshot_load(client, &n_nodes);
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_int_eq(n_nodes, client->cluster->nodes->size);
+	test_client_destroy(client);
+
+	// New client starts with the snapshot and routes commands before the first tend.
+	client = test_client_create(snapshot_config);
+	assert_not_null(client);
+
+	as_error err;
+	as_key key;
+	as_key_init_int64(&key, NAMESPACE, SET, 1);
+
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_int64(&rec, "a", 1);
+
+	status = aerospike_key_put(client, &err, NULL, &key, &rec);
+	as_record_destroy(&rec);
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	status = aerospike_key_remove(client, &err, NULL, &key);
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	test_client_destroy(client);
+	remove(SNAPSHOT_PATH);
+}
+
+TEST(cluster_snapshot_partitions, "snapshot with wrong partition count is rejected")
+{
+	if (! snapshot_cluster_name()) {
+		info("skipped: server has no cluster name");
+		return;
+	}
+
+	aerospike* client = snapshot_client_create();
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+	assert_true(snapshot_exists());
+
+	uint32_t n_partitions = 1024;
+	assert_true(snapshot_patch(SNAPSHOT_N_PARTITIONS_OFFSET, &n_partitions,
+		sizeof(n_partitions)));
+
+	uint32_t n_nodes = 0;
+	as_status status = snapshot_load(client, &n_nodes);
+	assert_int_ne(status, AEROSPIKE_OK);
+	assert_int_eq(n_nodes, 0);
+
+	test_client_destroy(client);
+	remove(SNAPSHOT_PATH);
+}
+
+TEST(cluster_snapshot_seeds, "snapshot without the configured seeds is rejected")
+{
+	if (! snapshot_cluster_name()) {
+		info("skipped: server has no cluster name");
+		return;
+	}
+
+	aerospike* client = snapshot_client_create();
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+	assert_true(snapshot_exists());
+
+	// Seeds follow the header and the 8 byte aligned cluster name.
+	size_t offset = SNAPSHOT_HEADER_SIZE + ((strlen(g_cluster_name) + 7) & ~(size_t)7);
+	assert_true(snapshot_patch(offset, "#", 1));
+
+	uint32_t n_nodes = 0;
+	as_status status = snapshot_load(client, &n_nodes);
+	assert_int_ne(status, AEROSPIKE_OK);
+	assert_int_eq(n_nodes, 0);
+
+	test_client_destroy(client);
+	remove(SNAPSHOT_PATH);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_snapshot, "partition map snapshot tests")
+{
+	suite_add(cluster_snapshot_no_name);
+	suite_add(cluster_snapshot_load);
+	suite_add(cluster_snapshot_partitions);
+	suite_add(cluster_snapshot_seeds);
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_sleep.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+// Long enough that only an early tend runs during a test.
+#define TEND_INTERVAL 60000
+#define TEND_INTERVAL_MIN 50
+#define BUDGET_MIN 5
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+early_tend_config(as_config* config)
+{
+	config->tender_interval = TEND_INTERVAL;
+	config->tender_interval_min = TEND_INTERVAL_MIN;
+}
+
+static void
+no_early_tend_config(as_config* config)
+{
+	config->tender_interval = TEND_INTERVAL;
+	config->tender_interval_min = 0;
+}
+
+static void
+retry_budget_config(as_config* config)
+{
+	config->tender_interval = TEND_INTERVAL;
+	config->tender_interval_min = TEND_INTERVAL_MIN;
+	config->retry_budget = 10;
+	config->retry_budget_min = BUDGET_MIN;
+}
+
+static void
+backoff_config(as_config* config)
+{
+	config->tender_interval = 250;
+	config->tender_interval_max = 4000;
+}
+
+static bool
+tend_wait_requested(as_cluster* cluster, uint8_t requested)
+{
+	// The tender clears the flag when it starts a tend.
+	for (uint32_t i = 0; i < 20; i++) {
+		if (as_load_uint8(&cluster->tend_requested) == requested) {
+			return true;
+		}
+		as_sleep(TEND_INTERVAL_MIN);
+	}
+	return false;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(cluster_tend_early, "tend request wakes the tender before the tend interval")
+{
+	aerospike* client = test_client_create(early_tend_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_cluster* cluster = client->cluster;
+	assert_int_eq(cluster->tend_interval_min, TEND_INTERVAL_MIN);
+
+	// Let the tender finish its first tend and go to sleep.
+	as_sleep(TEND_INTERVAL_MIN * 4);
+	assert_true(tend_wait_requested(cluster, 0));
+
+	as_cluster_request_tend(cluster);
+	assert_true(tend_wait_requested(cluster, 0));
+
+	// A second request after the early tend wakes the tender again.
+	as_cluster_request_tend(cluster);
+	assert_true(tend_wait_requested(cluster, 0));
+
+	test_client_destroy(client);
+}
+
+TEST(cluster_tend_early_disabled, "tend requests are ignored without tender_interval_min")
+{
+	aerospike* client = test_client_create(no_early_tend_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_cluster* cluster = client->cluster;
+	assert_int_eq(cluster->tend_interval_min, 0);
+
+	as_sleep(TEND_INTERVAL_MIN * 4);
+	as_cluster_request_tend(cluster);
+	assert_int_eq(as_load_uint8(&cluster->tend_requested), 0);
+
+	test_client_destroy(client);
+}
+
+TEST(cluster_tend_early_stats, "early tends do not shorten statistics windows")
+{
+	aerospike* client = test_client_create(retry_budget_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_cluster* cluster = client->cluster;
+	as_sleep(TEND_INTERVAL_MIN * 4);
+
+	uint64_t stats_time = as_load_uint64(&cluster->stats_time);
+	assert_true(stats_time > 0);
+
+	// Use up the retry budget for this interval.
+	for (uint32_t i = 0; i < BUDGET_MIN; i++) {
+		assert_true(as_cluster_retry_budget_allow(cluster));
+	}
+	assert_false(as_cluster_retry_budget_allow(cluster));
+
+	as_cluster_request_tend(cluster);
+	assert_true(tend_wait_requested(cluster, 0));
+
+	// The early tend did not start a new statistics window, so the budget is still spent.
+	assert_int_eq(as_load_uint64(&cluster->stats_time), stats_time);
+	assert_false(as_cluster_retry_budget_allow(cluster));
+
+	test_client_destroy(client);
+}
+
+TEST(cluster_tend_backoff_stats, "statistics are evaluated while tends are backed off")
+{
+	aerospike* client = test_client_create(backoff_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_cluster* cluster = client->cluster;
+	assert_int_eq(cluster->tend_interval, 250);
+	assert_int_eq(cluster->tend_interval_max, 4000);
+
+	// A stable cluster backs off to 4 second tends, but statistics windows stay at 250ms.
+	as_sleep(3000);
+
+	uint64_t stats_time = as_load_uint64(&cluster->stats_time);
+	as_sleep(1000);
+	assert_true(as_load_uint64(&cluster->stats_time) > stats_time);
+
+	test_client_destroy(client);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(cluster_tend, "adaptive tender interval tests")
+{
+	suite_add(cluster_tend_early);
+	suite_add(cluster_tend_early_disabled);
+	suite_add(cluster_tend_early_stats);
+	suite_add(cluster_tend_backoff_stats);
+}
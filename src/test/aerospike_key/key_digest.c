@@ -0,0 +1,212 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_error.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_ripemd160.h>
+#include <aerospike/as_status.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+
+// Covers a partial last chunk for every lane count, plus three full chunks.
+#define MAX_KEYS (AS_RIPEMD160_LANES * 3 + 1)
+
+// Message lengths up to and just past the multi-buffer limit.
+#define MAX_LEN (AS_RIPEMD160_MULTI_MAX + 16)
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+static const char* sets[] = {
+	"",
+	"s",
+	"digest",
+	"set_name_that_spans_most_of_the_first_block_of_the_digest_msg"
+};
+
+#define N_SETS (sizeof(sets) / sizeof(sets[0]))
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+digest_key_init(as_key* key, const char* set, uint32_t type, uint32_t len, uint32_t seed)
+{
+	switch (type) {
+	case 0: {
+		as_key_init_int64(key, NAMESPACE, set, (int64_t)(seed * 0x9E3779B97F4A7C15ULL));
+		break;
+	}
+
+	case 1: {
+		char* str = malloc(len + 1);
+
+		for (uint32_t i = 0; i < len; i++) {
+			str[i] = 'a' + (char)((i + seed) % 26);
+		}
+		str[len] = 0;
+		as_key_init_strp(key, NAMESPACE, set, str, true);
+		break;
+	}
+
+	default: {
+		uint8_t* bytes = malloc(len ? len : 1);
+
+		for (uint32_t i = 0; i < len; i++) {
+			bytes[i] = (uint8_t)(i * 31 + seed);
+		}
+		as_key_init_rawp(key, NAMESPACE, set, bytes, len, true);
+		break;
+	}
+	}
+}
+
+static void
+digest_keys_init(as_key* keys, uint32_t n_keys, uint32_t seed)
+{
+	// Mix key types, set names and lengths so lanes in the same chunk hash messages of
+	// different block counts.
+	for (uint32_t i = 0; i < n_keys; i++) {
+		uint32_t v = i + seed;
+		digest_key_init(&keys[i], sets[v % N_SETS], v % 3, (v * 37) % MAX_LEN, v);
+	}
+}
+
+static void
+digest_keys_destroy(as_key* keys, uint32_t n_keys)
+{
+	for (uint32_t i = 0; i < n_keys; i++) {
+		as_key_destroy(&keys[i]);
+	}
+}
+
+static void
+digest_keys_compare(atf_test_result* __result__, as_key* keys, as_key* expected, uint32_t n_keys)
+{
+	as_error err;
+
+	as_status status = as_keys_set_digests(&err, keys, n_keys);
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		status = as_key_set_digest(&err, &expected[i]);
+		assert_int_eq(status, AEROSPIKE_OK);
+
+		assert_true(keys[i].digest.init);
+		assert_bytes_eq(keys[i].digest.value, AS_DIGEST_VALUE_SIZE,
+			expected[i].digest.value, AS_DIGEST_VALUE_SIZE);
+	}
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(key_digest_counts, "batch digests match single digests for every key count")
+{
+	as_key keys[MAX_KEYS];
+	as_key expected[MAX_KEYS];
+
+	for (uint32_t n = 1; n <= MAX_KEYS; n++) {
+		digest_keys_init(keys, n, n);
+		digest_keys_init(expected, n, n);
+
+		digest_keys_compare(__result__, keys, expected, n);
+
+		digest_keys_destroy(keys, n);
+		digest_keys_destroy(expected, n);
+
+		if (! __result__->success) {
+			info("key count %u", n);
+			return;
+		}
+	}
+}
+
+TEST(key_digest_lengths, "batch digests match single digests for every message length")
+{
+	// Every string and blob length up to past the multi-buffer limit, so each block
+	// boundary and padding case is hashed in a vector lane.
+	uint32_t n_keys = (MAX_LEN + 1) * 2;
+	as_key* keys = malloc(sizeof(as_key) * n_keys);
+	as_key* expected = malloc(sizeof(as_key) * n_keys);
+
+	for (uint32_t len = 0; len <= MAX_LEN; len++) {
+		for (uint32_t type = 1; type <= 2; type++) {
+			uint32_t i = len * 2 + (type - 1);
+			digest_key_init(&keys[i], "digest", type, len, len);
+			digest_key_init(&expected[i], "digest", type, len, len);
+		}
+	}
+
+	digest_keys_compare(__result__, keys, expected, n_keys);
+
+	digest_keys_destroy(keys, n_keys);
+	digest_keys_destroy(expected, n_keys);
+	free(keys);
+	free(expected);
+}
+
+TEST(key_digest_preset, "keys with digests are not rehashed")
+{
+	as_key keys[AS_RIPEMD160_LANES + 3];
+	as_key expected[AS_RIPEMD160_LANES + 3];
+	uint32_t n_keys = AS_RIPEMD160_LANES + 3;
+
+	digest_keys_init(keys, n_keys, 7);
+	digest_keys_init(expected, n_keys, 7);
+
+	// Every third key already has a digest that does not match its value.
+	as_digest_value preset;
+	memset(preset, 0xAB, sizeof(preset));
+
+	for (uint32_t i = 0; i < n_keys; i += 3) {
+		memcpy(keys[i].digest.value, preset, sizeof(preset));
+		keys[i].digest.init = true;
+		memcpy(expected[i].digest.value, preset, sizeof(preset));
+		expected[i].digest.init = true;
+	}
+
+	digest_keys_compare(__result__, keys, expected, n_keys);
+
+	for (uint32_t i = 0; i < n_keys; i += 3) {
+		assert_true(memcmp(keys[i].digest.value, preset, sizeof(preset)) == 0);
+	}
+
+	digest_keys_destroy(keys, n_keys);
+	digest_keys_destroy(expected, n_keys);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(key_digest, "as_keys_set_digests tests")
+{
+	suite_add(key_digest_counts);
+	suite_add(key_digest_lengths);
+	suite_add(key_digest_preset);
+}
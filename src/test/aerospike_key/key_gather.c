@@ -0,0 +1,133 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_operations.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_gather"
+#define BLOB_SIZE (512 * 1024)
+#define ITERATIONS 20
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+gather_config(as_config* config)
+{
+	config->gather_write_threshold = 1024;
+}
+
+static void
+zero_copy_config(as_config* config)
+{
+	config->gather_write_threshold = 1024;
+	config->zero_copy_threshold = 1024;
+}
+
+static void
+gather_put_get(atf_test_result* __result__, aerospike* client)
+{
+	as_error err;
+	uint8_t* blob = malloc(BLOB_SIZE);
+
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		memset(blob, (int)i, BLOB_SIZE);
+
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, (int64_t)i);
+
+		// Small bins are copied and the blob is referenced in the same write.
+		as_record rec;
+		as_record_inita(&rec, 2);
+		as_record_set_int64(&rec, "a", (int64_t)i);
+		as_record_set_raw(&rec, "b", blob, BLOB_SIZE);
+
+		as_status status = aerospike_key_put(client, &err, NULL, &key, &rec);
+		as_record_destroy(&rec);
+		assert_int_eq(status, AEROSPIKE_OK);
+
+		// The next read on the same connection must wait for the response, even when
+		// zero-copy completion notifications are pending on the socket.
+		as_record* r = NULL;
+		status = aerospike_key_get(client, &err, NULL, &key, &r);
+		assert_int_eq(status, AEROSPIKE_OK);
+		assert_int_eq(as_record_get_int64(r, "a", -1), (int64_t)i);
+
+		as_bytes* b = as_record_get_bytes(r, "b");
+		assert_not_null(b);
+		assert_int_eq(b->size, BLOB_SIZE);
+		assert_true(memcmp(b->value, blob, BLOB_SIZE) == 0);
+		as_record_destroy(r);
+
+		status = aerospike_key_remove(client, &err, NULL, &key);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+	free(blob);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(key_gather_put, "put with scatter/gather write")
+{
+	aerospike* client = test_client_create(gather_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+	gather_put_get(__result__, client);
+	test_client_destroy(client);
+}
+
+TEST(key_zero_copy_put, "put with zero-copy write")
+{
+	aerospike* client = test_client_create(zero_copy_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+	gather_put_get(__result__, client);
+	test_client_destroy(client);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(key_gather, "aerospike_key scatter/gather write tests")
+{
+	suite_add(key_gather_put);
+	suite_add(key_zero_copy_put);
+}
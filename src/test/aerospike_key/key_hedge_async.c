@@ -0,0 +1,165 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_event.h>
+#include <aerospike/as_monitor.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike* as;
+static as_monitor monitor;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_hedge"
+#define N_READS 200
+#define MAX_COMMANDS 4
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	uint32_t completed;
+	uint32_t failures;
+	uint32_t over_limit;
+	int max_commands;
+} hedge_data;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+before(atf_suite* suite)
+{
+	as_monitor_init(&monitor);
+	return true;
+}
+
+static bool
+after(atf_suite* suite)
+{
+	as_monitor_destroy(&monitor);
+	return true;
+}
+
+static void
+hedge_get_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+{
+	hedge_data* data = udata;
+
+	if (err) {
+		as_incr_uint32(&data->failures);
+	}
+	else if (as_record_get_int64(rec, "a", -1) != 7) {
+		as_incr_uint32(&data->failures);
+	}
+
+	// Original commands and hedged reads together must stay within the event loop limit.
+	if (data->max_commands > 0 && event_loop->pending > data->max_commands) {
+		as_incr_uint32(&data->over_limit);
+	}
+
+	if (as_aaf_uint32(&data->completed, 1) == N_READS) {
+		as_monitor_notify(&monitor);
+	}
+}
+
+static void
+hedge_get(atf_test_result* __result__, int max_commands)
+{
+	as_error err;
+	as_key key;
+	as_key_init_int64(&key, NAMESPACE, SET, 1);
+
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_int64(&rec, "a", 7);
+
+	as_status status = aerospike_key_put(as, &err, NULL, &key, &rec);
+	as_record_destroy(&rec);
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	// Hedge every read that does not complete within a millisecond.
+	as_policy_read policy;
+	as_policy_read_init(&policy);
+	policy.replica = AS_POLICY_REPLICA_SEQUENCE;
+	policy.hedge_delay = 1;
+
+	as_event_loop* event_loop = as_event_loop_get_by_index(0);
+	int orig_max = event_loop->max_commands_in_process;
+	event_loop->max_commands_in_process = max_commands;
+
+	hedge_data data = {0, 0, 0, max_commands};
+
+	as_monitor_begin(&monitor);
+
+	for (uint32_t i = 0; i < N_READS; i++) {
+		status = aerospike_key_get_async(as, &err, &policy, &key, hedge_get_listener, &data,
+										 event_loop, NULL);
+
+		if (status != AEROSPIKE_OK) {
+			hedge_get_listener(&err, NULL, &data, event_loop);
+		}
+	}
+	as_monitor_wait(&monitor);
+
+	event_loop->max_commands_in_process = orig_max;
+
+	assert_int_eq(data.failures, 0);
+	assert_int_eq(data.over_limit, 0);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(key_hedge_async_get, "async hedged reads")
+{
+	hedge_get(__result__, 0);
+}
+
+TEST(key_hedge_async_limit, "async hedged reads respect max commands in process")
+{
+	hedge_get(__result__, MAX_COMMANDS);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(key_hedge_async, "aerospike_key async hedged read tests")
+{
+	suite_before(before);
+	suite_after(after);
+
+	suite_add(key_hedge_async_get);
+	suite_add(key_hedge_async_limit);
+}
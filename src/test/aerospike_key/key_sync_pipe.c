@@ -0,0 +1,227 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "../test.h"
+#include "../aerospike_test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_sync_pipe"
+#define N_THREADS 16
+#define N_COMMANDS 500
+#define BLOB_SIZE (256 * 1024)
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	aerospike* client;
+	uint32_t id;
+	uint32_t failures;
+	uint32_t timeouts;
+} pipe_thread;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+pipe_config(as_config* config)
+{
+	config->sync_pipe_conns_per_node = 1;
+}
+
+static void*
+pipe_put_get(void* udata)
+{
+	pipe_thread* t = udata;
+	as_error err;
+
+	// Do not retry, so a failed pipeline connection is reported to the test.
+	as_policy_write wp;
+	as_policy_write_init(&wp);
+	wp.base.max_retries = 0;
+
+	as_policy_read rp;
+	as_policy_read_init(&rp);
+	rp.base.max_retries = 0;
+
+	for (uint32_t i = 0; i < N_COMMANDS; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, (int64_t)(t->id * N_COMMANDS + i));
+
+		as_record rec;
+		as_record_inita(&rec, 1);
+		as_record_set_int64(&rec, "a", (int64_t)i);
+
+		as_status status = aerospike_key_put(t->client, &err, &wp, &key, &rec);
+		as_record_destroy(&rec);
+
+		if (status != AEROSPIKE_OK) {
+			info("put error(%d): %s", err.code, err.message);
+			t->failures++;
+			continue;
+		}
+
+		as_record* r = NULL;
+		status = aerospike_key_get(t->client, &err, &rp, &key, &r);
+
+		if (status != AEROSPIKE_OK) {
+			info("get error(%d): %s", err.code, err.message);
+			t->failures++;
+			continue;
+		}
+
+		if (as_record_get_int64(r, "a", -1) != (int64_t)i) {
+			// Response of another command was read.
+			t->failures++;
+		}
+		as_record_destroy(r);
+	}
+	return NULL;
+}
+
+static void*
+pipe_timeout_get(void* udata)
+{
+	pipe_thread* t = udata;
+	as_error err;
+
+	// Read a large record with a timeout that is likely to expire before the response is read.
+	as_policy_read rp;
+	as_policy_read_init(&rp);
+	rp.base.max_retries = 0;
+	rp.base.socket_timeout = 1;
+	rp.base.total_timeout = 1;
+
+	as_key key;
+	as_key_init_int64(&key, NAMESPACE, SET, -1);
+
+	for (uint32_t i = 0; i < N_COMMANDS; i++) {
+		as_record* r = NULL;
+		as_status status = aerospike_key_get(t->client, &err, &rp, &key, &r);
+
+		if (status == AEROSPIKE_OK) {
+			as_record_destroy(r);
+		}
+		else if (status == AEROSPIKE_ERR_TIMEOUT) {
+			t->timeouts++;
+		}
+		else {
+			info("timeout get error(%d): %s", err.code, err.message);
+			t->failures++;
+		}
+	}
+	return NULL;
+}
+
+static void
+pipe_run(atf_test_result* __result__, aerospike* client, bool with_timeouts)
+{
+	pthread_t threads[N_THREADS + 1];
+	pipe_thread data[N_THREADS + 1];
+	uint32_t n = with_timeouts ? N_THREADS + 1 : N_THREADS;
+
+	for (uint32_t i = 0; i < n; i++) {
+		data[i].client = client;
+		data[i].id = i;
+		data[i].failures = 0;
+		data[i].timeouts = 0;
+		pthread_create(&threads[i], NULL, (i < N_THREADS)? pipe_put_get : pipe_timeout_get,
+					   &data[i]);
+	}
+
+	uint32_t failures = 0;
+	uint32_t timeouts = 0;
+
+	for (uint32_t i = 0; i < n; i++) {
+		pthread_join(threads[i], NULL);
+		failures += data[i].failures;
+		timeouts += data[i].timeouts;
+	}
+
+	info("timeouts: %u", timeouts);
+	assert_int_eq(failures, 0);
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(key_sync_pipe_put_get, "concurrent put/get on sync pipeline connection")
+{
+	aerospike* client = test_client_create(pipe_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+	pipe_run(__result__, client, false);
+	test_client_destroy(client);
+}
+
+TEST(key_sync_pipe_timeout, "sync pipeline command timeouts do not fail other commands")
+{
+	aerospike* client = test_client_create(pipe_config);
+
+	if (! client) {
+		info("skipped");
+		return;
+	}
+
+	as_error err;
+	as_key key;
+	as_key_init_int64(&key, NAMESPACE, SET, -1);
+
+	uint8_t* blob = calloc(1, BLOB_SIZE);
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_raw(&rec, "b", blob, BLOB_SIZE);
+
+	as_status status = aerospike_key_put(client, &err, NULL, &key, &rec);
+	as_record_destroy(&rec);
+	free(blob);
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	pipe_run(__result__, client, true);
+
+	status = aerospike_key_remove(client, &err, NULL, &key);
+	assert_int_eq(status, AEROSPIKE_OK);
+	test_client_destroy(client);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(key_sync_pipe, "aerospike_key sync pipeline tests")
+{
+	suite_add(key_sync_pipe_put_get);
+	suite_add(key_sync_pipe_timeout);
+}
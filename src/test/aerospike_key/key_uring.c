@@ -0,0 +1,229 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_event.h>
+#include <aerospike/as_monitor.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_status.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike* as;
+static as_monitor monitor;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_uring"
+#define N_KEYS 20
+
+// Each response spans several 16KB ring buffers.  All pipeline responses together exceed
+// the 16 buffers a connection may queue, so receives must wait for the queue to drain.
+#define BLOB_SIZE (64 * 1024)
+#define BIG_KEY N_KEYS
+#define BIG_SIZE (1024 * 1024)
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	uint32_t completed;
+	uint32_t failures;
+	uint32_t max;
+} uring_data;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+before(atf_suite* suite)
+{
+	as_monitor_init(&monitor);
+	return true;
+}
+
+static bool
+after(atf_suite* suite)
+{
+	as_monitor_destroy(&monitor);
+	return true;
+}
+
+static uint32_t
+uring_blob_size(int64_t id)
+{
+	// Vary sizes so responses end at different offsets within ring buffers.
+	return id == BIG_KEY ? BIG_SIZE : BLOB_SIZE + (uint32_t)id * 97;
+}
+
+static as_status
+uring_put(int64_t id)
+{
+	uint32_t size = uring_blob_size(id);
+	uint8_t* blob = malloc(size);
+	memset(blob, (int)id, size);
+
+	as_key key;
+	as_key_init_int64(&key, NAMESPACE, SET, id);
+
+	as_record rec;
+	as_record_inita(&rec, 2);
+	as_record_set_int64(&rec, "id", id);
+	as_record_set_raw(&rec, "b", blob, size);
+
+	as_error err;
+	as_status status = aerospike_key_put(as, &err, NULL, &key, &rec);
+	as_record_destroy(&rec);
+	free(blob);
+	return status;
+}
+
+static bool
+uring_valid(as_record* rec)
+{
+	int64_t id = as_record_get_int64(rec, "id", -1);
+	as_bytes* b = as_record_get_bytes(rec, "b");
+
+	if (id < 0 || ! b || b->size != uring_blob_size(id)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < b->size; i++) {
+		if (b->value[i] != (uint8_t)id) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+uring_get_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+{
+	uring_data* data = udata;
+
+	if (err || ! uring_valid(rec)) {
+		as_incr_uint32(&data->failures);
+	}
+
+	if (as_aaf_uint32(&data->completed, 1) == data->max) {
+		as_monitor_notify(&monitor);
+	}
+}
+
+static void
+uring_pipeline_noop(void* udata, as_event_loop* event_loop)
+{
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(key_uring_put, "write records with large responses")
+{
+	for (int64_t i = 0; i <= BIG_KEY; i++) {
+		assert_int_eq(uring_put(i), AEROSPIKE_OK);
+	}
+}
+
+TEST(key_uring_get_large, "async read of response larger than receive queue")
+{
+	as_key key;
+	as_key_init_int64(&key, NAMESPACE, SET, BIG_KEY);
+
+	uring_data data = {0, 0, 1};
+	as_error err;
+
+	as_monitor_begin(&monitor);
+
+	as_status status = aerospike_key_get_async(as, &err, NULL, &key, uring_get_listener, &data,
+											   NULL, NULL);
+
+	if (status != AEROSPIKE_OK) {
+		uring_get_listener(&err, NULL, &data, NULL);
+	}
+	as_monitor_wait(&monitor);
+
+	assert_int_eq(data.failures, 0);
+}
+
+TEST(key_uring_pipeline, "pipeline reads with more responses than receive queue")
+{
+	// All reads share one pipeline connection on the same event loop.
+	as_event_loop* event_loop = as_event_loop_get_by_index(0);
+	uring_data data = {0, 0, N_KEYS};
+
+	as_monitor_begin(&monitor);
+
+	for (int64_t i = 0; i < N_KEYS; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, i);
+
+		as_error err;
+		as_status status = aerospike_key_get_async(as, &err, NULL, &key, uring_get_listener,
+												   &data, event_loop, uring_pipeline_noop);
+
+		if (status != AEROSPIKE_OK) {
+			uring_get_listener(&err, NULL, &data, event_loop);
+		}
+	}
+	as_monitor_wait(&monitor);
+
+	assert_int_eq(data.failures, 0);
+}
+
+TEST(key_uring_remove, "remove records")
+{
+	as_error err;
+
+	for (int64_t i = 0; i <= BIG_KEY; i++) {
+		as_key key;
+		as_key_init_int64(&key, NAMESPACE, SET, i);
+
+		as_status status = aerospike_key_remove(as, &err, NULL, &key);
+		assert_int_eq(status, AEROSPIKE_OK);
+	}
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(key_uring, "io_uring event loop command tests")
+{
+	suite_before(before);
+	suite_after(after);
+
+	suite_add(key_uring_put);
+	suite_add(key_uring_get_large);
+	suite_add(key_uring_pipeline);
+	suite_add(key_uring_remove);
+}
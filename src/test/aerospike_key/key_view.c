@@ -0,0 +1,183 @@
+/*
+ * Copyright 2008-2020 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_arraylist.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_list.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_record_view.h>
+#include <aerospike/as_status.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+extern aerospike* as;
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define SET "test_view"
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+view_owns(const as_record_view* view, const void* p)
+{
+	// Bin values must reference the response buffer owned by the view.
+	return view->buf && (const uint8_t*)p > (const uint8_t*)view->buf;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(key_view_put, "put record for views")
+{
+	as_error err;
+	as_key key;
+	as_key_init(&key, NAMESPACE, SET, "view1");
+
+	static const uint8_t blob[] = {1, 2, 3, 4, 5};
+
+	as_arraylist list;
+	as_arraylist_init(&list, 3, 0);
+	as_arraylist_append_int64(&list, 1);
+	as_arraylist_append_int64(&list, 2);
+	as_arraylist_append_int64(&list, 3);
+
+	as_record rec;
+	as_record_inita(&rec, 5);
+	as_record_set_int64(&rec, "i", 42);
+	as_record_set_double(&rec, "d", 1.5);
+	as_record_set_str(&rec, "s", "hello view");
+	as_record_set_raw(&rec, "b", blob, sizeof(blob));
+	as_record_set_list(&rec, "l", (as_list*)&list);
+
+	as_status status = aerospike_key_put(as, &err, NULL, &key, &rec);
+	as_record_destroy(&rec);
+	assert_int_eq(status, AEROSPIKE_OK);
+}
+
+TEST(key_view_get, "get record view")
+{
+	as_error err;
+	as_key key;
+	as_key_init(&key, NAMESPACE, SET, "view1");
+
+	as_record_view view;
+	as_status status = aerospike_key_get_view(as, &err, NULL, &key, &view);
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_int_eq(view.n_bins, 5);
+	assert_not_null(view.buf);
+
+	int64_t i = 0;
+	assert_true(as_record_view_get_int64(&view, "i", &i));
+	assert_int_eq(i, 42);
+
+	double d = 0;
+	assert_true(as_record_view_get_double(&view, "d", &d));
+	assert_true(d == 1.5);
+
+	uint32_t len = 0;
+	const char* s = as_record_view_get_str(&view, "s", &len);
+	assert_not_null(s);
+	assert_int_eq(len, 10);
+	assert_true(memcmp(s, "hello view", len) == 0);
+	assert_true(view_owns(&view, s));
+
+	uint32_t size = 0;
+	const uint8_t* b = as_record_view_get_bytes(&view, "b", &size);
+	assert_not_null(b);
+	assert_int_eq(size, 5);
+	assert_int_eq(b[4], 5);
+	assert_true(view_owns(&view, b));
+
+	as_val* l = as_record_view_get_val(&view, "l");
+	assert_not_null(l);
+	assert_int_eq(as_list_size(as_list_fromval(l)), 3);
+
+	as_record_view_destroy(&view);
+	assert_null(view.buf);
+}
+
+TEST(key_view_select, "select record view")
+{
+	as_error err;
+	as_key key;
+	as_key_init(&key, NAMESPACE, SET, "view1");
+
+	const char* bins[] = {"s", NULL};
+
+	as_record_view view;
+	as_status status = aerospike_key_select_view(as, &err, NULL, &key, bins, &view);
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_int_eq(view.n_bins, 1);
+
+	uint32_t len = 0;
+	const char* s = as_record_view_get_str(&view, "s", &len);
+	assert_not_null(s);
+	assert_true(view_owns(&view, s));
+	assert_null(as_record_view_get(&view, "i"));
+
+	as_record_view_destroy(&view);
+}
+
+TEST(key_view_not_found, "get record view of missing record")
+{
+	as_error err;
+	as_key key;
+	as_key_init(&key, NAMESPACE, SET, "view_missing");
+
+	as_record_view view;
+	as_status status = aerospike_key_get_view(as, &err, NULL, &key, &view);
+	assert_int_eq(status, AEROSPIKE_ERR_RECORD_NOT_FOUND);
+	assert_null(view.buf);
+	assert_int_eq(view.n_bins, 0);
+	as_record_view_destroy(&view);
+}
+
+TEST(key_view_remove, "remove record for views")
+{
+	as_error err;
+	as_key key;
+	as_key_init(&key, NAMESPACE, SET, "view1");
+
+	as_status status = aerospike_key_remove(as, &err, NULL, &key);
+	assert_int_eq(status, AEROSPIKE_OK);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(key_view, "aerospike_key record view tests")
+{
+	suite_add(key_view_put);
+	suite_add(key_view_get);
+	suite_add(key_view_select);
+	suite_add(key_view_not_found);
+	suite_add(key_view_remove);
+}
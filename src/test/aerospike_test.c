@@ -369,6 +369,51 @@ static bool after(atf_plan* plan)
 	}
 }
 
+/******************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+aerospike*
+test_client_create(void (*config_cb)(as_config* config))
+{
+	if (g_tls.enable) {
+		// TLS configuration is owned by the main client.
+		return NULL;
+	}
+
+	as_config config;
+	as_config_init(&config);
+
+	if (! as_config_add_hosts(&config, g_host, g_port)) {
+		return NULL;
+	}
+
+	as_config_set_user(&config, g_user, g_password);
+	config.auth_mode = g_auth_mode;
+
+	if (config_cb) {
+		config_cb(&config);
+	}
+
+	aerospike* client = aerospike_new(&config);
+	as_error err;
+
+	if (aerospike_connect(client, &err) != AEROSPIKE_OK) {
+		error("%s @ %s[%s:%d]", err.message, err.func, err.file, err.line);
+		aerospike_destroy(client);
+		return NULL;
+	}
+	return client;
+}
+
+void
+test_client_destroy(aerospike* client)
+{
+	as_error err;
+	aerospike_close(client, &err);
+	aerospike_destroy(client);
+}
+
 /******************************************************************************
  * TEST PLAN
  *****************************************************************************/
@@ -388,6 +433,10 @@ PLAN(aerospike_test)
 	plan_add(key_apply);
 	plan_add(key_apply2);
 	plan_add(key_operate);
+	plan_add(key_gather);
+	plan_add(key_sync_pipe);
+	plan_add(key_view);
+	plan_add(key_digest);
 
 	// cdt
 	plan_add(list_basics);
@@ -422,6 +471,21 @@ PLAN(aerospike_test)
 
 	// aerospike_scan module
 	plan_add(batch_get);
+	plan_add(batch_write);
+	plan_add(batch_stream);
+
+	// cluster
+	plan_add(cluster_arena);
+	plan_add(cluster_circuit);
+	plan_add(cluster_epoch);
+	plan_add(cluster_namespace);
+	plan_add(cluster_numa);
+	plan_add(cluster_partition);
+	plan_add(cluster_pool);
+	plan_add(cluster_replica);
+	plan_add(cluster_shm);
+	plan_add(cluster_snapshot);
+	plan_add(cluster_tend);
 
 #if AS_EVENT_LIB_DEFINED
 	plan_add(key_basics_async);
@@ -429,9 +493,15 @@ PLAN(aerospike_test)
 	plan_add(map_basics_async);
 	plan_add(key_apply_async);
 	plan_add(key_pipeline);
+	plan_add(key_hedge_async);
 	plan_add(batch_async);
+	plan_add(batch_stream_async);
 	plan_add(scan_async);
 	plan_add(query_async);
 #endif
+
+#if defined(AS_USE_LIBURING)
+	plan_add(key_uring);
+#endif
 }
 
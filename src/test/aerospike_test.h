@@ -16,7 +16,20 @@
  */
 #pragma once
 
+#include <aerospike/aerospike.h>
+
 #define MAX_HOST_SIZE 1024
 extern char g_host[MAX_HOST_SIZE];
 extern int g_port;
 extern bool g_enable_tls;
+
+/**
+ * Create and connect a second client to the test cluster.  The callback may modify the
+ * configuration before connecting.  Return NULL if the client can not be created.
+ * Use test_client_destroy() to close the client.
+ */
+aerospike*
+test_client_create(void (*config_cb)(as_config* config));
+
+void
+test_client_destroy(aerospike* client);